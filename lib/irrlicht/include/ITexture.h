@@ -100,7 +100,8 @@ class ITexture : public virtual IReferenceCounted
 public:
 
 	//! constructor
-	ITexture(const io::path& name) : NamedPath(name)
+	ITexture(const io::path& name) : NamedPath(name), UserData(0),
+		UserDataStamp(0)
 	{
 	}
 
@@ -190,6 +191,29 @@ public:
 	//! Get name of texture (in most cases this is the filename)
 	const io::SNamedPath& getName() const { return NamedPath; }
 
+	//! Stores an application defined pointer with this texture.
+	/** \param data The pointer to store.
+	\param stamp Must be passed to getUserData() to get the pointer back.
+	The application can invalidate all stored pointers by changing the
+	stamp it uses. 0 is never valid. */
+	void setUserData(void* data, u32 stamp)
+	{
+		UserData = data;
+		UserDataStamp = stamp;
+	}
+
+	//! Returns the pointer stored with setUserData().
+	/** \param stamp The stamp the pointer was stored with.
+	\param data Receives the stored pointer.
+	\return True if a pointer was stored with the given stamp. */
+	bool getUserData(u32 stamp, void** data) const
+	{
+		if (stamp == 0 || stamp != UserDataStamp)
+			return false;
+		*data = UserData;
+		return true;
+	}
+
 protected:
 
 	//! Helper function, helps to get the desired texture creation format from the flags.
@@ -209,6 +233,9 @@ protected:
 	}
 
 	io::SNamedPath NamedPath;
+
+	void* UserData;
+	u32 UserDataStamp;
 };
 
 
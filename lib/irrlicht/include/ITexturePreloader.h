@@ -0,0 +1,39 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __I_TEXTURE_PRELOADER_H_INCLUDED__
+#define __I_TEXTURE_PRELOADER_H_INCLUDED__
+
+#include "path.h"
+
+namespace irr
+{
+namespace video
+{
+	class ITexture;
+
+	//! Interface for an object which loads textures in advance.
+	/** Set it with IVideoDriver::setTexturePreloader(). When a texture is
+	requested with IVideoDriver::getTexture() which is not loaded yet, the
+	driver first asks the preloader for it before loading the file. */
+	class ITexturePreloader
+	{
+	public:
+
+		//! Destructor
+		virtual ~ITexturePreloader() {}
+
+		//! Returns a texture which was loaded in advance.
+		/** Only called from the thread which uses the video driver.
+		\param absolutePath Absolute path of the texture file.
+		\return The texture, which is then added to the texture cache of
+		the driver, or 0 if this file was not loaded in advance. The
+		reference of the preloader is passed to the driver. */
+		virtual ITexture* getPreloadedTexture(const io::path& absolutePath) = 0;
+	};
+
+} // end namespace video
+} // end namespace irr
+
+#endif
@@ -8,6 +8,7 @@
 #include "rect.h"
 #include "SColor.h"
 #include "ITexture.h"
+#include "ITexturePreloader.h"
 #include "irrArray.h"
 #include "matrix4.h"
 #include "plane3d.h"
@@ -393,6 +394,13 @@ namespace video
 		IReferenceCounted::drop() for more information. */
 		virtual ITexture* getTexture(io::IReadFile* file) =0;
 
+		//! Sets an object which provides textures loaded in advance.
+		/** getTexture() asks the preloader for a texture before loading
+		it from a file.
+		\param preloader The preloader, or 0 to remove it. It is not
+		grabbed, so it must be removed before it is deleted. */
+		virtual void setTexturePreloader(ITexturePreloader* preloader) =0;
+
 		//! Returns a texture by index
 		/** \param index: Index of the texture, must be smaller than
 		getTextureCount() Please note that this index might change when
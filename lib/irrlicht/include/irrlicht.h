@@ -141,6 +141,7 @@
 #include "ITerrainSceneNode.h"
 #include "ITextSceneNode.h"
 #include "ITexture.h"
+#include "ITexturePreloader.h"
 #include "ITimer.h"
 #include "ITriangleSelector.h"
 #include "IVertexBuffer.h"
@@ -17,7 +17,6 @@ namespace video
 {
 
 // Static members
-io::path CImageLoaderJPG::Filename;
 
 //! constructor
 CImageLoaderJPG::CImageLoaderJPG()
@@ -54,6 +53,10 @@ bool CImageLoaderJPG::isALoadableFileExtension(const io::path& filename) const
 
         // for longjmp, to return to caller on a fatal error
         jmp_buf setjmp_buffer;
+
+        // filename for error-messages (stored here and not in a static
+        // member, so that images can be loaded by several threads)
+        const io::path* filename;
     };
 
 void CImageLoaderJPG::init_source (j_decompress_ptr cinfo)
@@ -111,7 +114,7 @@ void CImageLoaderJPG::output_message(j_common_ptr cinfo)
 	c8 temp1[JMSG_LENGTH_MAX];
 	(*cinfo->err->format_message)(cinfo, temp1);
 	core::stringc errMsg("JPEG FATAL ERROR in ");
-	errMsg += core::stringc(Filename);
+	errMsg += core::stringc(*((irr_jpeg_error_mgr*) cinfo->err)->filename);
 	os::Printer::log(errMsg.c_str(),temp1, ELL_ERROR);
 }
 #endif // _IRR_COMPILE_WITH_LIBJPEG_
@@ -145,8 +148,6 @@ IImage* CImageLoaderJPG::loadImage(io::IReadFile* file) const
 	if (!file)
 		return 0;
 
-	Filename = file->getFileName();
-
 	u8 **rowPtr=0;
 	u8* input = new u8[file->getSize()];
 	file->read(input, file->getSize());
@@ -163,6 +164,7 @@ IImage* CImageLoaderJPG::loadImage(io::IReadFile* file) const
 	cinfo.err = jpeg_std_error(&jerr.pub);
 	cinfo.err->error_exit = error_exit;
 	cinfo.err->output_message = output_message;
+	jerr.filename = &file->getFileName();
 
 	// compatibility fudge:
 	// we need to use setjmp/longjmp for error handling as gcc-linux
@@ -82,8 +82,8 @@ IImageWriter* createImageWriterPPM();
 
 //! constructor
 CNullDriver::CNullDriver(io::IFileSystem* io, const core::dimension2d<u32>& screenSize)
-: FileSystem(io), MeshManipulator(0), ViewPort(0,0,0,0), ScreenSize(screenSize),
-	PrimitivesDrawn(0), MinVertexCountForVBO(500), TextureCreationFlags(0),
+: FileSystem(io), MeshManipulator(0), TexturePreloader(0), ViewPort(0,0,0,0),
+	ScreenSize(screenSize), PrimitivesDrawn(0), MinVertexCountForVBO(500), TextureCreationFlags(0),
 	OverrideMaterial2DEnabled(false), AllowZWriteOnTransparent(false)
 {
 	#ifdef _DEBUG
@@ -396,6 +396,18 @@ ITexture* CNullDriver::getTexture(const io::path& filename)
 	if (texture)
 		return texture;
 
+	// Check if the texture was loaded in advance
+	if (TexturePreloader)
+	{
+		texture = TexturePreloader->getPreloadedTexture(absolutePath);
+		if (texture)
+		{
+			addTexture(texture);
+			texture->drop();
+			return texture;
+		}
+	}
+
 	// Now try to open the file using the complete path.
 	io::IReadFile* file = FileSystem->createAndOpenFile(absolutePath);
 
@@ -435,6 +447,13 @@ ITexture* CNullDriver::getTexture(const io::path& filename)
 }
 
 
+//! Sets an object which provides textures loaded in advance
+void CNullDriver::setTexturePreloader(ITexturePreloader* preloader)
+{
+	TexturePreloader = preloader;
+}
+
+
 //! loads a Texture
 ITexture* CNullDriver::getTexture(io::IReadFile* file)
 {
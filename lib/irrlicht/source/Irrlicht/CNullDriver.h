@@ -91,6 +91,9 @@ namespace video
 		//! loads a Texture
 		virtual ITexture* getTexture(io::IReadFile* file);
 
+		//! Sets an object which provides textures loaded in advance
+		virtual void setTexturePreloader(ITexturePreloader* preloader);
+
 		//! Returns a texture by index
 		virtual ITexture* getTextureByIndex(u32 index);
 
@@ -816,6 +819,9 @@ namespace video
 		//! mesh manipulator
 		scene::IMeshManipulator* MeshManipulator;
 
+		//! provides textures loaded in advance, can be 0
+		ITexturePreloader* TexturePreloader;
+
 		core::rect<s32> ViewPort;
 		core::dimension2d<u32> ScreenSize;
 		core::matrix4 TransformationMatrix;
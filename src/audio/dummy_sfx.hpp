@@ -31,7 +31,7 @@ class DummySFX : public SFXBase
 {
 public:
                        DummySFX(SFXBuffer* buffer, bool positional,
-                                float gain) {}
+                                float gain, bool owns_buffer) {}
     virtual           ~DummySFX()                     {}
 
     /** Late creation, if SFX was initially disabled */
@@ -33,6 +33,7 @@
 #endif
 
 #include "audio/music_ogg.hpp"
+#include "audio/sfx_manager.hpp"
 #include "audio/sfx_openal.hpp"
 #include "config/user_config.hpp"
 #include "io/file_manager.hpp"
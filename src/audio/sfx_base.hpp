@@ -23,6 +23,8 @@
 #include "audio/sfx_manager.hpp"
 #include "utils/no_copy.hpp"
 
+#include <atomic>
+
 /**
  * \defgroup audio
  * This module handles audio (sound effects and music).
@@ -49,8 +51,45 @@ public:
         SFX_NOT_INITIALISED = 3
     };
 
+private:
+    /** Incremented each time a position update for this sfx is queued.
+     *  The sfx thread only executes the position update with the current
+     *  number, so older updates still in the queue are skipped. */
+    std::atomic<unsigned int> m_position_sequence;
+
+    /** Same as m_position_sequence, but for speed updates. */
+    std::atomic<unsigned int> m_speed_sequence;
+
+public:
+                       SFXBase()
+    {
+        m_position_sequence.store(0);
+        m_speed_sequence.store(0);
+    }   // SFXBase
     virtual           ~SFXBase()  {}
 
+    // ------------------------------------------------------------------------
+    /** Called when a position update is queued, returns the sequence
+     *  number of this update. */
+    unsigned int nextPositionSequence() { return ++m_position_sequence; }
+    // ------------------------------------------------------------------------
+    /** Called when a speed update is queued, returns the sequence number
+     *  of this update. */
+    unsigned int nextSpeedSequence() { return ++m_speed_sequence; }
+    // ------------------------------------------------------------------------
+    /** Returns the sequence number of the last queued position update. */
+    unsigned int getPositionSequence() const
+    {
+        return m_position_sequence.load(std::memory_order_acquire);
+    }   // getPositionSequence
+    // ------------------------------------------------------------------------
+    /** Returns the sequence number of the last queued speed update. */
+    unsigned int getSpeedSequence() const
+    {
+        return m_speed_sequence.load(std::memory_order_acquire);
+    }   // getSpeedSequence
+    // ------------------------------------------------------------------------
+
     /** Late creation, if SFX was initially disabled */
     virtual bool       init()                               = 0;
     virtual bool       isLooped()                           = 0;
@@ -22,7 +22,6 @@
 #include "audio/sfx_buffer.hpp"
 #include "config/user_config.hpp"
 #include "io/file_manager.hpp"
-#include "modes/world.hpp"
 #include "race/race_manager.hpp"
 #include "utils/vs.hpp"
 
@@ -48,6 +47,11 @@
 
 SFXManager *SFXManager::m_sfx_manager;
 
+/** Number of commands that fit into the command ring buffer. If the ring is
+ *  full (which should only happen if the sfx thread is blocked), additional
+ *  commands are stored in a slower overflow list. */
+static const size_t SFX_COMMAND_RING_SIZE = 1024;
+
 // ----------------------------------------------------------------------------
 /** Static function to create the singleton sfx manager.
  */
@@ -70,7 +74,7 @@ void SFXManager::destroy()
 // ----------------------------------------------------------------------------
 /** Initialises the SFX manager and loads the sfx from a config file.
  */
-SFXManager::SFXManager()
+SFXManager::SFXManager() : m_sfx_commands(SFX_COMMAND_RING_SIZE)
 {
 
     // The sound manager initialises OpenAL
@@ -86,6 +90,7 @@ SFXManager::SFXManager()
     loadSfx();
 
     pthread_cond_init(&m_cond_request, NULL);
+    pthread_mutex_init(&m_mutex_request, NULL);
 
     pthread_attr_t  attr;
     pthread_attr_init(&attr);
@@ -111,9 +116,6 @@ SFXManager::SFXManager()
     pthread_attr_destroy(&attr);
 
     setMasterSFXVolume( UserConfigParams::m_sfx_volume );
-    m_sfx_commands.lock();
-    m_sfx_commands.getData().clear();
-    m_sfx_commands.unlock();
 
 }  // SoundManager
 
@@ -127,6 +129,7 @@ SFXManager::~SFXManager()
     delete m_thread_id.getData();
     m_thread_id.unlock();
     pthread_cond_destroy(&m_cond_request);
+    pthread_mutex_destroy(&m_mutex_request);
 
     // ---- clear m_all_sfx
     // not strictly necessary, but might avoid copy&paste problems
@@ -176,8 +179,7 @@ SFXManager::~SFXManager()
  */
 void SFXManager::queue(SFXCommands command,  SFXBase *sfx)
 {
-    SFXCommand *sfx_command = new SFXCommand(command, sfx);
-    queueCommand(sfx_command);
+    queueCommand(SFXCommand(command, sfx));
 }   // queue
 
 //----------------------------------------------------------------------------
@@ -190,7 +192,9 @@ void SFXManager::queue(SFXCommands command,  SFXBase *sfx)
  */
 void SFXManager::queue(SFXCommands command, SFXBase *sfx, float f)
 {
-    SFXCommand *sfx_command = new SFXCommand(command, sfx, f);
+    SFXCommand sfx_command(command, sfx, f);
+    if (command == SFX_SPEED)
+        sfx_command.m_speed_sequence = sfx->nextSpeedSequence();
     queueCommand(sfx_command);
 }   // queue(float)
 
@@ -204,8 +208,10 @@ void SFXManager::queue(SFXCommands command, SFXBase *sfx, float f)
  */
 void SFXManager::queue(SFXCommands command, SFXBase *sfx, const Vec3 &p)
 {
-   SFXCommand *sfx_command = new SFXCommand(command, sfx, p);
-   queueCommand(sfx_command);
+    SFXCommand sfx_command(command, sfx, p);
+    if (command == SFX_POSITION)
+        sfx_command.m_position_sequence = sfx->nextPositionSequence();
+    queueCommand(sfx_command);
 }   // queue (Vec3)
 
 //----------------------------------------------------------------------------
@@ -220,7 +226,12 @@ void SFXManager::queue(SFXCommands command, SFXBase *sfx, const Vec3 &p)
 void SFXManager::queue(SFXCommands command, SFXBase *sfx, float f,
                        const Vec3 &p)
 {
-    SFXCommand *sfx_command = new SFXCommand(command, sfx, f, p);
+    SFXCommand sfx_command(command, sfx, f, p);
+    if (command == SFX_SPEED_POSITION)
+    {
+        sfx_command.m_speed_sequence    = sfx->nextSpeedSequence();
+        sfx_command.m_position_sequence = sfx->nextPositionSequence();
+    }
     queueCommand(sfx_command);
 }   // queue(float, Vec3)
 
@@ -230,8 +241,7 @@ void SFXManager::queue(SFXCommands command, SFXBase *sfx, float f,
  */
 void SFXManager::queue(SFXCommands command, MusicInformation *mi)
 {
-    SFXCommand *sfx_command = new SFXCommand(command, mi);
-    queueCommand(sfx_command);
+    queueCommand(SFXCommand(command, mi));
 }   // queue(MusicInformation)
 //----------------------------------------------------------------------------
 /** Queues a command for the music manager that takes a floating point value
@@ -241,42 +251,42 @@ void SFXManager::queue(SFXCommands command, MusicInformation *mi)
  */
 void SFXManager::queue(SFXCommands command, MusicInformation *mi, float f)
 {
-    SFXCommand *sfx_command = new SFXCommand(command, mi, f);
-    queueCommand(sfx_command);
+    queueCommand(SFXCommand(command, mi, f));
 }   // queue(MusicInformation)
 
 //----------------------------------------------------------------------------
-/** Enqueues a command to the sfx queue threadsafe. Then signal the
- *  sfx manager to wake up.
- *  \param command Pointer to the command to queue up.
+/** Enqueues a command to the sfx queue threadsafe. This does not take a
+ *  lock, and commands are never dropped: position and speed updates that
+ *  are outdated by a later update of the same sfx are instead skipped by
+ *  the sfx thread (see SFXBase::nextPositionSequence).
+ *  \param command The command to queue up.
  */
-void SFXManager::queueCommand(SFXCommand *command)
+void SFXManager::queueCommand(const SFXCommand &command)
 {
-    m_sfx_commands.lock();
-    if(World::getWorld() && 
-        m_sfx_commands.getData().size() > 20*race_manager->getNumberOfKarts()+20 &&
-        race_manager->getMinorMode() != RaceManager::MINOR_MODE_CUTSCENE)
+    if (!m_sfx_commands.push(command))
     {
-        if(command->m_command==SFX_POSITION || command->m_command==SFX_LOOP ||
-           command->m_command==SFX_SPEED    || 
-           command->m_command==SFX_SPEED_POSITION                               )
+        static int count_messages = 0;
+        if (count_messages < 5)
         {
-            delete command;
-            static int count_messages = 0;
-            if(count_messages < 5)
-            {
-                Log::warn("SFXManager", "Throttling sfx - queue size %d",
-                         m_sfx_commands.getData().size());
-                count_messages++;
-            }
-            m_sfx_commands.unlock();
-            return;
-        }   // if throttling
+            Log::warn("SFXManager", "Sfx command ring is full, using "
+                      "overflow list.");
+            count_messages++;
+        }
     }
-    m_sfx_commands.getData().push_back(command);
-    m_sfx_commands.unlock();
 }   // queueCommand
 
+//----------------------------------------------------------------------------
+/** Wakes up the sfx thread if it is waiting for commands. The mutex is
+ *  necessary so that the signal can not be sent between the thread
+ *  testing for an empty queue and starting to wait.
+ */
+void SFXManager::wakeUpThread()
+{
+    pthread_mutex_lock(&m_mutex_request);
+    pthread_cond_signal(&m_cond_request);
+    pthread_mutex_unlock(&m_mutex_request);
+}   // wakeUpThread
+
 //----------------------------------------------------------------------------
 /** Puts a NULL request into the queue, which will trigger the thread to
  *  exit.
@@ -285,7 +295,7 @@ void SFXManager::stopThread()
 {
     queue(SFX_EXIT);
     // Make sure the thread wakes up.
-    pthread_cond_signal(&m_cond_request);
+    wakeUpThread();
 }   // stopThread
 
 //----------------------------------------------------------------------------
@@ -301,96 +311,107 @@ void* SFXManager::mainLoop(void *obj)
 
     pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL);
 
-    me->m_sfx_commands.lock();
-
-    // Wait till we have an empty sfx in the queue
-    while (me->m_sfx_commands.getData().empty() ||
-           me->m_sfx_commands.getData().front()->m_command!=SFX_EXIT)
+    SFXCommand current;
+    while (true)
     {
-        bool empty = me->m_sfx_commands.getData().empty();
-
-        // Wait in cond_wait for a request to arrive. The 'while' is necessary
-        // since "spurious wakeups from the pthread_cond_wait ... may occur"
-        // (pthread_cond_wait man page)!
-        while (empty)
+        if (!me->m_sfx_commands.pop(&current))
         {
-            pthread_cond_wait(&me->m_cond_request, me->m_sfx_commands.getMutex());
-            empty = me->m_sfx_commands.getData().empty();
+            // Wait in cond_wait for a request to arrive. The 'while' is
+            // necessary since "spurious wakeups from the pthread_cond_wait
+            // ... may occur" (pthread_cond_wait man page)!
+            pthread_mutex_lock(&me->m_mutex_request);
+            while (!me->m_sfx_commands.pop(&current))
+                pthread_cond_wait(&me->m_cond_request, &me->m_mutex_request);
+            pthread_mutex_unlock(&me->m_mutex_request);
         }
-        SFXCommand *current = me->m_sfx_commands.getData().front();
-        me->m_sfx_commands.getData().erase(me->m_sfx_commands.getData().begin());
 
-        if (current->m_command == SFX_EXIT)
-        {
-            delete current;
+        if (current.m_command == SFX_EXIT)
             break;
-        }
-        me->m_sfx_commands.unlock();
-        switch (current->m_command)
+
+        switch (current.m_command)
         {
-        case SFX_PLAY:     current->m_sfx->reallyPlayNow();       break;
+        case SFX_PLAY:     current.m_sfx->reallyPlayNow();       break;
         case SFX_PLAY_POSITION:
-            current->m_sfx->reallyPlayNow(current->m_parameter);  break;
-        case SFX_STOP:     current->m_sfx->reallyStopNow();       break;
-        case SFX_PAUSE:    current->m_sfx->reallyPauseNow();      break;
-        case SFX_RESUME:   current->m_sfx->reallyResumeNow();     break;
-        case SFX_SPEED:    current->m_sfx->reallySetSpeed(
-                                  current->m_parameter.getX());   break;
-        case SFX_POSITION: current->m_sfx->reallySetPosition(
-                                         current->m_parameter);   break;
-        case SFX_SPEED_POSITION: current->m_sfx->reallySetSpeedPosition(
-                                         // Extract float from W component
-                                         current->m_parameter.getW(),
-                                         current->m_parameter);   break;
-        case SFX_VOLUME:   current->m_sfx->reallySetVolume(
-                                  current->m_parameter.getX());   break;
+            current.m_sfx->reallyPlayNow(current.m_parameter);  break;
+        case SFX_STOP:     current.m_sfx->reallyStopNow();       break;
+        case SFX_PAUSE:    current.m_sfx->reallyPauseNow();      break;
+        case SFX_RESUME:   current.m_sfx->reallyResumeNow();     break;
+        case SFX_SPEED:
+            // Skip the update if a newer one is already queued
+            if (current.m_speed_sequence ==
+                current.m_sfx->getSpeedSequence())
+                current.m_sfx->reallySetSpeed(current.m_parameter.getX());
+            break;
+        case SFX_POSITION:
+            if (current.m_position_sequence ==
+                current.m_sfx->getPositionSequence())
+                current.m_sfx->reallySetPosition(current.m_parameter);
+            break;
+        case SFX_SPEED_POSITION:
+        {
+            // Speed and position can be outdated independently of each
+            // other (by a later SFX_SPEED or SFX_POSITION update).
+            bool speed = current.m_speed_sequence ==
+                         current.m_sfx->getSpeedSequence();
+            bool position = current.m_position_sequence ==
+                            current.m_sfx->getPositionSequence();
+            // Extract float from W component
+            if (speed && position)
+                current.m_sfx->reallySetSpeedPosition(
+                    current.m_parameter.getW(), current.m_parameter);
+            else if (speed)
+                current.m_sfx->reallySetSpeed(current.m_parameter.getW());
+            else if (position)
+                current.m_sfx->reallySetPosition(current.m_parameter);
+            break;
+        }
+        case SFX_VOLUME:   current.m_sfx->reallySetVolume(
+                                  current.m_parameter.getX());   break;
         case SFX_MASTER_VOLUME:
-            current->m_sfx->reallySetMasterVolumeNow(
-                                  current->m_parameter.getX());   break;
-        case SFX_LOOP:     current->m_sfx->reallySetLoop(
-                             current->m_parameter.getX() != 0);   break;
-        case SFX_DELETE:     me->deleteSFX(current->m_sfx);       break;
+            current.m_sfx->reallySetMasterVolumeNow(
+                                  current.m_parameter.getX());   break;
+        case SFX_LOOP:     current.m_sfx->reallySetLoop(
+                             current.m_parameter.getX() != 0);   break;
+        case SFX_DELETE:     me->deleteSFX(current.m_sfx);       break;
         case SFX_PAUSE_ALL:  me->reallyPauseAllNow();             break;
         case SFX_RESUME_ALL: me->reallyResumeAllNow();            break;
         case SFX_LISTENER:   me->reallyPositionListenerNow();     break;
         case SFX_UPDATE:     me->reallyUpdateNow(current);        break;
         case SFX_MUSIC_START:
         {
-            current->m_music_information->setDefaultVolume();
-            current->m_music_information->startMusic();           break;
+            current.m_music_information->setDefaultVolume();
+            current.m_music_information->startMusic();           break;
         }
         case SFX_MUSIC_STOP:
-            current->m_music_information->stopMusic();            break;
+            current.m_music_information->stopMusic();            break;
         case SFX_MUSIC_PAUSE:
-            current->m_music_information->pauseMusic();           break;
+            current.m_music_information->pauseMusic();           break;
         case SFX_MUSIC_RESUME:
-            current->m_music_information->resumeMusic();
+            current.m_music_information->resumeMusic();
             // This might be necessasary if the volume was changed
             // in the in-game menu
-            current->m_music_information->setDefaultVolume();     break;
+            current.m_music_information->setDefaultVolume();     break;
         case SFX_MUSIC_SWITCH_FAST:
-            current->m_music_information->switchToFastMusic();    break;
+            current.m_music_information->switchToFastMusic();    break;
         case SFX_MUSIC_SET_TMP_VOLUME:
         {
-            MusicInformation *mi = current->m_music_information;
-            mi->setTemporaryVolume(current->m_parameter.getX());  break;
+            MusicInformation *mi = current.m_music_information;
+            mi->setTemporaryVolume(current.m_parameter.getX());  break;
         }
         case SFX_MUSIC_WAITING:
-               current->m_music_information->setMusicWaiting();   break;
+               current.m_music_information->setMusicWaiting();   break;
         case SFX_MUSIC_DEFAULT_VOLUME:
         {
-            current->m_music_information->setDefaultVolume();
+            current.m_music_information->setDefaultVolume();
             break;
         }
         case SFX_CREATE_SOURCE:
-            current->m_sfx->init(); break;
+            current.m_sfx->init(); break;
         default: assert("Not yet supported.");
         }
-        delete current;
-        current = NULL;
-        // We access the size without lock, doesn't matter if we
-        // should get an incorrect value because of concurrent read/writes
-        if (me->m_sfx_commands.getData().size() == 0)
+        // We access the queue without lock, doesn't matter if we
+        // should get an incorrect value because of concurrent writes
+        if (me->m_sfx_commands.isEmpty())
         {
             // Wait some time to let other threads run, then queue an
             // update event to keep music playing.
@@ -399,22 +420,12 @@ void* SFXManager::mainLoop(void *obj)
             t = StkTime::getRealTime() - t;
             me->queue(SFX_UPDATE, (SFXBase*)NULL, float(t));
         }
-        me->m_sfx_commands.lock();
 
     }   // while
 
     // Signal that the sfx manager can now be deleted.
-    // We signal this even before cleaning up memory, since there is no
-    // need to keep the user waiting for STK to exit.
     me->setCanBeDeleted();
 
-    // Clean up memory to avoid leak detection
-    while(!me->m_sfx_commands.getData().empty())
-    {
-        delete me->m_sfx_commands.getData().front();
-        me->m_sfx_commands.getData().erase(me->m_sfx_commands.getData().begin());
-    }
-    me->m_sfx_commands.unlock();
     return NULL;
 }   // mainLoop
 
@@ -704,7 +715,7 @@ void SFXManager::update()
 {
     queue(SFX_UPDATE, (SFXBase*)NULL);
     // Wake up the sfx thread to handle all queued up audio commands.
-    pthread_cond_signal(&m_cond_request);
+    wakeUpThread();
 }   // update
 
 //----------------------------------------------------------------------------
@@ -712,7 +723,7 @@ void SFXManager::update()
  *  This function is executed once per frame (triggered by the audio thread).
  *  \param current The sfx command - used to get timestep information.
 */
-void SFXManager::reallyUpdateNow(SFXCommand *current)
+void SFXManager::reallyUpdateNow(const SFXCommand &current)
 {
     if (m_last_update_time < 0.0)
     {
@@ -724,7 +735,7 @@ void SFXManager::reallyUpdateNow(SFXCommand *current)
     m_last_update_time = StkTime::getRealTime();
     float dt = float(m_last_update_time - previous_update_time);
 
-    assert(current->m_command==SFX_UPDATE);
+    assert(current.m_command==SFX_UPDATE);
     if (music_manager->getCurrentMusic())
         music_manager->getCurrentMusic()->update(dt);
     m_all_sfx.lock();
@@ -20,7 +20,7 @@
 #define HEADER_SFX_MANAGER_HPP
 
 #include "utils/can_be_deleted.hpp"
-#include "utils/leak_check.hpp"
+#include "utils/mpsc_queue.hpp"
 #include "utils/no_copy.hpp"
 #include "utils/synchronised.hpp"
 #include "utils/vec3.hpp"
@@ -113,11 +113,10 @@ public:
 private:
 
     /** Data structure for the queue, which stores a sfx and the command to 
-     *  execute for it. */
-    class SFXCommand : public NoCopy
+     *  execute for it. Commands are stored by value in a preallocated ring
+     *  buffer, so this class must remain small and copyable. */
+    class SFXCommand
     {
-    private:
-        LEAK_CHECK()
     public:
         /** The sound effect for which the command should be executed. */
         SFXBase *m_sfx;
@@ -130,6 +129,23 @@ private:
         /** Optional parameter for commands that need more input. Single
          *  floating point values are stored in the X component. */
         Vec3        m_parameter;
+
+        /** For position updates the sequence number of this update (see
+         *  SFXBase::nextPositionSequence), used to skip outdated updates. */
+        unsigned int m_position_sequence;
+
+        /** For speed updates the sequence number of this update. */
+        unsigned int m_speed_sequence;
+        // --------------------------------------------------------------------
+        /** Default constructor, only used for the ring buffer entries. */
+        SFXCommand()
+        {
+            m_command           = SFX_UPDATE;
+            m_sfx               = NULL;
+            m_music_information = NULL;
+            m_position_sequence = 0;
+            m_speed_sequence    = 0;
+        }   // SFXCommand
         // --------------------------------------------------------------------
         SFXCommand(SFXCommands command, SFXBase *base)
         {
@@ -199,8 +215,8 @@ private:
     /** The actual instances (sound sources) */
     Synchronised<std::vector<SFXBase*> > m_all_sfx;
 
-    /** The list of sound effects to be played in the next update. */
-    Synchronised< std::vector<SFXCommand*> > m_sfx_commands;
+    /** The queue of commands to be executed by the sfx thread. */
+    MPSCQueue<SFXCommand>     m_sfx_commands;
 
     /** To play non-positional sounds without having to create a
      *  new object for each. */
@@ -220,13 +236,18 @@ private:
     /** A conditional variable to wake up the main loop. */
     pthread_cond_t            m_cond_request;
 
+    /** The mutex used with m_cond_request. The queue itself is lock free,
+     *  this is only used to avoid missing a wake up signal. */
+    pthread_mutex_t           m_mutex_request;
+
     void                      loadSfx();
                              SFXManager();
     virtual                 ~SFXManager();
 
     static void* mainLoop(void *obj);
     void deleteSFX(SFXBase *sfx);
-    void queueCommand(SFXCommand *command);
+    void queueCommand(const SFXCommand &command);
+    void wakeUpThread();
     void reallyPositionListenerNow();
 
 public:
@@ -272,7 +293,7 @@ public:
     void                     resumeAll();
     void                     reallyResumeAllNow();
     void                     update();
-    void                     reallyUpdateNow(SFXCommand *current);
+    void                     reallyUpdateNow(const SFXCommand &current);
     bool                     soundExist(const std::string &name);
     void                     setMasterSFXVolume(float gain);
     float                    getMasterSFXVolume() const { return m_master_gain; }
@@ -28,6 +28,7 @@
 #include "graphics/glwrap.hpp"
 #include "graphics/irr_driver.hpp"
 #include "online/http_request.hpp"
+#include "online/request_manager.hpp"
 #include "utils/random_generator.hpp"
 
 #ifdef __APPLE__
@@ -264,6 +265,8 @@ const std::string& getOSVersion()
  */
 void reportHardwareStats()
 {
+    // A server has no graphics hardware worth reporting.
+#ifndef SERVER_ONLY
     if(!UserConfigParams::m_hw_report_enable)
         return;
 
@@ -351,7 +354,9 @@ void reportHardwareStats()
         /** Version number of the hw report. */
         int m_version;
     public:
-        HWReportRequest(int version) : Online::HTTPRequest(/*manage memory*/true, 1)
+        HWReportRequest(int version)
+            : Online::HTTPRequest(/*manage memory*/true,
+                            Online::RequestManager::HTTP_BACKGROUND_PRIORITY)
                                      , m_version(version)
         {}
         // --------------------------------------------------------------------
@@ -391,6 +396,7 @@ void reportHardwareStats()
     request->setURL((std::string)UserConfigParams::m_server_hw_report+"/upload/v1/");
     //request->setURL("http://127.0.0.1:8000/upload/v1/");
     request->queue();
+#endif   // !SERVER_ONLY
 
 }   // reportHardwareStats
 
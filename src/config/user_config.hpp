@@ -535,6 +535,9 @@ namespace UserConfigParams
     /** True if fps should be printed each frame. */
     PARAM_PREFIX bool m_fps_debug PARAM_DEFAULT(false);
 
+    /** True if the sector lookup of each loaded graph should be timed. */
+    PARAM_PREFIX bool m_graph_benchmark PARAM_DEFAULT(false);
+
     /** True if arena (battle/soccer) ai profiling. */
     PARAM_PREFIX bool m_arena_ai_stats PARAM_DEFAULT(false);
 
@@ -602,6 +605,15 @@ namespace UserConfigParams
                             "stun.voxgratia.org",
                             "stun.xten.com") );
 
+    PARAM_PREFIX IntUserConfigParam         m_network_state_frequency
+            PARAM_DEFAULT(  IntUserConfigParam(10, "network_state_frequency",
+                                       "Number of kart state updates sent per second.") );
+
+    PARAM_PREFIX IntUserConfigParam         m_server_ticks_per_second
+            PARAM_DEFAULT(  IntUserConfigParam(60, "server_ticks_per_second",
+                                       "Number of fixed simulation steps per second "
+                                       "on a server without graphics.") );
+
     PARAM_PREFIX BoolUserConfigParam m_log_packets
             PARAM_DEFAULT( BoolUserConfigParam(false, "log-network-packets",
                                                  "If all network packets should be logged") );
@@ -689,6 +701,12 @@ namespace UserConfigParams
     PARAM_PREFIX BoolUserConfigParam        m_cache_overworld
             PARAM_DEFAULT(  BoolUserConfigParam(true, "cache-overworld") );
 
+    PARAM_PREFIX IntUserConfigParam         m_worker_threads
+            PARAM_DEFAULT(  IntUserConfigParam(-1, "worker_threads",
+            "Number of additional threads used for parallel work in each "
+            "frame, e.g. AI updates. -1 means one less than the number of "
+            "processors.") );
+
     // TODO : is this used with new code? does it still work?
     PARAM_PREFIX BoolUserConfigParam        m_crashed
             PARAM_DEFAULT(  BoolUserConfigParam(false, "crashed") );
@@ -817,6 +835,15 @@ namespace UserConfigParams
                                                  &m_online_group,
                                                     "Version of the server API to use."));
 
+    PARAM_PREFIX IntUserConfigParam        m_max_http_transfers
+            PARAM_DEFAULT( IntUserConfigParam(   6,
+                                                 "max_http_transfers",
+                                                 &m_online_group,
+                                                 "Maximum number of http "
+                                                 "requests (e.g. addon icon "
+                                                 "downloads) done at the "
+                                                 "same time."));
+
 
     // ---- Addon server related entries
     PARAM_PREFIX GroupUserConfigParam       m_addon_group
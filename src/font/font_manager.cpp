@@ -24,6 +24,7 @@
 #include "font/face_ttf.hpp"
 #include "font/regular_face.hpp"
 #include "utils/string_utils.hpp"
+#include "utils/time.hpp"
 #include "utils/translation.hpp"
 
 FontManager *font_manager = NULL;
@@ -135,4 +136,38 @@ void FontManager::unitTesting()
         }
     }
 
+    // Benchmark the glyph tables and the dimension cache of a font
+    RegularFace* regular = getFont<RegularFace>();
+    std::vector<core::stringw> texts;
+    for (int i = 0; i < 500; i++)
+    {
+        core::stringw text(L"The quick brown fox jumps over the lazy dog ");
+        text += core::stringw(i);
+        texts.push_back(text);
+    }
+    std::vector<core::dimension2d<u32> > dims(texts.size());
+
+    double start = StkTime::getRealTime();
+    for (unsigned int i = 0; i < texts.size(); i++)
+        dims[i] = regular->getDimension(texts[i].c_str());
+    double measured = StkTime::getRealTime();
+    for (unsigned int i = 0; i < texts.size(); i++)
+    {
+        core::dimension2d<u32> dim = regular->getDimension(texts[i].c_str());
+        assert(dim == dims[i]);
+    }
+    double cached = StkTime::getRealTime();
+    unsigned int num_chars = 0;
+    for (unsigned int i = 0; i < texts.size(); i++)
+    {
+        // A position that is never reached, so all characters are looked up
+        regular->getCharacterFromPos(texts[i].c_str(), 1 << 30);
+        num_chars += texts[i].size();
+    }
+    double end = StkTime::getRealTime();
+    Log::info("UnitTest", "Measured %d texts in %f ms, cached in %f ms, "
+              "looked up %d glyphs in %f ms.", (int)texts.size(),
+              (measured - start) * 1000.0, (cached - measured) * 1000.0,
+              num_chars, (end - cached) * 1000.0);
+
 }   // unitTesting
@@ -25,8 +25,17 @@
 #include "graphics/irr_driver.hpp"
 #include "guiengine/engine.hpp"
 #include "guiengine/skin.hpp"
+#include "utils/hash.hpp"
 #include "utils/string_utils.hpp"
 
+namespace
+{
+    /** Maximum number of texts in the dimension cache of a font. Texts that
+     *  change each frame (e.g. times) fill up the cache, which is then
+     *  simply cleared. */
+    const unsigned int MAX_CACHED_DIMENSIONS = 1024;
+}   // namespace
+
 // ----------------------------------------------------------------------------
 /** Constructor. It will initialize the \ref m_spritebank and TTF files to use.
  *  \param name The name of face, used by irrlicht to distinguish spritebank.
@@ -100,6 +109,7 @@ void FontWithFace::reset()
     m_new_char_holder.clear();
     m_character_area_map.clear();
     m_character_glyph_info_map.clear();
+    m_dimension_cache.clear();
     m_spritebank->clear();
     createNewGlyphPage();
 }   // reset
@@ -121,7 +131,7 @@ void FontWithFace::loadGlyphInfo(wchar_t c)
         if (glyph_index > 0) break;
         font_number++;
     }
-    m_character_glyph_info_map[c] = GlyphInfo(font_number, glyph_index);
+    m_character_glyph_info_map.set(c, GlyphInfo(font_number, glyph_index));
 }   // loadGlyphInfo
 
 // ----------------------------------------------------------------------------
@@ -293,7 +303,7 @@ void FontWithFace::insertGlyph(wchar_t c, const GlyphInfo& gi)
     a.offset_y = m_glyph_max_height - cur_height + cur_offset_y;
     a.offset_y_bt = -cur_offset_y;
     a.spriteno = f.rectNumber;
-    m_character_area_map[c] = a;
+    m_character_area_map.set(c, a);
 
     // Clean the temporary glyph
     glyph->drop();
@@ -406,13 +416,12 @@ const FontWithFace::FontArea&
     FontWithFace::getAreaFromCharacter(const wchar_t c,
                                        bool* fallback_font) const
 {
-    std::map<wchar_t, FontArea>::const_iterator n =
-        m_character_area_map.find(c);
-    if (n != m_character_area_map.end())
+    const FontArea *area = m_character_area_map.find(c);
+    if (area != NULL)
     {
         if (fallback_font != NULL)
             *fallback_font = false;
-        return n->second;
+        return *area;
     }
     else if (m_fallback_font != NULL && fallback_font != NULL)
     {
@@ -423,13 +432,15 @@ const FontWithFace::FontArea&
     // Not found, return the first font area, which is a white-space
     if (fallback_font != NULL)
         *fallback_font = false;
-    return m_character_area_map.begin()->second;
+    return m_character_area_map.getFirst();
 
 }   // getAreaFromCharacter
 
 // ----------------------------------------------------------------------------
 /** Get the dimension of text with support to different \ref FontSettings,
  *  it will also do checking for missing characters in font and lazy load them.
+ *  The result is cached, since the same texts are usually measured each
+ *  frame.
  *  \param text The text to be calculated.
  *  \param font_settings \ref FontSettings to use.
  *  \return The dimension of text
@@ -438,11 +449,48 @@ core::dimension2d<u32> FontWithFace::getDimension(const wchar_t* text,
                                             FontSettings* font_settings)
 {
     const float scale = font_settings ? font_settings->getScale() : 1.0f;
+
+    // FNV-1a hash of text and scaling
+    uint64_t hash = Hash::FNV_OFFSET;
+    for (const wchar_t* p = text; *p; ++p)
+        hash = Hash::mix(hash, (uint64_t)*p);
+    uint32_t scale_bits;
+    memcpy(&scale_bits, &scale, sizeof(scale_bits));
+    hash = Hash::mix(hash, scale_bits);
+
+    typedef std::unordered_multimap<uint64_t, CachedDimension>::const_iterator
+            Iterator;
+    std::pair<Iterator, Iterator> range = m_dimension_cache.equal_range(hash);
+    for (Iterator i = range.first; i != range.second; i++)
+    {
+        if (i->second.m_scale == scale && i->second.m_text == text)
+            return i->second.m_dimension;
+    }
+
     // Test if lazy load char is needed
     insertCharacters(text);
     updateCharactersList();
 
-    assert(m_character_area_map.size() > 0);
+    if (m_dimension_cache.size() >= MAX_CACHED_DIMENSIONS)
+        m_dimension_cache.clear();
+    CachedDimension cached;
+    cached.m_text      = text;
+    cached.m_scale     = scale;
+    cached.m_dimension = computeDimension(text, scale);
+    m_dimension_cache.insert(std::make_pair(hash, cached));
+    return cached.m_dimension;
+}   // getDimension
+
+// ----------------------------------------------------------------------------
+/** Calculates the dimension of a text, all characters of which must have
+ *  been loaded.
+ *  \param text The text to be calculated.
+ *  \param scale The scaling of the text.
+ */
+core::dimension2d<u32> FontWithFace::computeDimension(const wchar_t* text,
+                                                      float scale)
+{
+    assert(!m_character_area_map.empty());
     core::dimension2d<float> dim(0.0f, 0.0f);
     core::dimension2d<float> this_line(0.0f, m_font_max_height * scale);
 
@@ -475,7 +523,7 @@ core::dimension2d<u32> FontWithFace::getDimension(const wchar_t* text,
     ret_dim.Height = (u32)(dim.Height + 0.9f);
 
     return ret_dim;
-}   // getDimension
+}   // computeDimension
                                   
 // ----------------------------------------------------------------------------
 /** Calculate the index of the character in the text on a specific position.
@@ -579,10 +627,13 @@ void FontWithFace::render(const core::stringw& text,
     core::array<core::position2d<float>> offsets(text_size);
     std::vector<bool> fallback(text_size);
 
-    // Test again if lazy load char is needed,
-    // as some text isn't drawn with getDimension
-    insertCharacters(text.c_str());
-    updateCharactersList();
+    // Test if lazy load char is needed, if the text was not measured with
+    // getDimension (which loads all characters) above
+    if (!(rtl || hcenter || vcenter || clip))
+    {
+        insertCharacters(text.c_str());
+        updateCharactersList();
+    }
 
     for (u32 i = 0; i < text_size; i++)
     {
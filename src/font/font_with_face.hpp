@@ -19,14 +19,18 @@
 #ifndef HEADER_FONT_WITH_FACE_HPP
 #define HEADER_FONT_WITH_FACE_HPP
 
+#include "font/glyph_table.hpp"
 #include "utils/cpp2011.hpp"
 #include "utils/leak_check.hpp"
 #include "utils/no_copy.hpp"
+#include "utils/types.hpp"
 
 #include <algorithm>
 #include <cassert>
 #include <map>
 #include <set>
+#include <string>
+#include <unordered_map>
 
 #include <ft2build.h>
 #include FT_FREETYPE_H
@@ -177,10 +181,24 @@ private:
     unsigned int                 m_face_dpi;
 
     /** Store a list of supported character to a \ref FontArea. */
-    std::map<wchar_t, FontArea>  m_character_area_map;
+    GlyphTable<FontArea>         m_character_area_map;
 
     /** Store a list of loaded and tested character to a \ref GlyphInfo. */
-    std::map<wchar_t, GlyphInfo> m_character_glyph_info_map;
+    GlyphTable<GlyphInfo>        m_character_glyph_info_map;
+
+    /** A text measured by \ref getDimension. */
+    struct CachedDimension
+    {
+        core::stringw          m_text;
+        float                  m_scale;
+        core::dimension2d<u32> m_dimension;
+    };
+
+    /** The dimensions of recently measured texts, indexed by a hash of
+     *  text and scaling. All characters of a cached text have been loaded,
+     *  so its dimension can only change in \ref reset, which clears this
+     *  cache. */
+    std::unordered_multimap<uint64_t, CachedDimension> m_dimension_cache;
 
     // ------------------------------------------------------------------------
     /** Return a character width.
@@ -201,11 +219,7 @@ private:
      *  \return True if tested. */
     bool loadedChar(wchar_t c) const
     {
-        std::map<wchar_t, GlyphInfo>::const_iterator n =
-            m_character_glyph_info_map.find(c);
-        if (n != m_character_glyph_info_map.end())
-            return true;
-        return false;
+        return m_character_glyph_info_map.find(c) != NULL;
     }
     // ------------------------------------------------------------------------
     /** Get the \ref GlyphInfo from \ref m_character_glyph_info_map about a
@@ -214,11 +228,10 @@ private:
      *  \return \ref GlyphInfo of this character. */
     const GlyphInfo& getGlyphInfo(wchar_t c) const
     {
-        std::map<wchar_t, GlyphInfo>::const_iterator n =
-            m_character_glyph_info_map.find(c);
+        const GlyphInfo *gi = m_character_glyph_info_map.find(c);
         // Make sure we always find GlyphInfo
-        assert(n != m_character_glyph_info_map.end());
-        return n->second;
+        assert(gi != NULL);
+        return *gi;
     }
     // ------------------------------------------------------------------------
     /** Tells whether a character is supported by all TTFs in \ref m_face_ttf
@@ -227,13 +240,8 @@ private:
      *  \return True if it's supported. */
     bool supportChar(wchar_t c)
     {
-        std::map<wchar_t, GlyphInfo>::const_iterator n =
-            m_character_glyph_info_map.find(c);
-        if (n != m_character_glyph_info_map.end())
-        {
-            return n->second.glyph_index > 0;
-        }
-        return false;
+        const GlyphInfo *gi = m_character_glyph_info_map.find(c);
+        return gi != NULL && gi->glyph_index > 0;
     }
     // ------------------------------------------------------------------------
     void loadGlyphInfo(wchar_t c);
@@ -247,6 +255,8 @@ private:
     // ------------------------------------------------------------------------
     void setDPI();
     // ------------------------------------------------------------------------
+    core::dimension2d<u32> computeDimension(const wchar_t* text, float scale);
+    // ------------------------------------------------------------------------
     /** Override it if sub-class should not do lazy loading characters. */
     virtual bool supportLazyLoadChar() const                   { return true; }
     // ------------------------------------------------------------------------
@@ -0,0 +1,162 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2016 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#ifndef HEADER_GLYPH_TABLE_HPP
+#define HEADER_GLYPH_TABLE_HPP
+
+#include "utils/no_copy.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <unordered_map>
+
+/** Maps characters to per-character data of a font. Characters of the basic
+ *  multilingual plane are stored in a two-level page table (256 pages of
+ *  256 characters, allocated when the first character of a page is added),
+ *  so a lookup is two array accesses. All other characters are stored in a
+ *  hash map.
+ *  \ingroup font
+ */
+template <typename T>
+class GlyphTable : public NoCopy
+{
+private:
+    /** The data of 256 consecutive characters. */
+    struct Page
+    {
+        T    m_values[256];
+        bool m_used[256];
+        Page()
+        {
+            for (unsigned int i = 0; i < 256; i++)
+                m_used[i] = false;
+        }
+    };   // Page
+
+    /** The pages for the basic multilingual plane, NULL if unused. */
+    Page *m_pages[256];
+
+    /** All characters outside of the basic multilingual plane. */
+    std::unordered_map<wchar_t, T> m_others;
+
+    /** Number of characters stored. */
+    unsigned int m_size;
+
+    // ------------------------------------------------------------------------
+    /** Returns true if the character is stored in the page table. */
+    static bool inPages(wchar_t c)
+    {
+        return c >= 0 && (unsigned int)c < 0x10000;
+    }   // inPages
+
+public:
+    GlyphTable()
+    {
+        for (unsigned int i = 0; i < 256; i++)
+            m_pages[i] = NULL;
+        m_size = 0;
+    }   // GlyphTable
+    // ------------------------------------------------------------------------
+    ~GlyphTable()
+    {
+        clear();
+    }   // ~GlyphTable
+    // ------------------------------------------------------------------------
+    /** Removes all characters. */
+    void clear()
+    {
+        for (unsigned int i = 0; i < 256; i++)
+        {
+            delete m_pages[i];
+            m_pages[i] = NULL;
+        }
+        m_others.clear();
+        m_size = 0;
+    }   // clear
+    // ------------------------------------------------------------------------
+    /** Returns the data of a character, or NULL if it was not added. */
+    const T* find(wchar_t c) const
+    {
+        if (inPages(c))
+        {
+            const Page *page = m_pages[(unsigned int)c >> 8];
+            if (!page || !page->m_used[c & 0xff])
+                return NULL;
+            return &page->m_values[c & 0xff];
+        }
+        typename std::unordered_map<wchar_t, T>::const_iterator i =
+            m_others.find(c);
+        return i == m_others.end() ? NULL : &i->second;
+    }   // find
+    // ------------------------------------------------------------------------
+    /** Sets the data of a character, adding the character if necessary. */
+    void set(wchar_t c, const T &value)
+    {
+        if (inPages(c))
+        {
+            Page *&page = m_pages[(unsigned int)c >> 8];
+            if (!page)
+                page = new Page();
+            if (!page->m_used[c & 0xff])
+            {
+                page->m_used[c & 0xff] = true;
+                m_size++;
+            }
+            page->m_values[c & 0xff] = value;
+            return;
+        }
+        if (m_others.find(c) == m_others.end())
+            m_size++;
+        m_others[c] = value;
+    }   // set
+    // ------------------------------------------------------------------------
+    /** Returns the data of the character with the smallest code, which must
+     *  exist. */
+    const T& getFirst() const
+    {
+        for (unsigned int i = 0; i < 256; i++)
+        {
+            if (!m_pages[i]) continue;
+            for (unsigned int j = 0; j < 256; j++)
+            {
+                if (m_pages[i]->m_used[j])
+                    return m_pages[i]->m_values[j];
+            }
+        }
+        assert(!m_others.empty());
+        typename std::unordered_map<wchar_t, T>::const_iterator first =
+            m_others.begin();
+        for (typename std::unordered_map<wchar_t, T>::const_iterator i =
+             m_others.begin(); i != m_others.end(); i++)
+        {
+            if (i->first < first->first)
+                first = i;
+        }
+        return first->second;
+    }   // getFirst
+    // ------------------------------------------------------------------------
+    /** Returns the number of characters stored. */
+    unsigned int size() const                               { return m_size; }
+    // ------------------------------------------------------------------------
+    /** Returns true if no character is stored. */
+    bool empty() const                                 { return m_size == 0; }
+
+};   // GlyphTable
+
+#endif
+/* EOF */
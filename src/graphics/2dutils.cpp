@@ -25,6 +25,7 @@
 #include "glwrap.hpp"
 #include "utils/cpp2011.hpp"
 
+#ifndef SERVER_ONLY
 #if defined(USE_GLES2)
 #   define _IRR_COMPILE_WITH_OGLES2_
 #   include "../../lib/irrlicht/source/Irrlicht/COGLES2Texture.h"
@@ -315,6 +316,7 @@ static void getSize(unsigned texture_width, unsigned texture_height,
                                   sourceRect.LowerRightCorner.X * invW,
                                   sourceRect.LowerRightCorner.Y * invH);
 }   // getSize
+#endif   // !SERVER_ONLY
 
 // ----------------------------------------------------------------------------
 void draw2DImage(const video::ITexture* texture,
@@ -331,6 +333,7 @@ void draw2DImage(const video::ITexture* texture,
         return;
     }
 
+#ifndef SERVER_ONLY
     float width, height, center_pos_x, center_pos_y;
     float tex_width, tex_height, tex_center_pos_x, tex_center_pos_y;
 
@@ -390,6 +393,7 @@ void draw2DImage(const video::ITexture* texture,
     glUseProgram(0);
 
     glGetError();
+#endif   // !SERVER_ONLY
 }   // draw2DImage
 
 // ----------------------------------------------------------------------------
@@ -414,6 +418,7 @@ void draw2DImage(const video::ITexture* texture,
         return;
     }
 
+#ifndef SERVER_ONLY
     float width, height, center_pos_x, center_pos_y;
     float tex_width, tex_height, tex_center_pos_x, tex_center_pos_y;
 
@@ -473,9 +478,11 @@ void draw2DImage(const video::ITexture* texture,
     glUseProgram(0);
 
     glGetError();
+#endif   // !SERVER_ONLY
 }   // draw2DImage
 
 // ----------------------------------------------------------------------------
+#ifndef SERVER_ONLY
 void draw2DImageFromRTT(GLuint texture, size_t texture_w, size_t texture_h,
                         const core::rect<s32>& destRect,
                         const core::rect<s32>& sourceRect,
@@ -511,6 +518,7 @@ void draw2DImageFromRTT(GLuint texture, size_t texture_w, size_t texture_h,
     glBindVertexArray(0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
 }   // draw2DImageFromRTT
+#endif   // !SERVER_ONLY
 
 // ----------------------------------------------------------------------------
 void draw2DImage(const video::ITexture* texture,
@@ -529,6 +537,7 @@ void draw2DImage(const video::ITexture* texture,
         return;
     }
 
+#ifndef SERVER_ONLY
     float width, height, center_pos_x, center_pos_y, tex_width, tex_height;
     float tex_center_pos_x, tex_center_pos_y;
 
@@ -587,6 +596,7 @@ void draw2DImage(const video::ITexture* texture,
     glUseProgram(0);
 
     glGetError();
+#endif   // !SERVER_ONLY
 }   // draw2DImage
 
 // ----------------------------------------------------------------------------
@@ -612,6 +622,7 @@ void draw2DImage(const video::ITexture* texture,
         return;
     }
 
+#ifndef SERVER_ONLY
     float width, height, center_pos_x, center_pos_y, tex_width, tex_height;
     float tex_center_pos_x, tex_center_pos_y;
 
@@ -670,6 +681,7 @@ void draw2DImage(const video::ITexture* texture,
     glUseProgram(0);
 
     glGetError();
+#endif   // !SERVER_ONLY
 }   // draw2DImage
 
 // ----------------------------------------------------------------------------
@@ -687,6 +699,7 @@ void draw2DVertexPrimitiveList(video::ITexture *tex, const void* vertices,
         return;
     }
 
+#ifndef SERVER_ONLY
     GLuint tmpvao, tmpvbo, tmpibo;
     primitiveCount += 2;
     glGenVertexArrays(1, &tmpvao);
@@ -712,6 +725,7 @@ void draw2DVertexPrimitiveList(video::ITexture *tex, const void* vertices,
     glDeleteBuffers(1, &tmpvbo);
     glDeleteBuffers(1, &tmpibo);
 
+#endif   // !SERVER_ONLY
 }   // draw2DVertexPrimitiveList
 
 // ----------------------------------------------------------------------------
@@ -725,6 +739,7 @@ void GL32_draw2DRectangle(video::SColor color, const core::rect<s32>& position,
         return;
     }
 
+#ifndef SERVER_ONLY
     core::dimension2d<u32> frame_size = irr_driver->getActualScreenSize();
     const int screen_w = frame_size.Width;
     const int screen_h = frame_size.Height;
@@ -776,4 +791,5 @@ void GL32_draw2DRectangle(video::SColor color, const core::rect<s32>& position,
     glUseProgram(0);
 
     glGetError();
+#endif   // !SERVER_ONLY
 }   // GL32_draw2DRectangle
@@ -28,12 +28,14 @@
 #include <SColor.h>
 #include <SVertexIndex.h>
 
+#ifndef SERVER_ONLY
 void draw2DImageFromRTT(GLuint texture, size_t texture_w, size_t texture_h,
                         const irr::core::rect<irr::s32>& destRect,
                         const irr::core::rect<irr::s32>& sourceRect,
                         const irr::core::rect<irr::s32>* clipRect,
                         const irr::video::SColor &colors,
                         bool useAlphaChannelOfTexture);
+#endif
 
 void draw2DImage(const irr::video::ITexture* texture,
                  const irr::core::rect<irr::s32>& destRect,
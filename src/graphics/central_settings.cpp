@@ -66,6 +66,7 @@ void CentralVideoSettings::init()
     {
 
     }
+#ifndef SERVER_ONLY
     if (!ProfileWorld::isNoGraphics())
     {
         glGetIntegerv(GL_MAJOR_VERSION, &m_gl_major_version);
@@ -75,12 +76,14 @@ void CentralVideoSettings::init()
         Log::info("IrrDriver", "OpenGL renderer: %s", glGetString(GL_RENDERER));
         Log::info("IrrDriver", "OpenGL version string: %s", glGetString(GL_VERSION));
     }
+#endif   // !SERVER_ONLY
 #if !defined(USE_GLES2)
     m_glsl = (m_gl_major_version > 3 || (m_gl_major_version == 3 && m_gl_minor_version >= 1))
            && !UserConfigParams::m_force_legacy_device;
 #else
     m_glsl = m_gl_major_version >= 3 && !UserConfigParams::m_force_legacy_device;
 #endif
+#ifndef SERVER_ONLY
     if (!ProfileWorld::isNoGraphics())
         initGL();
 
@@ -246,6 +249,7 @@ void CentralVideoSettings::init()
         }
 #endif
     }
+#endif   // !SERVER_ONLY
 }
 
 unsigned CentralVideoSettings::getGLSLVersion() const
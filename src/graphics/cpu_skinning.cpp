@@ -0,0 +1,395 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2016 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#include "graphics/cpu_skinning.hpp"
+
+#include <S3DVertex.h>
+#include <matrix4.h>
+
+#include <algorithm>
+#include <cmath>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define CPU_SKINNING_SSE2
+#  include <emmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#  define CPU_SKINNING_NEON
+#  include <arm_neon.h>
+#endif
+
+// ----------------------------------------------------------------------------
+/** Collects the influences of all joints on each vertex of the mesh, and
+ *  copies all vertices. Hardware skinning must be enabled in the mesh, so
+ *  that its mesh buffers contain the static pose.
+ *  \param mesh The mesh to skin, which can be shared with other nodes.
+ */
+CPUSkinning::CPUSkinning(scene::ISkinnedMesh *mesh)
+{
+    const u32 buffer_count = mesh->getMeshBufferCount();
+    m_buffers.resize(buffer_count);
+
+    // The influences of each vertex of each buffer
+    std::vector<std::vector<std::vector<Influence> > > influences(buffer_count);
+    for (u32 i = 0; i < buffer_count; i++)
+    {
+        const scene::IMeshBuffer *mb = mesh->getMeshBuffer(i);
+        SkinnedBuffer &buffer = m_buffers[i];
+        buffer.m_stride = video::getVertexPitchFromType(mb->getVertexType());
+        const uint8_t *vertices = (const uint8_t*)mb->getVertices();
+        buffer.m_skinned.assign(vertices,
+                                vertices + mb->getVertexCount() * buffer.m_stride);
+        influences[i].resize(mb->getVertexCount());
+    }
+
+    const core::array<scene::ISkinnedMesh::SJoint*> &joints =
+        mesh->getAllJoints();
+    m_palette.resize(16 * joints.size(), 0.0f);
+    m_joint_boxes.resize(joints.size());
+    m_joint_used.resize(joints.size(), false);
+    for (u32 j = 0; j < joints.size(); j++)
+    {
+        const core::array<scene::ISkinnedMesh::SWeight> &weights =
+            joints[j]->Weights;
+        for (u32 k = 0; k < weights.size(); k++)
+        {
+            const u16 buffer_id = weights[k].buffer_id;
+            const u32 vertex_id = weights[k].vertex_id;
+            if (buffer_id >= buffer_count ||
+                vertex_id >= influences[buffer_id].size())
+                continue;
+            Influence influence;
+            influence.m_joint  = j;
+            influence.m_weight = weights[k].strength;
+            influences[buffer_id][vertex_id].push_back(influence);
+
+            const SkinnedBuffer &buffer = m_buffers[buffer_id];
+            const video::S3DVertex *vertex = (const video::S3DVertex*)
+                (buffer.m_skinned.data() + vertex_id * buffer.m_stride);
+            if (m_joint_used[j])
+                m_joint_boxes[j].addInternalPoint(vertex->Pos);
+            else
+                m_joint_boxes[j].reset(vertex->Pos);
+            m_joint_used[j] = true;
+        }
+    }
+
+    m_has_static_vertices = false;
+    m_max_weight_sum      = 0.0f;
+    for (u32 i = 0; i < buffer_count; i++)
+    {
+        SkinnedBuffer &buffer = m_buffers[i];
+        for (u32 v = 0; v < influences[i].size(); v++)
+        {
+            const std::vector<Influence> &list = influences[i][v];
+            if (list.empty())
+            {
+                const video::S3DVertex *vertex = (const video::S3DVertex*)
+                    (buffer.m_skinned.data() + v * buffer.m_stride);
+                if (m_has_static_vertices)
+                    m_static_box.addInternalPoint(vertex->Pos);
+                else
+                    m_static_box.reset(vertex->Pos);
+                m_has_static_vertices = true;
+                continue;
+            }
+            buffer.m_vertices.push_back(v);
+            buffer.m_first_influence.push_back(
+                (uint32_t)buffer.m_influences.size());
+            float sum = 0.0f;
+            for (const Influence &influence : list)
+            {
+                buffer.m_influences.push_back(influence);
+                sum += influence.m_weight;
+            }
+            if (fabsf(sum - 1.0f) > 0.001f)
+                m_max_weight_sum = std::max(m_max_weight_sum,
+                                            std::max(sum, 1.0f));
+        }
+        buffer.m_first_influence.push_back(
+            (uint32_t)buffer.m_influences.size());
+    }
+    m_box = mesh->getBoundingBox();
+}   // CPUSkinning
+
+// ----------------------------------------------------------------------------
+/** Copies the joint matrices of the mesh, which must have been animated for
+ *  the frame of this node, and updates the bounding box. Must be called
+ *  from the main thread, since the mesh can be shared with other nodes.
+ *  \param mesh The mesh this object was created for.
+ *  \param strength The animation strength of the node.
+ *  \return True if any joint matrix changed, i.e. skin() must be called.
+ */
+bool CPUSkinning::updatePalette(const scene::ISkinnedMesh *mesh,
+                                float strength)
+{
+    const core::array<scene::ISkinnedMesh::SJoint*> &joints =
+        mesh->getAllJoints();
+    assert(16 * joints.size() == m_palette.size());
+
+    bool changed = false, has_box = false;
+    core::matrix4 matrix(core::matrix4::EM4CONST_NOTHING);
+    for (u32 j = 0; j < joints.size(); j++)
+    {
+        matrix.setbyproduct(joints[j]->GlobalAnimatedMatrix,
+                            joints[j]->GlobalInversedMatrix);
+        // Irrlicht interpolates between the static and the skinned vertex,
+        // which is the same as interpolating the matrix with the identity.
+        if (strength != 1.0f)
+            matrix = core::IdentityMatrix.interpolate(matrix, strength);
+
+        float *entry = &m_palette[16 * j];
+        if (memcmp(entry, matrix.pointer(), 16 * sizeof(float)) != 0)
+        {
+            memcpy(entry, matrix.pointer(), 16 * sizeof(float));
+            changed = true;
+        }
+
+        // Each skinned vertex is a weighted average of its positions
+        // transformed by each joint, which is inside of the union of the
+        // transformed joint boxes.
+        if (!m_joint_used[j])
+            continue;
+        core::aabbox3df box = m_joint_boxes[j];
+        matrix.transformBoxEx(box);
+        if (has_box)
+            m_box.addInternalBox(box);
+        else
+            m_box = box;
+        has_box = true;
+    }
+
+    if (has_box && m_max_weight_sum > 0.0f)
+    {
+        // If the weights do not add up to one, the vertex is additionally
+        // scaled (towards the origin) by the sum of its weights.
+        const core::aabbox3df joints_box = m_box;
+        m_box.addInternalPoint(core::vector3df(0, 0, 0));
+        m_box.addInternalPoint(joints_box.MinEdge * m_max_weight_sum);
+        m_box.addInternalPoint(joints_box.MaxEdge * m_max_weight_sum);
+    }
+    if (m_has_static_vertices)
+    {
+        if (has_box)
+            m_box.addInternalBox(m_static_box);
+        else
+            m_box = m_static_box;
+    }
+    return changed;
+}   // updatePalette
+
+// ----------------------------------------------------------------------------
+/** Skins all vertices of one buffer with the given palette. The positions
+ *  and normals are transformed by the weighted sum of the matrices of all
+ *  joints influencing the vertex, which is the same as irrlicht's sum of the
+ *  weighted vertices transformed by each matrix.
+ *  \param buffer The influences of the buffer.
+ *  \param palette 16 floats per joint.
+ *  \param static_vertices The vertices of the buffer in the static pose.
+ *  \param skinned Receives the skinned positions and normals, the other
+ *         components of the vertices are not changed.
+ */
+void CPUSkinning::skinVertices(const SkinnedBuffer &buffer,
+                               const float *palette,
+                               const uint8_t *static_vertices,
+                               uint8_t *skinned)
+{
+    const Influence *influences = buffer.m_influences.data();
+    for (unsigned int i = 0; i < buffer.m_vertices.size(); i++)
+    {
+        const size_t offset = buffer.m_vertices[i] * buffer.m_stride;
+        const video::S3DVertex *src =
+            (const video::S3DVertex*)(static_vertices + offset);
+        video::S3DVertex *dst = (video::S3DVertex*)(skinned + offset);
+        const Influence *first = influences + buffer.m_first_influence[i];
+        const Influence *last  = influences + buffer.m_first_influence[i + 1];
+
+        // Each matrix is stored as four columns: the result for a point p
+        // is c0 * p.X + c1 * p.Y + c2 * p.Z + c3.
+#if defined(CPU_SKINNING_SSE2)
+        __m128 c0 = _mm_setzero_ps(), c1 = _mm_setzero_ps();
+        __m128 c2 = _mm_setzero_ps(), c3 = _mm_setzero_ps();
+        for (const Influence *in = first; in != last; in++)
+        {
+            const float *m = palette + 16 * in->m_joint;
+            const __m128 w = _mm_set1_ps(in->m_weight);
+            c0 = _mm_add_ps(c0, _mm_mul_ps(w, _mm_loadu_ps(m     )));
+            c1 = _mm_add_ps(c1, _mm_mul_ps(w, _mm_loadu_ps(m +  4)));
+            c2 = _mm_add_ps(c2, _mm_mul_ps(w, _mm_loadu_ps(m +  8)));
+            c3 = _mm_add_ps(c3, _mm_mul_ps(w, _mm_loadu_ps(m + 12)));
+        }
+        __m128 pos = _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(src->Pos.X)),
+                       _mm_mul_ps(c1, _mm_set1_ps(src->Pos.Y))),
+            _mm_add_ps(_mm_mul_ps(c2, _mm_set1_ps(src->Pos.Z)), c3));
+        __m128 normal = _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(src->Normal.X)),
+                       _mm_mul_ps(c1, _mm_set1_ps(src->Normal.Y))),
+            _mm_mul_ps(c2, _mm_set1_ps(src->Normal.Z)));
+        float result[8];
+        _mm_storeu_ps(result, pos);
+        _mm_storeu_ps(result + 4, normal);
+#elif defined(CPU_SKINNING_NEON)
+        float32x4_t c0 = vdupq_n_f32(0.0f), c1 = vdupq_n_f32(0.0f);
+        float32x4_t c2 = vdupq_n_f32(0.0f), c3 = vdupq_n_f32(0.0f);
+        for (const Influence *in = first; in != last; in++)
+        {
+            const float *m = palette + 16 * in->m_joint;
+            c0 = vmlaq_n_f32(c0, vld1q_f32(m     ), in->m_weight);
+            c1 = vmlaq_n_f32(c1, vld1q_f32(m +  4), in->m_weight);
+            c2 = vmlaq_n_f32(c2, vld1q_f32(m +  8), in->m_weight);
+            c3 = vmlaq_n_f32(c3, vld1q_f32(m + 12), in->m_weight);
+        }
+        float32x4_t pos = vmlaq_n_f32(c3, c0, src->Pos.X);
+        pos = vmlaq_n_f32(pos, c1, src->Pos.Y);
+        pos = vmlaq_n_f32(pos, c2, src->Pos.Z);
+        float32x4_t normal = vmulq_n_f32(c0, src->Normal.X);
+        normal = vmlaq_n_f32(normal, c1, src->Normal.Y);
+        normal = vmlaq_n_f32(normal, c2, src->Normal.Z);
+        float result[8];
+        vst1q_f32(result, pos);
+        vst1q_f32(result + 4, normal);
+#else
+        float m[16] = { 0 };
+        for (const Influence *in = first; in != last; in++)
+        {
+            const float *joint = palette + 16 * in->m_joint;
+            for (unsigned int k = 0; k < 16; k++)
+                m[k] += in->m_weight * joint[k];
+        }
+        const core::vector3df &p = src->Pos, &n = src->Normal;
+        float result[8];
+        for (unsigned int k = 0; k < 3; k++)
+        {
+            result[k]     = m[k] * p.X + m[k + 4] * p.Y + m[k + 8] * p.Z
+                          + m[k + 12];
+            result[k + 4] = m[k] * n.X + m[k + 4] * n.Y + m[k + 8] * n.Z;
+        }
+#endif
+        dst->Pos.set(result[0], result[1], result[2]);
+        dst->Normal.set(result[4], result[5], result[6]);
+    }
+}   // skinVertices
+
+// ----------------------------------------------------------------------------
+/** Skins all vertices with the palette of the last updatePalette() call.
+ *  This only reads the (static) vertices of the mesh, so it can be called
+ *  from any thread.
+ *  \param mesh The mesh this object was created for.
+ */
+void CPUSkinning::skin(const scene::ISkinnedMesh *mesh)
+{
+    assert(mesh->getMeshBufferCount() == m_buffers.size());
+    for (unsigned int i = 0; i < m_buffers.size(); i++)
+    {
+        const scene::IMeshBuffer *mb = mesh->getMeshBuffer(i);
+        SkinnedBuffer &buffer = m_buffers[i];
+        assert(mb->getVertexCount() * buffer.m_stride ==
+               buffer.m_skinned.size());
+        skinVertices(buffer, m_palette.data(),
+                     (const uint8_t*)mb->getVertices(),
+                     buffer.m_skinned.data());
+    }
+}   // skin
+
+// ----------------------------------------------------------------------------
+/** Compares skinVertices() with irrlicht's way of skinning: transforming
+ *  each vertex with each joint matrix and adding the weighted results.
+ */
+void CPUSkinning::unitTesting()
+{
+    const unsigned int joint_count = 5, vertex_count = 101;
+    std::vector<core::matrix4> joints(joint_count);
+    std::vector<float> palette;
+    for (unsigned int j = 0; j < joint_count; j++)
+    {
+        joints[j].setRotationDegrees(core::vector3df(37.0f * j,
+                                                     11.0f * j + 5.0f,
+                                                     -23.0f * j));
+        joints[j].setTranslation(core::vector3df((float)j, -2.0f * j,
+                                                 0.5f * j));
+        palette.insert(palette.end(), joints[j].pointer(),
+                       joints[j].pointer() + 16);
+    }
+
+    uint32_t seed = 12345;
+    auto random = [&seed]()
+    {
+        seed = seed * 1103515245 + 12345;
+        return (float)((seed >> 16) & 0x7fff) / 16383.5f - 1.0f;
+    };
+
+    // Every fifth vertex is not influenced by any joint, the others by up
+    // to four joints with different weights.
+    SkinnedBuffer buffer;
+    buffer.m_stride = sizeof(video::S3DVertex);
+    std::vector<video::S3DVertex> vertices(vertex_count);
+    for (unsigned int v = 0; v < vertex_count; v++)
+    {
+        vertices[v] = video::S3DVertex(random(), random(), random(),
+                                       random(), random(), random(),
+                                       video::SColor(255, v, 2 * v, 3 * v),
+                                       random(), random());
+        const unsigned int count = v % 5;
+        if (count == 0)
+            continue;
+        buffer.m_vertices.push_back(v);
+        buffer.m_first_influence.push_back(
+            (uint32_t)buffer.m_influences.size());
+        for (unsigned int k = 0; k < count; k++)
+        {
+            Influence influence;
+            influence.m_joint  = (v + 2 * k) % joint_count;
+            influence.m_weight = 2.0f * (k + 1) / (count * (count + 1));
+            buffer.m_influences.push_back(influence);
+        }
+    }
+    buffer.m_first_influence.push_back((uint32_t)buffer.m_influences.size());
+    const uint8_t *data = (const uint8_t*)vertices.data();
+    buffer.m_skinned.assign(data, data + vertex_count * buffer.m_stride);
+
+    skinVertices(buffer, palette.data(), data, buffer.m_skinned.data());
+
+    const video::S3DVertex *skinned =
+        (const video::S3DVertex*)buffer.m_skinned.data();
+    for (unsigned int v = 0; v < vertex_count; v++)
+    {
+        core::vector3df pos(0, 0, 0), normal(0, 0, 0);
+        const unsigned int count = v % 5;
+        if (count == 0)
+        {
+            pos    = vertices[v].Pos;
+            normal = vertices[v].Normal;
+        }
+        for (unsigned int k = 0; k < count; k++)
+        {
+            const core::matrix4 &m = joints[(v + 2 * k) % joint_count];
+            const float weight = 2.0f * (k + 1) / (count * (count + 1));
+            core::vector3df p, n;
+            m.transformVect(p, vertices[v].Pos);
+            m.rotateVect(n, vertices[v].Normal);
+            pos    += p * weight;
+            normal += n * weight;
+        }
+        assert(skinned[v].Pos.equals(pos, 0.0001f));
+        assert(skinned[v].Normal.equals(normal, 0.0001f));
+        assert(skinned[v].Color == vertices[v].Color);
+        assert(skinned[v].TCoords == vertices[v].TCoords);
+    }
+}   // unitTesting
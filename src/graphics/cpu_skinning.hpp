@@ -0,0 +1,117 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2016 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#ifndef HEADER_CPU_SKINNING_HPP
+#define HEADER_CPU_SKINNING_HPP
+
+#include "utils/no_copy.hpp"
+#include "utils/types.hpp"
+
+#include <aabbox3d.h>
+#include <ISkinnedMesh.h>
+
+#include <assert.h>
+#include <vector>
+
+using namespace irr;
+
+/** Skins the vertices of one animated scene node on the CPU. Irrlicht only
+ *  animates the joints of the mesh (hardware skinning is enabled, so the
+ *  mesh buffers keep the static pose), and updatePalette() copies the
+ *  resulting joint matrices. skin() then blends the matrices of all joints
+ *  influencing a vertex (with SSE2 or NEON if available) and transforms
+ *  the static position and normal into a private copy of the vertices.
+ *  skin() only reads the mesh and only writes data of this object, so
+ *  different nodes can be skinned in parallel even if they share a mesh.
+ *  \ingroup graphics
+ */
+class CPUSkinning : public NoCopy
+{
+private:
+    /** The weight of one joint on one vertex. */
+    struct Influence
+    {
+        uint32_t m_joint;
+        float    m_weight;
+    };   // Influence
+
+    /** The skinning data of one mesh buffer. */
+    struct SkinnedBuffer
+    {
+        /** Size of one vertex in bytes. */
+        unsigned int           m_stride;
+        /** Index of each vertex which is influenced by at least one joint. */
+        std::vector<uint32_t>  m_vertices;
+        /** Index of the first influence of each vertex in m_influences,
+         *  followed by the total number of influences. */
+        std::vector<uint32_t>  m_first_influence;
+        std::vector<Influence> m_influences;
+        /** Copy of all vertices of the buffer, the positions and normals
+         *  of the influenced vertices are overwritten by skin(). */
+        std::vector<uint8_t>   m_skinned;
+    };   // SkinnedBuffer
+
+    std::vector<SkinnedBuffer> m_buffers;
+
+    /** The matrix of each joint (animated matrix times inverse bind pose
+     *  matrix), 16 floats in irrlicht's order per joint. */
+    std::vector<float> m_palette;
+
+    /** For each joint the box of all vertices it influences in the static
+     *  pose, empty joints are not used for the bounding box. */
+    std::vector<core::aabbox3df> m_joint_boxes;
+    std::vector<bool> m_joint_used;
+
+    /** Box of all vertices which are not influenced by any joint. */
+    core::aabbox3df m_static_box;
+    bool m_has_static_vertices;
+
+    /** Zero if the weights of each vertex add up to one, otherwise the
+     *  largest sum (at least one) by which the joint boxes are scaled. */
+    float m_max_weight_sum;
+
+    /** Bounding box of the vertices for the current palette. */
+    core::aabbox3df m_box;
+
+    static void skinVertices(const SkinnedBuffer &buffer,
+                             const float *palette,
+                             const uint8_t *static_vertices,
+                             uint8_t *skinned);
+
+public:
+    CPUSkinning(scene::ISkinnedMesh *mesh);
+    bool updatePalette(const scene::ISkinnedMesh *mesh, float strength);
+    void skin(const scene::ISkinnedMesh *mesh);
+    static void unitTesting();
+
+    // ------------------------------------------------------------------------
+    /** Returns a box containing all vertices for the current palette. It is
+     *  computed from the joints only, so it is valid before skin() is
+     *  called (and for nodes which are not skinned since they are culled).
+     */
+    const core::aabbox3df& getBoundingBox() const { return m_box; }
+    // ------------------------------------------------------------------------
+    /** Returns the skinned vertices of the given mesh buffer. */
+    const void* getVertices(unsigned int buffer) const
+    {
+        assert(buffer < m_buffers.size());
+        return m_buffers[buffer].m_skinned.data();
+    }   // getVertices
+};   // CPUSkinning
+
+#endif
@@ -18,6 +18,32 @@
 #ifndef GL_HEADER_HPP
 #define GL_HEADER_HPP
 
+#ifdef SERVER_ONLY
+// The server is compiled without the OpenGL renderer, but some headers of
+// the graphics module (which are used by the game logic) contain OpenGL
+// types. Define them without including any OpenGL header.
+#include <cinttypes>
+typedef unsigned int  GLenum;
+typedef unsigned int  GLbitfield;
+typedef unsigned int  GLuint;
+typedef int           GLint;
+typedef int           GLsizei;
+typedef unsigned char GLboolean;
+typedef float         GLfloat;
+typedef void          GLvoid;
+typedef struct __GLsync *GLsync;
+#define GL_FALSE 0
+#define GL_TRUE  1
+// Used as face indices by the (renderer independent) spherical harmonics code.
+#define GL_TEXTURE_CUBE_MAP_POSITIVE_X 0x8515
+#define GL_TEXTURE_CUBE_MAP_NEGATIVE_X 0x8516
+#define GL_TEXTURE_CUBE_MAP_POSITIVE_Y 0x8517
+#define GL_TEXTURE_CUBE_MAP_NEGATIVE_Y 0x8518
+#define GL_TEXTURE_CUBE_MAP_POSITIVE_Z 0x8519
+#define GL_TEXTURE_CUBE_MAP_NEGATIVE_Z 0x851A
+
+#else
+
 #define GLEW_STATIC
 
 extern "C" {
@@ -72,6 +98,8 @@ inline void glDrawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type,
 }
 #endif
 
+#endif   // SERVER_ONLY
+
 struct DrawElementsIndirectCommand{
     GLuint count;
     GLuint instanceCount;
@@ -30,6 +30,7 @@
 #include <string>
 #include <sstream>
 
+#ifndef SERVER_ONLY
 #ifdef DEBUG
 #if !defined(__APPLE__) && !defined(ANDROID)
 #define ARB_DEBUG_OUTPUT
@@ -318,6 +319,7 @@ void FrameBuffer::BlitToDefault(size_t x0, size_t y0, size_t x1, size_t y1)
     glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
 }
 
+#endif   // !SERVER_ONLY
 
 void draw3DLine(const core::vector3df& start,
                 const core::vector3df& end, irr::video::SColor color)
@@ -327,6 +329,7 @@ void draw3DLine(const core::vector3df& start,
         return;
     }
 
+#ifndef SERVER_ONLY
     float vertex[6] = {
         start.X, start.Y, start.Z,
         end.X, end.Y, end.Z
@@ -342,8 +345,10 @@ void draw3DLine(const core::vector3df& start,
     glDrawArrays(GL_LINES, 0, 2);
 
     glGetError();
+#endif   // !SERVER_ONLY
 }
 
+#ifndef SERVER_ONLY
 bool hasGLExtension(const char* extension) 
 {
     if (glGetStringi != NULL)
@@ -757,3 +762,5 @@ else \
 
 #endif  // ifdef XX
 }   // getGLLimits
+
+#endif   // !SERVER_ONLY
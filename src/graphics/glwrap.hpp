@@ -34,8 +34,12 @@ namespace HardwareStats
     class Json;
 }
 
-void initGL();
 video::ITexture* getUnicolorTexture(const video::SColor &c);
+void draw3DLine(const core::vector3df& start,
+    const core::vector3df& end, irr::video::SColor color);
+
+#ifndef SERVER_ONLY
+void initGL();
 
 class GPUTimer;
 
@@ -146,11 +150,9 @@ public:
     }
 };
 
-void draw3DLine(const core::vector3df& start,
-    const core::vector3df& end, irr::video::SColor color);
-
 bool hasGLExtension(const char* extension);
 const std::string getGLExtensions();
 void getGLLimits(HardwareStats::Json *json);
+#endif   // !SERVER_ONLY
 
 #endif
@@ -15,6 +15,8 @@
 //  along with this program; if not, write to the Free Software
 //  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
+#ifndef SERVER_ONLY
+
 #include "graphics/gpu_particles.hpp"
 
 #include "config/user_config.hpp"
@@ -632,3 +634,5 @@ void ParticleSystemProxy::render() {
         draw();
     }
 }
+
+#endif   // !SERVER_ONLY
@@ -18,6 +18,8 @@
 #ifndef HEADER_GPU_PARTICLES_HPP
 #define HEADER_GPU_PARTICLES_HPP
 
+#ifndef SERVER_ONLY
+
 #include "graphics/shader.hpp"
 
 #include "../lib/irrlicht/source/Irrlicht/CParticleSystemSceneNode.h"
@@ -108,4 +110,5 @@ public:
     void setFlip();
 };
 
+#endif   // !SERVER_ONLY
 #endif // GPUPARTICLES_H
@@ -0,0 +1,469 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2016 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#include "graphics/image_kernels.hpp"
+
+#include "utils/log.hpp"
+#include "utils/time.hpp"
+
+#include <assert.h>
+#include <cmath>
+#include <string.h>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define IMAGE_KERNELS_SSE2
+#  include <emmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#  define IMAGE_KERNELS_NEON
+#  include <arm_neon.h>
+#endif
+
+namespace
+{
+    /** The factor with which the colour channels are multiplied in
+     *  premultiplyGammaAlpha() for each alpha value. */
+    struct GammaTable
+    {
+        float m_factor[256];
+        GammaTable()
+        {
+            for (unsigned int a = 0; a < 256; a++)
+            {
+                float alpha = (float)a;
+                if (alpha > 0.)
+                    alpha = pow(alpha / 255.f, 1.f / 2.2f);
+                m_factor[a] = alpha;
+            }
+        }
+    };   // GammaTable
+
+    // ------------------------------------------------------------------------
+    /** For each alpha value a the factor r so that (c * r) >> 16 is equal
+     *  to 255 * c / a for all colour values c, which avoids a division per
+     *  channel in predivideAlpha(). */
+    struct ReciprocalTable
+    {
+        uint32_t m_factor[256];
+        ReciprocalTable()
+        {
+            m_factor[0] = 0;
+            for (unsigned int a = 1; a < 256; a++)
+                m_factor[a] = ((255u << 16) + a - 1) / a;
+        }
+    };   // ReciprocalTable
+
+    // ------------------------------------------------------------------------
+    const GammaTable& getGammaTable()
+    {
+        static GammaTable table;
+        return table;
+    }   // getGammaTable
+
+    // ------------------------------------------------------------------------
+    const ReciprocalTable& getReciprocalTable()
+    {
+        static ReciprocalTable table;
+        return table;
+    }   // getReciprocalTable
+
+#ifdef IMAGE_KERNELS_SSE2
+    // ------------------------------------------------------------------------
+    /** Computes (c * a) / 255 (rounded down) for the four channels of two
+     *  pixels stored as 16 bit values, where a is the alpha of the pixel.
+     *  (x + (x >> 8) + 1) >> 8 is exactly x / 255 for 0 <= x <= 255 * 255.
+     */
+    __m128i premultiplyTwoPixels(__m128i pixels)
+    {
+        __m128i alpha = _mm_shufflelo_epi16(pixels, _MM_SHUFFLE(3, 3, 3, 3));
+        alpha = _mm_shufflehi_epi16(alpha, _MM_SHUFFLE(3, 3, 3, 3));
+        __m128i x = _mm_mullo_epi16(pixels, alpha);
+        x = _mm_add_epi16(x, _mm_srli_epi16(x, 8));
+        x = _mm_add_epi16(x, _mm_set1_epi16(1));
+        return _mm_srli_epi16(x, 8);
+    }   // premultiplyTwoPixels
+
+    // ------------------------------------------------------------------------
+    /** Multiplies the colour channels of one pixel (stored as 32 bit values)
+     *  with a factor and truncates the result, keeping alpha unchanged. */
+    __m128i scalePixel(__m128i pixel, float factor)
+    {
+        __m128 f = _mm_cvtepi32_ps(pixel);
+        f = _mm_mul_ps(f, _mm_set_ps(1.0f, factor, factor, factor));
+        return _mm_cvttps_epi32(f);
+    }   // scalePixel
+#endif
+
+#ifdef IMAGE_KERNELS_NEON
+    // ------------------------------------------------------------------------
+    /** Computes x / 255 (rounded down) for 0 <= x <= 255 * 255. */
+    uint8x8_t divideBy255(uint16x8_t x)
+    {
+        x = vaddq_u16(x, vshrq_n_u16(x, 8));
+        x = vaddq_u16(x, vdupq_n_u16(1));
+        return vshrn_n_u16(x, 8);
+    }   // divideBy255
+
+    // ------------------------------------------------------------------------
+    /** Multiplies four colour values with four factors and truncates. */
+    uint16x4_t scaleChannel(uint16x4_t c, float32x4_t factor)
+    {
+        float32x4_t f = vcvtq_f32_u32(vmovl_u16(c));
+        return vmovn_u32(vcvtq_u32_f32(vmulq_f32(f, factor)));
+    }   // scaleChannel
+#endif
+}   // namespace
+
+// ----------------------------------------------------------------------------
+/** Multiplies the colour channels of each pixel with its alpha value:
+ *  c = a * c / 255 (rounded down).
+ *  \param pixels The pixel data.
+ *  \param count Number of pixels.
+ */
+void ImageKernels::premultiplyAlpha(uint8_t *pixels, unsigned int count)
+{
+    unsigned int i = 0;
+#if defined(IMAGE_KERNELS_SSE2)
+    const __m128i zero       = _mm_setzero_si128();
+    const __m128i alpha_mask = _mm_set1_epi32(0xff000000);
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i *p = (__m128i*)(pixels + 4 * i);
+        const __m128i in = _mm_loadu_si128(p);
+        __m128i lo = premultiplyTwoPixels(_mm_unpacklo_epi8(in, zero));
+        __m128i hi = premultiplyTwoPixels(_mm_unpackhi_epi8(in, zero));
+        __m128i out = _mm_packus_epi16(lo, hi);
+        out = _mm_or_si128(_mm_andnot_si128(alpha_mask, out),
+                           _mm_and_si128(alpha_mask, in));
+        _mm_storeu_si128(p, out);
+    }
+#elif defined(IMAGE_KERNELS_NEON)
+    for (; i + 8 <= count; i += 8)
+    {
+        uint8x8x4_t p = vld4_u8(pixels + 4 * i);
+        for (unsigned int c = 0; c < 3; c++)
+            p.val[c] = divideBy255(vmull_u8(p.val[c], p.val[3]));
+        vst4_u8(pixels + 4 * i, p);
+    }
+#endif
+    for (; i < count; i++)
+    {
+        uint8_t *p = pixels + 4 * i;
+        const unsigned int alpha = p[3];
+        p[0] = (uint8_t)(alpha * p[0] / 255);
+        p[1] = (uint8_t)(alpha * p[1] / 255);
+        p[2] = (uint8_t)(alpha * p[2] / 255);
+    }
+}   // premultiplyAlpha
+
+// ----------------------------------------------------------------------------
+/** Divides the colour channels of each pixel by its alpha value:
+ *  c = 255 * c / a (rounded down, and only the lowest 8 bits are kept).
+ *  Pixels with an alpha of 0 are not changed.
+ *  \param pixels The pixel data.
+ *  \param count Number of pixels.
+ */
+void ImageKernels::predivideAlpha(uint8_t *pixels, unsigned int count)
+{
+    // There is no integer division in SSE2 or NEON, and emulating the
+    // reciprocal multiplication needs 32 bit products, so this remains a
+    // scalar loop. The table lookup replaces the three divisions.
+    const uint32_t *reciprocal = getReciprocalTable().m_factor;
+    for (unsigned int i = 0; i < count; i++)
+    {
+        uint8_t *p = pixels + 4 * i;
+        const uint32_t r = reciprocal[p[3]];
+        if (r == 0) continue;
+        p[0] = (uint8_t)((p[0] * r) >> 16);
+        p[1] = (uint8_t)((p[1] * r) >> 16);
+        p[2] = (uint8_t)((p[2] * r) >> 16);
+    }
+}   // predivideAlpha
+
+// ----------------------------------------------------------------------------
+/** Multiplies the colour channels of each pixel with (a / 255)^(1 / 2.2),
+ *  which is the premultiplication used for textures in sRGB space.
+ *  \param pixels The pixel data.
+ *  \param count Number of pixels.
+ */
+void ImageKernels::premultiplyGammaAlpha(uint8_t *pixels, unsigned int count)
+{
+    const float *factor = getGammaTable().m_factor;
+    unsigned int i = 0;
+#if defined(IMAGE_KERNELS_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 4 <= count; i += 4)
+    {
+        uint8_t *p = pixels + 4 * i;
+        const __m128i in = _mm_loadu_si128((const __m128i*)p);
+        const __m128i lo = _mm_unpacklo_epi8(in, zero);
+        const __m128i hi = _mm_unpackhi_epi8(in, zero);
+        __m128i p0 = scalePixel(_mm_unpacklo_epi16(lo, zero), factor[p[ 3]]);
+        __m128i p1 = scalePixel(_mm_unpackhi_epi16(lo, zero), factor[p[ 7]]);
+        __m128i p2 = scalePixel(_mm_unpacklo_epi16(hi, zero), factor[p[11]]);
+        __m128i p3 = scalePixel(_mm_unpackhi_epi16(hi, zero), factor[p[15]]);
+        __m128i out = _mm_packus_epi16(_mm_packs_epi32(p0, p1),
+                                       _mm_packs_epi32(p2, p3));
+        _mm_storeu_si128((__m128i*)p, out);
+    }
+#elif defined(IMAGE_KERNELS_NEON)
+    for (; i + 8 <= count; i += 8)
+    {
+        uint8x8x4_t p = vld4_u8(pixels + 4 * i);
+        float f[8];
+        for (unsigned int j = 0; j < 8; j++)
+            f[j] = factor[pixels[4 * (i + j) + 3]];
+        const float32x4_t f_lo = vld1q_f32(f);
+        const float32x4_t f_hi = vld1q_f32(f + 4);
+        for (unsigned int c = 0; c < 3; c++)
+        {
+            const uint16x8_t v = vmovl_u8(p.val[c]);
+            p.val[c] = vmovn_u16(
+                vcombine_u16(scaleChannel(vget_low_u16(v),  f_lo),
+                             scaleChannel(vget_high_u16(v), f_hi)));
+        }
+        vst4_u8(pixels + 4 * i, p);
+    }
+#endif
+    for (; i < count; i++)
+    {
+        uint8_t *p = pixels + 4 * i;
+        const float alpha = factor[p[3]];
+        p[0] = (uint8_t)(p[0] * alpha);
+        p[1] = (uint8_t)(p[1] * alpha);
+        p[2] = (uint8_t)(p[2] * alpha);
+    }
+}   // premultiplyGammaAlpha
+
+// ----------------------------------------------------------------------------
+/** Swaps the red and blue channel of each pixel, i.e. converts between
+ *  BGRA and RGBA.
+ *  \param pixels The pixel data.
+ *  \param count Number of pixels.
+ */
+void ImageKernels::swapRedBlue(uint8_t *pixels, unsigned int count)
+{
+    unsigned int i = 0;
+#if defined(IMAGE_KERNELS_SSE2)
+    const __m128i keep_mask = _mm_set1_epi32(0xff00ff00);
+    const __m128i low_mask  = _mm_set1_epi32(0x000000ff);
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i *p = (__m128i*)(pixels + 4 * i);
+        const __m128i in = _mm_loadu_si128(p);
+        __m128i out = _mm_and_si128(in, keep_mask);
+        out = _mm_or_si128(out,
+                           _mm_slli_epi32(_mm_and_si128(in, low_mask), 16));
+        out = _mm_or_si128(out,
+                           _mm_and_si128(_mm_srli_epi32(in, 16), low_mask));
+        _mm_storeu_si128(p, out);
+    }
+#elif defined(IMAGE_KERNELS_NEON)
+    for (; i + 16 <= count; i += 16)
+    {
+        uint8x16x4_t p = vld4q_u8(pixels + 4 * i);
+        const uint8x16_t tmp = p.val[0];
+        p.val[0] = p.val[2];
+        p.val[2] = tmp;
+        vst4q_u8(pixels + 4 * i, p);
+    }
+#endif
+    for (; i < count; i++)
+    {
+        uint8_t *p = pixels + 4 * i;
+        const uint8_t tmp = p[0];
+        p[0] = p[2];
+        p[2] = tmp;
+    }
+}   // swapRedBlue
+
+// ----------------------------------------------------------------------------
+/** Sets the alpha channel of each pixel to the red channel of the
+ *  corresponding pixel in a mask.
+ *  \param pixels The pixel data.
+ *  \param mask The pixel data of the mask, same size and format.
+ *  \param count Number of pixels.
+ */
+void ImageKernels::copyRedToAlpha(uint8_t *pixels, const uint8_t *mask,
+                                  unsigned int count)
+{
+    unsigned int i = 0;
+#if defined(IMAGE_KERNELS_SSE2)
+    const __m128i alpha_mask = _mm_set1_epi32(0xff000000);
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i *p = (__m128i*)(pixels + 4 * i);
+        const __m128i in = _mm_loadu_si128(p);
+        const __m128i m  = _mm_loadu_si128((const __m128i*)(mask + 4 * i));
+        const __m128i out =
+            _mm_or_si128(_mm_andnot_si128(alpha_mask, in),
+                         _mm_and_si128(alpha_mask, _mm_slli_epi32(m, 8)));
+        _mm_storeu_si128(p, out);
+    }
+#elif defined(IMAGE_KERNELS_NEON)
+    for (; i + 16 <= count; i += 16)
+    {
+        uint8x16x4_t p = vld4q_u8(pixels + 4 * i);
+        const uint8x16x4_t m = vld4q_u8(mask + 4 * i);
+        p.val[3] = m.val[2];
+        vst4q_u8(pixels + 4 * i, p);
+    }
+#endif
+    for (; i < count; i++)
+        pixels[4 * i + 3] = mask[4 * i + 2];
+}   // copyRedToAlpha
+
+// ============================================================================
+namespace
+{
+    // The per-pixel code that was used before the kernels, to test that the
+    // kernels give exactly the same results.
+    void referencePremultiply(uint8_t *pixels, unsigned int count)
+    {
+        uint32_t *col = (uint32_t*)pixels;
+        for (unsigned int i = 0; i < count; i++)
+        {
+            unsigned int alpha = col[i] >> 24;
+            unsigned int red   = alpha * ((col[i] >> 16) & 0xff) / 255;
+            unsigned int green = alpha * ((col[i] >>  8) & 0xff) / 255;
+            unsigned int blue  = alpha * ( col[i]        & 0xff) / 255;
+            col[i] = ((alpha & 0xff) << 24) | ((red & 0xff) << 16) |
+                     ((green & 0xff) << 8) | (blue & 0xff);
+        }
+    }   // referencePremultiply
+
+    // ------------------------------------------------------------------------
+    void referencePredivide(uint8_t *pixels, unsigned int count)
+    {
+        uint32_t *col = (uint32_t*)pixels;
+        for (unsigned int i = 0; i < count; i++)
+        {
+            unsigned int alpha = col[i] >> 24;
+            if (!alpha) continue;
+            unsigned int red   = 255 * ((col[i] >> 16) & 0xff) / alpha;
+            unsigned int green = 255 * ((col[i] >>  8) & 0xff) / alpha;
+            unsigned int blue  = 255 * ( col[i]        & 0xff) / alpha;
+            col[i] = ((alpha & 0xff) << 24) | ((red & 0xff) << 16) |
+                     ((green & 0xff) << 8) | (blue & 0xff);
+        }
+    }   // referencePredivide
+
+    // ------------------------------------------------------------------------
+    void referenceGamma(uint8_t *data, unsigned int count)
+    {
+        for (unsigned i = 0; i < count; i++)
+        {
+            float alpha = data[4 * i + 3];
+            if (alpha > 0.)
+                alpha = pow(alpha / 255.f, 1.f / 2.2f);
+            data[4 * i] = (unsigned char)(data[4 * i] * alpha);
+            data[4 * i + 1] = (unsigned char)(data[4 * i + 1] * alpha);
+            data[4 * i + 2] = (unsigned char)(data[4 * i + 2] * alpha);
+        }
+    }   // referenceGamma
+
+    // ------------------------------------------------------------------------
+    void referenceSwap(uint8_t *data, unsigned int count)
+    {
+        for (unsigned int i = 0; i < count; i++)
+        {
+            char tmp_val = data[i*4];
+            data[i*4] = data[i*4 + 2];
+            data[i*4 + 2] = tmp_val;
+        }
+    }   // referenceSwap
+
+    // ------------------------------------------------------------------------
+    void referenceMask(uint8_t *pixels, const uint8_t *mask,
+                       unsigned int count)
+    {
+        uint32_t *col = (uint32_t*)pixels;
+        const uint32_t *alpha = (const uint32_t*)mask;
+        for (unsigned int i = 0; i < count; i++)
+        {
+            unsigned int red = (alpha[i] >> 16) & 0xff;
+            col[i] = (col[i] & 0x00ffffff) | (red << 24);
+        }
+    }   // referenceMask
+
+    // ------------------------------------------------------------------------
+    /** Applies a kernel and the corresponding reference code to copies of
+     *  the same data, and tests that the results are identical.
+     *  Logs the time the kernel and the reference code took. */
+    template<typename K, typename R>
+    void compareKernel(const char *name, const std::vector<uint8_t> &data,
+                       K kernel, R reference)
+    {
+        std::vector<uint8_t> a = data, b = data;
+        const unsigned int count = (unsigned int)data.size() / 4;
+        double start = StkTime::getRealTime();
+        kernel(a.data(), count);
+        double middle = StkTime::getRealTime();
+        reference(b.data(), count);
+        double end = StkTime::getRealTime();
+        if (memcmp(a.data(), b.data(), data.size()) != 0)
+        {
+            Log::error("ImageKernels", "%s differs from the reference.",
+                       name);
+            assert(false);
+        }
+        Log::info("ImageKernels", "%s: %f ms, reference %f ms.", name,
+                  (middle - start) * 1000.0, (end - middle) * 1000.0);
+    }   // compareKernel
+}   // namespace
+
+// ----------------------------------------------------------------------------
+/** Tests that all kernels give exactly the same results as the per-pixel
+ *  code they replace, both for all combinations of colour and alpha values
+ *  and for a larger random image, and logs the time for both.
+ */
+void ImageKernels::unitTesting()
+{
+    // All colour / alpha combinations, then random pixels. The odd number
+    // of pixels tests the scalar loop at the end of each kernel as well.
+    std::vector<uint8_t> data;
+    for (unsigned int a = 0; a < 256; a++)
+    {
+        for (unsigned int c = 0; c < 256; c++)
+        {
+            data.push_back((uint8_t)c);
+            data.push_back((uint8_t)(255 - c));
+            data.push_back((uint8_t)(c * 7));
+            data.push_back((uint8_t)a);
+        }
+    }
+    uint32_t seed = 12345;
+    for (unsigned int i = 0; i < 4 * (1024 * 1024 + 3); i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        data.push_back((uint8_t)(seed >> 16));
+    }
+
+    compareKernel("premultiplyAlpha", data, premultiplyAlpha,
+                  referencePremultiply);
+    compareKernel("predivideAlpha", data, predivideAlpha, referencePredivide);
+    compareKernel("premultiplyGammaAlpha", data, premultiplyGammaAlpha,
+                  referenceGamma);
+    compareKernel("swapRedBlue", data, swapRedBlue, referenceSwap);
+
+    std::vector<uint8_t> mask(data.rbegin(), data.rend());
+    compareKernel("copyRedToAlpha", data,
+        [&mask](uint8_t *p, unsigned int n) { copyRedToAlpha(p, mask.data(), n); },
+        [&mask](uint8_t *p, unsigned int n) { referenceMask(p, mask.data(), n); });
+}   // unitTesting
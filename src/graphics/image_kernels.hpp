@@ -0,0 +1,42 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2016 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#ifndef HEADER_IMAGE_KERNELS_HPP
+#define HEADER_IMAGE_KERNELS_HPP
+
+#include "utils/types.hpp"
+
+/** Functions that process the pixels of a texture before it is uploaded.
+ *  All functions work on 32 bit pixels with the bytes in the order blue,
+ *  green, red, alpha in memory (which is irrlicht's ECF_A8R8G8B8 format,
+ *  and GL_BGRA). They use SSE2 or NEON if available, and give exactly the
+ *  same results as the plain per-pixel code they replace.
+ *  \ingroup graphics
+ */
+namespace ImageKernels
+{
+    void premultiplyAlpha(uint8_t *pixels, unsigned int count);
+    void predivideAlpha(uint8_t *pixels, unsigned int count);
+    void premultiplyGammaAlpha(uint8_t *pixels, unsigned int count);
+    void swapRedBlue(uint8_t *pixels, unsigned int count);
+    void copyRedToAlpha(uint8_t *pixels, const uint8_t *mask,
+                        unsigned int count);
+    void unitTesting();
+}   // namespace ImageKernels
+
+#endif
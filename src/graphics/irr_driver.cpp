@@ -25,6 +25,7 @@
 #include "graphics/glwrap.hpp"
 #include "graphics/2dutils.hpp"
 #include "graphics/graphics_restrictions.hpp"
+#include "graphics/image_kernels.hpp"
 #include "graphics/light.hpp"
 #include "graphics/material_manager.hpp"
 #include "graphics/particle_kind_manager.hpp"
@@ -41,6 +42,7 @@
 #include "graphics/sun.hpp"
 #include "graphics/rtts.hpp"
 #include "graphics/texture_manager.hpp"
+#include "graphics/texture_streamer.hpp"
 #include "graphics/water.hpp"
 #include "graphics/wind.hpp"
 #include "guiengine/engine.hpp"
@@ -78,7 +80,7 @@
 #if (IRRLICHT_VERSION_MAJOR < 1 || IRRLICHT_VERSION_MINOR < 7 || \
     _IRR_MATERIAL_MAX_TEXTURES_ < 8 || \
     (!defined(_IRR_COMPILE_WITH_OPENGL_) && \
-     !defined(_IRR_COMPILE_WITH_OGLES2_)) || \
+     !defined(_IRR_COMPILE_WITH_OGLES2_) && !defined(SERVER_ONLY)) || \
     !defined(_IRR_COMPILE_WITH_B3D_LOADER_))
 #error "Building against an incompatible Irrlicht. Distros, \
 please use the included version."
@@ -90,7 +92,7 @@ using namespace irr;
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
 #endif
-#if defined(__linux__) && !defined(ANDROID)
+#if defined(__linux__) && !defined(ANDROID) && !defined(SERVER_ONLY)
 #include <X11/Xlib.h>
 #include <X11/Xutil.h>
 #endif
@@ -98,8 +100,9 @@ using namespace irr;
 /** singleton */
 IrrDriver *irr_driver = NULL;
 
-
+#ifndef SERVER_ONLY
 GPUTimer          m_perf_query[Q_LAST];
+#endif
 
 const int MIN_SUPPORTED_HEIGHT = 768;
 const int MIN_SUPPORTED_WIDTH  = 1024;
@@ -153,11 +156,13 @@ IrrDriver::~IrrDriver()
     // instead we just decrease the ref count here. When the material
     // is deleted, it will trigger the actual deletion of
     // PostProcessing when decreasing the refcount of its callback object.
+#ifndef SERVER_ONLY
     if(m_post_processing)
     {
         // check if we createad the OpenGL device by calling initDevice()
         m_post_processing->drop();
     }
+#endif
     assert(m_device != NULL);
 
     cleanUnicolorTextures();
@@ -165,12 +170,14 @@ IrrDriver::~IrrDriver()
     m_device = NULL;
     m_modes.clear();
 
+#ifndef SERVER_ONLY
     delete m_shadow_matrices;
     m_shadow_matrices = NULL;
     if (CVS->isGLSL())
     {
         Shaders::destroy();
     }
+#endif
     delete m_wind;
     delete m_spherical_harmonics;
 }   // ~IrrDriver
@@ -180,7 +187,9 @@ IrrDriver::~IrrDriver()
  */
 void IrrDriver::reset()
 {
+#ifndef SERVER_ONLY
     if (CVS->isGLSL()) m_post_processing->reset();
+#endif
 }   // reset
 
 void IrrDriver::setPhase(STKRenderingPass p)
@@ -208,6 +217,7 @@ core::array<video::IRenderTarget> &IrrDriver::getMainSetup()
   return m_mrt;
 }
 
+#ifndef SERVER_ONLY
 GPUTimer &IrrDriver::getGPUTimer(unsigned i)
 {
     return m_perf_query[i];
@@ -222,10 +232,11 @@ void IrrDriver::computeMatrixesAndCameras(scene::ICameraSceneNode *const camnode
     m_current_screen_size = core::vector2df(w, h);
     m_shadow_matrices->computeMatrixesAndCameras(camnode, int(w), int(h));
 }   // computeMatrixesAndCameras
+#endif   // !SERVER_ONLY
 
 // ----------------------------------------------------------------------------
 
-#if defined(__linux__) && !defined(ANDROID)
+#if defined(__linux__) && !defined(ANDROID) && !defined(SERVER_ONLY)
 /*
 Returns the parent window of "window" (i.e. the ancestor of window
 that is a direct child of the root, or window itself if it is a direct child).
@@ -298,7 +309,7 @@ void IrrDriver::updateConfigIfRelevant()
         {
             Log::warn("irr_driver", "Could not retrieve window location\n");
         }
-#elif defined(__linux__) && !defined(ANDROID)
+#elif defined(__linux__) && !defined(ANDROID) && !defined(SERVER_ONLY)
         const video::SExposedVideoData& videoData =
             m_device->getVideoDriver()->getExposedVideoData();
         Display* display = (Display*)videoData.OpenGLLinux.X11Display;
@@ -580,6 +591,7 @@ void IrrDriver::initDevice()
     m_scene_manager = m_device->getSceneManager();
     m_gui_env       = m_device->getGUIEnvironment();
     m_video_driver  = m_device->getVideoDriver();
+    m_video_driver->setTexturePreloader(TextureStreamer::get());
     m_sync = 0;
 
     m_actual_screen_size = m_video_driver->getCurrentRenderTargetSize();
@@ -616,6 +628,7 @@ void IrrDriver::initDevice()
     }*/
 
     // m_glsl might be reset in rtt if an error occurs.
+#ifndef SERVER_ONLY
     if (CVS->isGLSL())
     {
         Shaders::init();
@@ -625,6 +638,7 @@ void IrrDriver::initDevice()
 
     }
     else
+#endif
     {
         Log::warn("irr_driver", "Using the fixed pipeline (old GPU, or "
                                 "shaders disabled in options)");
@@ -633,7 +647,7 @@ void IrrDriver::initDevice()
     // Only change video driver settings if we are showing graphics
     if (!ProfileWorld::isNoGraphics())
     {
-#if defined(__linux__) && !defined(ANDROID)
+#if defined(__linux__) && !defined(ANDROID) && !defined(SERVER_ONLY)
         // Set class hints on Linux, used by Window Managers.
         const video::SExposedVideoData& videoData = m_video_driver
                                                 ->getExposedVideoData();
@@ -683,14 +697,18 @@ void IrrDriver::initDevice()
     material2D.AntiAliasing=video::EAAM_FULL_BASIC;
     //m_video_driver->enableMaterial2D();
 
+#ifndef SERVER_ONLY
     // Initialize post-processing if supported
     m_post_processing = new PostProcessing(m_video_driver);
+#endif
 
     // set cursor visible by default (what's the default is not too clearly documented,
     // so let's decide ourselves...)
     m_device->getCursorControl()->setVisible(true);
     m_pointer_shown = true;
+#ifndef SERVER_ONLY
     m_shadow_matrices = new ShadowMatrices();
+#endif
 }   // initDevice
 
 // ----------------------------------------------------------------------------
@@ -706,6 +724,7 @@ void IrrDriver::setMaxTextureSize()
 }   // setMaxTextureSize
 
 // ----------------------------------------------------------------------------
+#ifndef SERVER_ONLY
 void IrrDriver::cleanSunInterposer()
 {
     delete m_sun_interposer;
@@ -752,6 +771,7 @@ void IrrDriver::getOpenGLData(std::string *vendor, std::string *renderer,
     *renderer = (char*)glGetString(GL_RENDERER);
     *version  = (char*)glGetString(GL_VERSION );
 }   // getOpenGLData
+#endif   // !SERVER_ONLY
 
 //-----------------------------------------------------------------------------
 void IrrDriver::showPointer()
@@ -812,7 +832,7 @@ bool IrrDriver::moveWindow(int x, int y)
         Log::warn("irr_driver", "Could not set window location\n");
         return false;
     }
-#elif defined(__linux__) && !defined(ANDROID)
+#elif defined(__linux__) && !defined(ANDROID) && !defined(SERVER_ONLY)
     const video::SExposedVideoData& videoData = m_video_driver->getExposedVideoData();
 
     Display* display = (Display*)videoData.OpenGLLinux.X11Display;
@@ -869,6 +889,7 @@ void IrrDriver::applyResolutionSettings()
                                             UserConfigParams::m_prev_width,
                                             UserConfigParams::m_prev_height) );
     m_video_driver->endScene();
+    TextureStreamer::get()->finishRequests();
     track_manager->removeAllCachedData();
     delete attachment_manager;
     projectile_manager->removeTextures();
@@ -894,6 +915,7 @@ void IrrDriver::applyResolutionSettings()
     // FIXME: this load sequence is (mostly) duplicated from main.cpp!!
     // That's just error prone
     // (we're sure to update main.cpp at some point and forget this one...)
+#ifndef SERVER_ONLY
     ShaderBase::updateShaders();
     VAOManager::getInstance()->kill();
     SolidPassCmd::getInstance()->kill();
@@ -915,6 +937,7 @@ void IrrDriver::applyResolutionSettings()
     {
         Shaders::destroy();
     }
+#endif   // !SERVER_ONLY
     delete m_spherical_harmonics;
 
     // initDevice will drop the current device.
@@ -1206,6 +1229,7 @@ scene::IMeshSceneNode *IrrDriver::addSphere(float radius,
     m.setTexture(1, getUnicolorTexture(video::SColor(0, 0, 0, 0)));
     m.setTexture(7, getUnicolorTexture(video::SColor(0, 0, 0, 0)));
 
+#ifndef SERVER_ONLY
     if (CVS->isGLSL())
     {
         STKMeshSceneNode *node =
@@ -1214,6 +1238,7 @@ scene::IMeshSceneNode *IrrDriver::addSphere(float radius,
                                 NULL, -1, "sphere");
         return node;
     }
+#endif
 
     scene::IMeshSceneNode *node = m_scene_manager->addMeshSceneNode(mesh);
     return node;
@@ -1238,9 +1263,12 @@ scene::IMeshSceneNode *IrrDriver::addMesh(scene::IMesh *mesh,
                                           RenderInfo* render_info,
                                           bool all_parts_colorized)
 {
+#ifndef SERVER_ONLY
     if (!CVS->isGLSL())
+#endif
         return m_scene_manager->addMeshSceneNode(mesh, parent);
 
+#ifndef SERVER_ONLY
     if (!parent)
       parent = m_scene_manager->getRootSceneNode();
 
@@ -1255,6 +1283,7 @@ scene::IMeshSceneNode *IrrDriver::addMesh(scene::IMesh *mesh,
     node->drop();
 
     return node;
+#endif   // !SERVER_ONLY
 }   // addMesh
 
 // ----------------------------------------------------------------------------
@@ -1278,6 +1307,7 @@ scene::ISceneNode *IrrDriver::addBillboard(const core::dimension2d< f32 > size,
                                            bool alphaTesting)
 {
     scene::IBillboardSceneNode* node;
+#ifndef SERVER_ONLY
     if (CVS->isGLSL())
     {
         if (!parent)
@@ -1288,6 +1318,7 @@ scene::ISceneNode *IrrDriver::addBillboard(const core::dimension2d< f32 > size,
         node->drop();
     }
     else
+#endif
         node = m_scene_manager->addBillboardSceneNode(parent, size);
     assert(node->getMaterialCount() > 0);
     node->setMaterialTexture(0, texture);
@@ -1436,7 +1467,9 @@ scene::IAnimatedMeshSceneNode *IrrDriver::addAnimatedMesh(scene::IAnimatedMesh *
     const std::string& debug_name, scene::ISceneNode* parent,
     RenderInfo* render_info, bool all_parts_colorized)
 {
+#ifndef SERVER_ONLY
     if (!CVS->isGLSL())
+#endif
     {
         return m_scene_manager->addAnimatedMeshSceneNode(mesh, parent, -1,
             core::vector3df(0, 0, 0),
@@ -1445,6 +1478,7 @@ scene::IAnimatedMeshSceneNode *IrrDriver::addAnimatedMesh(scene::IAnimatedMesh *
             /*addIfMeshIsZero*/true);
     }
 
+#ifndef SERVER_ONLY
     if (!parent)
         parent = m_scene_manager->getRootSceneNode();
     scene::IAnimatedMeshSceneNode* node =
@@ -1453,6 +1487,7 @@ scene::IAnimatedMeshSceneNode *IrrDriver::addAnimatedMesh(scene::IAnimatedMesh *
         core::vector3df(1, 1, 1), render_info, all_parts_colorized);
     node->drop();
     return node;
+#endif   // !SERVER_ONLY
 }   // addAnimatedMesh
 
 // ----------------------------------------------------------------------------
@@ -1495,10 +1530,12 @@ scene::ISceneNode *IrrDriver::addSkyBox(const std::vector<video::ITexture*> &tex
 {
     assert(texture.size() == 6);
 
+#ifndef SERVER_ONLY
     if (CVS->isGLSL())
     {
         m_skybox = new Skybox(texture);
     }
+#endif
 
     if(spherical_harmonics_textures.size() == 6)
     {
@@ -1512,7 +1549,9 @@ scene::ISceneNode *IrrDriver::addSkyBox(const std::vector<video::ITexture*> &tex
 
 void IrrDriver::suppressSkyBox()
 {
+#ifndef SERVER_ONLY
     delete m_skybox;
+#endif
     m_skybox = NULL;
 }
 
@@ -1689,19 +1728,8 @@ video::ITexture *IrrDriver::getTexture(const std::string &filename,
             img->lock())
         {
             core::dimension2d<u32> dim = img->getDimension();
-            for(unsigned int x = 0; x < dim.Width; x++)
-            {
-                for(unsigned int y = 0; y < dim.Height; y++)
-                {
-                    video::SColor col = img->getPixel(x, y);
-                    unsigned int alpha = col.getAlpha();
-                    unsigned int red   = alpha * col.getRed()   / 255;
-                    unsigned int blue  = alpha * col.getBlue()  / 255;
-                    unsigned int green = alpha * col.getGreen() / 255;
-                    col.set(alpha, red, green, blue);
-                    img->setPixel(x, y, col, false);
-                }   // for y
-            }   // for x
+            ImageKernels::premultiplyAlpha((uint8_t*)img->lock(),
+                                           dim.Width * dim.Height);
             img->unlock();
         }   // if png and ColorFOrmat and lock
         // Other formats can be premul, but the tasks can be non premul
@@ -1711,22 +1739,8 @@ video::ITexture *IrrDriver::getTexture(const std::string &filename,
             img->lock())
         {
             core::dimension2d<u32> dim = img->getDimension();
-            for(unsigned int  x = 0; x < dim.Width; x++)
-            {
-                for(unsigned int y = 0; y < dim.Height; y++)
-                {
-                    video::SColor col = img->getPixel(x, y);
-                    unsigned int alpha = col.getAlpha();
-                    // Avoid divide by zero
-                    if (alpha) {
-                        unsigned int red   = 255 * col.getRed() / alpha ;
-                        unsigned int blue  = 255 * col.getBlue() / alpha;
-                        unsigned int green = 255 * col.getGreen() / alpha;
-                        col.set(alpha, red, green, blue);
-                        img->setPixel(x, y, col, false);
-                    }
-                }   // for y
-            }   // for x
+            ImageKernels::predivideAlpha((uint8_t*)img->lock(),
+                                         dim.Width * dim.Height);
             img->unlock();
         }   // if premul && color format && lock
         out = m_video_driver->addTexture(filename.c_str(), img, NULL);
@@ -1832,19 +1846,32 @@ video::ITexture* IrrDriver::applyMask(video::ITexture* texture,
 
     if (img == NULL || mask == NULL) return NULL;
 
-    if (img->lock() && mask->lock())
+    void *img_data  = img->lock();
+    void *mask_data = mask->lock();
+    if (img_data && mask_data)
     {
         core::dimension2d<u32> dim = img->getDimension();
-        for (unsigned int x = 0; x < dim.Width; x++)
+        if (img->getColorFormat()  == video::ECF_A8R8G8B8 &&
+            mask->getColorFormat() == video::ECF_A8R8G8B8 &&
+            mask->getDimension()   == dim                    )
         {
-            for (unsigned int y = 0; y < dim.Height; y++)
+            ImageKernels::copyRedToAlpha((uint8_t*)img_data,
+                                         (const uint8_t*)mask_data,
+                                         dim.Width * dim.Height);
+        }
+        else
+        {
+            for (unsigned int x = 0; x < dim.Width; x++)
             {
-                video::SColor col = img->getPixel(x, y);
-                video::SColor alpha = mask->getPixel(x, y);
-                col.setAlpha( alpha.getRed() );
-                img->setPixel(x, y, col, false);
-            }   // for y
-        }   // for x
+                for (unsigned int y = 0; y < dim.Height; y++)
+                {
+                    video::SColor col = img->getPixel(x, y);
+                    video::SColor alpha = mask->getPixel(x, y);
+                    col.setAlpha( alpha.getRed() );
+                    img->setPixel(x, y, col, false);
+                }   // for y
+            }   // for x
+        }
 
         mask->unlock();
         img->unlock();
@@ -1862,14 +1889,17 @@ video::ITexture* IrrDriver::applyMask(video::ITexture* texture,
     return t;
 }   // applyMask
 // ----------------------------------------------------------------------------
+#ifndef SERVER_ONLY
 void IrrDriver::setRTT(RTT* rtt)
 {
     m_shadow_matrices->resetShadowCamNodes();
     m_rtts = rtt;
 }
+#endif   // !SERVER_ONLY
 // ----------------------------------------------------------------------------
 void IrrDriver::onLoadWorld()
 {
+#ifndef SERVER_ONLY
     if (CVS->isGLSL())
     {
         const core::recti &viewport = Camera::getCamera(0)->getViewport();
@@ -1877,11 +1907,14 @@ void IrrDriver::onLoadWorld()
         size_t height = viewport.LowerRightCorner.Y - viewport.UpperLeftCorner.Y;
         m_rtts = new RTT(width, height);
     }
+#endif
 }
 // ----------------------------------------------------------------------------
 void IrrDriver::onUnloadWorld()
 {
+#ifndef SERVER_ONLY
     delete m_rtts;
+#endif
     m_rtts = NULL;
 
     suppressSkyBox();
@@ -2262,10 +2295,12 @@ void IrrDriver::update(float dt)
 
     if (world)
     {
+#ifndef SERVER_ONLY
         if (CVS->isGLSL())
             renderGLSL(dt);
         else
             renderFixed(dt);
+#endif
 
         GUIEngine::Screen* current_screen = GUIEngine::getCurrentScreen();
         if (current_screen != NULL && current_screen->needs3D())
@@ -2574,6 +2609,7 @@ void IrrDriver::applyObjectPassShader(scene::ISceneNode * const node, bool rimli
     if (!CVS->isGLSL())
         return;
 
+#ifndef SERVER_ONLY
     // Don't override sky
     if (node->getType() == scene::ESNT_SKY_DOME ||
         node->getType() == scene::ESNT_SKY_BOX)
@@ -2634,6 +2670,7 @@ void IrrDriver::applyObjectPassShader(scene::ISceneNode * const node, bool rimli
     {
         applyObjectPassShader(*it, rimlit);
     }
+#endif   // !SERVER_ONLY
 }
 
 // ----------------------------------------------------------------------------
@@ -2653,6 +2690,7 @@ scene::ISceneNode *IrrDriver::addLight(const core::vector3df &pos,
                                        float r, float g, float b,
                                        bool sun, scene::ISceneNode* parent)
 {
+#ifndef SERVER_ONLY
     if (CVS->isGLSL())
     {
         if (parent == NULL) parent = m_scene_manager->getRootSceneNode();
@@ -2682,6 +2720,7 @@ scene::ISceneNode *IrrDriver::addLight(const core::vector3df &pos,
         return light;
     }
     else
+#endif
     {
         return m_scene_manager
                ->addLightSceneNode(m_scene_manager->getRootSceneNode(),
@@ -2703,6 +2742,7 @@ void IrrDriver::clearLights()
 
 // ----------------------------------------------------------------------------
 
+#ifndef SERVER_ONLY
 GLuint IrrDriver::getRenderTargetTexture(TypeRTT which)
 {
     return m_rtts->getRenderTarget(which);
@@ -2721,4 +2761,5 @@ GLuint IrrDriver::getDepthStencilTexture()
 {
     return m_rtts->getDepthStencilTexture();
 }   // getDepthStencilTexture
+#endif   // !SERVER_ONLY
 
@@ -66,6 +66,7 @@ class PostProcessing;
 class LightNode;
 class ShadowImportance;
 class ShadowMatrices;
+class Skybox;
 
 enum STKRenderingPass
 {
@@ -322,6 +323,7 @@ private:
                    irr::scene::ISkinnedMesh* mesh, int id);
 #endif
 
+#ifndef SERVER_ONLY
     void renderFixed(float dt);
     void renderGLSL(float dt);
     void renderSolidFirstPass();
@@ -337,18 +339,21 @@ private:
     void renderAmbientScatter();
     void renderLightsScatter(unsigned pointlightCount);
     void renderShadowsDebug();
-    void doScreenShot();
     void PrepareDrawCalls(scene::ICameraSceneNode *camnode);
+#endif
+    void doScreenShot();
 public:
          IrrDriver();
         ~IrrDriver();
     void initDevice();
     void reset();
     void setMaxTextureSize();
+#ifndef SERVER_ONLY
     void getOpenGLData(std::string *vendor, std::string *renderer,
                        std::string *version);
 
     void renderSkybox(const scene::ICameraSceneNode *camera);
+#endif
     void setPhase(STKRenderingPass);
     STKRenderingPass getPhase() const;
     void IncreaseObjectCount();
@@ -443,7 +448,9 @@ public:
     void                  setTextureErrorMessage(const std::string &error,
                                                  const std::string &detail="");
     void                  unsetTextureErrorMessage();
+#ifndef SERVER_ONLY
     class GPUTimer        &getGPUTimer(unsigned);
+#endif
 
     void draw2dTriangle(const core::vector2df &a, const core::vector2df &b,
                         const core::vector2df &c,
@@ -502,8 +509,10 @@ public:
     {
         return m_texture_error_message;
     }   // getTextureErrorMessage
+#ifndef SERVER_ONLY
     // ------------------------------------------------------------------------
     void setRTT(RTT* rtt);
+#endif
     // ------------------------------------------------------------------------
     RTT* getRTT() { return m_rtts; }
     // ------------------------------------------------------------------------
@@ -554,10 +563,12 @@ public:
     {
         m_suncolor = col;
     }
+#ifndef SERVER_ONLY
     // ------------------------------------------------------------------------
     GLuint getRenderTargetTexture(TypeRTT which);
     FrameBuffer& getFBO(TypeFBO which);
     GLuint getDepthStencilTexture();
+#endif
     // ------------------------------------------------------------------------
     void resetDebugModes()
     {
@@ -670,9 +681,10 @@ public:
     // ------------------------------------------------------------------------
     ShadowMatrices *getShadowMatrices() { return m_shadow_matrices;  }
     // ------------------------------------------------------------------------
-    
+#ifndef SERVER_ONLY
     void cleanSunInterposer();
     void createSunInterposer();
+#endif
     // ------------------------------------------------------------------------
     void setViewMatrix(core::matrix4 matrix)
     {
@@ -765,6 +777,7 @@ public:
     void onLoadWorld();
     void onUnloadWorld();
 
+#ifndef SERVER_ONLY
     void renderScene(scene::ICameraSceneNode * const camnode,
                      unsigned pointlightcount, std::vector<GlowData>& glows,
                      float dt, bool hasShadows, bool forceRTT);
@@ -775,6 +788,7 @@ public:
     void computeMatrixesAndCameras(scene::ICameraSceneNode * const camnode,
                                    size_t width, size_t height);
     void uploadLightingData();
+#endif
 
 
     // --------------------- OLD RTT --------------------
@@ -716,6 +716,7 @@ void  Material::setMaterialProperties(video::SMaterial *m, scene::IMeshBuffer* m
                   m_texname.c_str());
     }
 
+#ifndef SERVER_ONLY
     if (CVS->isGLSL())
     {
         ITexture *tex;
@@ -865,6 +866,7 @@ void  Material::setMaterialProperties(video::SMaterial *m, scene::IMeshBuffer* m
         }
         m->setTexture(1, glossytex);
     }
+#endif   // !SERVER_ONLY
 
 
     if (m_shader_type == SHADERTYPE_SOLID_UNLIT)
@@ -43,6 +43,7 @@ MaterialManager::MaterialManager()
     /* Create list - and default material zero */
 
     m_materials.reserve(256);
+    m_materials_stamp = 1;
     // We can't call init/loadMaterial here, since the global variable
     // material_manager has not yet been initialised, and
     // material_manager is used in the Material constructor.
@@ -60,6 +61,8 @@ MaterialManager::~MaterialManager()
         delete m_materials[i];
     }
     m_materials.clear();
+    m_name_index.clear();
+    m_full_path_index.clear();
 
     for (std::map<video::E_MATERIAL_TYPE, Material*> ::iterator it =
          m_default_materials.begin(); it != m_default_materials.end(); it++)
@@ -85,31 +88,29 @@ Material* MaterialManager::getMaterialFor(video::ITexture* t,
     if (t == NULL)
         return getDefaultMaterial(material_type);
 
+    // The result is cached in the texture, so that the name does not need
+    // to be looked up each frame. NULL means no material uses the texture.
+    void *cached;
+    if (t->getUserData(m_materials_stamp, &cached))
+    {
+        return cached ? (Material*)cached
+                      : getDefaultMaterial(material_type);
+    }
+
     core::stringc img_path = core::stringc(t->getName());
-    const std::string image = StringUtils::getBasename(img_path.c_str());
+    Material *m;
     if (!img_path.empty() && (img_path.findFirst('/') != -1 || img_path.findFirst('\\') != -1))
     {
-        // Search backward so that temporary (track) textures are found first
-        for (int i = (int)m_materials.size() - 1; i >= 0; i--)
-        {
-            if (m_materials[i]->getTexFullPath() == img_path.c_str())
-            {
-                return m_materials[i];
-            }
-        }
+        m = findMaterial(m_full_path_index, img_path.c_str());
     }
     else
     {
-        for (int i = (int)m_materials.size() - 1; i >= 0; i--)
-        {
-            if (m_materials[i]->getTexFname() == image)
-            {
-                return m_materials[i];
-            }
-        }   // for i
+        m = findMaterial(m_name_index,
+                         StringUtils::getBasename(img_path.c_str()));
     }
+    t->setUserData(m, m_materials_stamp);
 
-    return getDefaultMaterial(material_type);
+    return m ? m : getDefaultMaterial(material_type);
 }
 
 //-----------------------------------------------------------------------------
@@ -145,6 +146,7 @@ Material* MaterialManager::getDefaultMaterial(video::E_MATERIAL_TYPE shader_type
         // Try to find a cleaner way
         // If graphics are disabled, shaders should not be accessed (getShader
         // asserts that shaders are initialised).
+#ifndef SERVER_ONLY
         if(!ProfileWorld::isNoGraphics() && CVS->isGLSL() &&
             shader_type == Shaders::getShader(ShaderType::ES_OBJECT_UNLIT))
             default_material->setShaderType(Material::SHADERTYPE_SOLID_UNLIT);
@@ -155,6 +157,7 @@ Material* MaterialManager::getDefaultMaterial(video::E_MATERIAL_TYPE shader_type
         //         shader_type == Shaders::getShader(ShaderType::ES_OBJECTPASS))
         //    default_material->setShaderType(Material::SHADERTYPE_ALPHA_BLEND);
         else
+#endif
             default_material->setShaderType(Material::SHADERTYPE_SOLID);
 
         m_default_materials[shader_type] = default_material;
@@ -174,15 +177,9 @@ void MaterialManager::adjustForFog(video::ITexture* t,
                                    bool use_fog) const
 {
     const std::string image = StringUtils::getBasename(core::stringc(t->getName()).c_str());
-    // Search backward so that temporary (track) textures are found first
-    for(int i = (int)m_materials.size()-1; i>=0; i-- )
-    {
-        if (m_materials[i]->getTexFname()==image)
-        {
-            m_materials[i]->adjustForFog(parent, &(mb->getMaterial()), use_fog);
-            return;
-        }
-    }   // for i
+    Material *m = findMaterial(m_name_index, image);
+    if (m)
+        m->adjustForFog(parent, &(mb->getMaterial()), use_fog);
 }   // adjustForFog
 
 //-----------------------------------------------------------------------------
@@ -207,10 +204,68 @@ void MaterialManager::setAllUntexturedMaterialFlags(scene::IMeshBuffer *mb)
 //-----------------------------------------------------------------------------
 int MaterialManager::addEntity(Material *m)
 {
-    m_materials.push_back(m);
+    addMaterial(m);
     return (int)m_materials.size()-1;
 }
 
+//-----------------------------------------------------------------------------
+/** Adds a material at the end of m_materials and to the indices.
+ */
+void MaterialManager::addMaterial(Material *m)
+{
+    const int index = (int)m_materials.size();
+    m_materials.push_back(m);
+    m_name_index[m->getTexFname()].push_back(index);
+    if (!m->getTexFullPath().empty())
+        m_full_path_index[m->getTexFullPath()].push_back(index);
+    if (++m_materials_stamp == 0)
+        m_materials_stamp = 1;
+}   // addMaterial
+
+//-----------------------------------------------------------------------------
+/** Deletes the last material in m_materials and removes it from the
+ *  indices.
+ */
+void MaterialManager::removeLastMaterial()
+{
+    Material *m = m_materials.back();
+    MaterialIndex::iterator i = m_name_index.find(m->getTexFname());
+    assert(i != m_name_index.end() &&
+           i->second.back() == (int)m_materials.size() - 1);
+    i->second.pop_back();
+    if (i->second.empty())
+        m_name_index.erase(i);
+    if (!m->getTexFullPath().empty())
+    {
+        i = m_full_path_index.find(m->getTexFullPath());
+        assert(i != m_full_path_index.end() &&
+               i->second.back() == (int)m_materials.size() - 1);
+        i->second.pop_back();
+        if (i->second.empty())
+            m_full_path_index.erase(i);
+    }
+    delete m;
+    m_materials.pop_back();
+    if (++m_materials_stamp == 0)
+        m_materials_stamp = 1;
+}   // removeLastMaterial
+
+//-----------------------------------------------------------------------------
+/** Returns the most recently added material with the given name in an
+ *  index, so that temporary (track) textures are found first.
+ *  \param index The index to search (by name or by full path).
+ *  \param name The texture name.
+ *  \return The material, or NULL if there is no such material.
+ */
+Material* MaterialManager::findMaterial(const MaterialIndex &index,
+                                        const std::string &name) const
+{
+    MaterialIndex::const_iterator i = index.find(name);
+    if (i == index.end())
+        return NULL;
+    return m_materials[i->second.back()];
+}   // findMaterial
+
 //-----------------------------------------------------------------------------
 void MaterialManager::loadMaterial()
 {
@@ -248,6 +303,21 @@ void MaterialManager::addSharedMaterial(const std::string& filename, bool deprec
     m_shared_material_index = (int)m_materials.size();
 }   // addSharedMaterial
 
+//-----------------------------------------------------------------------------
+/** Adds the materials of an already parsed materials file as shared
+ *  materials. Like pushTempMaterial(), a file without a materials node is
+ *  silently ignored.
+ *  \param root The parsed materials file.
+ *  \param filename Name of the file, used in error messages.
+ */
+void MaterialManager::addSharedMaterial(const XMLNode *root,
+                                        const std::string& filename)
+{
+    if(root->getName()=="materials")
+        pushTempMaterial(root, filename, /*deprecated*/false);
+    m_shared_material_index = (int)m_materials.size();
+}   // addSharedMaterial
+
 //-----------------------------------------------------------------------------
 bool MaterialManager::pushTempMaterial(const std::string& filename, bool deprecated)
 {
@@ -278,7 +348,7 @@ bool MaterialManager::pushTempMaterial(const XMLNode *root,
         }
         try
         {
-            m_materials.push_back(new Material(node, deprecated));
+            addMaterial(new Material(node, deprecated));
         }
         catch(std::exception& e)
         {
@@ -293,11 +363,8 @@ bool MaterialManager::pushTempMaterial(const XMLNode *root,
 //-----------------------------------------------------------------------------
 void MaterialManager::popTempMaterial()
 {
-    for(int i=(int)m_materials.size()-1; i>=this->m_shared_material_index; i--)
-    {
-        delete m_materials[i];
-        m_materials.pop_back();
-    }   // for i6
+    while ((int)m_materials.size() > m_shared_material_index)
+        removeLastMaterial();
 }   // popTempMaterial
 
 //-----------------------------------------------------------------------------
@@ -338,15 +405,13 @@ Material *MaterialManager::getMaterial(const std::string& fname,
     else
         basename = fname;
         
-    // Search backward so that temporary (track) textures are found first
-    for(int i = (int)m_materials.size()-1; i>=0; i-- )
-    {
-        if(m_materials[i]->getTexFname()==basename) return m_materials[i];
-    }
+    Material *found = findMaterial(m_name_index, basename);
+    if (found)
+        return found;
 
     // Add the new material
     Material* m = new Material(fname, is_full_path, complain_if_not_found);
-    m_materials.push_back(m);
+    addMaterial(m);
     if(make_permanent)
     {
         assert(m_shared_material_index==(int)m_materials.size()-1);
@@ -368,11 +433,5 @@ void MaterialManager::makeMaterialsPermanent()
 bool MaterialManager::hasMaterial(const std::string& fname)
 {
     std::string basename=StringUtils::getBasename(fname);
-
-    // Search backward so that temporary (track) textures are found first
-    for(int i = (int)m_materials.size()-1; i>=0; i-- )
-    {
-        if(m_materials[i]->getTexFname()==basename) return true;
-    }
-    return false;
+    return findMaterial(m_name_index, basename) != NULL;
 }
@@ -31,6 +31,7 @@ using namespace irr;
 
 #include <irrlicht.h>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <map>
 
@@ -50,6 +51,29 @@ private:
 
     std::vector<Material*> m_materials;
 
+    /** Maps a texture name to the indices (in m_materials) of all materials
+     *  using it, in increasing order. Since materials are only added and
+     *  removed at the end of m_materials, the last index is the material
+     *  that a backwards search would find, and removing a temporary
+     *  material makes an older material with the same name visible
+     *  again. */
+    typedef std::unordered_map<std::string, std::vector<int> > MaterialIndex;
+
+    /** Index of m_materials by texture file name (without path). */
+    MaterialIndex m_name_index;
+
+    /** Index of m_materials by full texture path. */
+    MaterialIndex m_full_path_index;
+
+    /** Changed whenever m_materials changes, which invalidates the
+     *  materials cached in the textures by getMaterialFor(). */
+    u32 m_materials_stamp;
+
+    void      addMaterial(Material *m);
+    void      removeLastMaterial();
+    Material* findMaterial(const MaterialIndex &index,
+                           const std::string &name) const;
+
     std::map<video::E_MATERIAL_TYPE, Material*> m_default_materials;
     Material* getDefaultMaterial(video::E_MATERIAL_TYPE material_type);
 
@@ -77,6 +101,7 @@ public:
                                 bool complain_if_not_found=true,
                                 bool strip_path=true);
     void      addSharedMaterial(const std::string& filename, bool deprecated = false);
+    void      addSharedMaterial(const XMLNode *root, const std::string& filename);
     bool      pushTempMaterial (const std::string& filename, bool deprecated = false);
     bool      pushTempMaterial (const XMLNode *root, const std::string& filename, bool deprecated = false);
     void      popTempMaterial  ();
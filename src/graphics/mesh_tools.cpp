@@ -330,10 +330,14 @@ void recalculateTangents(scene::IMesh* mesh, bool recalculate_normals, bool smoo
 
 bool MeshTools::isNormalMap(scene::IMeshBuffer* mb)
 {
+#ifdef SERVER_ONLY
+    return false;
+#else
     if (!CVS->isGLSL())
         return false;
     return (mb->getMaterial().MaterialType == Shaders::getShader(ES_NORMAL_MAP) &&
             mb->getVertexType() != video::EVT_TANGENTS);
+#endif
 }
 
 // Copied from irrlicht
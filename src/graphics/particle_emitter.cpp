@@ -453,16 +453,20 @@ void ParticleEmitter::setParticleType(const ParticleKind* type)
         }
         else
         {
+#ifndef SERVER_ONLY
             if (m_is_glsl)
                 m_node = ParticleSystemProxy::addParticleNode(m_is_glsl, type->randomizeInitialY());
             else
+#endif   // !SERVER_ONLY
                 m_node = irr_driver->addParticleNode();
             
+#ifndef SERVER_ONLY
             if (m_is_glsl)
             {
                 bool additive = (type->getMaterial()->getShaderType() == Material::SHADERTYPE_ADDITIVE);
                 static_cast<ParticleSystemProxy *>(m_node)->setAlphaAdditive(additive);
             }
+#endif   // !SERVER_ONLY
         }
 
         if (m_parent != NULL)
@@ -637,11 +641,13 @@ void ParticleEmitter::setParticleType(const ParticleKind* type)
 
         if (type->hasScaleAffector())
         {
+#ifndef SERVER_ONLY
             if (m_is_glsl)
             {
                 static_cast<ParticleSystemProxy *>(m_node)->setIncreaseFactor(type->getScaleAffectorFactorX());
             }
             else
+#endif   // !SERVER_ONLY
             {
                 core::vector2df factor = core::vector2df(type->getScaleAffectorFactorX(),
                     type->getScaleAffectorFactorY());
@@ -653,6 +659,7 @@ void ParticleEmitter::setParticleType(const ParticleKind* type)
 
         if (type->getMinColor() != type->getMaxColor())
         {
+#ifndef SERVER_ONLY
             if (m_is_glsl)
             {
                 video::SColor color_from = type->getMinColor();
@@ -666,6 +673,7 @@ void ParticleEmitter::setParticleType(const ParticleKind* type)
                     color_to.getBlue() / 255.0f);
             }
             else
+#endif   // !SERVER_ONLY
             {
                 video::SColor color_from = type->getMinColor();
                 core::vector3df color_from_v =
@@ -694,12 +702,14 @@ void ParticleEmitter::setParticleType(const ParticleKind* type)
             // TODO: wind affector for GLSL particles
         }
 
+#ifndef SERVER_ONLY
         const bool flips = type->getFlips();
         if (flips)
         {
             if (m_is_glsl)
                 static_cast<ParticleSystemProxy *>(m_node)->setFlip();
         }
+#endif   // !SERVER_ONLY
     }
 }   // setParticleType
 
@@ -708,6 +718,7 @@ void ParticleEmitter::setParticleType(const ParticleKind* type)
 void ParticleEmitter::addHeightMapAffector(Track* t)
 {
     
+#ifndef SERVER_ONLY
     if (m_is_glsl)
     {
         const Vec3* aabb_min;
@@ -721,6 +732,7 @@ void ParticleEmitter::addHeightMapAffector(Track* t)
             track_x, track_z, track_x_len, track_z_len);
     }
     else
+#endif   // !SERVER_ONLY
     {
         HeightMapCollisionAffector* hmca = new HeightMapCollisionAffector(t);
         m_node->addAffector(hmca);
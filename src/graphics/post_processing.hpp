@@ -18,6 +18,8 @@
 #ifndef HEADER_POST_PROCESSING_HPP
 #define HEADER_POST_PROCESSING_HPP
 
+#ifndef SERVER_ONLY
+
 #include "IShaderConstantSetCallBack.h"
 #include "S3DVertex.h"
 #include "SMaterial.h"
@@ -114,4 +116,5 @@ public:
     void         giveBoost(unsigned int cam_index);
 };   // class PostProcessing
 
+#endif   // !SERVER_ONLY
 #endif // HEADER_POST_PROCESSING_HPP
@@ -16,6 +16,8 @@
 //  along with this program; if not, write to the Free Software
 //  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
+#ifndef SERVER_ONLY
+
 #include "graphics/irr_driver.hpp"
 
 #include "config/user_config.hpp"
@@ -730,3 +732,5 @@ void IrrDriver::renderGlow(std::vector<GlowData>& glows)
     m_post_processing->renderGlow(m_rtts->getRenderTarget(RTT_QUARTER1));
     glDisable(GL_STENCIL_TEST);
 }
+
+#endif   // !SERVER_ONLY
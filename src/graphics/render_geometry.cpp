@@ -15,6 +15,8 @@
 //  along with this program; if not, write to the Free Software
 //  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
+#ifndef SERVER_ONLY
+
 #include "graphics/irr_driver.hpp"
 
 #include "config/user_config.hpp"
@@ -2021,3 +2023,5 @@ void IrrDriver::renderRSM()
     getShadowMatrices()->setRSMMapAvail(true);
 #endif
 }   // renderRSM
+
+#endif   // !SERVER_ONLY
@@ -16,6 +16,8 @@
 //  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 
+#ifndef SERVER_ONLY
+
 #include "config/user_config.hpp"
 #include "graphics/callbacks.hpp"
 #include "graphics/central_settings.hpp"
@@ -615,3 +617,5 @@ void IrrDriver::renderLightsScatter(unsigned pointlightcount)
                                          getFBO(FBO_COLORS).getWidth(),
                                          getFBO(FBO_COLORS).getHeight());
 }   // renderLightsScatter
+
+#endif   // !SERVER_ONLY
@@ -15,6 +15,8 @@
 //  along with this program; if not, write to the Free Software
 //  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
+#ifndef SERVER_ONLY
+
 #include "graphics/rtts.hpp"
 #include "central_settings.hpp"
 #include "config/user_config.hpp"
@@ -348,3 +350,5 @@ FrameBuffer* RTT::render(scene::ICameraSceneNode* camera, float dt)
     irr_driver->getSceneManager()->setActiveCamera(NULL);
     return frame_buffer;
 }
+
+#endif   // !SERVER_ONLY
@@ -18,6 +18,8 @@
 #ifndef HEADER_RTTS_HPP
 #define HEADER_RTTS_HPP
 
+#ifndef SERVER_ONLY
+
 #include "graphics/irr_driver.hpp"
 #include "utils/ptr_vector.hpp"
 #include "utils/leak_check.hpp"
@@ -70,5 +72,6 @@ private:
     LEAK_CHECK();
 };
 
+#endif   // !SERVER_ONLY
 #endif
 
@@ -16,6 +16,8 @@
 //  along with this program; if not, write to the Free Software
 //  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
+#ifndef SERVER_ONLY
+
 #include "graphics/shader.hpp"
 
 #include "graphics/central_settings.hpp"
@@ -362,3 +364,5 @@ GLuint ShaderBase::createVAO()
 }   // createVAO
 
 // ============================================================================
+
+#endif   // !SERVER_ONLY
@@ -18,6 +18,8 @@
 #ifndef HEADER_SHADER_HPP
 #define HEADER_SHADER_HPP
 
+#ifndef SERVER_ONLY
+
 #include "graphics/central_settings.hpp"
 #include "graphics/gl_headers.hpp"
 #include "graphics/shared_gpu_objects.hpp"
@@ -381,4 +383,5 @@ public:
 
 // ============================================================================
 
+#endif   // !SERVER_ONLY
 #endif
@@ -90,6 +90,8 @@
 
 */
 
+#ifndef SERVER_ONLY
+
 #include "graphics/shaders.hpp"
 
 #include "graphics/callbacks.hpp"
@@ -397,3 +399,5 @@ Shaders::ColoredLine::ColoredLine()
     glBindVertexArray(0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
 }   // Shaders::ColoredLine
+
+#endif   // !SERVER_ONLY
@@ -18,6 +18,8 @@
 #ifndef HEADER_SHADERS_HPP
 #define HEADER_SHADERS_HPP
 
+#ifndef SERVER_ONLY
+
 #include "graphics/shader.hpp"
 #include "graphics/shared_gpu_objects.hpp"
 #include "graphics/texture_shader.hpp"
@@ -163,4 +165,5 @@ public:
 
 };   // class Shaders
 
+#endif   // !SERVER_ONLY
 #endif
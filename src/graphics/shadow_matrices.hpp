@@ -19,6 +19,8 @@
 #ifndef HEADER_SHADOW_MATRICES_HPP
 #define HEADER_SHADOW_MATRICES_HPP
 
+#ifndef SERVER_ONLY
+
 #include "matrix4.h"
 #include "vector3d.h"
 
@@ -103,4 +105,5 @@ public:
 
 };   // class ShadowMatrices
 
+#endif   // !SERVER_ONLY
 #endif
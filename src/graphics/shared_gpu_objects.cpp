@@ -15,6 +15,8 @@
 //  along with this program; if not, write to the Free Software
 //  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
+#ifndef SERVER_ONLY
+
 #include "graphics/shared_gpu_objects.hpp"
 
 GLuint SharedGPUObjects::m_billboard_vbo;
@@ -205,4 +207,6 @@ void SharedGPUObjects::init()
 void SharedGPUObjects::reset()
 {
     m_has_been_initialised = false;
-}   // reset
\ No newline at end of file
+}   // reset
+
+#endif   // !SERVER_ONLY
@@ -18,6 +18,8 @@
 #ifndef HEADER_SHARED_GPU_OBJECTS_HPP
 #define HEADER_SHARED_GPU_OBJECTS_HPP
 
+#ifndef SERVER_ONLY
+
 #include "graphics/gl_headers.hpp"
 
 #include <assert.h>
@@ -119,4 +121,5 @@ public:
 };   // class SharedGPUObjecctS
 
 
+#endif   // !SERVER_ONLY
 #endif
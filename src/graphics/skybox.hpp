@@ -19,6 +19,8 @@
 #ifndef HEADER_SKYBOX_HPP
 #define HEADER_SKYBOX_HPP
 
+#ifndef SERVER_ONLY
+
 #include "graphics/gl_headers.hpp"
 #include <ICameraSceneNode.h>
 #include <ITexture.h>
@@ -52,4 +54,5 @@ public:
 
 };
 
+#endif   // !SERVER_ONLY
 #endif //HEADER_SKYBOX_HPP
@@ -15,11 +15,14 @@
 //  along with this program; if not, write to the Free Software
 //  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
+#ifndef SERVER_ONLY
+
 #include "graphics/glwrap.hpp"
 
 #include "config/user_config.hpp"
 #include "central_settings.hpp"
 #include "graphics/camera.hpp"
+#include "graphics/cpu_skinning.hpp"
 #include "graphics/irr_driver.hpp"
 #include "graphics/material_manager.hpp"
 #include "graphics/render_info.hpp"
@@ -28,6 +31,7 @@
 #include "tracks/track.hpp"
 #include "utils/profiler.hpp"
 #include "utils/cpp2011.hpp"
+#include "utils/worker_pool.hpp"
 
 #include <IMaterialRenderer.h>
 #include <ISceneManager.h>
@@ -35,6 +39,10 @@
 
 using namespace irr;
 
+unsigned int STKAnimatedMesh::m_last_skinning_serial = 0;
+std::map<std::pair<GLuint, size_t>, unsigned int>
+    STKAnimatedMesh::m_uploaded_vertices;
+
 STKAnimatedMesh::STKAnimatedMesh(irr::scene::IAnimatedMesh* mesh, irr::scene::ISceneNode* parent,
 irr::scene::ISceneManager* mgr, s32 id, const std::string& debug_name,
 const core::vector3df& position,
@@ -46,6 +54,10 @@ const core::vector3df& scale, RenderInfo* render_info, bool all_parts_colorized)
     isMaterialInitialized = false;
     m_mesh_render_info = render_info;
     m_all_parts_colorized = all_parts_colorized;
+    m_skinning = NULL;
+    m_culled = false;
+    m_skinning_serial = 0;
+    initSkinning();
 #ifdef DEBUG
     m_debug_name = debug_name;
 #endif
@@ -54,6 +66,37 @@ const core::vector3df& scale, RenderInfo* render_info, bool all_parts_colorized)
 STKAnimatedMesh::~STKAnimatedMesh()
 {
     cleanGLMeshes();
+    delete m_skinning;
+
+    std::map<std::pair<GLuint, size_t>, unsigned int>::iterator it =
+        m_uploaded_vertices.begin();
+    while (it != m_uploaded_vertices.end())
+    {
+        if (m_skinning_serial != 0 && it->second == m_skinning_serial)
+            it = m_uploaded_vertices.erase(it);
+        else
+            it++;
+    }
+}
+
+/** Skinned meshes with animations are skinned by CPUSkinning instead of
+ *  irrlicht, so that only visible nodes are skinned (in parallel), and only
+ *  when their joints moved. Hardware skinning makes irrlicht only animate
+ *  the joints (and keep the static pose in the mesh buffers), which also
+ *  keeps joint scene nodes working.
+ */
+void STKAnimatedMesh::initSkinning()
+{
+    delete m_skinning;
+    m_skinning = NULL;
+    m_skinned = false;
+    if (!Mesh || Mesh->getMeshType() != scene::EAMT_SKINNED)
+        return;
+    scene::ISkinnedMesh *mesh = static_cast<scene::ISkinnedMesh*>(Mesh);
+    if (mesh->isStatic())
+        return;
+    mesh->setHardwareSkinning(true);
+    m_skinning = new CPUSkinning(mesh);
 }
 
 void STKAnimatedMesh::cleanGLMeshes()
@@ -83,6 +126,7 @@ void STKAnimatedMesh::setMesh(scene::IAnimatedMesh* mesh)
     isMaterialInitialized = false;
     cleanGLMeshes();
     CAnimatedMeshSceneNode::setMesh(mesh);
+    initSkinning();
 }
 
 void STKAnimatedMesh::updateNoGL()
@@ -97,6 +141,16 @@ void STKAnimatedMesh::updateNoGL()
         return;
     }
 
+    m_culled = false;
+    if (m_skinning)
+    {
+        // The joints were just animated for the frame of this node
+        if (m_skinning->updatePalette(static_cast<scene::ISkinnedMesh*>(Mesh),
+                                      AnimationStrength))
+            m_skinned = false;
+        Box = m_skinning->getBoundingBox();
+    }
+
     if (!isMaterialInitialized)
     {
         video::IVideoDriver* driver = SceneManager->getVideoDriver();
@@ -189,10 +243,35 @@ void STKAnimatedMesh::updateNoGL()
     }
 }
 
-void STKAnimatedMesh::updateGL()
+/** Skins all visible nodes whose joints moved since they were skinned last,
+ *  in parallel. Must be called after updateNoGL() and before updateGL().
+ *  \param meshes All animated nodes of this frame.
+ */
+void STKAnimatedMesh::skinMeshes(const std::vector<STKAnimatedMesh*> &meshes)
 {
+    std::vector<STKAnimatedMesh*> skinned;
+    for (STKAnimatedMesh *mesh : meshes)
+    {
+        if (!mesh->m_skinning || mesh->m_skinned || mesh->m_culled)
+            continue;
+        mesh->m_skinning_serial = ++m_last_skinning_serial;
+        mesh->m_skinned = true;
+        skinned.push_back(mesh);
+    }
+    if (skinned.empty())
+        return;
 
-    scene::IMesh* m = getMeshForCurrentFrame();
+    WorkerPool::get()->parallelFor((int)skinned.size(), [&skinned](int i)
+    {
+        STKAnimatedMesh *mesh = skinned[i];
+        mesh->m_skinning->skin(static_cast<scene::ISkinnedMesh*>(mesh->Mesh));
+    });
+}
+
+void STKAnimatedMesh::updateGL()
+{
+    // Skinned meshes were animated in updateNoGL() already
+    scene::IMesh* m = m_skinning ? Mesh : getMeshForCurrentFrame();
 
     if (!isGLInitialized)
     {
@@ -235,6 +314,17 @@ void STKAnimatedMesh::updateGL()
         isGLInitialized = true;
     }
 
+    if (m_culled)
+        return;
+
+    if (m_skinning && !m_skinned)
+    {
+        // Not skinned by skinMeshes(), e.g. if the node is rendered directly
+        m_skinning_serial = ++m_last_skinning_serial;
+        m_skinning->skin(static_cast<scene::ISkinnedMesh*>(Mesh));
+        m_skinned = true;
+    }
+
     for (u32 i = 0; i<m->getMeshBufferCount(); ++i)
     {
         scene::IMeshBuffer* mb = m->getMeshBuffer(i);
@@ -243,6 +333,19 @@ void STKAnimatedMesh::updateGL()
         {
 
             size_t size = mb->getVertexCount() * GLmeshes[i].Stride, offset = GLmeshes[i].vaoBaseVertex * GLmeshes[i].Stride;
+            const void *vertices = mb->getVertices();
+            if (m_skinning)
+            {
+                GLuint vbo = CVS->isARBBaseInstanceUsable()
+                           ? VAOManager::getInstance()->getVBO(mb->getVertexType())
+                           : GLmeshes[i].vertex_buffer;
+                unsigned int &uploaded =
+                    m_uploaded_vertices[std::make_pair(vbo, offset)];
+                if (uploaded == m_skinning_serial)
+                    continue;
+                uploaded = m_skinning_serial;
+                vertices = m_skinning->getVertices(i);
+            }
             void *buf;
             if (CVS->supportsAsyncInstanceUpload())
             {
@@ -259,7 +362,7 @@ void STKAnimatedMesh::updateGL()
                 GLbitfield bitfield = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
                 buf = glMapBufferRange(GL_ARRAY_BUFFER, offset, size, bitfield);
             }
-            memcpy(buf, mb->getVertices(), size);
+            memcpy(buf, vertices, size);
             if (!CVS->supportsAsyncInstanceUpload())
             {
                 glUnmapBuffer(GL_ARRAY_BUFFER);
@@ -277,3 +380,5 @@ void STKAnimatedMesh::render()
     updateNoGL();
     updateGL();
 }
+
+#endif   // !SERVER_ONLY
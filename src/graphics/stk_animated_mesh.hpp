@@ -18,6 +18,8 @@
 #ifndef STKANIMATEDMESH_HPP
 #define STKANIMATEDMESH_HPP
 
+#ifndef SERVER_ONLY
+
 #include "graphics/stk_mesh.hpp"
 #include "utils/ptr_vector.hpp"
 
@@ -25,6 +27,10 @@
 #include <IAnimatedMesh.h>
 #include <irrTypes.h>
 
+#include <map>
+#include <utility>
+
+class CPUSkinning;
 class RenderInfo;
 
 class STKAnimatedMesh : public irr::scene::CAnimatedMeshSceneNode, public STKMeshCommon
@@ -39,6 +45,7 @@ protected:
 public:
     virtual void updateNoGL();
     virtual void updateGL();
+    static void skinMeshes(const std::vector<STKAnimatedMesh*> &meshes);
   STKAnimatedMesh(irr::scene::IAnimatedMesh* mesh, irr::scene::ISceneNode* parent,
      irr::scene::ISceneManager* mgr, irr::s32 id, const std::string& debug_name,
      const irr::core::vector3df& position = irr::core::vector3df(0,0,0),
@@ -50,9 +57,36 @@ public:
   virtual void render();
   virtual void setMesh(irr::scene::IAnimatedMesh* mesh);
   virtual bool glow() const { return false; }
+  // --------------------------------------------------------------------------
+  /** Called by the scene manager after updateNoGL() if the node is not
+   *  visible for any camera, so skinning and vertex upload are skipped. */
+  void setCulled(bool culled) { m_culled = culled; }
 private:
     RenderInfo* m_mesh_render_info;
     bool m_all_parts_colorized;
+
+    /** Skins the vertices of a skinned mesh on the CPU, NULL for other
+     *  meshes (which upload the vertices irrlicht computed). */
+    CPUSkinning *m_skinning;
+
+    /** True if the vertices of m_skinning match the current joints. */
+    bool m_skinned;
+
+    /** True if the node is not visible this frame. */
+    bool m_culled;
+
+    /** Identifies the vertices of the last skin() call of any node. */
+    unsigned int m_skinning_serial;
+    static unsigned int m_last_skinning_serial;
+
+    /** The serial of the vertices last uploaded to each vertex buffer
+     *  region (buffer and offset). Nodes sharing a mesh share the region if
+     *  base instance is usable, so a node can only skip the upload if its
+     *  own vertices are still in there. */
+    static std::map<std::pair<GLuint, size_t>, unsigned int> m_uploaded_vertices;
+
+    void initSkinning();
 };
 
+#endif   // !SERVER_ONLY
 #endif // STKANIMATEDMESH_HPP
@@ -18,6 +18,8 @@
 #ifndef STKBILLBOARD_HPP
 #define STKBILLBOARD_HPP
 
+#ifndef SERVER_ONLY
+
 #include "../lib/irrlicht/source/Irrlicht/CBillboardSceneNode.h"
 #include <IBillboardSceneNode.h>
 #include <irrTypes.h>
@@ -37,4 +39,5 @@ public:
     virtual void render() OVERRIDE;
 };   // STKBillboard
 
+#endif   // !SERVER_ONLY
 #endif
@@ -19,6 +19,8 @@
 #ifndef HEADER_STK_MESH_H
 #define HEADER_STK_MESH_H
 
+#ifndef SERVER_ONLY
+
 #include "graphics/irr_driver.hpp"
 #include "graphics/material.hpp"
 #include "utils/singleton.hpp"
@@ -262,4 +264,5 @@ void initTextures(GLMesh &mesh, Material::ShaderType);
 // ----------------------------------------------------------------------------
 void initTexturesTransparent(GLMesh &mesh);
 
+#endif   // !SERVER_ONLY
 #endif // STKMESH_H
@@ -18,6 +18,8 @@
 #ifndef HEADER_STK_MESH_SCENE_NODE
 #define HEADER_STK_MESH_SCENE_NODE
 
+#ifndef SERVER_ONLY
+
 #include "graphics/stk_mesh.hpp"
 
 #include "graphics/shaders.hpp"
@@ -80,4 +82,5 @@ public:
     video::SColor getGlowColor() const { return glowcolor; }
 };
 
+#endif   // !SERVER_ONLY
 #endif
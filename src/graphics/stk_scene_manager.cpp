@@ -15,6 +15,8 @@
 //  along with this program; if not, write to the Free Software
 //  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
+#ifndef SERVER_ONLY
+
 #include "graphics/stk_scene_manager.hpp"
 
 #include "graphics/callbacks.hpp"
@@ -210,6 +212,7 @@ static std::unordered_map <std::pair<scene::IMeshBuffer*, RenderInfo*>, std::vec
 static std::unordered_map <scene::IMeshBuffer *, std::vector<std::pair<GLMesh *, scene::ISceneNode*> > > MeshForShadowPass[Material::SHADERTYPE_COUNT][4], MeshForRSM[Material::SHADERTYPE_COUNT];
 static std::unordered_map <scene::IMeshBuffer *, std::vector<std::pair<GLMesh *, scene::ISceneNode*> > > MeshForGlowPass;
 static std::vector <STKMeshCommon *> DeferredUpdate;
+static std::vector <STKAnimatedMesh *> AnimatedMeshes;
 
 static core::vector3df windDir;
 
@@ -312,6 +315,22 @@ handleSTKCommon(scene::ISceneNode *Node, std::vector<scene::ISceneNode *> *Immed
     for (unsigned i = 0; i < 4; i++)
         culledforshadowcam[i] = culledforshadowcam[i] || isCulledPrecise(shadowcam[i], Node);
 
+    // Animated meshes which are not drawn in any pass are neither skinned
+    // nor uploaded
+    if (STKAnimatedMesh *animated = dynamic_cast<STKAnimatedMesh *>(Node))
+    {
+        bool culled = culledforcam;
+        if (CVS->isShadowEnabled())
+        {
+            for (unsigned i = 0; i < 4; i++)
+                culled = culled && culledforshadowcam[i];
+        }
+        if (UserConfigParams::m_gi && drawRSM)
+            culled = culled && culledforrsm;
+        animated->setCulled(culled);
+        AnimatedMeshes.push_back(animated);
+    }
+
     // Transparent
 
     if (World::getWorld() && World::getWorld()->isFogEnabled())
@@ -649,6 +668,7 @@ void IrrDriver::PrepareDrawCalls(scene::ICameraSceneNode *camnode)
     }
     MeshForGlowPass.clear();
     DeferredUpdate.clear();
+    AnimatedMeshes.clear();
     core::list<scene::ISceneNode*> List = m_scene_manager->getRootSceneNode()->getChildren();
 
 PROFILER_PUSH_CPU_MARKER("- culling", 0xFF, 0xFF, 0x0);
@@ -664,6 +684,12 @@ PROFILER_PUSH_CPU_MARKER("- culling", 0xFF, 0xFF, 0x0);
                       !getShadowMatrices()->isRSMMapAvail());
 PROFILER_POP_CPU_MARKER();
 
+    // Skinning only writes to memory of the nodes, so it can be done while
+    // the GPU finishes the previous frame
+    PROFILER_PUSH_CPU_MARKER("- Skinning", 0x0, 0xFF, 0xFF);
+    STKAnimatedMesh::skinMeshes(AnimatedMeshes);
+    PROFILER_POP_CPU_MARKER();
+
     // Add a 1 s timeout
     if (!m_sync)
         m_sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
@@ -922,3 +948,5 @@ PROFILER_POP_CPU_MARKER();
         glMemoryBarrier(GL_CLIENT_MAPPED_BUFFER_BARRIER_BIT);
 #endif
 }
+
+#endif   // !SERVER_ONLY
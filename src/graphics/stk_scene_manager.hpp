@@ -22,6 +22,8 @@
 #ifndef HEADER_STKSCENEMANAGER_HPP
 #define HEADER_STKSCENEMANAGER_HPP
 
+#ifndef SERVER_ONLY
+
 #include "graphics/central_settings.hpp"
 #include "graphics/gl_headers.hpp"
 #include "graphics/gpu_particles.hpp"
@@ -88,4 +90,5 @@ public:
 };
 
 
+#endif   // !SERVER_ONLY
 #endif
@@ -18,6 +18,8 @@
 #ifndef STK_TEXT_BILLBOARD_HPP
 #define STK_TEXT_BILLBOARD_HPP
 
+#ifndef SERVER_ONLY
+
 #include "graphics/stk_mesh_scene_node.hpp"
 #include "font/font_with_face.hpp"
 #include "utils/cpp2011.hpp"
@@ -89,4 +91,5 @@ public:
     virtual void updateAbsolutePosition() OVERRIDE;
 };
 
+#endif   // !SERVER_ONLY
 #endif
@@ -0,0 +1,668 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2016 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#include "graphics/texture_compressor.hpp"
+
+#include "config/user_config.hpp"
+#include "utils/hash.hpp"
+#include "utils/log.hpp"
+#include "utils/time.hpp"
+#include "utils/worker_pool.hpp"
+
+#include <algorithm>
+#include <assert.h>
+#include <cmath>
+#include <stdlib.h>
+#include <string.h>
+
+namespace
+{
+    /** Converts between sRGB and linear values, used to compute the mip
+     *  levels of sRGB textures in linear space. */
+    struct SRGBTable
+    {
+        float   m_to_linear[256];
+        uint8_t m_from_linear[4097];
+        SRGBTable()
+        {
+            for (unsigned int i = 0; i < 256; i++)
+            {
+                const float c = i / 255.0f;
+                m_to_linear[i] = c <= 0.04045f ? c / 12.92f
+                               : powf((c + 0.055f) / 1.055f, 2.4f);
+            }
+            for (unsigned int i = 0; i < 4097; i++)
+            {
+                const float l = i / 4096.0f;
+                const float c = l <= 0.0031308f ? l * 12.92f
+                              : 1.055f * powf(l, 1.0f / 2.4f) - 0.055f;
+                m_from_linear[i] = (uint8_t)std::min(255.0f,
+                                                     c * 255.0f + 0.5f);
+            }
+        }
+    };   // SRGBTable
+
+    // ------------------------------------------------------------------------
+    const SRGBTable& getSRGBTable()
+    {
+        static SRGBTable table;
+        return table;
+    }   // getSRGBTable
+
+    // ------------------------------------------------------------------------
+    /** Converts a colour to the 5:6:5 format of BC1 endpoints. */
+    uint16_t to565(int r, int g, int b)
+    {
+        return (uint16_t)((((r * 31 + 127) / 255) << 11) |
+                          (((g * 63 + 127) / 255) <<  5) |
+                           ((b * 31 + 127) / 255)        );
+    }   // to565
+
+    // ------------------------------------------------------------------------
+    /** Expands a 5:6:5 colour to 8 bits per channel (r, g, b). */
+    void from565(uint16_t c, int *rgb)
+    {
+        const int r = c >> 11, g = (c >> 5) & 63, b = c & 31;
+        rgb[0] = (r << 3) | (r >> 2);
+        rgb[1] = (g << 2) | (g >> 4);
+        rgb[2] = (b << 3) | (b >> 2);
+    }   // from565
+
+    // ------------------------------------------------------------------------
+    /** Computes the four colours a BC1 block with the given endpoints can
+     *  represent (in 4-colour mode). */
+    void getPalette(uint16_t c0, uint16_t c1, int palette[4][3])
+    {
+        from565(c0, palette[0]);
+        from565(c1, palette[1]);
+        for (unsigned int k = 0; k < 3; k++)
+        {
+            palette[2][k] = (2 * palette[0][k] + palette[1][k]) / 3;
+            palette[3][k] = (palette[0][k] + 2 * palette[1][k]) / 3;
+        }
+    }   // getPalette
+
+    // ------------------------------------------------------------------------
+    /** Selects the closest palette entry for each pixel.
+     *  \return The sum of the squared errors. */
+    int computeIndices(uint16_t c0, uint16_t c1, const int rgb[16][3],
+                       uint8_t indices[16])
+    {
+        int palette[4][3];
+        getPalette(c0, c1, palette);
+        int total = 0;
+        for (unsigned int i = 0; i < 16; i++)
+        {
+            int best = 0, best_error = 0x7fffffff;
+            for (int j = 0; j < 4; j++)
+            {
+                const int dr = rgb[i][0] - palette[j][0];
+                const int dg = rgb[i][1] - palette[j][1];
+                const int db = rgb[i][2] - palette[j][2];
+                const int error = dr * dr + dg * dg + db * db;
+                if (error < best_error)
+                {
+                    best_error = error;
+                    best = j;
+                }
+            }
+            indices[i] = (uint8_t)best;
+            total += best_error;
+        }
+        return total;
+    }   // computeIndices
+
+    // ------------------------------------------------------------------------
+    /** Computes the endpoints that minimise the squared error for the given
+     *  indices (least squares fit).
+     *  \return False if the endpoints can not be determined. */
+    bool refineEndpoints(const int rgb[16][3], const uint8_t indices[16],
+                         uint16_t *c0, uint16_t *c1)
+    {
+        // Weight of endpoint 0 for each index in 4-colour mode
+        static const float weight[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+        float aa = 0, bb = 0, ab = 0;
+        float ax[3] = { 0, 0, 0 }, bx[3] = { 0, 0, 0 };
+        for (unsigned int i = 0; i < 16; i++)
+        {
+            const float a = weight[indices[i]], b = 1.0f - a;
+            aa += a * a;
+            bb += b * b;
+            ab += a * b;
+            for (unsigned int k = 0; k < 3; k++)
+            {
+                ax[k] += a * rgb[i][k];
+                bx[k] += b * rgb[i][k];
+            }
+        }
+        const float det = aa * bb - ab * ab;
+        if (fabsf(det) < 1e-6f)
+            return false;
+        int e0[3], e1[3];
+        for (unsigned int k = 0; k < 3; k++)
+        {
+            const float v0 = (bb * ax[k] - ab * bx[k]) / det;
+            const float v1 = (aa * bx[k] - ab * ax[k]) / det;
+            e0[k] = std::min(255, std::max(0, (int)(v0 + 0.5f)));
+            e1[k] = std::min(255, std::max(0, (int)(v1 + 0.5f)));
+        }
+        *c0 = to565(e0[0], e0[1], e0[2]);
+        *c1 = to565(e1[0], e1[1], e1[2]);
+        return true;
+    }   // refineEndpoints
+
+    // ------------------------------------------------------------------------
+    /** Writes a BC1 colour block. The endpoints are ordered so that the
+     *  block uses the 4-colour mode. */
+    void writeColorBlock(uint16_t c0, uint16_t c1, uint8_t indices[16],
+                         uint8_t *out)
+    {
+        if (c0 < c1)
+        {
+            std::swap(c0, c1);
+            // Swapping the endpoints swaps 0 with 1 and 2 with 3
+            for (unsigned int i = 0; i < 16; i++)
+                indices[i] ^= 1;
+        }
+        else if (c0 == c1)
+        {
+            for (unsigned int i = 0; i < 16; i++)
+                indices[i] = 0;
+        }
+        out[0] = (uint8_t)(c0 & 0xff);
+        out[1] = (uint8_t)(c0 >> 8);
+        out[2] = (uint8_t)(c1 & 0xff);
+        out[3] = (uint8_t)(c1 >> 8);
+        uint32_t bits = 0;
+        for (unsigned int i = 0; i < 16; i++)
+            bits |= (uint32_t)indices[i] << (2 * i);
+        for (unsigned int i = 0; i < 4; i++)
+            out[4 + i] = (uint8_t)(bits >> (8 * i));
+    }   // writeColorBlock
+
+    // ------------------------------------------------------------------------
+    /** Encodes the colours of 16 pixels into a BC1 colour block. The
+     *  endpoints are the extreme colours along the principal axis of the
+     *  colours, followed by one least squares refinement. */
+    void encodeColorBlock(const uint8_t *pixels, uint8_t *out)
+    {
+        int rgb[16][3];
+        int min_c[3] = { 255, 255, 255 }, max_c[3] = { 0, 0, 0 };
+        float mean[3] = { 0, 0, 0 };
+        for (unsigned int i = 0; i < 16; i++)
+        {
+            rgb[i][0] = pixels[4 * i + 2];
+            rgb[i][1] = pixels[4 * i + 1];
+            rgb[i][2] = pixels[4 * i    ];
+            for (unsigned int k = 0; k < 3; k++)
+            {
+                min_c[k] = std::min(min_c[k], rgb[i][k]);
+                max_c[k] = std::max(max_c[k], rgb[i][k]);
+                mean[k] += rgb[i][k];
+            }
+        }
+        for (unsigned int k = 0; k < 3; k++)
+            mean[k] /= 16.0f;
+
+        uint8_t indices[16];
+        if (min_c[0] == max_c[0] && min_c[1] == max_c[1] &&
+            min_c[2] == max_c[2])
+        {
+            const uint16_t c = to565(min_c[0], min_c[1], min_c[2]);
+            writeColorBlock(c, c, indices, out);
+            return;
+        }
+
+        // Covariance matrix: xx, xy, xz, yy, yz, zz
+        float cov[6] = { 0, 0, 0, 0, 0, 0 };
+        for (unsigned int i = 0; i < 16; i++)
+        {
+            const float r = rgb[i][0] - mean[0];
+            const float g = rgb[i][1] - mean[1];
+            const float b = rgb[i][2] - mean[2];
+            cov[0] += r * r; cov[1] += r * g; cov[2] += r * b;
+            cov[3] += g * g; cov[4] += g * b; cov[5] += b * b;
+        }
+
+        // Power iteration, starting with the diagonal of the bounding box
+        float axis[3] = { float(max_c[0] - min_c[0]),
+                          float(max_c[1] - min_c[1]),
+                          float(max_c[2] - min_c[2]) };
+        for (unsigned int iter = 0; iter < 4; iter++)
+        {
+            const float x = cov[0] * axis[0] + cov[1] * axis[1]
+                          + cov[2] * axis[2];
+            const float y = cov[1] * axis[0] + cov[3] * axis[1]
+                          + cov[4] * axis[2];
+            const float z = cov[2] * axis[0] + cov[4] * axis[1]
+                          + cov[5] * axis[2];
+            const float length = std::max(fabsf(x),
+                                          std::max(fabsf(y), fabsf(z)));
+            if (length < 1e-6f)
+                break;
+            axis[0] = x / length;
+            axis[1] = y / length;
+            axis[2] = z / length;
+        }
+
+        int min_i = 0, max_i = 0;
+        float min_d = 1e30f, max_d = -1e30f;
+        for (unsigned int i = 0; i < 16; i++)
+        {
+            const float d = rgb[i][0] * axis[0] + rgb[i][1] * axis[1]
+                          + rgb[i][2] * axis[2];
+            if (d < min_d) { min_d = d; min_i = i; }
+            if (d > max_d) { max_d = d; max_i = i; }
+        }
+
+        uint16_t c0 = to565(rgb[max_i][0], rgb[max_i][1], rgb[max_i][2]);
+        uint16_t c1 = to565(rgb[min_i][0], rgb[min_i][1], rgb[min_i][2]);
+        int error = computeIndices(c0, c1, rgb, indices);
+
+        uint16_t r0, r1;
+        if (error > 0 && refineEndpoints(rgb, indices, &r0, &r1))
+        {
+            uint8_t refined[16];
+            const int refined_error = computeIndices(r0, r1, rgb, refined);
+            if (refined_error < error)
+            {
+                c0 = r0;
+                c1 = r1;
+                memcpy(indices, refined, 16);
+            }
+        }
+        writeColorBlock(c0, c1, indices, out);
+    }   // encodeColorBlock
+
+    // ------------------------------------------------------------------------
+    /** Encodes the alpha values of 16 pixels into a BC3 alpha block, using
+     *  the mode with 6 interpolated values between minimum and maximum. */
+    void encodeAlphaBlock(const uint8_t *pixels, uint8_t *out)
+    {
+        int a_min = 255, a_max = 0;
+        for (unsigned int i = 0; i < 16; i++)
+        {
+            a_min = std::min(a_min, (int)pixels[4 * i + 3]);
+            a_max = std::max(a_max, (int)pixels[4 * i + 3]);
+        }
+        out[0] = (uint8_t)a_max;
+        out[1] = (uint8_t)a_min;
+
+        uint64_t bits = 0;
+        if (a_max > a_min)
+        {
+            int values[8];
+            values[0] = a_max;
+            values[1] = a_min;
+            for (int i = 1; i < 7; i++)
+                values[i + 1] = ((7 - i) * a_max + i * a_min) / 7;
+            for (unsigned int i = 0; i < 16; i++)
+            {
+                const int a = pixels[4 * i + 3];
+                int best = 0, best_error = 256;
+                for (int j = 0; j < 8; j++)
+                {
+                    const int error = abs(a - values[j]);
+                    if (error < best_error)
+                    {
+                        best_error = error;
+                        best = j;
+                    }
+                }
+                bits |= (uint64_t)best << (3 * i);
+            }
+        }
+        for (unsigned int i = 0; i < 6; i++)
+            out[2 + i] = (uint8_t)(bits >> (8 * i));
+    }   // encodeAlphaBlock
+
+    // ------------------------------------------------------------------------
+    /** Computes the next smaller mip level with a 2x2 box filter. For sRGB
+     *  textures the colour channels are averaged in linear space.
+     *  \param rows Number of rows of the new level to compute (used to split
+     *         the work between threads).
+     */
+    void downsampleRow(const uint8_t *src, unsigned int src_width,
+                       unsigned int src_height, uint8_t *dst,
+                       unsigned int dst_width, unsigned int y, bool srgb)
+    {
+        const SRGBTable &table = getSRGBTable();
+        const unsigned int y0 = std::min(2 * y,     src_height - 1);
+        const unsigned int y1 = std::min(2 * y + 1, src_height - 1);
+        for (unsigned int x = 0; x < dst_width; x++)
+        {
+            const unsigned int x0 = std::min(2 * x,     src_width - 1);
+            const unsigned int x1 = std::min(2 * x + 1, src_width - 1);
+            const uint8_t *p[4] = { src + 4 * (y0 * src_width + x0),
+                                    src + 4 * (y0 * src_width + x1),
+                                    src + 4 * (y1 * src_width + x0),
+                                    src + 4 * (y1 * src_width + x1) };
+            uint8_t *out = dst + 4 * (y * dst_width + x);
+            for (unsigned int k = 0; k < 4; k++)
+            {
+                if (srgb && k < 3)
+                {
+                    const float l = (table.m_to_linear[p[0][k]] +
+                                     table.m_to_linear[p[1][k]] +
+                                     table.m_to_linear[p[2][k]] +
+                                     table.m_to_linear[p[3][k]]) * 0.25f;
+                    out[k] = table.m_from_linear[(int)(l * 4096.0f + 0.5f)];
+                }
+                else
+                {
+                    out[k] = (uint8_t)((p[0][k] + p[1][k] + p[2][k] +
+                                        p[3][k] + 2) / 4);
+                }
+            }
+        }
+    }   // downsampleRow
+}   // namespace
+
+// ----------------------------------------------------------------------------
+/** Encodes a 4x4 block of pixels (stored row by row) into a BC1 block of
+ *  8 bytes. The alpha channel is ignored.
+ */
+void TextureCompressor::encodeBC1Block(const uint8_t *pixels, uint8_t *out)
+{
+    encodeColorBlock(pixels, out);
+}   // encodeBC1Block
+
+// ----------------------------------------------------------------------------
+/** Encodes a 4x4 block of pixels (stored row by row) into a BC3 block of
+ *  16 bytes.
+ */
+void TextureCompressor::encodeBC3Block(const uint8_t *pixels, uint8_t *out)
+{
+    encodeAlphaBlock(pixels, out);
+    encodeColorBlock(pixels, out + 8);
+}   // encodeBC3Block
+
+// ----------------------------------------------------------------------------
+/** Returns true if all pixels have an alpha value of 255, in which case
+ *  BC1 can be used instead of BC3.
+ */
+bool TextureCompressor::isOpaque(const uint8_t *pixels, unsigned int count)
+{
+    for (unsigned int i = 0; i < count; i++)
+    {
+        if (pixels[4 * i + 3] != 255)
+            return false;
+    }
+    return true;
+}   // isOpaque
+
+// ----------------------------------------------------------------------------
+/** Computes a hash of the pixels of a texture, used to detect outdated
+ *  entries in the texture cache.
+ *  \param flags Any options that affect the compressed data.
+ */
+uint64_t TextureCompressor::hashPixels(const uint8_t *pixels,
+                                       unsigned int width,
+                                       unsigned int height, uint32_t flags)
+{
+    uint64_t hash = Hash::mixWords(Hash::FNV_OFFSET, pixels,
+                                   (size_t)width * height * 4);
+    hash = Hash::mix(hash, width);
+    hash = Hash::mix(hash, height);
+    hash = Hash::mix(hash, flags);
+    return hash;
+}   // hashPixels
+
+// ----------------------------------------------------------------------------
+/** Compresses a texture and all its mip levels (down to 1x1). The blocks
+ *  of each level are encoded in parallel by the worker pool, so this must
+ *  be called from the main thread.
+ *  \param pixels The pixels of the texture.
+ *  \param width Width of the texture.
+ *  \param height Height of the texture.
+ *  \param bc3 True to use BC3 (with alpha), false for BC1.
+ *  \param srgb True if the colours are in sRGB space, which is taken into
+ *         account when computing the mip levels.
+ *  \param levels Receives the compressed levels, starting with the
+ *         largest.
+ */
+void TextureCompressor::compress(const uint8_t *pixels, unsigned int width,
+                                 unsigned int height, bool bc3, bool srgb,
+                                 std::vector<Level> *levels)
+{
+    levels->clear();
+    const unsigned int block_size = bc3 ? 16 : 8;
+    std::vector<uint8_t> current(pixels, pixels + (size_t)width * height * 4);
+    std::vector<uint8_t> next;
+    while (true)
+    {
+        levels->push_back(Level());
+        Level &level = levels->back();
+        level.m_width  = width;
+        level.m_height = height;
+        const unsigned int blocks_x = (width  + 3) / 4;
+        const unsigned int blocks_y = (height + 3) / 4;
+        level.m_data.resize(blocks_x * blocks_y * block_size);
+
+        const uint8_t *src = current.data();
+        uint8_t *dst = level.m_data.data();
+        WorkerPool::get()->parallelFor((int)blocks_y,
+            [=](int by)
+            {
+                uint8_t block[64];
+                for (unsigned int bx = 0; bx < blocks_x; bx++)
+                {
+                    // Pixels outside of the texture (for sizes that are not
+                    // a multiple of 4) repeat the last row or column.
+                    for (unsigned int y = 0; y < 4; y++)
+                    {
+                        const unsigned int sy = std::min(by * 4 + y,
+                                                         height - 1);
+                        for (unsigned int x = 0; x < 4; x++)
+                        {
+                            const unsigned int sx = std::min(bx * 4 + x,
+                                                             width - 1);
+                            memcpy(block + 4 * (4 * y + x),
+                                   src + 4 * (sy * width + sx), 4);
+                        }
+                    }
+                    uint8_t *out = dst + (by * blocks_x + bx) * block_size;
+                    if (bc3)
+                        encodeBC3Block(block, out);
+                    else
+                        encodeBC1Block(block, out);
+                }
+            });
+
+        if (width == 1 && height == 1)
+            break;
+
+        const unsigned int next_width  = std::max(1u, width  / 2);
+        const unsigned int next_height = std::max(1u, height / 2);
+        next.resize((size_t)next_width * next_height * 4);
+        uint8_t *next_data = next.data();
+        WorkerPool::get()->parallelFor((int)next_height,
+            [=](int y)
+            {
+                downsampleRow(src, width, height, next_data, next_width, y,
+                              srgb);
+            });
+        current.swap(next);
+        width  = next_width;
+        height = next_height;
+    }
+}   // compress
+
+// ============================================================================
+namespace
+{
+    /** Decodes a BC1 colour block into 16 pixels, for testing. */
+    void decodeColorBlock(const uint8_t *block, uint8_t *pixels)
+    {
+        const uint16_t c0 = (uint16_t)(block[0] | (block[1] << 8));
+        const uint16_t c1 = (uint16_t)(block[2] | (block[3] << 8));
+        int palette[4][3];
+        getPalette(c0, c1, palette);
+        for (unsigned int i = 0; i < 16; i++)
+        {
+            const int index = (block[4 + i / 4] >> (2 * (i % 4))) & 3;
+            pixels[4 * i + 2] = (uint8_t)palette[index][0];
+            pixels[4 * i + 1] = (uint8_t)palette[index][1];
+            pixels[4 * i    ] = (uint8_t)palette[index][2];
+            pixels[4 * i + 3] = 255;
+        }
+    }   // decodeColorBlock
+
+    // ------------------------------------------------------------------------
+    /** Decodes a BC3 alpha block into the alpha channel of 16 pixels. */
+    void decodeAlphaBlock(const uint8_t *block, uint8_t *pixels)
+    {
+        const int a0 = block[0], a1 = block[1];
+        uint64_t bits = 0;
+        for (unsigned int i = 0; i < 6; i++)
+            bits |= (uint64_t)block[2 + i] << (8 * i);
+        for (unsigned int i = 0; i < 16; i++)
+        {
+            const int index = (int)((bits >> (3 * i)) & 7);
+            int a;
+            if (index == 0)      a = a0;
+            else if (index == 1) a = a1;
+            else if (a0 > a1)    a = ((8 - index) * a0 + (index - 1) * a1) / 7;
+            else if (index < 6)  a = ((6 - index) * a0 + (index - 1) * a1) / 5;
+            else                 a = index == 6 ? 0 : 255;
+            pixels[4 * i + 3] = (uint8_t)a;
+        }
+    }   // decodeAlphaBlock
+
+    // ------------------------------------------------------------------------
+    /** Returns the largest difference of any channel between the pixels of
+     *  an image and its compressed first level. */
+    int getMaxError(const std::vector<uint8_t> &image, unsigned int width,
+                    unsigned int height, bool bc3,
+                    const TextureCompressor::Level &level)
+    {
+        const unsigned int block_size = bc3 ? 16 : 8;
+        const unsigned int blocks_x = (width + 3) / 4;
+        int max_error = 0;
+        for (unsigned int by = 0; by < (height + 3) / 4; by++)
+        {
+            for (unsigned int bx = 0; bx < blocks_x; bx++)
+            {
+                const uint8_t *block =
+                    level.m_data.data() + (by * blocks_x + bx) * block_size;
+                uint8_t decoded[64];
+                if (bc3)
+                {
+                    decodeColorBlock(block + 8, decoded);
+                    decodeAlphaBlock(block, decoded);
+                }
+                else
+                    decodeColorBlock(block, decoded);
+                for (unsigned int i = 0; i < 16; i++)
+                {
+                    const unsigned int x = bx * 4 + i % 4;
+                    const unsigned int y = by * 4 + i / 4;
+                    if (x >= width || y >= height) continue;
+                    for (unsigned int k = 0; k < (bc3 ? 4u : 3u); k++)
+                    {
+                        const int d = abs((int)decoded[4 * i + k] -
+                                          image[4 * (y * width + x) + k]);
+                        max_error = std::max(max_error, d);
+                    }
+                }
+            }
+        }
+        return max_error;
+    }   // getMaxError
+}   // namespace
+
+// ----------------------------------------------------------------------------
+/** Tests the encoder by decoding the result, and checks the structure of the
+ *  created mip chains. Does not need an OpenGL context.
+ */
+void TextureCompressor::unitTesting()
+{
+    // A block of one colour that is exactly representable in 5:6:5
+    uint8_t solid[64];
+    for (unsigned int i = 0; i < 16; i++)
+    {
+        solid[4 * i] = 0; solid[4 * i + 1] = 255;
+        solid[4 * i + 2] = 255; solid[4 * i + 3] = 255;
+    }
+    uint8_t block[16], decoded[64];
+    encodeBC1Block(solid, block);
+    decodeColorBlock(block, decoded);
+    assert(memcmp(solid, decoded, 64) == 0);
+    encodeBC3Block(solid, block);
+    decodeColorBlock(block + 8, decoded);
+    decodeAlphaBlock(block, decoded);
+    assert(memcmp(solid, decoded, 64) == 0);
+
+    // Smooth gradients, with a size that is not a multiple of 4
+    const unsigned int width = 70, height = 30;
+    std::vector<uint8_t> image(width * height * 4);
+    for (unsigned int y = 0; y < height; y++)
+    {
+        for (unsigned int x = 0; x < width; x++)
+        {
+            uint8_t *p = &image[4 * (y * width + x)];
+            p[0] = (uint8_t)(x * 255 / (width - 1));
+            p[1] = (uint8_t)(y * 255 / (height - 1));
+            p[2] = (uint8_t)(255 - x * 255 / (width - 1));
+            p[3] = (uint8_t)((x + y) * 255 / (width + height - 2));
+        }
+    }
+    assert(!isOpaque(image.data(), width * height));
+
+    for (unsigned int bc3 = 0; bc3 < 2; bc3++)
+    {
+        std::vector<Level> levels, levels2;
+        double start = StkTime::getRealTime();
+        compress(image.data(), width, height, bc3 == 1, /*srgb*/true, &levels);
+        double end = StkTime::getRealTime();
+
+        // 70x30, 35x15, 17x7, 8x3, 4x1, 2x1, 1x1
+        assert(levels.size() == 7);
+        assert(levels.back().m_width == 1 && levels.back().m_height == 1);
+        for (unsigned int i = 0; i < levels.size(); i++)
+        {
+            const Level &l = levels[i];
+            assert(l.m_data.size() ==
+                   ((l.m_width + 3) / 4) * ((l.m_height + 3) / 4) *
+                   (bc3 ? 16u : 8u));
+        }
+        const int max_error = getMaxError(image, width, height, bc3 == 1,
+                                          levels[0]);
+        assert(max_error <= 12);
+
+        // The result must not depend on the number of threads, so compress
+        // again with a pool with a different number of worker threads
+        const int num_threads = UserConfigParams::m_worker_threads;
+        const bool has_workers = WorkerPool::get()->getNumThreads() > 0;
+        WorkerPool::destroy();
+        UserConfigParams::m_worker_threads = has_workers ? 0 : 3;
+        WorkerPool::create();
+        compress(image.data(), width, height, bc3 == 1, true, &levels2);
+        WorkerPool::destroy();
+        UserConfigParams::m_worker_threads = num_threads;
+        WorkerPool::create();
+        for (unsigned int i = 0; i < levels.size(); i++)
+            assert(levels[i].m_data == levels2[i].m_data);
+
+        Log::info("TextureCompressor", "%s: max error %d, %f ms.",
+                  bc3 ? "BC3" : "BC1", max_error, (end - start) * 1000.0);
+    }
+
+    assert(hashPixels(image.data(), width, height, 0) !=
+           hashPixels(image.data(), width, height, 1));
+}   // unitTesting
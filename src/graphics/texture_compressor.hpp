@@ -0,0 +1,57 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2016 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#ifndef HEADER_TEXTURE_COMPRESSOR_HPP
+#define HEADER_TEXTURE_COMPRESSOR_HPP
+
+#include "utils/types.hpp"
+
+#include <vector>
+
+/** A CPU encoder for the BC1 (DXT1) and BC3 (DXT5) block compression
+ *  formats, which creates the complete mip chain of a texture. Unlike
+ *  compression by the graphics driver, the result is the same on all
+ *  systems, and all mip levels can be stored in the texture cache. The
+ *  blocks are encoded in parallel by the worker pool. Nothing here needs
+ *  an OpenGL context.
+ *  All pixels use the byte order blue, green, red, alpha (see
+ *  \ref ImageKernels).
+ *  \ingroup graphics
+ */
+namespace TextureCompressor
+{
+    /** One compressed mip level. */
+    struct Level
+    {
+        unsigned int         m_width;
+        unsigned int         m_height;
+        std::vector<uint8_t> m_data;
+    };   // Level
+
+    void     encodeBC1Block(const uint8_t *pixels, uint8_t *out);
+    void     encodeBC3Block(const uint8_t *pixels, uint8_t *out);
+    bool     isOpaque(const uint8_t *pixels, unsigned int count);
+    uint64_t hashPixels(const uint8_t *pixels, unsigned int width,
+                        unsigned int height, uint32_t flags);
+    void     compress(const uint8_t *pixels, unsigned int width,
+                      unsigned int height, bool bc3, bool srgb,
+                      std::vector<Level> *levels);
+    void     unitTesting();
+}   // namespace TextureCompressor
+
+#endif
@@ -18,20 +18,26 @@
 #include "graphics/texture_manager.hpp"
 
 #include "graphics/central_settings.hpp"
+#include "graphics/image_kernels.hpp"
 #include "graphics/irr_driver.hpp"
+#include "graphics/texture_compressor.hpp"
+#include "io/file_manager.hpp"
 
+#ifndef SERVER_ONLY
 #if defined(USE_GLES2)
 #define _IRR_COMPILE_WITH_OGLES2_
 #include "../../lib/irrlicht/source/Irrlicht/COGLES2Texture.h"
 #else
 #include "../../lib/irrlicht/source/Irrlicht/COpenGLTexture.h"
 #endif
+#endif   // !SERVER_ONLY
 
 
 #include <fstream>
 #include <sstream>
 
 
+#ifndef SERVER_ONLY
 GLuint getTextureGLuint(irr::video::ITexture *tex)
 {
     if (tex == NULL)
@@ -52,6 +58,7 @@ GLuint getDepthTexture(irr::video::ITexture *tex)
     return static_cast<irr::video::COpenGLFBOTexture*>(tex)->DepthBufferTexture;
 #endif
 }
+#endif   // !SERVER_ONLY
 
 static std::set<irr::video::ITexture *> AlreadyTransformedTexture;
 static std::map<int, video::ITexture*> unicolor_cache;
@@ -70,6 +77,80 @@ void cleanUnicolorTextures()
     unicolor_cache.clear();
 }
 
+#ifndef SERVER_ONLY
+#if !defined(USE_GLES2)
+/** Identifies files of the texture cache, followed by the format version.
+ *  Files in an older format are ignored and regenerated. */
+static const char GLTZ_MAGIC[8] = { 'S', 'T', 'K', 'G', 'L', 'T', 'Z', 0 };
+static const uint32_t GLTZ_VERSION = 2;
+
+//-----------------------------------------------------------------------------
+/** Uploads all mip levels of a compressed texture to the bound texture. */
+static void uploadCompressedLevels(GLint internal_format,
+                         const std::vector<TextureCompressor::Level> &levels)
+{
+    for (unsigned int i = 0; i < levels.size(); i++)
+    {
+        const TextureCompressor::Level &level = levels[i];
+        glCompressedTexImage2D(GL_TEXTURE_2D, i, internal_format,
+                               level.m_width, level.m_height, 0,
+                               (GLsizei)level.m_data.size(),
+                               (GLvoid*)level.m_data.data());
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL,
+                    (GLint)levels.size() - 1);
+}   // uploadCompressedLevels
+
+//-----------------------------------------------------------------------------
+/** Compresses a texture (in ECF_A8R8G8B8 format) with the CPU encoder and
+ *  uploads all its mip levels. The result is taken from the texture cache
+ *  if the cache contains it for the same pixels and settings, otherwise it
+ *  is added to the cache.
+ */
+static void compressTextureOnCPU(irr::video::ITexture *tex,
+                                 const uint8_t *pixels, bool srgb,
+                                 bool premul_alpha)
+{
+    const unsigned int w = tex->getSize().Width, h = tex->getSize().Height;
+    const uint64_t hash =
+        TextureCompressor::hashPixels(pixels, w, h, (srgb ? 1 : 0) |
+                                                    (premul_alpha ? 2 : 0));
+    std::string cached_file;
+    std::string tex_name = irr_driver->getTextureName(tex);
+    if (!tex_name.empty())
+    {
+        cached_file = file_manager->getTextureCacheLocation(tex_name)
+                    + ".gltz";
+        if (!file_manager->fileIsNewer(tex_name, cached_file) &&
+            loadCompressedTexture(cached_file, hash))
+            return;
+    }
+
+    std::vector<uint8_t> data(pixels, pixels + w * h * 4);
+    if (premul_alpha)
+        ImageKernels::premultiplyGammaAlpha(data.data(), w * h);
+
+    // Use the smaller BC1 format if the alpha channel is not needed
+    const bool bc3 = tex->hasAlpha() &&
+                     !TextureCompressor::isOpaque(data.data(), w * h);
+    GLint internal_format;
+    if (srgb)
+        internal_format = bc3 ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT
+                              : GL_COMPRESSED_SRGB_S3TC_DXT1_EXT;
+    else
+        internal_format = bc3 ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+                              : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+
+    std::vector<TextureCompressor::Level> levels;
+    TextureCompressor::compress(data.data(), w, h, bc3, srgb, &levels);
+    uploadCompressedLevels(internal_format, levels);
+
+    if (!cached_file.empty())
+        saveCompressedTexture(cached_file, hash, internal_format, levels);
+}   // compressTextureOnCPU
+#endif
+
+//-----------------------------------------------------------------------------
 void compressTexture(irr::video::ITexture *tex, bool srgb, bool premul_alpha)
 {
     if (AlreadyTransformedTexture.find(tex) != AlreadyTransformedTexture.end())
@@ -78,23 +159,21 @@ void compressTexture(irr::video::ITexture *tex, bool srgb, bool premul_alpha)
 
     glBindTexture(GL_TEXTURE_2D, getTextureGLuint(tex));
 
-    std::string cached_file;
-    if (CVS->isTextureCompressionEnabled())
+    size_t w = tex->getSize().Width, h = tex->getSize().Height;
+    const uint8_t *pixels = (const uint8_t*)tex->lock(video::ETLM_READ_ONLY);
+
+#if !defined(USE_GLES2)
+    if (CVS->isTextureCompressionEnabled() &&
+        tex->getColorFormat() == video::ECF_A8R8G8B8)
     {
-        // Try to retrieve the compressed texture in cache
-        std::string tex_name = irr_driver->getTextureName(tex);
-        if (!tex_name.empty()) {
-            cached_file = file_manager->getTextureCacheLocation(tex_name) + ".gltz";
-            if (!file_manager->fileIsNewer(tex_name, cached_file)) {
-                if (loadCompressedTexture(cached_file))
-                    return;
-            }
-        }
+        compressTextureOnCPU(tex, pixels, srgb, premul_alpha);
+        tex->unlock();
+        return;
     }
+#endif
 
-    size_t w = tex->getSize().Width, h = tex->getSize().Height;
     unsigned char *data = new unsigned char[w * h * 4];
-    memcpy(data, tex->lock(), w * h * 4);
+    memcpy(data, pixels, w * h * 4);
     tex->unlock();
     unsigned internalFormat, Format;
     Format = tex->hasAlpha() ? GL_BGRA : GL_BGR;
@@ -102,28 +181,12 @@ void compressTexture(irr::video::ITexture *tex, bool srgb, bool premul_alpha)
     if (!CVS->isEXTTextureFormatBGRA8888Usable())
     {
         Format = tex->hasAlpha() ? GL_RGBA : GL_RGB;
-        
-        for (unsigned int i = 0; i < w * h; i++)
-        {
-            char tmp_val = data[i*4];
-            data[i*4] = data[i*4 + 2];
-            data[i*4 + 2] = tmp_val;
-        }
+        ImageKernels::swapRedBlue(data, (unsigned int)(w * h));
     }
 #endif
 
     if (premul_alpha)
-    {
-        for (unsigned i = 0; i < w * h; i++)
-        {
-            float alpha = data[4 * i + 3];
-            if (alpha > 0.)
-                alpha = pow(alpha / 255.f, 1.f / 2.2f);
-            data[4 * i] = (unsigned char)(data[4 * i] * alpha);
-            data[4 * i + 1] = (unsigned char)(data[4 * i + 1] * alpha);
-            data[4 * i + 2] = (unsigned char)(data[4 * i + 2] * alpha);
-        }
-    }
+        ImageKernels::premultiplyGammaAlpha(data, (unsigned int)(w * h));
 
 #if !defined(USE_GLES2)
     if (!CVS->isTextureCompressionEnabled())
@@ -135,6 +198,7 @@ void compressTexture(irr::video::ITexture *tex, bool srgb, bool premul_alpha)
     }
     else
     {
+        // Other colour formats are still compressed by the driver
         if (srgb)
             internalFormat = (tex->hasAlpha()) ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT : GL_COMPRESSED_SRGB_S3TC_DXT1_EXT;
         else
@@ -146,90 +210,101 @@ void compressTexture(irr::video::ITexture *tex, bool srgb, bool premul_alpha)
     glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, w, h, 0, Format, GL_UNSIGNED_BYTE, (GLvoid *)data);
     glGenerateMipmap(GL_TEXTURE_2D);
     delete[] data;
-
-    if (CVS->isTextureCompressionEnabled() && !cached_file.empty())
-    {
-        // Save the compressed texture in the cache for later use.
-        saveCompressedTexture(cached_file);
-    }
 }
 
 //-----------------------------------------------------------------------------
-/** Try to load a compressed texture from the given file name.
-*   Data in the specified file need to have a specific format. See the
+/** Try to load a compressed texture with all its mip levels from the given
+*   file name, and upload it to the bound texture. See the
 *   saveCompressedTexture() function for a description of the format.
+*   \param hash Hash of the uncompressed pixels and settings, which must
+*          match the hash stored in the file.
 *   \return true if the loading succeeded, false otherwise.
 *   \see saveCompressedTexture
 */
-bool loadCompressedTexture(const std::string& compressed_tex)
+bool loadCompressedTexture(const std::string& compressed_tex, uint64_t hash)
 {
+#if !defined(USE_GLES2)
     std::ifstream ifs(compressed_tex.c_str(), std::ios::in | std::ios::binary);
     if (!ifs.is_open())
         return false;
 
-    int internal_format;
-    int w, h;
-    int size = -1;
-    ifs.read((char*)&internal_format, sizeof(int));
-    ifs.read((char*)&w, sizeof(int));
-    ifs.read((char*)&h, sizeof(int));
-    ifs.read((char*)&size, sizeof(int));
-
-    if (ifs.fail() || size == -1)
+    char magic[8];
+    uint32_t version = 0, num_levels = 0;
+    uint64_t file_hash = 0;
+    int32_t internal_format = 0;
+    ifs.read(magic, sizeof(magic));
+    ifs.read((char*)&version, sizeof(version));
+    ifs.read((char*)&file_hash, sizeof(file_hash));
+    ifs.read((char*)&internal_format, sizeof(internal_format));
+    ifs.read((char*)&num_levels, sizeof(num_levels));
+    if (ifs.fail() || memcmp(magic, GLTZ_MAGIC, sizeof(magic)) != 0 ||
+        version != GLTZ_VERSION || file_hash != hash ||
+        num_levels == 0 || num_levels > 32)
         return false;
 
-    char *data = new char[size];
-    ifs.read(data, size);
-    if (!ifs.fail())
+    // Read all levels first, so that nothing is uploaded from a broken file
+    std::vector<TextureCompressor::Level> levels(num_levels);
+    for (unsigned int i = 0; i < num_levels; i++)
     {
-        glCompressedTexImage2D(GL_TEXTURE_2D, 0, internal_format,
-            w, h, 0, size, (GLvoid*)data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-        delete[] data;
-        ifs.close();
-        return true;
+        TextureCompressor::Level &level = levels[i];
+        uint32_t size = 0;
+        ifs.read((char*)&level.m_width, sizeof(uint32_t));
+        ifs.read((char*)&level.m_height, sizeof(uint32_t));
+        ifs.read((char*)&size, sizeof(size));
+        if (ifs.fail() || size > 64 * 1024 * 1024)
+            return false;
+        level.m_data.resize(size);
+        ifs.read((char*)level.m_data.data(), size);
+        if (ifs.fail())
+            return false;
     }
-    delete[] data;
+    uploadCompressedLevels(internal_format, levels);
+    return true;
+#else
     return false;
+#endif
 }
 
 //-----------------------------------------------------------------------------
-/** Try to save the last texture sent to glTexImage2D in a file of the given
-*   file name. This function should only be used for textures sent to
-*   glTexImage2D with a compressed internal format as argument.<br>
+/** Saves a texture compressed by the CPU encoder with all its mip levels in
+*   a file of the given file name.<br>
 *   \note The following format is used to save the compressed texture:<br>
-*         <internal-format><width><height><size><data> <br>
-*         The first four elements are integers and the last one is stored
+*         <magic><version><hash><internal-format><number-of-levels> followed
+*         by <width><height><size><data> for each level.<br>
+*         The magic is 8 bytes, the hash 64 bits, and all other elements
+*         except the data are 32 bit integers. The data of a level is stored
 *         on \c size bytes.
 *   \see loadCompressedTexture
 */
-void saveCompressedTexture(const std::string& compressed_tex)
+void saveCompressedTexture(const std::string& compressed_tex, uint64_t hash,
+                           int internal_format,
+                           const std::vector<TextureCompressor::Level> &levels)
 {
 #if !defined(USE_GLES2)
-    int internal_format, width, height, size, compressionSuccessful;
-    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_INTERNAL_FORMAT, (GLint *)&internal_format);
-    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, (GLint *)&width);
-    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, (GLint *)&height);
-    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_COMPRESSED, (GLint *)&compressionSuccessful);
-    if (!compressionSuccessful)
+    std::ofstream ofs(compressed_tex.c_str(), std::ios::out | std::ios::binary);
+    if (!ofs.is_open())
         return;
-    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_COMPRESSED_IMAGE_SIZE, (GLint *)&size);
 
-    char *data = new char[size];
-    glGetCompressedTexImage(GL_TEXTURE_2D, 0, (GLvoid*)data);
-    std::ofstream ofs(compressed_tex.c_str(), std::ios::out | std::ios::binary);
-    if (ofs.is_open())
+    const uint32_t num_levels = (uint32_t)levels.size();
+    const int32_t format = internal_format;
+    ofs.write(GLTZ_MAGIC, sizeof(GLTZ_MAGIC));
+    ofs.write((const char*)&GLTZ_VERSION, sizeof(GLTZ_VERSION));
+    ofs.write((const char*)&hash, sizeof(hash));
+    ofs.write((const char*)&format, sizeof(format));
+    ofs.write((const char*)&num_levels, sizeof(num_levels));
+    for (unsigned int i = 0; i < levels.size(); i++)
     {
-        ofs.write((char*)&internal_format, sizeof(int));
-        ofs.write((char*)&width, sizeof(int));
-        ofs.write((char*)&height, sizeof(int));
-        ofs.write((char*)&size, sizeof(int));
-        ofs.write(data, size);
-        ofs.close();
+        const TextureCompressor::Level &level = levels[i];
+        const uint32_t size = (uint32_t)level.m_data.size();
+        ofs.write((const char*)&level.m_width, sizeof(uint32_t));
+        ofs.write((const char*)&level.m_height, sizeof(uint32_t));
+        ofs.write((const char*)&size, sizeof(size));
+        ofs.write((const char*)level.m_data.data(), size);
     }
-    delete[] data;
+    ofs.close();
 #endif
 }
+#endif   // !SERVER_ONLY
 
 video::ITexture* getUnicolorTexture(const video::SColor &c)
 {
@@ -20,15 +20,22 @@
 #define MEMORYMANAGER_HPP
 
 #include "gl_headers.hpp"
+#include "graphics/texture_compressor.hpp"
+
 #include <ITexture.h>
 #include <string>
+#include <vector>
 
-GLuint getTextureGLuint(irr::video::ITexture *tex);
-GLuint getDepthTexture(irr::video::ITexture *tex);
 void resetTextureTable();
 void cleanUnicolorTextures();
+#ifndef SERVER_ONLY
+GLuint getTextureGLuint(irr::video::ITexture *tex);
+GLuint getDepthTexture(irr::video::ITexture *tex);
 void compressTexture(irr::video::ITexture *tex, bool srgb, bool premul_alpha = false);
-bool loadCompressedTexture(const std::string& compressed_tex);
-void saveCompressedTexture(const std::string& compressed_tex);
+bool loadCompressedTexture(const std::string& compressed_tex, uint64_t hash);
+void saveCompressedTexture(const std::string& compressed_tex, uint64_t hash,
+                           int internal_format,
+                           const std::vector<TextureCompressor::Level> &levels);
+#endif
 
 #endif
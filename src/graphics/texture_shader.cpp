@@ -16,6 +16,8 @@
 //  along with this program; if not, write to the Free Software
 //  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
+#ifndef SERVER_ONLY
+
 #include "graphics/texture_shader.hpp"
 #include "graphics/central_settings.hpp"
 
@@ -366,3 +368,5 @@ GLuint TextureShaderBase::createSemiTrilinearSampler()
 
 // ----------------------------------------------------------------------------
 // ----------------------------------------------------------------------------
+
+#endif   // !SERVER_ONLY
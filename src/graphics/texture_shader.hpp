@@ -18,6 +18,8 @@
 #ifndef HEADER_TEXTURE_SHADER_HPP
 #define HEADER_TEXTURE_SHADER_HPP
 
+#ifndef SERVER_ONLY
+
 #include "graphics/central_settings.hpp"
 #include "graphics/gl_headers.hpp"
 #include "graphics/shader.hpp"
@@ -253,4 +255,5 @@ public:
 
 };   // class TextureShader
 
+#endif   // !SERVER_ONLY
 #endif
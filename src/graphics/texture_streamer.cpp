@@ -0,0 +1,372 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2016 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#include "graphics/texture_streamer.hpp"
+
+#include "graphics/irr_driver.hpp"
+#include "io/file_manager.hpp"
+#include "utils/log.hpp"
+#include "utils/string_utils.hpp"
+#include "utils/vs.hpp"
+#include "utils/worker_pool.hpp"
+
+#include <algorithm>
+#include <set>
+#include <stdio.h>
+
+TextureStreamer *TextureStreamer::m_texture_streamer = NULL;
+
+/** Maximum number of textures uploaded each time the loading screen is
+ *  drawn, so that the loading screen stays responsive. */
+static const unsigned int MAX_UPLOADS_PER_FRAME = 8;
+
+/** Maximum number of decoded images waiting to be uploaded. The decoder
+ *  threads pause when this is reached, to limit the memory used. */
+static const unsigned int MAX_DECODED_IMAGES = 32;
+
+// ----------------------------------------------------------------------------
+/** Creates the texture streamer. It uses as many threads as the worker
+ *  pool, so it must be created after the worker pool, but before the
+ *  irrlicht device (which registers it as texture preloader).
+ */
+void TextureStreamer::create()
+{
+    assert(!m_texture_streamer);
+    m_texture_streamer =
+        new TextureStreamer(WorkerPool::get()->getNumThreads());
+}   // create
+
+// ----------------------------------------------------------------------------
+/** Frees all requests, stops all threads and deletes the streamer.
+ */
+void TextureStreamer::destroy()
+{
+    delete m_texture_streamer;
+    m_texture_streamer = NULL;
+}   // destroy
+
+// ----------------------------------------------------------------------------
+TextureStreamer::TextureStreamer(unsigned int num_threads)
+{
+    pthread_mutex_init(&m_mutex, NULL);
+    pthread_cond_init(&m_cond_request, NULL);
+    pthread_cond_init(&m_cond_decoded, NULL);
+    m_num_decoding = 0;
+    m_video_driver = NULL;
+    m_file_system  = NULL;
+    m_abort        = false;
+
+    for (unsigned int i = 0; i < num_threads; i++)
+    {
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, &TextureStreamer::mainLoop, this))
+        {
+            Log::warn("TextureStreamer", "Could not create thread %d.", i);
+            break;
+        }
+        m_threads.push_back(thread);
+    }
+}   // TextureStreamer
+
+// ----------------------------------------------------------------------------
+TextureStreamer::~TextureStreamer()
+{
+    finishRequests();
+    if (irr_driver && irr_driver->getVideoDriver())
+        irr_driver->getVideoDriver()->setTexturePreloader(NULL);
+
+    pthread_mutex_lock(&m_mutex);
+    m_abort = true;
+    pthread_cond_broadcast(&m_cond_request);
+    pthread_mutex_unlock(&m_mutex);
+
+    for (unsigned int i = 0; i < m_threads.size(); i++)
+        pthread_join(m_threads[i], NULL);
+
+    pthread_cond_destroy(&m_cond_decoded);
+    pthread_cond_destroy(&m_cond_request);
+    pthread_mutex_destroy(&m_mutex);
+}   // ~TextureStreamer
+
+// ----------------------------------------------------------------------------
+/** The main loop of each decoder thread: takes the oldest request from the
+ *  queue and decodes it.
+ *  \param obj Pointer to the texture streamer.
+ */
+void *TextureStreamer::mainLoop(void *obj)
+{
+    VS::setThreadName("TextureStreamer");
+    TextureStreamer *me = (TextureStreamer*)obj;
+
+    pthread_mutex_lock(&me->m_mutex);
+    while (true)
+    {
+        while (!me->m_abort && (me->m_queue.empty() ||
+                  me->m_decoded.size() >= MAX_DECODED_IMAGES))
+            pthread_cond_wait(&me->m_cond_request, &me->m_mutex);
+        if (me->m_abort)
+            break;
+
+        Request *request = me->m_queue.front();
+        me->m_queue.pop_front();
+        request->m_state = RS_DECODING;
+        me->m_num_decoding++;
+        video::IVideoDriver *driver = me->m_video_driver;
+        io::IFileSystem *file_system = me->m_file_system;
+        pthread_mutex_unlock(&me->m_mutex);
+
+        video::IImage *image = decode(driver, file_system, request->m_path);
+
+        pthread_mutex_lock(&me->m_mutex);
+        request->m_image = image;
+        request->m_state = RS_DECODED;
+        me->m_decoded.push_back(request);
+        me->m_num_decoding--;
+        pthread_cond_broadcast(&me->m_cond_decoded);
+    }   // while true
+    pthread_mutex_unlock(&me->m_mutex);
+    return NULL;
+}   // mainLoop
+
+// ----------------------------------------------------------------------------
+/** Reads and decodes an image file. The file is read directly (not through
+ *  the irrlicht file system, which is not thread safe).
+ *  \return The image, or NULL if the file can not be read or decoded (the
+ *          driver will then try to load it itself).
+ */
+video::IImage *TextureStreamer::decode(video::IVideoDriver *driver,
+                                       io::IFileSystem *file_system,
+                                       const io::path &path)
+{
+    FILE *f = fopen(path.c_str(), "rb");
+    if (!f)
+        return NULL;
+    fseek(f, 0, SEEK_END);
+    const long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    if (size <= 0)
+    {
+        fclose(f);
+        return NULL;
+    }
+    c8 *data = new c8[size];
+    const size_t n = fread(data, 1, size, f);
+    fclose(f);
+    if (n != (size_t)size)
+    {
+        delete[] data;
+        return NULL;
+    }
+
+    io::IReadFile *file = file_system->createMemoryReadFile(data, (s32)size,
+                                      path, /*deleteMemoryWhenDropped*/true);
+    video::IImage *image = driver->createImageFromFile(file);
+    file->drop();
+    return image;
+}   // decode
+
+// ----------------------------------------------------------------------------
+/** Requests a texture file to be decoded in the background. Files which
+ *  are already loaded or requested are ignored.
+ *  \param path Full path of the texture file.
+ */
+void TextureStreamer::requestTexture(const std::string &path)
+{
+    video::IVideoDriver *driver = irr_driver->getVideoDriver();
+    // Without graphics no textures are uploaded, so there is nothing to gain
+    if (m_threads.empty() || driver->getDriverType() == video::EDT_NULL)
+        return;
+
+    io::IFileSystem *file_system = irr_driver->getDevice()->getFileSystem();
+    // Use the same name that the driver's getTexture() uses
+    const io::path absolute_path = file_system->getAbsolutePath(path.c_str());
+    if (driver->findTexture(absolute_path))
+        return;
+
+    pthread_mutex_lock(&m_mutex);
+    m_video_driver = driver;
+    m_file_system  = file_system;
+    if (m_requests.find(absolute_path) == m_requests.end())
+    {
+        Request *request   = new Request();
+        request->m_path    = absolute_path;
+        request->m_state   = RS_QUEUED;
+        request->m_image   = NULL;
+        request->m_texture = NULL;
+        m_requests[absolute_path] = request;
+        m_queue.push_back(request);
+        pthread_cond_signal(&m_cond_request);
+    }
+    pthread_mutex_unlock(&m_mutex);
+}   // requestTexture
+
+// ----------------------------------------------------------------------------
+/** Requests all images (png and jpg files) in a directory.
+ *  \param dir The directory, with a trailing '/'.
+ */
+void TextureStreamer::requestDirectory(const std::string &dir)
+{
+    if (m_threads.empty())
+        return;
+
+    std::set<std::string> files;
+    file_manager->listFiles(files, dir);
+    for (std::set<std::string>::const_iterator i = files.begin();
+         i != files.end(); i++)
+    {
+        const std::string ext = StringUtils::toLowerCase(
+                                               StringUtils::getExtension(*i));
+        if (ext == "png" || ext == "jpg" || ext == "jpeg")
+            requestTexture(dir + *i);
+    }
+}   // requestDirectory
+
+// ----------------------------------------------------------------------------
+/** Creates the texture for a decoded request, and frees the image. The
+ *  texture is not kept in the texture cache of the driver, so that unused
+ *  textures can be freed; it is added when the driver takes it.
+ *  \return The texture (grabbed), or NULL if decoding failed.
+ */
+video::ITexture *TextureStreamer::createTexture(Request *request)
+{
+    if (!request->m_image)
+        return NULL;
+    video::IVideoDriver *driver = irr_driver->getVideoDriver();
+    video::ITexture *texture = driver->addTexture(request->m_path,
+                                                  request->m_image);
+    request->m_image->drop();
+    request->m_image = NULL;
+    if (texture)
+    {
+        texture->grab();
+        driver->removeTexture(texture);
+    }
+    return texture;
+}   // createTexture
+
+// ----------------------------------------------------------------------------
+/** Uploads the textures of up to max_count decoded images.
+ */
+void TextureStreamer::uploadDecoded(unsigned int max_count)
+{
+    for (unsigned int i = 0; i < max_count; i++)
+    {
+        pthread_mutex_lock(&m_mutex);
+        if (m_decoded.empty())
+        {
+            pthread_mutex_unlock(&m_mutex);
+            return;
+        }
+        Request *request = m_decoded.front();
+        m_decoded.pop_front();
+        request->m_state = RS_UPLOADED;
+        pthread_cond_signal(&m_cond_request);
+        pthread_mutex_unlock(&m_mutex);
+
+        // Only the main thread accesses uploaded requests
+        request->m_texture = createTexture(request);
+    }
+}   // uploadDecoded
+
+// ----------------------------------------------------------------------------
+/** Uploads some of the decoded textures. Called each time the loading
+ *  screen is drawn.
+ */
+void TextureStreamer::uploadTextures()
+{
+    uploadDecoded(MAX_UPLOADS_PER_FRAME);
+}   // uploadTextures
+
+// ----------------------------------------------------------------------------
+/** Called by the irrlicht driver when it loads a texture which is not in
+ *  its cache. If the file was requested, the texture is created from the
+ *  decoded image, waiting for a decoder thread if necessary (or decoding
+ *  it here if no thread has started on it).
+ *  \param path Absolute path of the texture file.
+ *  \return The texture, or NULL if the file was not requested.
+ */
+video::ITexture *TextureStreamer::getPreloadedTexture(const io::path &path)
+{
+    pthread_mutex_lock(&m_mutex);
+    std::map<io::path, Request*>::iterator i = m_requests.find(path);
+    if (i == m_requests.end())
+    {
+        pthread_mutex_unlock(&m_mutex);
+        return NULL;
+    }
+    Request *request = i->second;
+    m_requests.erase(i);
+
+    if (request->m_state == RS_QUEUED)
+    {
+        m_queue.erase(std::find(m_queue.begin(), m_queue.end(), request));
+        video::IVideoDriver *driver = m_video_driver;
+        io::IFileSystem *file_system = m_file_system;
+        pthread_mutex_unlock(&m_mutex);
+        request->m_image = decode(driver, file_system, request->m_path);
+    }
+    else
+    {
+        while (request->m_state == RS_DECODING)
+            pthread_cond_wait(&m_cond_decoded, &m_mutex);
+        if (request->m_state == RS_DECODED)
+        {
+            m_decoded.erase(std::find(m_decoded.begin(), m_decoded.end(),
+                                      request));
+            pthread_cond_signal(&m_cond_request);
+        }
+        pthread_mutex_unlock(&m_mutex);
+    }
+
+    video::ITexture *texture = request->m_texture ? request->m_texture
+                                                  : createTexture(request);
+    delete request;
+
+    // Loading screens are not drawn while a track is loaded, so upload
+    // another texture now to keep the decoder threads busy.
+    uploadDecoded(1);
+    return texture;
+}   // getPreloadedTexture
+
+// ----------------------------------------------------------------------------
+/** Cancels all requests which were not decoded yet, and frees the images
+ *  and textures of all requests which were not used. Must be called once
+ *  loading is finished.
+ */
+void TextureStreamer::finishRequests()
+{
+    pthread_mutex_lock(&m_mutex);
+    m_queue.clear();
+    while (m_num_decoding > 0)
+        pthread_cond_wait(&m_cond_decoded, &m_mutex);
+    m_decoded.clear();
+    std::map<io::path, Request*> requests;
+    requests.swap(m_requests);
+    pthread_mutex_unlock(&m_mutex);
+
+    for (std::map<io::path, Request*>::iterator i = requests.begin();
+         i != requests.end(); i++)
+    {
+        Request *request = i->second;
+        if (request->m_image)
+            request->m_image->drop();
+        if (request->m_texture)
+            request->m_texture->drop();
+        delete request;
+    }
+}   // finishRequests
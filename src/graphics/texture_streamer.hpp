@@ -0,0 +1,132 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2016 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#ifndef HEADER_TEXTURE_STREAMER_HPP
+#define HEADER_TEXTURE_STREAMER_HPP
+
+#include "utils/no_copy.hpp"
+
+#include <IFileSystem.h>
+#include <IImage.h>
+#include <ITexturePreloader.h>
+#include <IVideoDriver.h>
+
+#include <assert.h>
+#include <deque>
+#include <map>
+#include <pthread.h>
+#include <string>
+#include <vector>
+
+using namespace irr;
+
+/** Decodes texture files in background threads before they are needed.
+ *  Loaders request all textures they are going to use (e.g. the track
+ *  and kart loaders request all images in their directory), then load
+ *  their meshes as usual. When irrlicht's getTexture() needs one of the
+ *  requested files, it takes the decoded image from here (see
+ *  video::ITexturePreloader), waiting for it to be decoded if necessary.
+ *  Decoded images are also turned into textures a few at a time each time
+ *  the loading screen is drawn (the GL upload must happen on the main
+ *  thread). Textures that were requested but never used are freed by
+ *  finishRequests(), which must be called once loading is done.
+ *  All public functions must be called from the main thread.
+ *  \ingroup graphics
+ */
+class TextureStreamer : public NoCopy, public video::ITexturePreloader
+{
+private:
+    /** The singleton instance. */
+    static TextureStreamer *m_texture_streamer;
+
+    enum RequestState { RS_QUEUED, RS_DECODING, RS_DECODED, RS_UPLOADED };
+
+    /** One requested texture file. */
+    struct Request
+    {
+        /** Absolute path of the file, as used by the irrlicht driver. */
+        io::path         m_path;
+        RequestState     m_state;
+        /** The decoded image, NULL if not decoded yet or if decoding
+         *  failed. */
+        video::IImage   *m_image;
+        /** The texture once it was uploaded, grabbed by this object. */
+        video::ITexture *m_texture;
+    };   // Request
+
+    /** The ids of all decoder threads. */
+    std::vector<pthread_t> m_threads;
+
+    /** Protects all data below. */
+    pthread_mutex_t m_mutex;
+
+    /** Signalled when a request is added, or an image was removed from
+     *  m_decoded (or the streamer is shut down). */
+    pthread_cond_t m_cond_request;
+
+    /** Signalled when a request was decoded. */
+    pthread_cond_t m_cond_decoded;
+
+    /** All requested textures which were not taken by the driver yet. */
+    std::map<io::path, Request*> m_requests;
+
+    /** Requests which are not decoded yet, in the order of the requests. */
+    std::deque<Request*> m_queue;
+
+    /** Decoded requests waiting for their texture to be uploaded. */
+    std::deque<Request*> m_decoded;
+
+    /** Number of requests currently decoded by a thread. */
+    unsigned int m_num_decoding;
+
+    /** The driver and file system used to decode images, set by the main
+     *  thread when requests are added (the device can be recreated). */
+    video::IVideoDriver *m_video_driver;
+    io::IFileSystem     *m_file_system;
+
+    /** Set to tell all decoder threads to exit. */
+    bool m_abort;
+
+    TextureStreamer(unsigned int num_threads);
+    ~TextureStreamer();
+    static void *mainLoop(void *obj);
+    static video::IImage *decode(video::IVideoDriver *driver,
+                                 io::IFileSystem *file_system,
+                                 const io::path &path);
+    void uploadDecoded(unsigned int max_count);
+    video::ITexture *createTexture(Request *request);
+
+public:
+    static void create();
+    static void destroy();
+    void requestTexture(const std::string &path);
+    void requestDirectory(const std::string &dir);
+    void uploadTextures();
+    void finishRequests();
+    virtual video::ITexture *getPreloadedTexture(const io::path &path);
+
+    // ------------------------------------------------------------------------
+    /** Returns the texture streamer. */
+    static TextureStreamer *get()
+    {
+        assert(m_texture_streamer);
+        return m_texture_streamer;
+    }   // get
+};   // TextureStreamer
+
+#endif
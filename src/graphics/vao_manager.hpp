@@ -18,6 +18,8 @@
 #ifndef VAOMANAGER_HPP
 #define VAOMANAGER_HPP
 
+#ifndef SERVER_ONLY
+
 #include "gl_headers.hpp"
 #include "utils/singleton.hpp"
 #include <S3DVertex.h>
@@ -185,4 +187,5 @@ public:
     ~VAOManager();
 };
 
+#endif   // !SERVER_ONLY
 #endif
@@ -16,6 +16,8 @@
 //  along with this program; if not, write to the Free Software
 //  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
+#ifndef SERVER_ONLY
+
 #include "graphics/water.hpp"
 
 #include "graphics/callbacks.hpp"
@@ -93,3 +95,5 @@ void WaterNode::OnRegisterSceneNode()
         ISceneNode::OnRegisterSceneNode();
     }
 }
+
+#endif   // !SERVER_ONLY
@@ -19,6 +19,8 @@
 #ifndef HEADER_WATER_HPP
 #define HEADER_WATER_HPP
 
+#ifndef SERVER_ONLY
+
 #include <IMeshSceneNode.h>
 #include <utils/cpp2011.hpp>
 
@@ -67,4 +69,5 @@ protected:
     float m_length;
 };
 
+#endif   // !SERVER_ONLY
 #endif
@@ -665,6 +665,7 @@ namespace GUIEngine
 #include "input/input_manager.hpp"
 #include "io/file_manager.hpp"
 #include "graphics/2dutils.hpp"
+#include "graphics/texture_streamer.hpp"
 #include "guiengine/event_handler.hpp"
 #include "guiengine/modaldialog.hpp"
 #include "guiengine/message_queue.hpp"
@@ -1254,6 +1255,10 @@ namespace GUIEngine
     {
         if (clearIcons) g_loading_icons.clear();
 
+        // Use the time the loading screen is shown to upload textures
+        // decoded in the background
+        TextureStreamer::get()->uploadTextures();
+
         g_skin->drawBgImage();
         ITexture* loading =
             irr_driver->getTexture(file_manager->getAsset(FileManager::GUI,
@@ -1960,6 +1960,7 @@ void Skin::process3DPane(IGUIElement *element, const core::recti &rect,
     {
         ModelViewWidget* mvw = dynamic_cast<ModelViewWidget*>(widget);
         
+#ifndef SERVER_ONLY
         if (CVS->isGLSL())
         {
             FrameBuffer* fb = mvw->getFrameBuffer();
@@ -1973,6 +1974,7 @@ void Skin::process3DPane(IGUIElement *element, const core::recti &rect,
             }
         }
         else
+#endif   // !SERVER_ONLY
         {
             video::ITexture* texture = mvw->getTexture();
             if (texture != NULL && texture->getSize().Width > 0 
@@ -62,8 +62,10 @@ ModelViewWidget::~ModelViewWidget()
 {
     GUIEngine::needsUpdate.remove(this);
 
+#ifndef SERVER_ONLY
     delete m_rtt_provider;
     m_rtt_provider = NULL;
+#endif
 
     delete m_old_rtt_provider;
     m_old_rtt_provider = NULL;
@@ -175,6 +177,7 @@ void ModelViewWidget::update(float delta)
         if (fabsf(m_angle - m_rotation_target) < 2.0f) m_rotation_mode = ROTATE_OFF;
     }
 
+#ifndef SERVER_ONLY
     if (CVS->isGLSL())
     {
         if (m_rtt_provider == NULL)
@@ -196,6 +199,7 @@ void ModelViewWidget::update(float delta)
         m_rtt_main_node->setVisible(false);
     }
     else
+#endif   // !SERVER_ONLY
     {
         if (m_old_rtt_provider == NULL)
         {
@@ -314,7 +318,9 @@ void ModelViewWidget::setupRTTScene()
     m_camera->setFOV(DEGREE_TO_RAD*50.0f);
     m_camera->updateAbsolutePosition();
 
+#ifndef SERVER_ONLY
     m_rtt_provider->prepareRender(m_camera);
+#endif
 }
 
 void ModelViewWidget::setRotateOff()
@@ -340,8 +346,10 @@ bool ModelViewWidget::isRotating()
 
 void ModelViewWidget::elementRemoved()
 {
+#ifndef SERVER_ONLY
     delete m_rtt_provider;
     m_rtt_provider = NULL;
+#endif
 
     delete m_old_rtt_provider;
     m_old_rtt_provider = NULL;
@@ -352,8 +360,10 @@ void ModelViewWidget::elementRemoved()
 
 void ModelViewWidget::clearRttProvider()
 {
+#ifndef SERVER_ONLY
     delete m_rtt_provider;
     m_rtt_provider = NULL;
+#endif
 
     delete m_old_rtt_provider;
     m_old_rtt_provider = NULL;
@@ -0,0 +1,351 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2016 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#include "io/asset_loader.hpp"
+
+#include "io/file_manager.hpp"
+#include "io/xml_node.hpp"
+#include "utils/hash.hpp"
+#include "utils/log.hpp"
+#include "utils/string_utils.hpp"
+#include "utils/worker_pool.hpp"
+
+#include <stdexcept>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+
+namespace
+{
+    const char    ASSET_INDEX_MAGIC[8] = { 'S','T','K','A','S','S','E','T' };
+    /** Increase this whenever the format of the index (or of
+     *  XMLNode::writeBinary) changes. */
+    const uint32_t ASSET_INDEX_VERSION = 2;
+
+    // ------------------------------------------------------------------------
+    /** Reads a value of type T from a binary buffer.
+     *  \return False if the buffer is too small. */
+    template<typename T>
+    bool readValue(const char **data, const char *end, T *value)
+    {
+        if ((size_t)(end - *data) < sizeof(T))
+            return false;
+        memcpy(value, *data, sizeof(T));
+        *data += sizeof(T);
+        return true;
+    }   // readValue
+
+    // ------------------------------------------------------------------------
+    /** Appends a value of type T to a binary buffer. */
+    template<typename T>
+    void writeValue(std::string *out, const T &value)
+    {
+        out->append((const char*)&value, sizeof(T));
+    }   // writeValue
+}   // namespace
+
+// ----------------------------------------------------------------------------
+/** Creates an asset loader.
+ *  \param index_name Name of the index file (in the cached data directory).
+ *  \param materials_name Name of the materials file to parse in each
+ *         directory (besides the config file), or "" if none.
+ */
+AssetLoader::AssetLoader(const std::string &index_name,
+                         const std::string &materials_name)
+{
+    m_index_file     = file_manager->getCachedDataDir() + index_name;
+    m_materials_name = materials_name;
+}   // AssetLoader
+
+// ----------------------------------------------------------------------------
+/** Frees all parsed xml trees.
+ */
+AssetLoader::~AssetLoader()
+{
+    for (unsigned int i = 0; i < m_entries.size(); i++)
+    {
+        delete m_entries[i].m_config;
+        delete m_entries[i].m_materials;
+    }
+}   // ~AssetLoader
+
+// ----------------------------------------------------------------------------
+/** Adds a directory that might contain an asset. The directory does not
+ *  need to contain the config file, this is tested (in parallel) in load().
+ *  \param dir Name of the directory, this is only stored for the caller.
+ *  \param config_file Full name of the config file (kart.xml or track.xml).
+ */
+void AssetLoader::addDirectory(const std::string &dir,
+                               const std::string &config_file)
+{
+    Entry entry;
+    entry.m_dir         = dir;
+    entry.m_config_file = config_file;
+    if (m_materials_name.size() > 0)
+    {
+        entry.m_materials_file = StringUtils::getPath(config_file) + "/"
+                               + m_materials_name;
+    }
+    entry.m_stamp       = 0;
+    entry.m_exists      = false;
+    entry.m_config      = NULL;
+    entry.m_materials   = NULL;
+    m_entries.push_back(entry);
+}   // addDirectory
+
+// ----------------------------------------------------------------------------
+/** Parses the xml files of all directories, using all threads of the worker
+ *  pool. Directories that are unchanged since the last start are taken from
+ *  the index file, which is then updated if necessary.
+ */
+void AssetLoader::load()
+{
+    readIndex();
+
+    std::vector<char> from_index(m_entries.size(), 0);
+    WorkerPool::get()->parallelFor((int)m_entries.size(),
+        [this, &from_index](int i)
+        {
+            Entry *entry = &m_entries[i];
+            loadEntry(entry);
+            if (entry->m_exists)
+                from_index[i] = loadFromIndex(entry);
+            if (entry->m_exists && !from_index[i])
+            {
+                try
+                {
+                    entry->m_config = new XMLNode(entry->m_config_file);
+                }
+                catch (std::exception &)
+                {
+                    // The error is reported when the caller loads this
+                    // directory without the pre-parsed tree.
+                    entry->m_config = NULL;
+                }
+                if (entry->m_materials_file.size() > 0 &&
+                    file_manager->fileExists(entry->m_materials_file))
+                {
+                    entry->m_materials =
+                        file_manager->createXMLTree(entry->m_materials_file);
+                }
+            }
+        });
+
+    // Only rewrite the index if any directory was added, changed or removed
+    unsigned int num_indexed = 0;
+    bool changed = false;
+    for (unsigned int i = 0; i < m_entries.size(); i++)
+    {
+        if (from_index[i])
+            num_indexed++;
+        else if (m_entries[i].m_config)
+            changed = true;
+    }
+    if (changed || num_indexed != m_index.size())
+        writeIndex();
+
+    Log::verbose("AssetLoader", "'%s': %d directories, %d from index.",
+                 m_index_file.c_str(), (int)m_entries.size(), num_indexed);
+
+    // The index data is not needed anymore
+    m_index.clear();
+    std::string().swap(m_index_data);
+}   // load
+
+// ----------------------------------------------------------------------------
+/** Tests if the config file of a directory exists and computes the stamp of
+ *  the directory, which changes if the directory or any of its xml files
+ *  are modified. Called from worker threads.
+ */
+void AssetLoader::loadEntry(Entry *entry) const
+{
+    struct stat config_stat;
+    if (stat(entry->m_config_file.c_str(), &config_stat) != 0)
+    {
+        entry->m_exists = false;
+        return;
+    }
+    entry->m_exists = true;
+
+    uint64_t stamp = Hash::FNV_OFFSET;
+    stamp = Hash::mix(stamp, (uint64_t)config_stat.st_mtime);
+    stamp = Hash::mix(stamp, (uint64_t)config_stat.st_size);
+
+    // Adding or removing files changes the modification time of the
+    // directory, editing a file in place only changes the file itself.
+    struct stat dir_stat;
+    std::string dir = StringUtils::getPath(entry->m_config_file);
+    if (stat(dir.c_str(), &dir_stat) == 0)
+        stamp = Hash::mix(stamp, (uint64_t)dir_stat.st_mtime);
+
+    struct stat materials_stat;
+    if (entry->m_materials_file.size() > 0 &&
+        stat(entry->m_materials_file.c_str(), &materials_stat) == 0)
+    {
+        stamp = Hash::mix(stamp, (uint64_t)materials_stat.st_mtime);
+        stamp = Hash::mix(stamp, (uint64_t)materials_stat.st_size);
+    }
+    entry->m_stamp = stamp;
+}   // loadEntry
+
+// ----------------------------------------------------------------------------
+/** Takes the parsed xml trees of a directory from the index, if the index
+ *  contains this directory and the stamp is unchanged. Called from worker
+ *  threads, the index is only read at this stage.
+ *  \return True if the trees were taken from the index.
+ */
+bool AssetLoader::loadFromIndex(Entry *entry) const
+{
+    std::map<std::string, size_t>::const_iterator i =
+        m_index.find(entry->m_config_file);
+    if (i == m_index.end())
+        return false;
+
+    const char *data = m_index_data.data() + i->second;
+    const char *end  = m_index_data.data() + m_index_data.size();
+    uint32_t size;
+    uint64_t stamp;
+    uint8_t  has_materials;
+    if (!readValue(&data, end, &size) || (size_t)(end - data) < size)
+        return false;
+    end = data + size;
+    if (!readValue(&data, end, &stamp) || stamp != entry->m_stamp ||
+        !readValue(&data, end, &has_materials))
+        return false;
+
+    entry->m_config = XMLNode::createFromBinary(entry->m_config_file,
+                                                &data, end);
+    if (entry->m_config && has_materials)
+    {
+        entry->m_materials =
+            XMLNode::createFromBinary(entry->m_materials_file, &data, end);
+        if (!entry->m_materials)
+        {
+            delete entry->m_config;
+            entry->m_config = NULL;
+        }
+    }
+    return entry->m_config != NULL;
+}   // loadFromIndex
+
+// ----------------------------------------------------------------------------
+/** Reads the index file and determines the position of each directory in
+ *  it. A missing, outdated or corrupt index is simply ignored.
+ */
+void AssetLoader::readIndex()
+{
+    m_index.clear();
+    m_index_data.clear();
+
+    FILE *file = fopen(m_index_file.c_str(), "rb");
+    if (!file)
+        return;
+    char buffer[16384];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        m_index_data.append(buffer, n);
+    fclose(file);
+
+    const char *data = m_index_data.data();
+    const char *end  = data + m_index_data.size();
+    uint32_t version, count;
+    if (m_index_data.size() < sizeof(ASSET_INDEX_MAGIC) ||
+        memcmp(data, ASSET_INDEX_MAGIC, sizeof(ASSET_INDEX_MAGIC)) != 0)
+    {
+        m_index_data.clear();
+        return;
+    }
+    data += sizeof(ASSET_INDEX_MAGIC);
+    if (!readValue(&data, end, &version) ||
+        version != ASSET_INDEX_VERSION   ||
+        !readValue(&data, end, &count)      )
+    {
+        m_index_data.clear();
+        return;
+    }
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint32_t name_length, size;
+        if (!readValue(&data, end, &name_length) ||
+            (size_t)(end - data) < name_length)
+            break;
+        std::string name(data, name_length);
+        data += name_length;
+        // Store the offset of the size, so that loadFromIndex can check it
+        m_index[name] = data - m_index_data.data();
+        if (!readValue(&data, end, &size) || (size_t)(end - data) < size)
+        {
+            m_index.erase(name);
+            break;
+        }
+        data += size;
+    }
+}   // readIndex
+
+// ----------------------------------------------------------------------------
+/** Writes the parsed xml trees of all directories to the index file.
+ */
+void AssetLoader::writeIndex() const
+{
+    std::string out(ASSET_INDEX_MAGIC, sizeof(ASSET_INDEX_MAGIC));
+    writeValue(&out, ASSET_INDEX_VERSION);
+    uint32_t count = 0;
+    for (unsigned int i = 0; i < m_entries.size(); i++)
+        if (m_entries[i].m_config) count++;
+    writeValue(&out, count);
+
+    std::string body;
+    for (unsigned int i = 0; i < m_entries.size(); i++)
+    {
+        const Entry &entry = m_entries[i];
+        if (!entry.m_config) continue;
+        body.clear();
+        writeValue(&body, entry.m_stamp);
+        writeValue(&body, (uint8_t)(entry.m_materials ? 1 : 0));
+        entry.m_config->writeBinary(&body);
+        if (entry.m_materials)
+            entry.m_materials->writeBinary(&body);
+
+        writeValue(&out, (uint32_t)entry.m_config_file.size());
+        out.append(entry.m_config_file);
+        writeValue(&out, (uint32_t)body.size());
+        out.append(body);
+    }
+
+    // Write to a temporary file first, so that an interrupted write can
+    // not leave an incomplete index behind.
+    std::string tmp_name = m_index_file + ".tmp";
+    FILE *file = fopen(tmp_name.c_str(), "wb");
+    if (!file)
+    {
+        Log::warn("AssetLoader", "Can not write index '%s'.",
+                  tmp_name.c_str());
+        return;
+    }
+    bool ok = fwrite(out.data(), out.size(), 1, file) == 1;
+    ok = fclose(file) == 0 && ok;
+
+    file_manager->removeFile(m_index_file);
+    if (!ok || rename(tmp_name.c_str(), m_index_file.c_str()) != 0)
+    {
+        Log::warn("AssetLoader", "Can not write index '%s'.",
+                  m_index_file.c_str());
+        file_manager->removeFile(tmp_name);
+    }
+}   // writeIndex
@@ -0,0 +1,109 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2016 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#ifndef HEADER_ASSET_LOADER_HPP
+#define HEADER_ASSET_LOADER_HPP
+
+#include "utils/no_copy.hpp"
+#include "utils/types.hpp"
+
+#include <map>
+#include <string>
+#include <vector>
+
+class XMLNode;
+
+/** Parses the xml files of many asset directories (karts or tracks) in
+ *  parallel. The kart and track managers first add all candidate
+ *  directories in the order in which they want to load them, then call
+ *  load(), and finally create their objects on the main thread from the
+ *  pre-parsed xml trees, in the same order. This keeps the result
+ *  independent of the number of threads, while only the graphics related
+ *  work (which needs the main thread) remains serial.
+ *  The parsed trees are also stored in an index file in the cached data
+ *  directory, together with the modification times of each directory and
+ *  its xml files. On the next start directories that have not changed are
+ *  not parsed again, which avoids opening hundreds of small files when
+ *  many addons are installed.
+ *  \ingroup io
+ */
+class AssetLoader : public NoCopy
+{
+public:
+    /** The data of one candidate directory. */
+    struct Entry
+    {
+        /** The directory name as specified by the caller. */
+        std::string m_dir;
+        /** Full name of the main config file (kart.xml or track.xml). */
+        std::string m_config_file;
+        /** Full name of the materials file, empty if not used. */
+        std::string m_materials_file;
+        /** Stamp computed from the modification times of the directory
+         *  and its files, used to detect changes. */
+        uint64_t    m_stamp;
+        /** True if the config file exists. */
+        bool        m_exists;
+        /** The parsed config file, NULL if it does not exist or could not
+         *  be parsed. */
+        XMLNode    *m_config;
+        /** The parsed materials file, NULL if there is none. */
+        XMLNode    *m_materials;
+    };   // Entry
+
+private:
+    /** Name of the index file. */
+    std::string m_index_file;
+
+    /** Name of the materials file in each directory, or empty. */
+    std::string m_materials_name;
+
+    /** All candidate directories in the order they were added. */
+    std::vector<Entry> m_entries;
+
+    /** Content of the index file. */
+    std::string m_index_data;
+
+    /** Maps the config file name of each directory in the index to the
+     *  offset of its data in m_index_data. */
+    std::map<std::string, size_t> m_index;
+
+    void readIndex();
+    void writeIndex() const;
+    void loadEntry(Entry *entry) const;
+    bool loadFromIndex(Entry *entry) const;
+
+public:
+         AssetLoader(const std::string &index_name,
+                     const std::string &materials_name);
+        ~AssetLoader();
+    void addDirectory(const std::string &dir, const std::string &config_file);
+    void load();
+
+    // ------------------------------------------------------------------------
+    /** Returns the number of candidate directories. */
+    unsigned int getNumEntries() const
+    {
+        return (unsigned int)m_entries.size();
+    }   // getNumEntries
+    // ------------------------------------------------------------------------
+    /** Returns the data of a candidate directory, after load() was called.*/
+    const Entry &getEntry(unsigned int i) const { return m_entries[i]; }
+};   // AssetLoader
+
+#endif
@@ -26,6 +26,7 @@
 #include "karts/kart_properties_manager.hpp"
 #include "tracks/track_manager.hpp"
 #include "utils/command_line.hpp"
+#include "utils/hash.hpp"
 #include "utils/log.hpp"
 #include "utils/string_utils.hpp"
 
@@ -216,6 +217,7 @@ FileManager::FileManager()
     checkAndCreateScreenshotDir();
     checkAndCreateReplayDir();
     checkAndCreateCachedTexturesDir();
+    checkAndCreateCachedDataDir();
     checkAndCreateGPDir();
 
     redirectOutput();
@@ -443,27 +445,7 @@ XMLNode *FileManager::createXMLTree(const std::string &filename)
  */
 XMLNode *FileManager::createXMLTreeFromString(const std::string & content)
 {
-    try
-    {
-        char *b = new char[content.size()];
-        assert(b);
-        memcpy(b, content.c_str(), content.size());
-        io::IReadFile * ireadfile =
-            m_file_system->createMemoryReadFile(b, (int)content.size(),
-                                                "tempfile", true);
-        io::IXMLReader * reader = m_file_system->createXMLReader(ireadfile);
-        XMLNode* node = new XMLNode(reader);
-        reader->drop();
-        return node;
-    }
-    catch (std::runtime_error& e)
-    {
-        if (UserConfigParams::logMisc())
-        {
-            Log::error("[FileManager]", "createXMLTreeFromString: %s", e.what());
-        }
-        return NULL;
-    }
+    return XMLNode::createFromString(content);
 }   // createXMLTreeFromString
 
 //-----------------------------------------------------------------------------
@@ -659,6 +641,37 @@ std::string FileManager::getCachedTexturesDir() const
     return m_cached_textures_dir;
 }   // getCachedTexturesDir
 
+//-----------------------------------------------------------------------------
+/** Returns the directory in which data computed from assets should be cached.
+*/
+std::string FileManager::getCachedDataDir() const
+{
+    return m_cached_data_dir;
+}   // getCachedDataDir
+
+//-----------------------------------------------------------------------------
+/** Computes a 64 bit hash (FNV-1a) of the content of a file. This is used
+ *  to detect if cached data derived from a file is still up to date.
+ *  \param name Full path of the file.
+ *  \param hash On return contains the hash value.
+ *  \return False if the file could not be read.
+ */
+bool FileManager::getFileHash(const std::string &name, uint64_t *hash) const
+{
+    FILE *file = fopen(name.c_str(), "rb");
+    if (!file)
+        return false;
+
+    uint64_t h = Hash::FNV_OFFSET;
+    unsigned char buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        h = Hash::mixBytes(h, buffer, n);
+    fclose(file);
+    *hash = h;
+    return true;
+}   // getFileHash
+
 //-----------------------------------------------------------------------------
 /** Returns the directory in which user-defined grand prix should be stored.
  */
@@ -971,6 +984,31 @@ void FileManager::checkAndCreateCachedTexturesDir()
 
 }   // checkAndCreateCachedTexturesDir
 
+// ----------------------------------------------------------------------------
+/** Creates the directories for cached data. This will set m_cached_data_dir
+ *  with the appropriate path.
+ */
+void FileManager::checkAndCreateCachedDataDir()
+{
+#if defined(WIN32) || defined(__CYGWIN__)
+    m_cached_data_dir = m_user_config_dir + "cached-data/";
+#elif defined(__APPLE__)
+    m_cached_data_dir = getenv("HOME");
+    m_cached_data_dir += "/Library/Application Support/SuperTuxKart/CachedData/";
+#else
+    m_cached_data_dir = checkAndCreateLinuxDir("XDG_CACHE_HOME", "supertuxkart", ".cache/", ".");
+    m_cached_data_dir += "cached-data/";
+#endif
+
+    if (!checkAndCreateDirectory(m_cached_data_dir))
+    {
+        Log::error("FileManager", "Can not create cached data directory '%s', "
+            "falling back to '.'.", m_cached_data_dir.c_str());
+        m_cached_data_dir = ".";
+    }
+
+}   // checkAndCreateCachedDataDir
+
 // ----------------------------------------------------------------------------
 /** Creates the directories for user-defined grand prix. This will set m_gp_dir
  *  with the appropriate path.
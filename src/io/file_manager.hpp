@@ -36,6 +36,7 @@ using namespace irr;
 
 #include "io/xml_node.hpp"
 #include "utils/no_copy.hpp"
+#include "utils/types.hpp"
 
 /**
   * \brief class handling files and paths
@@ -81,6 +82,10 @@ private:
     /** Directory where resized textures are cached. */
     std::string       m_cached_textures_dir;
 
+    /** Directory where other data computed from the assets (e.g. the
+     *  shortest paths of arena navmeshes) is cached. */
+    std::string       m_cached_data_dir;
+
     /** Directory where user-defined grand prix are stored. */
     std::string       m_gp_dir;
 
@@ -102,6 +107,7 @@ private:
     void              checkAndCreateScreenshotDir();
     void              checkAndCreateReplayDir();
     void              checkAndCreateCachedTexturesDir();
+    void              checkAndCreateCachedDataDir();
     void              checkAndCreateGPDir();
     void              discoverPaths();
 #if !defined(WIN32) && !defined(__CYGWIN__) && !defined(__APPLE__)
@@ -124,6 +130,9 @@ public:
     std::string       getScreenshotDir() const;
     std::string       getReplayDir() const;
     std::string       getCachedTexturesDir() const;
+    std::string       getCachedDataDir() const;
+    bool              getFileHash(const std::string &name,
+                                  uint64_t *hash) const;
     std::string       getGPDir() const;
     std::string       getTextureCacheLocation(const std::string& filename);
     bool              checkAndCreateDirectoryP(const std::string &path);
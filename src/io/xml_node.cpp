@@ -18,18 +18,320 @@
 
 #include "io/file_manager.hpp"
 #include "io/xml_node.hpp"
+#include "karts/kart_properties.hpp"
+#include "karts/kart_properties_manager.hpp"
+#include "tracks/track.hpp"
+#include "tracks/track_manager.hpp"
 #include "utils/string_utils.hpp"
 #include "utils/interpolation_array.hpp"
 #include "utils/vec3.hpp"
 
+#include <assert.h>
+#include <errno.h>
+#include <limits>
 #include <stdexcept>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifndef WIN32
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+/** The data shared by all nodes of one xml file. */
+struct XMLNode::Document
+{
+    /** Name of the file, used in error messages. */
+    std::string            m_file_name;
+    /** The text of the file. All attribute names and values point into
+     *  this text. */
+    char                  *m_text;
+    /** Size of m_text. */
+    size_t                 m_text_size;
+    /** True if m_text is a mapped file, otherwise it was allocated. */
+    bool                   m_mapped;
+    /** The attributes of all nodes. */
+    std::vector<Attribute> m_attributes;
+    /** The children of all nodes, the children of a node are stored
+     *  consecutively. */
+    std::vector<XMLNode*>  m_children;
+    /** All nodes apart from the root. */
+    XMLNode               *m_nodes;
+    /** The root node, which owns this document. */
+    XMLNode               *m_root;
+
+    // ------------------------------------------------------------------------
+    Document(const std::string &file_name, XMLNode *root)
+    {
+        m_file_name = file_name;
+        m_text      = NULL;
+        m_text_size = 0;
+        m_mapped    = false;
+        m_nodes     = NULL;
+        m_root      = root;
+    }   // Document
+    // ------------------------------------------------------------------------
+    ~Document()
+    {
+        delete [] m_nodes;
+        freeText();
+    }   // ~Document
+    // ------------------------------------------------------------------------
+    void freeText()
+    {
+#ifndef WIN32
+        if (m_mapped)
+            munmap(m_text, m_text_size);
+        else
+#endif
+            delete [] m_text;
+        m_text   = NULL;
+        m_mapped = false;
+    }   // freeText
+    // ------------------------------------------------------------------------
+    /** Sets the text of this document to a copy of the given data. */
+    void copyText(const char *data, size_t size)
+    {
+        freeText();
+        m_text      = new char[size + 1];
+        m_text_size = size;
+        memcpy(m_text, data, size);
+        m_text[size] = 0;
+    }   // copyText
+    // ------------------------------------------------------------------------
+    /** Maps (or reads) a file into memory.
+     *  \return False if the file can not be opened.
+     */
+    bool loadFile(const std::string &filename)
+    {
+#ifndef WIN32
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0)
+        {
+            // A private writable mapping, so that strings can be terminated
+            // and entities replaced in place without changing the file.
+            void *p = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED)
+            {
+                m_text      = (char*)p;
+                m_text_size = (size_t)st.st_size;
+                m_mapped    = true;
+                close(fd);
+                return true;
+            }
+        }
+        close(fd);
+#endif
+        FILE *file = fopen(filename.c_str(), "rb");
+        if (!file)
+            return false;
+        std::string data;
+        char buffer[16384];
+        size_t n;
+        while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0)
+            data.append(buffer, n);
+        fclose(file);
+        copyText(data.data(), data.size());
+        return true;
+    }   // loadFile
+};   // Document
+
+// ============================================================================
+/** Collects all nodes and attributes while a file is parsed. Strings are
+ *  stored as offsets into the text of the document, which is either the
+ *  file itself, or (if the data does not come from a text file) m_pool,
+ *  which is copied into the document at the end.
+ */
+struct XMLNode::Builder
+{
+    struct NodeData
+    {
+        size_t       m_name;
+        size_t       m_name_length;
+        int          m_parent;
+        unsigned int m_first_attribute;
+        unsigned int m_num_attributes;
+    };
+    struct AttributeData
+    {
+        size_t m_name;
+        size_t m_value;
+        size_t m_value_length;
+    };
+    std::vector<NodeData>      m_nodes;
+    std::vector<AttributeData> m_attributes;
+    std::string                m_pool;
+
+    // ------------------------------------------------------------------------
+    /** Adds a node, the root is added with parent -1. */
+    int addNode(int parent, size_t name, size_t name_length)
+    {
+        NodeData node;
+        node.m_name            = name;
+        node.m_name_length     = name_length;
+        node.m_parent          = parent;
+        node.m_first_attribute = (unsigned int)m_attributes.size();
+        node.m_num_attributes  = 0;
+        m_nodes.push_back(node);
+        return (int)m_nodes.size() - 1;
+    }   // addNode
+    // ------------------------------------------------------------------------
+    /** Adds an attribute to the last added node. */
+    void addAttribute(size_t name, size_t value, size_t value_length)
+    {
+        AttributeData attribute;
+        attribute.m_name         = name;
+        attribute.m_value        = value;
+        attribute.m_value_length = value_length;
+        m_attributes.push_back(attribute);
+        m_nodes.back().m_num_attributes++;
+    }   // addAttribute
+    // ------------------------------------------------------------------------
+    /** Adds a 0-terminated copy of a string to the pool and returns its
+     *  offset. */
+    size_t addString(const char *s, size_t length)
+    {
+        size_t offset = m_pool.size();
+        m_pool.append(s, length);
+        m_pool.push_back(0);
+        return offset;
+    }   // addString
+};   // Builder
+
+// ============================================================================
+namespace
+{
+    /** The same whitespace characters as irrlicht's xml reader uses. */
+    inline bool isWhiteSpace(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }   // isWhiteSpace
+
+    // ------------------------------------------------------------------------
+    /** Replaces the predefined xml entities in place (other entities like
+     *  '&#x41;' are kept, see XMLNode::getAndDecode).
+     *  \return The new length of the string.
+     */
+    size_t replaceEntities(char *begin, char *end)
+    {
+        char *out = (char*)memchr(begin, '&', end - begin);
+        if (!out)
+            return end - begin;
+
+        static const struct { const char *m_name; size_t m_length; char m_c; }
+        entities[] = { { "amp;",  4, '&'  }, { "lt;",   3, '<'  },
+                       { "gt;",   3, '>'  }, { "quot;", 5, '"'  },
+                       { "apos;", 5, '\'' }                       };
+        const char *in = out;
+        while (in < end)
+        {
+            if (*in == '&')
+            {
+                bool found = false;
+                for (unsigned int i = 0; i < 5; i++)
+                {
+                    if ((size_t)(end - in - 1) >= entities[i].m_length &&
+                        memcmp(in + 1, entities[i].m_name,
+                               entities[i].m_length) == 0)
+                    {
+                        *out++ = entities[i].m_c;
+                        in    += entities[i].m_length + 1;
+                        found  = true;
+                        break;
+                    }
+                }
+                if (found) continue;
+            }
+            *out++ = *in++;
+        }
+        return out - begin;
+    }   // replaceEntities
 
-XMLNode::XMLNode(io::IXMLReader *xml)
+    // ------------------------------------------------------------------------
+    /** Skips leading whitespace like the stream operators do. */
+    const char *skipSpace(const char *s)
+    {
+        while (*s == ' ' || (*s >= '\t' && *s <= '\r'))
+            s++;
+        return s;
+    }   // skipSpace
+
+    // ------------------------------------------------------------------------
+    /** Parses a plain decimal integer. Anything else (including values that
+     *  might overflow) returns false, and the caller then uses the stream
+     *  based parsing, so that the accepted syntax does not change.
+     */
+    bool parseInteger(const char *s, int64_t *value)
+    {
+        const char *p = skipSpace(s);
+        const char *start = p;
+        if (*p == '-' || *p == '+') p++;
+        const char *digits = p;
+        while (*p >= '0' && *p <= '9') p++;
+        if (p == digits || p - digits > 18 || *p)
+            return false;
+        *value = strtoll(start, NULL, 10);
+        return true;
+    }   // parseInteger
+
+    // ------------------------------------------------------------------------
+    /** Parses a plain decimal floating point number, see parseInteger. */
+    bool parseFloat(const char *s, float *value)
+    {
+        const char *start = skipSpace(s);
+        const char *p = start;
+        while ((*p >= '0' && *p <= '9') || *p == '.' || *p == '-' ||
+               *p == '+' || *p == 'e' || *p == 'E')
+            p++;
+        if (p == start || *p)
+            return false;
+        char *end;
+        errno = 0;
+        float f = strtof(start, &end);
+        if (end != p || errno != 0)
+            return false;
+        *value = f;
+        return true;
+    }   // parseFloat
+}   // namespace
+
+// ============================================================================
+/** Private constructor for the nodes of a document. */
+XMLNode::XMLNode()
 {
-    m_file_name = "[unknown]";
+    m_document        = NULL;
+    m_first_attribute = 0;
+    m_num_attributes  = 0;
+    m_first_child     = 0;
+    m_num_children    = 0;
+}   // XMLNode
 
+// ----------------------------------------------------------------------------
+/** Creates a XMLNode tree using irrlicht's xml reader. This is mostly kept
+ *  for compatibility, all files are read with the faster parser in
+ *  parseText().
+ *  \param xml The xml reader.
+ */
+XMLNode::XMLNode(io::IXMLReader *xml)
+{
+    m_first_attribute = 0;
+    m_num_attributes  = 0;
+    m_first_child     = 0;
+    m_num_children    = 0;
+    m_document = new Document("[unknown]", this);
+
+    Builder builder;
+    builder.addNode(-1, builder.addString("", 0), 0);
     while(xml->getNodeType()!=io::EXN_ELEMENT && xml->read());
-    readXML(xml);
+    readXML(&builder, xml, 0);
+    m_document->copyText(builder.m_pool.data(), builder.m_pool.size());
+    createNodes(&builder);
 }   // XMLNode
 
 // ----------------------------------------------------------------------------
@@ -38,66 +340,267 @@ XMLNode::XMLNode(io::IXMLReader *xml)
  */
 XMLNode::XMLNode(const std::string &filename)
 {
-    m_file_name = filename;
+    m_first_attribute = 0;
+    m_num_attributes  = 0;
+    m_first_child     = 0;
+    m_num_children    = 0;
+    m_document = new Document(filename, this);
 
-    io::IXMLReader *xml = file_manager->createXMLReader(filename);
-    
-    if (xml == NULL)
+    if (!m_document->loadFile(filename))
     {
-        throw std::runtime_error("Cannot find file "+filename);
+        // Files in an archive (or if the file can not be opened for other
+        // reasons) are read with irrlicht's file system.
+        io::IReadFile *file = file_manager->getFileSystem()
+                            ->createAndOpenFile(filename.c_str());
+        if (file == NULL)
+        {
+            delete m_document;
+            m_document = NULL;
+            throw std::runtime_error("Cannot find file "+filename);
+        }
+        std::string data(file->getSize(), 0);
+        if (data.size() > 0)
+            file->read(&data[0], (u32)data.size());
+        file->drop();
+        m_document->copyText(data.data(), data.size());
     }
 
-    bool is_first_element = true;
-    while(xml->read())
+    Builder builder;
+    parseText(&builder);
+    createNodes(&builder);
+}   // XMLNode
+
+// ----------------------------------------------------------------------------
+/** Creates a XMLNode tree from a string.
+ *  \param content The xml data.
+ */
+XMLNode *XMLNode::createFromString(const std::string &content)
+{
+    XMLNode *node = new XMLNode();
+    node->m_document = new Document("[string]", node);
+    node->m_document->copyText(content.data(), content.size());
+    Builder builder;
+    node->parseText(&builder);
+    node->createNodes(&builder);
+    return node;
+}   // createFromString
+
+// ----------------------------------------------------------------------------
+/** Parses the text of the document. Like irrlicht's xml reader, files with
+ *  a UTF-16 or UTF-32 byte order mark are converted by using the lower 8
+ *  bits of each character, and all other files are treated as bytes (which
+ *  makes UTF-8 values available unchanged through get(std::string*)).
+ *  \param builder Collects all nodes and attributes.
+ */
+void XMLNode::parseText(Builder *builder)
+{
+    const unsigned char *bom = (const unsigned char*)m_document->m_text;
+    const size_t size = m_document->m_text_size;
+    size_t unit = 1;
+    bool big_endian = false;
+    if (size >= 4 && bom[0] == 0 && bom[1] == 0 && bom[2] == 0xFE &&
+        bom[3] == 0xFF)
     {
-        switch (xml->getNodeType())
+        unit = 4; big_endian = true;
+    }
+    else if (size >= 4 && bom[0] == 0xFF && bom[1] == 0xFE &&
+             bom[2] == 0 && bom[3] == 0)
+        unit = 4;
+    else if (size >= 2 && bom[0] == 0xFE && bom[1] == 0xFF)
+    {
+        unit = 2; big_endian = true;
+    }
+    else if (size >= 2 && bom[0] == 0xFF && bom[1] == 0xFE)
+        unit = 2;
+
+    if (unit > 1)
+    {
+        std::string converted;
+        for (size_t i = unit; i + unit <= size; i += unit)
+            converted.push_back((char)bom[big_endian ? i + unit - 1 : i]);
+        m_document->copyText(converted.data(), converted.size());
+    }
+
+    char *text  = m_document->m_text;
+    char *end   = text + m_document->m_text_size;
+    char *p     = text;
+    if (end - p >= 3 && memcmp(p, "\xEF\xBB\xBF", 3) == 0)
+        p += 3;
+
+    builder->addNode(-1, 0, 0);
+    // The stack of all currently open nodes
+    std::vector<int> open_nodes;
+    bool root_found = false;
+    // Counts the depth of elements to skip if there is more than one root
+    int skip_depth = 0;
+
+    while (p < end)
+    {
+        p = (char*)memchr(p, '<', end - p);
+        if (!p || ++p >= end)
+            break;
+
+        if (*p == '/')
         {
-        case io::EXN_ELEMENT:
+            // Closing tag, the name is not checked (same as irrlicht)
+            p = (char*)memchr(p, '>', end - p);
+            if (!p) break;
+            p++;
+            if (skip_depth > 0)
+                skip_depth--;
+            else if (!open_nodes.empty())
+                open_nodes.pop_back();
+            continue;
+        }
+        if (*p == '?')
+        {
+            // Definition like <?xml ... ?>
+            p = (char*)memchr(p, '>', end - p);
+            if (!p) break;
+            p++;
+            continue;
+        }
+        if (*p == '!')
+        {
+            if (p + 1 < end && p[1] == '[')
+            {
+                // CDATA section
+                p = end - p > 8 ? p + 8 : end;
+                while (p < end && !(p[0] == '>' && p[-1] == ']' &&
+                                    p[-2] == ']'))
+                    p++;
+                p++;
+            }
+            else
             {
-                if(!is_first_element)
+                // Comment or doctype: like irrlicht skip to the matching '>'
+                int count = 1;
+                p++;
+                while (p < end && count > 0)
                 {
-                    Log::warn("[XMLNode]",
-                                "More than one root element in '%s' - ignored.",
-                            filename.c_str());
+                    if (*p == '>')
+                        count--;
+                    else if (*p == '<')
+                        count++;
+                    p++;
                 }
-                readXML(xml);
-                is_first_element = false;
+            }
+            continue;
+        }
+
+        // Opening tag
+        // -----------
+        char *name = p;
+        while (p < end && *p != '>' && !isWhiteSpace(*p))
+            p++;
+        char *name_end = p;
+        bool is_empty = false;
+        if (name_end > name && name_end[-1] == '/')
+        {
+            is_empty = true;
+            name_end--;
+        }
+
+        int node = -1;
+        if (skip_depth == 0 && open_nodes.empty())
+        {
+            if (!root_found)
+            {
+                root_found = true;
+                node = 0;
+                builder->m_nodes[0].m_name        = name - text;
+                builder->m_nodes[0].m_name_length = name_end - name;
+                builder->m_nodes[0].m_first_attribute =
+                    (unsigned int)builder->m_attributes.size();
+            }
+            else
+            {
+                Log::warn("[XMLNode]",
+                          "More than one root element in '%s' - ignored.",
+                          m_document->m_file_name.c_str());
+            }
+        }
+        else if (skip_depth == 0)
+        {
+            node = builder->addNode(open_nodes.back(), name - text,
+                                    name_end - name);
+        }
+
+        while (p < end && *p != '>')
+        {
+            if (isWhiteSpace(*p))
+            {
+                p++;
+                continue;
+            }
+            if (*p == '/')
+            {
+                p++;
+                is_empty = true;
                 break;
             }
-        case io::EXN_ELEMENT_END:  break;   // Ignore all other types
-        case io::EXN_UNKNOWN:      break;
-        case io::EXN_COMMENT:      break;
-        case io::EXN_TEXT:         break;
-        default:                   break;
-        }   // switch
-    }   // while
-    xml->drop();
-}   // XMLNode
+            char *attribute_name = p;
+            while (p < end && !isWhiteSpace(*p) && *p != '=')
+                p++;
+            char *attribute_name_end = p;
+            p++;
+            while (p < end && *p != '"' && *p != '\'')
+                p++;
+            if (p >= end)
+                break;   // malformed file
+            char quote = *p++;
+            char *value = p;
+            p = (char*)memchr(p, quote, end - p);
+            if (!p)
+                break;   // malformed file
+            char *value_end = p++;
+
+            if (node < 0) continue;
+            size_t length = replaceEntities(value, value_end);
+            value[length] = 0;
+            *attribute_name_end = 0;
+            builder->addAttribute(attribute_name - text, value - text,
+                                  length);
+        }
+        if (p)
+            p++;   // skip '>'
 
-// ----------------------------------------------------------------------------
-/** Destructor. */
-XMLNode::~XMLNode()
-{
-    for(unsigned int i=0; i<m_nodes.size(); i++)
-    {
-        delete m_nodes[i];
-    }
-    m_nodes.clear();
-}   // ~XMLNode
+        if (skip_depth > 0)
+        {
+            if (!is_empty) skip_depth++;
+        }
+        else if (node < 0)
+        {
+            // Additional root element
+            if (!is_empty) skip_depth = 1;
+        }
+        else if (!is_empty)
+            open_nodes.push_back(node);
+    }   // while p < end
+}   // parseText
 
 // ----------------------------------------------------------------------------
-/** Stores all attributes, and reads in all children.
+/** Stores all attributes, and reads in all children using irrlicht's xml
+ *  reader.
+ *  \param builder Collects all nodes and attributes.
  *  \param xml The XML reader.
+ *  \param node Index of the node to read.
  */
-void XMLNode::readXML(io::IXMLReader *xml)
+void XMLNode::readXML(Builder *builder, io::IXMLReader *xml, int node)
 {
-    m_name = std::string(core::stringc(xml->getNodeName()).c_str());
+    core::stringc name(xml->getNodeName());
+    builder->m_nodes[node].m_name = builder->addString(name.c_str(),
+                                                       name.size());
+    builder->m_nodes[node].m_name_length = name.size();
 
     for(unsigned int i=0; i<xml->getAttributeCount(); i++)
     {
-        std::string   name  = core::stringc(xml->getAttributeName(i)).c_str();
-        core::stringw value = xml->getAttributeValue(i);
-        m_attributes[name] = value;
+        core::stringc attribute = xml->getAttributeName(i);
+        // Like irrlicht each character is stored in one byte
+        core::stringc value     = xml->getAttributeValue(i);
+        size_t n = builder->addString(attribute.c_str(), attribute.size());
+        size_t v = builder->addString(value.c_str(), value.size());
+        builder->addAttribute(n, v, value.size());
     }   // for i
 
     // If no children, we are done
@@ -111,9 +614,8 @@ void XMLNode::readXML(io::IXMLReader *xml)
         {
         case io::EXN_ELEMENT:
             {
-                XMLNode* n = new XMLNode(xml);
-                n->m_file_name = m_file_name;
-                m_nodes.push_back(n);
+                int child = builder->addNode(node, 0, 0);
+                readXML(builder, xml, child);
                 break;
             }
         case io::EXN_ELEMENT_END:
@@ -128,13 +630,238 @@ void XMLNode::readXML(io::IXMLReader *xml)
     }   // while
 }   // readXML
 
+// ----------------------------------------------------------------------------
+/** Creates all nodes of the document from the data collected while parsing.
+ *  This node becomes the root, all other nodes are allocated in one array.
+ *  \param builder The nodes and attributes collected while parsing.
+ */
+void XMLNode::createNodes(Builder *builder)
+{
+    Document *document = m_document;
+    const char *text = document->m_text;
+    const unsigned int n = (unsigned int)builder->m_nodes.size();
+
+    if (n > 1)
+        document->m_nodes = new XMLNode[n - 1];
+    std::vector<XMLNode*> nodes(n);
+    nodes[0] = this;
+    for (unsigned int i = 1; i < n; i++)
+        nodes[i] = &document->m_nodes[i - 1];
+
+    document->m_attributes.resize(builder->m_attributes.size());
+    for (unsigned int i = 0; i < builder->m_attributes.size(); i++)
+    {
+        const Builder::AttributeData &a = builder->m_attributes[i];
+        document->m_attributes[i].m_name         = text + a.m_name;
+        document->m_attributes[i].m_value        = text + a.m_value;
+        document->m_attributes[i].m_value_length = a.m_value_length;
+    }
+
+    // Count the children of each node, then store the children of each
+    // node consecutively (in the order of the file).
+    for (unsigned int i = 0; i < n; i++)
+    {
+        const Builder::NodeData &data = builder->m_nodes[i];
+        XMLNode *node = nodes[i];
+        node->m_document        = document;
+        if (data.m_name_length > 0)
+            node->m_name.assign(text + data.m_name, data.m_name_length);
+        node->m_first_attribute = data.m_first_attribute;
+        node->m_num_attributes  = data.m_num_attributes;
+        node->m_num_children    = 0;
+        if (i > 0)
+            nodes[data.m_parent]->m_num_children++;
+    }
+    unsigned int next = 0;
+    for (unsigned int i = 0; i < n; i++)
+    {
+        nodes[i]->m_first_child = next;
+        next += nodes[i]->m_num_children;
+        nodes[i]->m_num_children = 0;
+    }
+    document->m_children.resize(next);
+    for (unsigned int i = 1; i < n; i++)
+    {
+        XMLNode *parent = nodes[builder->m_nodes[i].m_parent];
+        document->m_children[parent->m_first_child + parent->m_num_children]
+            = nodes[i];
+        parent->m_num_children++;
+    }
+}   // createNodes
+
+// ----------------------------------------------------------------------------
+/** Appends a string with a 32 bit length prefix to a binary buffer. */
+static void writeBinaryString(std::string *out, const char *s, size_t length)
+{
+    uint32_t len = (uint32_t)length;
+    out->append((const char*)&len, sizeof(len));
+    out->append(s, length);
+}   // writeBinaryString
+
+// ----------------------------------------------------------------------------
+/** Reads a 32 bit value from a binary buffer, checking that it does not
+ *  read past the end of the buffer.
+ */
+static bool readBinaryUInt(const char **data, const char *end, uint32_t *n)
+{
+    if ((size_t)(end - *data) < sizeof(uint32_t))
+        return false;
+    memcpy(n, *data, sizeof(uint32_t));
+    *data += sizeof(uint32_t);
+    return true;
+}   // readBinaryUInt
+
+// ----------------------------------------------------------------------------
+/** Reads a string written by writeBinaryString and adds it to the string
+ *  pool of the builder.
+ *  \param offset On return the offset of the string in the pool.
+ *  \param length On return the length of the string.
+ *  \return False if the data is corrupt.
+ */
+static bool readBinaryString(const char **data, const char *end,
+                             std::string *pool, size_t *offset,
+                             size_t *length)
+{
+    uint32_t len;
+    if (!readBinaryUInt(data, end, &len) || (uint32_t)(end - *data) < len)
+        return false;
+    *offset = pool->size();
+    *length = len;
+    pool->append(*data, len);
+    pool->push_back(0);
+    *data += len;
+    return true;
+}   // readBinaryString
+
+// ----------------------------------------------------------------------------
+/** Creates a XML tree from the binary representation written by
+ *  writeBinary(). This is used to cache parsed XML files, see AssetLoader.
+ *  \param file_name Name of the file the tree was parsed from, used in
+ *         error messages.
+ *  \param data Pointer to the binary data, on return it points to the first
+ *         byte after this tree.
+ *  \param end End of the binary data.
+ *  \return The XML tree, or NULL if the data is corrupt.
+ */
+XMLNode *XMLNode::createFromBinary(const std::string &file_name,
+                                   const char **data, const char *end)
+{
+    XMLNode *node = new XMLNode();
+    node->m_document = new Document(file_name, node);
+    Builder builder;
+    builder.addNode(-1, 0, 0);
+    if (!node->readBinary(&builder, data, end, 0))
+    {
+        delete node;
+        return NULL;
+    }
+    node->m_document->copyText(builder.m_pool.data(), builder.m_pool.size());
+    node->createNodes(&builder);
+    return node;
+}   // createFromBinary
+
+// ----------------------------------------------------------------------------
+/** Reads the name, attributes and all children of a node from a binary
+ *  buffer.
+ *  \param builder Collects all nodes and attributes.
+ *  \param node Index of the node to read.
+ *  \return False if the data is corrupt.
+ */
+bool XMLNode::readBinary(Builder *builder, const char **data,
+                         const char *end, int node)
+{
+    uint32_t count;
+    size_t offset, length;
+    if (!readBinaryString(data, end, &builder->m_pool, &offset, &length) ||
+        !readBinaryUInt(data, end, &count)                                  )
+        return false;
+    builder->m_nodes[node].m_name        = offset;
+    builder->m_nodes[node].m_name_length = length;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        size_t name, value, value_length;
+        if (!readBinaryString(data, end, &builder->m_pool, &name,
+                              &length)                                   ||
+            !readBinaryString(data, end, &builder->m_pool, &value,
+                              &value_length)                                )
+            return false;
+        builder->addAttribute(name, value, value_length);
+    }
+
+    if (!readBinaryUInt(data, end, &count))
+        return false;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        int child = builder->addNode(node, 0, 0);
+        if (!readBinary(builder, data, end, child))
+            return false;
+    }
+    return true;
+}   // readBinary
+
+// ----------------------------------------------------------------------------
+/** Appends a compact binary representation of this node and all its
+ *  children to a buffer, which can be read back with createFromBinary().
+ *  \param out The buffer to append to.
+ */
+void XMLNode::writeBinary(std::string *out) const
+{
+    writeBinaryString(out, m_name.c_str(), m_name.size());
+    out->append((const char*)&m_num_attributes, sizeof(uint32_t));
+    for (unsigned int i = 0; i < m_num_attributes; i++)
+    {
+        const Attribute &a = m_document->m_attributes[m_first_attribute + i];
+        writeBinaryString(out, a.m_name, strlen(a.m_name));
+        writeBinaryString(out, a.m_value, a.m_value_length);
+    }
+    out->append((const char*)&m_num_children, sizeof(uint32_t));
+    for (unsigned int i = 0; i < m_num_children; i++)
+        getNode(i)->writeBinary(out);
+}   // writeBinary
+
+// ----------------------------------------------------------------------------
+/** Destructor. The root node deletes the document and so all other nodes.
+ */
+XMLNode::~XMLNode()
+{
+    if (m_document && m_document->m_root == this)
+        delete m_document;
+}   // ~XMLNode
+
+// ----------------------------------------------------------------------------
+/** Returns the name of the file this node was read from. */
+const std::string &XMLNode::getFileName() const
+{
+    return m_document->m_file_name;
+}   // getFileName
+
+// ----------------------------------------------------------------------------
+/** Returns the attribute with the given name, or NULL if this node has no
+ *  such attribute. If an attribute is specified more than once, the last
+ *  one is used.
+ */
+const XMLNode::Attribute *XMLNode::findAttribute(const std::string &name) const
+{
+    if (m_num_attributes == 0) return NULL;
+    const Attribute *attributes =
+        m_document->m_attributes.data() + m_first_attribute;
+    const char *s = name.c_str();
+    for (int i = (int)m_num_attributes - 1; i >= 0; i--)
+    {
+        if (strcmp(attributes[i].m_name, s) == 0)
+            return &attributes[i];
+    }
+    return NULL;
+}   // findAttribute
+
 // ----------------------------------------------------------------------------
 /** Returns the i.th node.
  *  \param i Number of node to return.
  */
 const XMLNode *XMLNode::getNode(unsigned int i) const
 {
-    return m_nodes[i];
+    return m_document->m_children[m_first_child + i];
 }   // getNode
 
 // ----------------------------------------------------------------------------
@@ -143,9 +870,10 @@ const XMLNode *XMLNode::getNode(unsigned int i) const
  */
 const XMLNode *XMLNode::getNode(const std::string &s) const
 {
-    for(unsigned int i=0; i<m_nodes.size(); i++)
+    for(unsigned int i=0; i<m_num_children; i++)
     {
-        if(m_nodes[i]->getName()==s) return m_nodes[i];
+        const XMLNode *node = getNode(i);
+        if(node->getName()==s) return node;
     }
     return NULL;
 }   // getNode
@@ -157,11 +885,12 @@ const XMLNode *XMLNode::getNode(const std::string &s) const
  */
 const void XMLNode::getNodes(const std::string &s, std::vector<XMLNode*>& out) const
 {
-    for(unsigned int i=0; i<m_nodes.size(); i++)
+    for(unsigned int i=0; i<m_num_children; i++)
     {
-        if(m_nodes[i]->getName()==s)
+        XMLNode *node = m_document->m_children[m_first_child + i];
+        if(node->getName()==s)
         {
-            out.push_back(m_nodes[i]);
+            out.push_back(node);
         }
     }
 }   // getNode
@@ -174,31 +903,29 @@ const void XMLNode::getNodes(const std::string &s, std::vector<XMLNode*>& out) c
 */
 int XMLNode::get(const std::string &attribute, std::string *value) const
 {
-    if(m_attributes.empty()) return 0;
-    std::map<std::string, core::stringw>::const_iterator o;
-    o = m_attributes.find(attribute);
-    if(o==m_attributes.end()) return 0;
-    *value=core::stringc(o->second).c_str();
+    const Attribute *a = findAttribute(attribute);
+    if(!a) return 0;
+    value->assign(a->m_value, a->m_value_length);
     return 1;
 }   // get
 // ----------------------------------------------------------------------------
 int XMLNode::get(const std::string &attribute, core::stringw *value) const
 {
-    if(m_attributes.empty()) return 0;
-    std::map<std::string, core::stringw>::const_iterator o;
-    o = m_attributes.find(attribute);
-    if(o==m_attributes.end()) return 0;
-    *value = o->second;
+    const Attribute *a = findAttribute(attribute);
+    if(!a) return 0;
+    // Each byte becomes one character, the same as irrlicht's xml reader
+    *value = L"";
+    value->reserve((u32)a->m_value_length + 1);
+    for (size_t i = 0; i < a->m_value_length; i++)
+        value->append((wchar_t)(unsigned char)a->m_value[i]);
     return 1;
 }   // get
 // ----------------------------------------------------------------------------
 int XMLNode::getAndDecode(const std::string &attribute, core::stringw *value) const
 {
-    if (m_attributes.empty()) return 0;
-    std::map<std::string, core::stringw>::const_iterator o;
-    o = m_attributes.find(attribute);
-    if (o == m_attributes.end()) return 0;
-    std::string raw_value = core::stringc(o->second).c_str();
+    const Attribute *a = findAttribute(attribute);
+    if (!a) return 0;
+    std::string raw_value(a->m_value, a->m_value_length);
     *value = StringUtils::xmlDecode(raw_value);
     return 1;
 }   // get
@@ -235,7 +962,7 @@ int XMLNode::get(const std::string &attribute, Vec3 *value) const
     if (v.size() != 3)
     {
         Log::warn("[XMLNode]", "WARNING: Expected 3 floating-point values, but found '%s' in file %s",
-                    s.c_str(), m_file_name.c_str());
+                    s.c_str(), getFileName().c_str());
         return 0;
     }
 
@@ -252,7 +979,7 @@ int XMLNode::get(const std::string &attribute, Vec3 *value) const
     else
     {
         Log::warn("[XMLNode]", "WARNING: Expected 3 floating-point values, but found '%s' in file %s",
-                    s.c_str(), m_file_name.c_str());
+                    s.c_str(), getFileName().c_str());
         return 0;
     }
 
@@ -308,16 +1035,36 @@ int XMLNode::get(const std::string &attribute, video::SColorf *color) const
 
     return 1;
 }   // get(SColor)
+// ----------------------------------------------------------------------------
+/** Parses an integer attribute. Plain decimal numbers that fit into T are
+ *  parsed directly from the file data, anything else is handled by
+ *  StringUtils::parseString, so the result does not change.
+ */
+template<typename T>
+static int getInteger(const char *s, T *value)
+{
+    int64_t v;
+    if (parseInteger(s, &v)                                     &&
+        v >= (int64_t)std::numeric_limits<T>::min()             &&
+        v <= (int64_t)std::numeric_limits<T>::max()             &&
+        (std::numeric_limits<T>::is_signed || *skipSpace(s) != '-'))
+    {
+        *value = (T)v;
+        return 1;
+    }
+    return StringUtils::parseString<T>(s, value) ? 1 : 0;
+}   // getInteger
+
 // ----------------------------------------------------------------------------
 int XMLNode::get(const std::string &attribute, int32_t *value) const
 {
-    std::string s;
-    if(!get(attribute, &s)) return 0;
+    const Attribute *a = findAttribute(attribute);
+    if(!a) return 0;
 
-    if (!StringUtils::parseString<int>(s, value))
+    if (!getInteger<int32_t>(a->m_value, value))
     {
         Log::warn("[XMLNode]", "WARNING: Expected int but found '%s' for attribute '%s' of node '%s' in file %s",
-                    s.c_str(), attribute.c_str(), m_name.c_str(), m_file_name.c_str());
+                    a->m_value, attribute.c_str(), m_name.c_str(), getFileName().c_str());
         return 0;
     }
 
@@ -327,13 +1074,13 @@ int XMLNode::get(const std::string &attribute, int32_t *value) const
 // ----------------------------------------------------------------------------
 int XMLNode::get(const std::string &attribute, int64_t *value) const
 {
-    std::string s;
-    if(!get(attribute, &s)) return 0;
+    const Attribute *a = findAttribute(attribute);
+    if(!a) return 0;
 
-    if (!StringUtils::parseString<int64_t>(s, value))
+    if (!getInteger<int64_t>(a->m_value, value))
     {
         Log::warn("[XMLNode]", "WARNING: Expected int but found '%s' for attribute '%s' of node '%s' in file %s",
-                    s.c_str(), attribute.c_str(), m_name.c_str(), m_file_name.c_str());
+                    a->m_value, attribute.c_str(), m_name.c_str(), getFileName().c_str());
         return 0;
     }
 
@@ -344,13 +1091,13 @@ int XMLNode::get(const std::string &attribute, int64_t *value) const
 // ----------------------------------------------------------------------------
 int XMLNode::get(const std::string &attribute, uint16_t *value) const
 {
-    std::string s;
-    if(!get(attribute, &s)) return 0;
+    const Attribute *a = findAttribute(attribute);
+    if(!a) return 0;
 
-    if (!StringUtils::parseString<uint16_t>(s, value))
+    if (!getInteger<uint16_t>(a->m_value, value))
     {
         Log::warn("[XMLNode]", "WARNING: Expected uint but found '%s' for attribute '%s' of node '%s' in file %s",
-                    s.c_str(), attribute.c_str(), m_name.c_str(), m_file_name.c_str());
+                    a->m_value, attribute.c_str(), m_name.c_str(), getFileName().c_str());
         return 0;
     }
 
@@ -360,13 +1107,13 @@ int XMLNode::get(const std::string &attribute, uint16_t *value) const
 // ----------------------------------------------------------------------------
 int XMLNode::get(const std::string &attribute, uint32_t *value) const
 {
-    std::string s;
-    if(!get(attribute, &s)) return 0;
+    const Attribute *a = findAttribute(attribute);
+    if(!a) return 0;
 
-    if (!StringUtils::parseString<unsigned int>(s, value))
+    if (!getInteger<uint32_t>(a->m_value, value))
     {
         Log::warn("[XMLNode]", "WARNING: Expected uint but found '%s' for attribute '%s' of node '%s' in file %s",
-                    s.c_str(), attribute.c_str(), m_name.c_str(), m_file_name.c_str());
+                    a->m_value, attribute.c_str(), m_name.c_str(), getFileName().c_str());
         return 0;
     }
 
@@ -376,13 +1123,14 @@ int XMLNode::get(const std::string &attribute, uint32_t *value) const
 // ----------------------------------------------------------------------------
 int XMLNode::get(const std::string &attribute, float *value) const
 {
-    std::string s;
-    if(!get(attribute, &s)) return 0;
+    const Attribute *a = findAttribute(attribute);
+    if(!a) return 0;
 
-    if (!StringUtils::parseString<float>(s, value))
+    if (!parseFloat(a->m_value, value) &&
+        !StringUtils::parseString<float>(a->m_value, value))
     {
         Log::warn("[XMLNode]", "WARNING: Expected float but found '%s' for attribute '%s' of node '%s' in file %s",
-                    s.c_str(), attribute.c_str(), m_name.c_str(), m_file_name.c_str());
+                    a->m_value, attribute.c_str(), m_name.c_str(), getFileName().c_str());
         return 0;
     }
 
@@ -392,12 +1140,12 @@ int XMLNode::get(const std::string &attribute, float *value) const
 // ----------------------------------------------------------------------------
 int XMLNode::get(const std::string &attribute, bool *value) const
 {
-    std::string s;
+    const Attribute *a = findAttribute(attribute);
+    if(!a) return 0;
 
-    // FIXME: for some reason, missing attributes don't trigger that if???
-    if(!get(attribute, &s)) return 0;
+    const char *s = a->m_value;
     *value = s[0]=='T' || s[0]=='t' || s[0]=='Y' || s[0]=='y' ||
-             s=="#t"   || s   =="#T" || s=="1";
+             strcmp(s, "#t")==0 || strcmp(s, "#T")==0 || strcmp(s, "1")==0;
     return 1;
 }   // get(bool)
 
@@ -441,7 +1189,7 @@ int XMLNode::get(const std::string &attribute,
         if (!StringUtils::parseString<float>(v[i], &curr))
         {
             Log::warn("[XMLNode]", "WARNING: Expected float but found '%s' for attribute '%s' of node '%s' in file %s",
-                        v[i].c_str(), attribute.c_str(), m_name.c_str(), m_file_name.c_str());
+                        v[i].c_str(), attribute.c_str(), m_name.c_str(), getFileName().c_str());
             return 0;
         }
 
@@ -625,9 +1373,109 @@ int XMLNode::getHPR(Vec3 *value) const
 
 bool XMLNode::hasChildNamed(const char* name) const
 {
-    for (unsigned int i = 0; i < m_nodes.size(); i++)
+    for (unsigned int i = 0; i < m_num_children; i++)
     {
-        if (m_nodes[i]->getName() == name) return true;
+        if (getNode(i)->getName() == name) return true;
     }
     return false;
 }
+
+// ============================================================================
+/** Tests that two trees are identical. */
+static void compareTrees(const XMLNode *a, const XMLNode *b)
+{
+    assert(a->getName() == b->getName());
+    assert(a->getNumNodes() == b->getNumNodes());
+    std::string sa, sb;
+    a->writeBinary(&sa);
+    b->writeBinary(&sb);
+    assert(sa == sb);
+}   // compareTrees
+
+// ----------------------------------------------------------------------------
+/** Tests the parser with some special cases, checks that it creates the same
+ *  trees as irrlicht's xml reader for the data files of all karts and tracks,
+ *  and prints the time both parsers need for these files.
+ */
+void XMLNode::unitTesting()
+{
+    std::string s =
+        "\xEF\xBB\xBF<?xml version=\"1.0\"?>\n"
+        "<!-- comment <with> tags -->\n"
+        "<root a=\"1 &amp; 2\" b='x&lt;y&gt;' c=\"&#x41;\" a=\"3\">\n"
+        "  <child/>\n"
+        "  <child n=\" 42\" f=\"-1.5e2\" u=\"-1\" yes=\"true\"></child>\n"
+        "  <![CDATA[ <not-a-node/> ]]>\n"
+        "  <other><x/></other>\n"
+        "</root>\n"
+        "<second-root/>";
+    XMLNode *xml = createFromString(s);
+    std::string v;
+    assert(xml->getName() == "root");
+    assert(xml->getNumNodes() == 3);
+    assert(xml->get("a", &v) && v == "3");
+    assert(xml->get("b", &v) && v == "x<y>");
+    assert(xml->get("c", &v) && v == "&#x41;");
+    assert(!xml->get("d", &v));
+    core::stringw w;
+    assert(xml->getAndDecode("c", &w) && w == L"A");
+    const XMLNode *child = xml->getNode(1);
+    int i = 0;
+    float f = 0.0f;
+    uint32_t u = 0;
+    bool b = false;
+    assert(child->get("n", &i) && i == 42);
+    assert(child->get("f", &f) && f == -150.0f);
+    assert(child->get("yes", &b) && b);
+    assert(child->get("u", &u) == (int)StringUtils::parseString("-1", &u));
+    assert(xml->getNode("other")->getNumNodes() == 1);
+    assert(!xml->hasChildNamed("second-root"));
+    std::string binary;
+    xml->writeBinary(&binary);
+    const char *data = binary.data();
+    XMLNode *copy = createFromBinary("", &data, data + binary.size());
+    compareTrees(xml, copy);
+    delete copy;
+    delete xml;
+
+    std::vector<std::string> files;
+    files.push_back(file_manager->getAsset("stk_config.xml"));
+    files.push_back(file_manager->getAsset(FileManager::TEXTURE,
+                                           "materials.xml"));
+    for (unsigned int i = 0; i < kart_properties_manager->getNumberOfKarts();
+         i++)
+    {
+        const KartProperties *kp = kart_properties_manager->getKartById(i);
+        files.push_back(kp->getKartDir() + "kart.xml");
+    }
+    for (unsigned int i = 0; i < track_manager->getNumberOfTracks(); i++)
+    {
+        const Track *track = track_manager->getTrack(i);
+        files.push_back(track->getFilename());
+        std::string scene = StringUtils::getPath(track->getFilename())
+                          + "/scene.xml";
+        if (file_manager->fileExists(scene))
+            files.push_back(scene);
+    }
+
+    // Compare with irrlicht's reader, and measure both parsers
+    double parser_time = 0, irrlicht_time = 0;
+    for (unsigned int i = 0; i < files.size(); i++)
+    {
+        double start = StkTime::getRealTime();
+        XMLNode *xml = new XMLNode(files[i]);
+        double middle = StkTime::getRealTime();
+        io::IXMLReader *reader = file_manager->createXMLReader(files[i]);
+        XMLNode *old_xml = new XMLNode(reader);
+        reader->drop();
+        double end = StkTime::getRealTime();
+        parser_time   += middle - start;
+        irrlicht_time += end - middle;
+        compareTrees(xml, old_xml);
+        delete xml;
+        delete old_xml;
+    }
+    Log::info("XMLNode", "Parsed %d files in %f ms, irrlicht's reader "
+              "needs %f ms.", (int)files.size(), parser_time*1000.0,
+              irrlicht_time*1000.0);
+}   // unitTesting
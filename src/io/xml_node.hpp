@@ -41,21 +41,51 @@ class Vec3;
 
 /**
   * \brief utility class used to parse XML files
+  * A file is parsed in one go into a Document: the file is mapped into
+  * memory (or read if that is not possible), and all attribute names and
+  * values are kept as 0-terminated strings inside the file data (entities
+  * are replaced in place). The attributes of all nodes are stored in one
+  * flat array, and all nodes apart from the root in one array as well, so
+  * only a handful of allocations are needed per file. The typed get()
+  * functions parse the values directly from the file data.
+  * The root node owns the document, child nodes must not be deleted.
   * \ingroup io
   */
 class XMLNode : public NoCopy
 {
 private:
+    struct Document;
+    struct Builder;
+
+    /** One attribute of a node, name and value are 0-terminated. */
+    struct Attribute
+    {
+        const char *m_name;
+        const char *m_value;
+        size_t      m_value_length;
+    };   // Attribute
+
+    /** The document this node belongs to. */
+    Document                            *m_document;
     /** Name of this element. */
     std::string                          m_name;
-    /** List of all attributes. */
-    std::map<std::string, core::stringw> m_attributes;
-    /** List of all sub nodes. */
-    std::vector<XMLNode *>               m_nodes;
+    /** Index of the first attribute of this node in the document. */
+    unsigned int                         m_first_attribute;
+    /** Number of attributes of this node. */
+    unsigned int                         m_num_attributes;
+    /** Index of the first child of this node in the document. */
+    unsigned int                         m_first_child;
+    /** Number of children of this node. */
+    unsigned int                         m_num_children;
 
-    void readXML(io::IXMLReader *xml);
-
-    std::string                          m_file_name;
+         XMLNode();
+    void parseText(Builder *builder);
+    void readXML(Builder *builder, io::IXMLReader *xml, int node);
+    bool readBinary(Builder *builder, const char **data, const char *end,
+                    int node);
+    void createNodes(Builder *builder);
+    const Attribute *findAttribute(const std::string &name) const;
+    const std::string &getFileName() const;
 
 public:
          LEAK_CHECK();
@@ -66,11 +96,17 @@ public:
 
         ~XMLNode();
 
+    void writeBinary(std::string *out) const;
+    static XMLNode *createFromBinary(const std::string &file_name,
+                                     const char **data, const char *end);
+    static XMLNode *createFromString(const std::string &content);
+    static void unitTesting();
+
     const std::string &getName() const {return m_name; }
     const XMLNode     *getNode(const std::string &name) const;
     const void         getNodes(const std::string &s, std::vector<XMLNode*>& out) const;
     const XMLNode     *getNode(unsigned int i) const;
-    unsigned int       getNumNodes() const {return (unsigned int) m_nodes.size(); }
+    unsigned int       getNumNodes() const {return m_num_children; }
     int get(const std::string &attribute, std::string *value) const;
     int get(const std::string &attribute, core::stringw *value) const;
     int getAndDecode(const std::string &attribute, core::stringw *value) const;
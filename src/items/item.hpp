@@ -254,6 +254,9 @@ public:
     /** Returns the XYZ position of the item. */
     const Vec3&   getXYZ() const { return m_xyz; }
     // ------------------------------------------------------------------------
+    /** Returns the square of the distance at which a kart hits this item. */
+    float         getHitDistance2() const { return m_distance_2; }
+    // ------------------------------------------------------------------------
     /** Returns the index of the graph node this item is on. */
     int           getGraphNode() const { return m_graph_node; }
     // ------------------------------------------------------------------------
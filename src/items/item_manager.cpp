@@ -47,6 +47,18 @@ std::vector<scene::IMesh *> ItemManager::m_item_lowres_mesh;
 std::vector<video::SColorf> ItemManager::m_glow_color;
 ItemManager *               ItemManager::m_item_manager = NULL;
 
+/** Size of a cell of the item grid. Items whose hit distance is larger than
+ *  this are stored in m_large_items, so a kart can only hit items in its own
+ *  or an adjacent cell. */
+static const float ITEM_GRID_CELL_SIZE = 10.0f;
+
+// ----------------------------------------------------------------------------
+/** Sorts items by their index in the item manager. */
+static bool compareItemId(const Item *a, const Item *b)
+{
+    return a->getItemId() < b->getItemId();
+}   // compareItemId
+
 
 //-----------------------------------------------------------------------------
 /** Creates one instance of the item manager. */
@@ -234,8 +246,32 @@ void ItemManager::insertItem(Item *item)
         else  // otherwise store it in the 'outside' index
             (*m_items_in_quads)[m_items_in_quads->size()-1].push_back(item);
     }   // if m_items_in_quads
+
+    // And into the spatial hash
+    if(item->getHitDistance2() > ITEM_GRID_CELL_SIZE*ITEM_GRID_CELL_SIZE)
+    {
+        m_large_items.push_back(item);
+    }
+    else
+    {
+        int x, z;
+        getGridCell(item->getXYZ(), &x, &z);
+        m_item_grid[getGridKey(x, z)].push_back(item);
+    }
 }   // insertItem
 
+//-----------------------------------------------------------------------------
+/** Computes the coordinates of the cell of the item grid that contains
+ *  the given point.
+ *  \param xyz The point.
+ *  \param x, z On return the grid coordinates.
+ */
+void ItemManager::getGridCell(const Vec3 &xyz, int *x, int *z)
+{
+    *x = (int)floorf(xyz.getX() / ITEM_GRID_CELL_SIZE);
+    *z = (int)floorf(xyz.getZ() / ITEM_GRID_CELL_SIZE);
+}   // getGridCell
+
 //-----------------------------------------------------------------------------
 /** Creates a new item.
  *  \param type Type of the item.
@@ -307,37 +343,110 @@ void ItemManager::collectedItem(Item *item, AbstractKart *kart, int add_info)
  */
 void  ItemManager::checkItemHit(AbstractKart* kart)
 {
-    // We could use m_items_in_quads to to check for item hits: take the quad
-    // of the graph node of the kart, and only check items in that quad. But
-    // then we also need to check for any adjacent quads (since an item just
-    // on the order of one quad might get hit from an adjacent quad). Then
-    // it is possible that a quad is that short that we need to test adjacent
-    // of adjacent quads. And check for items outside of the track.
-    // Since at this stace item detection is by far not a bottle neck,
-    // the original, simple and stable algorithm is left in place.
+    // Only the items in the cell of the kart and the adjacent cells can
+    // be hit, since the hit distance of all items in the grid is less
+    // than the size of a cell.
+    int kart_x, kart_z;
+    getGridCell(kart->getXYZ(), &kart_x, &kart_z);
+    AllItemTypes candidates;
+    for(int z=kart_z-1; z<=kart_z+1; z++)
+    {
+        for(int x=kart_x-1; x<=kart_x+1; x++)
+        {
+            std::unordered_map<uint64_t, AllItemTypes>::const_iterator cell =
+                m_item_grid.find(getGridKey(x, z));
+            if(cell==m_item_grid.end()) continue;
+            candidates.insert(candidates.end(), cell->second.begin(),
+                              cell->second.end());
+        }
+    }
+    candidates.insert(candidates.end(), m_large_items.begin(),
+                      m_large_items.end());
+
+    // Test the items in the order of their index, as the original linear
+    // search did, so that the result does not depend on the grid.
+    std::sort(candidates.begin(), candidates.end(), compareItemId);
+    for(unsigned int i=0; i<candidates.size(); i++)
+        testItemHit(candidates[i], kart);
+}   // checkItemHit
 
-    for(AllItemTypes::iterator i =m_all_items.begin();
-        i!=m_all_items.end();  i++)
+//-----------------------------------------------------------------------------
+/** Checks if a kart hits the given item, and if so collects it.
+ *  \param item The item to test.
+ *  \param kart The kart to test.
+ */
+void ItemManager::testItemHit(Item *item, AbstractKart *kart)
+{
+    if(item->wasCollected()) return;
+    // To allow inlining and avoid including kart.hpp in item.hpp,
+    // we pass the kart and the position separately.
+    if(item->hitKart(kart->getXYZ(), kart))
     {
-        if((!*i) || (*i)->wasCollected()) continue;
-        // To allow inlining and avoid including kart.hpp in item.hpp,
-        // we pass the kart and the position separately.
-        if((*i)->hitKart(kart->getXYZ(), kart))
+        // if we're not playing online, pick the item.
+        if (!RaceEventManager::getInstance()->isRunning())
+            collectedItem(item, kart);
+        else if (NetworkConfig::get()->isServer())
         {
-            // if we're not playing online, pick the item.
-            if (!RaceEventManager::getInstance()->isRunning())
-                collectedItem(*i, kart);
-            else if (NetworkConfig::get()->isServer())
+            // Only the server side detects item being collected
+            // A client does the collection upon receiving the 
+            // event from the server!
+            collectedItem(item, kart);
+            RaceEventManager::getInstance()->collectedItem(item, kart);
+        }
+    }   // if hit
+}   // testItemHit
+
+//-----------------------------------------------------------------------------
+/** Returns all items whose position is within the given distance of a
+ *  point, measured in the XZ plane only.
+ *  \param xyz The point.
+ *  \param radius The maximum distance.
+ *  \param items On return contains the items found (in no specific order).
+ */
+void ItemManager::getItemsInRadius(const Vec3 &xyz, float radius,
+                                   std::vector<Item*> *items) const
+{
+    items->clear();
+    const float radius_2 = radius*radius;
+    int min_x, min_z, max_x, max_z;
+    getGridCell(xyz - Vec3(radius, 0, radius), &min_x, &min_z);
+    getGridCell(xyz + Vec3(radius, 0, radius), &max_x, &max_z);
+
+    std::vector<const AllItemTypes*> cells;
+    // If the radius covers more cells than are in use, it is faster to
+    // test all cells than to look up each cell in range.
+    if((float)(max_x-min_x+1)*(float)(max_z-min_z+1) > m_item_grid.size())
+    {
+        std::unordered_map<uint64_t, AllItemTypes>::const_iterator cell;
+        for(cell=m_item_grid.begin(); cell!=m_item_grid.end(); cell++)
+            cells.push_back(&cell->second);
+    }
+    else
+    {
+        for(int z=min_z; z<=max_z; z++)
+        {
+            for(int x=min_x; x<=max_x; x++)
             {
-                // Only the server side detects item being collected
-                // A client does the collection upon receiving the 
-                // event from the server!
-                collectedItem(*i, kart);
-                RaceEventManager::getInstance()->collectedItem(*i, kart);
+                std::unordered_map<uint64_t, AllItemTypes>::const_iterator
+                    cell = m_item_grid.find(getGridKey(x, z));
+                if(cell!=m_item_grid.end())
+                    cells.push_back(&cell->second);
             }
-        }   // if hit
-    }   // for m_all_items
-}   // checkItemHit
+        }
+    }
+    cells.push_back(&m_large_items);
+
+    for(unsigned int i=0; i<cells.size(); i++)
+    {
+        for(unsigned int j=0; j<cells[i]->size(); j++)
+        {
+            Item *item = (*cells[i])[j];
+            const Vec3 d = item->getXYZ() - xyz;
+            if(d.getX()*d.getX() + d.getZ()*d.getZ() <= radius_2)
+                items->push_back(item);
+        }
+    }
+}   // getItemsInRadius
 
 //-----------------------------------------------------------------------------
 /** Resets all items and removes bubble gum that is stuck on the track.
@@ -438,6 +547,29 @@ void ItemManager::deleteItem(Item *item)
         items.erase(it);
     }   // if m_items_in_quads
 
+    // Then remove it from the spatial hash
+    if(item->getHitDistance2() > ITEM_GRID_CELL_SIZE*ITEM_GRID_CELL_SIZE)
+    {
+        AllItemTypes::iterator it = std::find(m_large_items.begin(),
+                                              m_large_items.end(), item);
+        assert(it!=m_large_items.end());
+        m_large_items.erase(it);
+    }
+    else
+    {
+        int x, z;
+        getGridCell(item->getXYZ(), &x, &z);
+        std::unordered_map<uint64_t, AllItemTypes>::iterator cell =
+            m_item_grid.find(getGridKey(x, z));
+        assert(cell!=m_item_grid.end());
+        AllItemTypes::iterator it = std::find(cell->second.begin(),
+                                              cell->second.end(), item);
+        assert(it!=cell->second.end());
+        cell->second.erase(it);
+        if(cell->second.empty())
+            m_item_grid.erase(cell);
+    }
+
     int index = item->getItemId();
     m_all_items[index] = NULL;
     delete item;
@@ -24,12 +24,14 @@
 #include "items/item.hpp"
 #include "utils/aligned_array.hpp"
 #include "utils/no_copy.hpp"
+#include "utils/types.hpp"
 
 #include <SColor.h>
 
 #include <assert.h>
 #include <map>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 class Kart;
@@ -85,6 +87,19 @@ private:
      *  field is undefined if no Graph exist, e.g. arena without navmesh. */
     std::vector< AllItemTypes > *m_items_in_quads;
 
+    /** A spatial hash of all items: the XZ plane is divided into square
+     *  cells, and each cell (indexed by getGridKey) stores the items whose
+     *  position is in it. Items do not move (switching only changes their
+     *  type), so an item is only added in insertItem and removed in
+     *  deleteItem. Unlike m_items_in_quads this is also available if
+     *  there is no graph. */
+    std::unordered_map<uint64_t, AllItemTypes> m_item_grid;
+
+    /** Items with a hit distance larger than a grid cell (e.g. trigger
+     *  items with a large radius). These are not stored in m_item_grid,
+     *  they are always tested. */
+    AllItemTypes m_large_items;
+
     /** What item this item is switched to. */
     std::vector<Item::ItemType> m_switch_to;
 
@@ -94,6 +109,14 @@ private:
 
     void  insertItem(Item *item);
     void  deleteItem(Item *item);
+    void  testItemHit(Item *item, AbstractKart *kart);
+    static void getGridCell(const Vec3 &xyz, int *x, int *z);
+    // ------------------------------------------------------------------------
+    /** Returns the key of a cell in m_item_grid. */
+    static uint64_t getGridKey(int x, int z)
+    {
+        return ((uint64_t)(uint32_t)x << 32) | (uint32_t)z;
+    }   // getGridKey
 
     // Make those private so only create/destroy functions can call them.
                    ItemManager();
@@ -112,6 +135,8 @@ public:
     void           collectedItem   (Item *item, AbstractKart *kart,
                                     int add_info=-1);
     void           switchItems     ();
+    void           getItemsInRadius(const Vec3 &xyz, float radius,
+                                    std::vector<Item*> *items) const;
     // ------------------------------------------------------------------------
     bool           randomItemsForArena(const AlignedArray<btTransform>& pos);
     // ------------------------------------------------------------------------
@@ -77,8 +77,10 @@ RubberBand::RubberBand(Plunger *plunger, AbstractKart *kart)
     updatePosition();
     m_node = irr_driver->addMesh(m_mesh, "rubberband");
     irr_driver->applyObjectPassShader(m_node);
+#ifndef SERVER_ONLY
     if (STKMeshSceneNode *stkm = dynamic_cast<STKMeshSceneNode *>(m_node))
         stkm->setReloadEachFrame(true);
+#endif
 #ifdef DEBUG
     std::string debug_name = m_owner->getIdent()+" (rubber-band)";
     m_node->setName(debug_name.c_str());
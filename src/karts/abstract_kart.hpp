@@ -398,6 +398,14 @@ public:
      *  over. */
     virtual void startEngineSFX() = 0;
     // ------------------------------------------------------------------------
+    /** Called for all karts in each time step before any kart is updated,
+     *  to take the new state from the physics. */
+    virtual void preUpdate(float dt) = 0;
+    // ------------------------------------------------------------------------
+    /** Called for all karts (possibly in parallel) after preUpdate(), to do
+     *  the terrain raycast for the following update() in advance. */
+    virtual void prepareTerrainInfo() = 0;
+    // ------------------------------------------------------------------------
     /** This method is to be called every time the mass of the kart is updated,
      *  which includes attaching an anvil to the kart (and detaching). */
     virtual void updateWeight() = 0;
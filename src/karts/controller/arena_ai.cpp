@@ -26,8 +26,10 @@
 #include "karts/controller/ai_properties.hpp"
 #include "karts/kart_properties.hpp"
 #include "karts/rescue_animation.hpp"
+#include "modes/world.hpp"
 #include "tracks/arena_graph.hpp"
 #include "tracks/arena_node.hpp"
+#include "tracks/track.hpp"
 
 #include <algorithm>
 
@@ -591,30 +593,54 @@ void ArenaAI::tryCollectItem(Vec3* aim_point, int* target_node) const
         return;
     }
 
-    for (unsigned int i = 0; i < m_graph->getNumNodes(); i++)
-    {
-        Item* cur_item = ItemManager::get()->getFirstItemInQuad(i);
-        if (cur_item == NULL) continue;
-        if (cur_item->wasCollected() ||
-            cur_item->getType() == Item::ITEM_BANANA ||
-            cur_item->getType() == Item::ITEM_BUBBLEGUM ||
-            cur_item->getType() == Item::ITEM_BUBBLEGUM_NOLOK)
-            continue;
-
-        if ((cur_item->getType() == Item::ITEM_NITRO_BIG ||
-             cur_item->getType() == Item::ITEM_NITRO_SMALL) &&
-            (m_kart->getEnergy() >
-             m_kart->getKartProperties()->getNitroSmallContainer()))
-                continue; // Ignore nitro when already has some
-
-        const int cur_node = cur_item->getGraphNode();
-        assert(cur_node != Graph::UNKNOWN_SECTOR);
-        float test_distance = m_graph->getDistance(cur_node, getCurrentNode());
-        if (test_distance <= distance)
+    // Search the items around the kart with an increasing radius. The
+    // distance on the graph is at least the straight distance between the
+    // node centers, so once the closest item found is well inside the
+    // search radius, no item outside of it can be closer.
+    const Vec3& center = m_graph->getNode(getCurrentNode())->getCenter();
+    const Vec3 *aabb_min, *aabb_max;
+    World::getWorld()->getTrack()->getAABB(&aabb_min, &aabb_max);
+    const float max_radius = (*aabb_max - *aabb_min).length();
+    // Allows for items not being at the center of their node.
+    const float node_margin = 5.0f;
+    std::vector<Item*> items;
+    for (float radius = 30.0f; ; radius *= 2.0f)
+    {
+        ItemManager::get()->getItemsInRadius(center, radius, &items);
+        selected = NULL;
+        distance = 999999.9f;
+        for (unsigned int i = 0; i < items.size(); i++)
         {
-            selected = cur_item;
-            distance = test_distance;
+            Item* cur_item = items[i];
+            if (cur_item->wasCollected() ||
+                cur_item->getType() == Item::ITEM_BANANA ||
+                cur_item->getType() == Item::ITEM_BUBBLEGUM ||
+                cur_item->getType() == Item::ITEM_BUBBLEGUM_NOLOK)
+                continue;
+
+            if ((cur_item->getType() == Item::ITEM_NITRO_BIG ||
+                 cur_item->getType() == Item::ITEM_NITRO_SMALL) &&
+                (m_kart->getEnergy() >
+                 m_kart->getKartProperties()->getNitroSmallContainer()))
+                    continue; // Ignore nitro when already has some
+
+            const int cur_node = cur_item->getGraphNode();
+            if (cur_node == Graph::UNKNOWN_SECTOR) continue;
+            float test_distance = m_graph->getDistance(cur_node,
+                                                       getCurrentNode());
+            // Use the item index to break ties, so the result does not
+            // depend on the order in which items are returned.
+            if (test_distance < distance ||
+                (selected && test_distance == distance &&
+                 cur_item->getItemId() > selected->getItemId()))
+            {
+                selected = cur_item;
+                distance = test_distance;
+            }
         }
+        if ((selected && distance + node_margin <= radius) ||
+            radius > max_radius)
+            break;
     }
 
     if (selected != NULL)
@@ -94,6 +94,13 @@ public:
     /** Called whan this controller's kart finishes the last lap. */
     virtual void  finishedRace(float time) = 0;
     // ------------------------------------------------------------------------
+    /** Called for all controllers before any kart is updated, to compute
+     *  the decisions that are then applied in update(). This is called from
+     *  worker threads at the same time for different karts, so it must only
+     *  read the state of the world and only modify data of this controller
+     *  (e.g. no random numbers, no items used). */
+    virtual void  prepareUpdate(float dt) {}
+    // ------------------------------------------------------------------------
     /** Get a pointer on the kart controls. */
     virtual KartControl* getControls() { return m_controls; }
     // ------------------------------------------------------------------------
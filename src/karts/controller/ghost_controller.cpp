@@ -71,9 +71,10 @@ void GhostController::update(float dt)
 //-----------------------------------------------------------------------------
 void GhostController::addReplayTime(float time)
 {
-    // FIXME: for now avoid that transforms for the same time are set
-    // twice (to avoid division by zero in update). This should be
-    // done when saving in replay
+    // Events with the same time are dropped when a replay is saved (and
+    // when an old text replay, which can still contain them, is converted).
+    // Keep checking here anyway, since two equal times would cause a
+    // division by zero in update().
     if (m_all_times.size() > 0 && m_all_times.back() == time)
         return;
     m_all_times.push_back(time);
@@ -177,6 +177,7 @@ void SkiddingAI::reset()
     m_avoid_item_close           = false;
     m_skid_probability_state     = SKID_PROBAB_NOT_YET;
     m_last_item_random           = NULL;
+    m_decisions_prepared         = false;
 
     AIBaseLapController::reset();
     m_track_node               = Graph::UNKNOWN_SECTOR;
@@ -215,6 +216,33 @@ unsigned int SkiddingAI::getNextSector(unsigned int index)
     return m_successor_index[index];
 }   // getNextSector
 
+//-----------------------------------------------------------------------------
+/** Computes the information about the world that the AI needs in update():
+ *  the nearest karts, possible crashes, the direction of the track and the
+ *  point to aim at. These are the expensive parts of the AI, and they only
+ *  read the world state, so this is done for all AI karts in parallel
+ *  before any kart is updated.
+ *  \param dt Time step size.
+ */
+void SkiddingAI::prepareUpdate(float dt)
+{
+    m_decisions_prepared = false;
+#if defined(AI_DEBUG) || defined(AI_DEBUG_KART_HEADING) || \
+    defined(AI_DEBUG_NEW_FIND_NON_CRASHING)
+    // The debug output modifies scene nodes, which must only be done from
+    // the main thread, so compute everything in update().
+    return;
+#endif
+    if(m_kart->getKartAnimation() || m_world->isStartPhase())
+        return;
+
+    computeNearestKarts();
+    checkCrashes(m_kart->getXYZ());
+    determineTrackDirection();
+    findAimPoint(&m_prepared_aim_point, &m_prepared_aim_node);
+    m_decisions_prepared = true;
+}   // prepareUpdate
+
 //-----------------------------------------------------------------------------
 /** This is the main entry point for the AI.
  *  It is called once per frame for each AI and determines the behaviour of
@@ -306,15 +334,19 @@ void SkiddingAI::update(float dt)
         return;
     }
 
-    // Get information that is needed by more than 1 of the handling funcs
-    computeNearestKarts();
+    // Get information that is needed by more than 1 of the handling funcs.
+    // This is usually already done in prepareUpdate().
+    if(!m_decisions_prepared)
+    {
+        computeNearestKarts();
+        //Detect if we are going to crash with the track and/or kart
+        checkCrashes(m_kart->getXYZ());
+        determineTrackDirection();
+    }
 
     m_kart->setSlowdown(MaxSpeed::MS_DECREASE_AI,
                         m_ai_properties->getSpeedCap(m_distance_to_player),
                         /*fade_in_time*/0.0f);
-    //Detect if we are going to crash with the track and/or kart
-    checkCrashes(m_kart->getXYZ());
-    determineTrackDirection();
 
     // Special behaviour if we have a bomb attach: try to hit the kart ahead
     // of us.
@@ -533,15 +565,13 @@ void SkiddingAI::handleSteering(float dt)
         Vec3 aim_point;
         int last_node = Graph::UNKNOWN_SECTOR;
 
-        switch(m_point_selection_algorithm)
+        if(m_decisions_prepared)
         {
-        case PSA_FIXED : findNonCrashingPointFixed(&aim_point, &last_node);
-                         break;
-        case PSA_NEW:    findNonCrashingPointNew(&aim_point, &last_node);
-                         break;
-        case PSA_DEFAULT:findNonCrashingPoint(&aim_point, &last_node);
-                         break;
+            aim_point = m_prepared_aim_point;
+            last_node = m_prepared_aim_node;
         }
+        else
+            findAimPoint(&aim_point, &last_node);
 #ifdef AI_DEBUG
         m_debug_sphere[m_point_selection_algorithm]->setPosition(aim_point.toIrrVector());
 #endif
@@ -2097,6 +2127,24 @@ void SkiddingAI::findNonCrashingPointFixed(Vec3 *aim_position, int *last_node)
     *aim_position = DriveGraph::get()->getNode(*last_node)->getCenter();
 }   // findNonCrashingPoint
 
+//-----------------------------------------------------------------------------
+/** Finds the point to aim at using the selected point selection algorithm.
+ *  \param aim_point On exit contains the point the AI should aim at.
+ *  \param last_node On exit contains the graph node the AI is aiming at.
+ */
+void SkiddingAI::findAimPoint(Vec3 *aim_point, int *last_node)
+{
+    switch(m_point_selection_algorithm)
+    {
+    case PSA_FIXED : findNonCrashingPointFixed(aim_point, last_node);
+                     break;
+    case PSA_NEW:    findNonCrashingPointNew(aim_point, last_node);
+                     break;
+    case PSA_DEFAULT:findNonCrashingPoint(aim_point, last_node);
+                     break;
+    }
+}   // findAimPoint
+
 //-----------------------------------------------------------------------------
 /** Determines the direction of the track ahead of the kart: 0 indicates
  *  straight, +1 right turn, -1 left turn.
@@ -220,6 +220,16 @@ private:
     enum {PSA_DEFAULT, PSA_FIXED, PSA_NEW}
           m_point_selection_algorithm;
 
+    /** True if prepareUpdate() has computed the nearest karts, crashes,
+     *  track direction and aim point for the next call to update(). */
+    bool m_decisions_prepared;
+
+    /** The point to aim at as computed in prepareUpdate(). */
+    Vec3 m_prepared_aim_point;
+
+    /** The graph node of m_prepared_aim_point. */
+    int  m_prepared_aim_node;
+
 #ifdef AI_DEBUG
     /** For skidding debugging: shows the estimated turn shape. */
     ShowCurve **m_curve;
@@ -263,6 +273,7 @@ private:
     void  findNonCrashingPointFixed(Vec3 *result, int *last_node);
     void  findNonCrashingPointNew(Vec3 *result, int *last_node);
     void  findNonCrashingPoint(Vec3 *result, int *last_node);
+    void  findAimPoint(Vec3 *aim_point, int *last_node);
 
     void  determineTrackDirection();
     virtual bool canSkid(float steer_fraction);
@@ -276,6 +287,7 @@ public:
                  SkiddingAI(AbstractKart *kart);
                 ~SkiddingAI();
     virtual void update      (float delta) ;
+    virtual void prepareUpdate(float dt);
     virtual void reset       ();
     virtual const irr::core::stringw& getNamePostfix() const;
 };
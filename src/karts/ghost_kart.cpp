@@ -31,6 +31,7 @@ GhostKart::GhostKart(const std::string& ident, unsigned int world_kart_id,
                  position, btTransform(btQuaternion(0, 0, 0, 1)),
                  PLAYER_DIFFICULTY_NORMAL, KRT_TRANSPARENT)
 {
+    m_first_frame = 0;
 }   // GhostKart
 
 // ----------------------------------------------------------------------------
@@ -43,29 +44,69 @@ void GhostKart::reset()
 }   // reset
 
 // ----------------------------------------------------------------------------
-void GhostKart::addReplayEvent(float time,
-                               const btTransform &trans,
-                               const ReplayBase::PhysicInfo &pi,
-                               const ReplayBase::KartReplayEvent &kre)
+/** Opens the replay file from which the events of this kart are read.
+ *  \param filename Full path of the (binary) replay file.
+ *  \param kart Index of this kart in the replay file.
+ *  \return False if the replay file could not be read.
+ */
+bool GhostKart::loadReplay(const std::string &filename, unsigned int kart)
 {
+    if (!m_replay_reader.open(filename, kart) ||
+        m_replay_reader.getNumEvents() < 2)
+        return false;
+
     GhostController* gc = dynamic_cast<GhostController*>(getController());
-    gc->addReplayTime(time);
+    const std::vector<float> &times = m_replay_reader.getTimes();
+    for (unsigned int i = 0; i < times.size(); i++)
+        gc->addReplayTime(times[i]);
 
-    m_all_transform.push_back(trans);
-    m_all_physic_info.push_back(pi);
-    m_all_replay_events.push_back(kre);
+    m_frames.clear();
+    m_first_frame = 0;
+    updateFrames(0);
+    if (m_frames.empty())
+        return false;
 
     // Use first frame of replay to calculate default suspension
-    if (m_all_physic_info.size() == 1)
+    m_first_physic_info = m_frames[0].m_physic_info;
+    float f = 0;
+    for (int i = 0; i < 4; i++)
+        f += m_first_physic_info.m_suspension_length[i];
+    m_graphical_y_offset = -f / 4 + getKartModel()->getLowestPoint();
+    m_kart_model->setDefaultSuspension();
+    return true;
+}   // loadReplay
+
+// ----------------------------------------------------------------------------
+/** Makes sure that the events idx and idx+1 are in memory, reading new
+ *  events from the replay file as needed, and discards older events.
+ *  \param idx Index of the current event.
+ */
+void GhostKart::updateFrames(unsigned int idx)
+{
+    // Going back in time (e.g. on restart) requires to read from the start
+    if (idx < m_first_frame)
+    {
+        m_replay_reader.rewind();
+        m_frames.clear();
+        m_first_frame = 0;
+    }
+
+    while (m_first_frame + m_frames.size() < idx + 2)
     {
-        float f = 0;
-        for (int i = 0; i < 4; i++)
-            f += m_all_physic_info[0].m_suspension_length[i];
-        m_graphical_y_offset = -f / 4 + getKartModel()->getLowestPoint();
-        m_kart_model->setDefaultSuspension();
+        ReplayFrame frame;
+        if (!m_replay_reader.readEvent(&frame.m_transform,
+                                       &frame.m_physic_info,
+                                       &frame.m_kart_replay_event))
+            break;
+        m_frames.push_back(frame);
     }
 
-}   // addReplayEvent
+    while (m_first_frame < idx && m_frames.size() > 1)
+    {
+        m_frames.pop_front();
+        m_first_frame++;
+    }
+}   // updateFrames
 
 // ----------------------------------------------------------------------------
 /** Updates the current event of the ghost kart using interpolation
@@ -77,14 +118,17 @@ void GhostKart::update(float dt)
     if (gc == NULL) return;
 
     gc->update(dt);
-    if (gc->isReplayEnd())
+    const unsigned int idx = gc->getCurrentReplayIndex();
+    if (!gc->isReplayEnd())
+        updateFrames(idx);
+    // Also stop if the replay file could not be read
+    if (gc->isReplayEnd() || !hasFrame(idx + 1))
     {
         m_node->setVisible(false);
         getKartGFX()->setGFXInvisible();
         return;
     }
 
-    const unsigned int idx = gc->getCurrentReplayIndex();
     if (!race_manager->isWatchingReplay())
     {
         if (idx == 0)
@@ -98,14 +142,15 @@ void GhostKart::update(float dt)
         }
     }
 
+    const ReplayFrame &frame = getFrame(idx);
+    const btTransform &next  = getFrame(idx + 1).m_transform.m_transform;
     const float rd         = gc->getReplayDelta();
-    assert(idx < m_all_transform.size());
 
-    setXYZ((1- rd)*m_all_transform[idx    ].getOrigin()
-           +  rd  *m_all_transform[idx + 1].getOrigin() );
+    setXYZ((1- rd)*frame.m_transform.m_transform.getOrigin()
+           +  rd  *next.getOrigin() );
 
-    const btQuaternion q = m_all_transform[idx].getRotation()
-        .slerp(m_all_transform[idx + 1].getRotation(), rd);
+    const btQuaternion q = frame.m_transform.m_transform.getRotation()
+        .slerp(next.getRotation(), rd);
     setRotation(q);
 
     Vec3 center_shift(0, 0, 0);
@@ -114,25 +159,24 @@ void GhostKart::update(float dt)
 
     Moveable::updateGraphics(dt, center_shift, btQuaternion(0, 0, 0, 1));
     Moveable::updatePosition();
-    getKartModel()->update(dt, dt*(m_all_physic_info[idx].m_speed),
-        m_all_physic_info[idx].m_steer, m_all_physic_info[idx].m_speed,
+    const ReplayBase::PhysicInfo &pi = frame.m_physic_info;
+    getKartModel()->update(dt, dt*(pi.m_speed), pi.m_steer, pi.m_speed,
         /*lean*/0.0f, idx);
 
-    getKartGFX()->setGFXFromReplay(m_all_replay_events[idx].m_nitro_usage,
-        m_all_replay_events[idx].m_zipper_usage,
-        m_all_replay_events[idx].m_skidding_state,
-        m_all_replay_events[idx].m_red_skidding);
+    const ReplayBase::KartReplayEvent &kre = frame.m_kart_replay_event;
+    getKartGFX()->setGFXFromReplay(kre.m_nitro_usage, kre.m_zipper_usage,
+        kre.m_skidding_state, kre.m_red_skidding);
     getKartGFX()->update(dt);
 
     Vec3 front(0, 0, getKartLength()*0.5f);
     m_xyz_front = getTrans()(front);
 
-    if (m_all_replay_events[idx].m_jumping && !m_is_jumping)
+    if (kre.m_jumping && !m_is_jumping)
     {
         m_is_jumping = true;
         getKartModel()->setAnimation(KartModel::AF_JUMP_START);
     }
-    else if (!m_all_replay_events[idx].m_jumping && m_is_jumping)
+    else if (!kre.m_jumping && m_is_jumping)
     {
         m_is_jumping = false;
         getKartModel()->setAnimation(KartModel::AF_DEFAULT);
@@ -147,6 +191,6 @@ float GhostKart::getSpeed() const
     const GhostController* gc =
         dynamic_cast<const GhostController*>(getController());
 
-    assert(gc->getCurrentReplayIndex() < m_all_physic_info.size());
-    return m_all_physic_info[gc->getCurrentReplayIndex()].m_speed;
+    const unsigned int idx = gc->getCurrentReplayIndex();
+    return hasFrame(idx) ? getFrame(idx).m_physic_info.m_speed : 0.0f;
 }   // getSpeed
@@ -21,27 +21,58 @@
 
 #include "karts/kart.hpp"
 #include "replay/replay_base.hpp"
+#include "replay/replay_stream.hpp"
 
 #include "LinearMath/btTransform.h"
 
-#include <vector>
+#include <deque>
 
 /** \defgroup karts */
 
 /** A ghost kart. It does not have a phsyics representation. It gets two
  *  transforms from the replay objects at two consecutive time steps,
  *  and will interpolate between those positions depending on the current
- *  time
+ *  time. The events are streamed from the replay file, so only the events
+ *  around the current time are kept in memory.
  */
 class GhostKart : public Kart
 {
 private:
-    /** The transforms to assume at the corresponding time in m_all_times. */
-    std::vector<btTransform>                 m_all_transform;
+    /** One event of the replay. */
+    struct ReplayFrame
+    {
+        ReplayBase::TransformEvent  m_transform;
+        ReplayBase::PhysicInfo      m_physic_info;
+        ReplayBase::KartReplayEvent m_kart_replay_event;
+    };   // ReplayFrame
 
-    std::vector<ReplayBase::PhysicInfo>      m_all_physic_info;
+    /** Reads the events of this kart from the replay file. */
+    ReplayStreamReader      m_replay_reader;
 
-    std::vector<ReplayBase::KartReplayEvent> m_all_replay_events;
+    /** The events currently in memory, starting with m_first_frame. */
+    std::deque<ReplayFrame> m_frames;
+
+    /** Index of the first event in m_frames. */
+    unsigned int            m_first_frame;
+
+    /** The physic info of the first event, which is used to compute the
+     *  default suspension. */
+    ReplayBase::PhysicInfo  m_first_physic_info;
+
+    void               updateFrames(unsigned int idx);
+    // ------------------------------------------------------------------------
+    /** Returns true if the event with the given index is in memory. */
+    bool               hasFrame(unsigned int idx) const
+    {
+        return idx >= m_first_frame && idx - m_first_frame < m_frames.size();
+    }   // hasFrame
+    // ------------------------------------------------------------------------
+    /** Returns an event that is currently in memory. */
+    const ReplayFrame& getFrame(unsigned int idx) const
+    {
+        assert(hasFrame(idx));
+        return m_frames[idx - m_first_frame];
+    }   // getFrame
 
 public:
                   GhostKart(const std::string& ident,
@@ -49,6 +80,12 @@ public:
     virtual void  update (float dt);
     virtual void  reset();
     // ------------------------------------------------------------------------
+    /** No physics for ghost kart, the state is set in update(). */
+    virtual void  preUpdate(float dt) {};
+    // ------------------------------------------------------------------------
+    /** No terrain raycast needed for ghost karts. */
+    virtual void  prepareTerrainInfo() {};
+    // ------------------------------------------------------------------------
     /** No physics body for ghost kart, so nothing to adjust. */
     virtual void  updateWeight() {};
     // ------------------------------------------------------------------------
@@ -59,12 +96,13 @@ public:
     virtual void  createPhysics() {};
     // ------------------------------------------------------------------------
     const float   getSuspensionLength(int index, int wheel) const
-               { return m_all_physic_info[index].m_suspension_length[wheel]; }
+    {
+        if (index == 0)
+            return m_first_physic_info.m_suspension_length[wheel];
+        return getFrame(index).m_physic_info.m_suspension_length[wheel];
+    }   // getSuspensionLength
     // ------------------------------------------------------------------------
-    void          addReplayEvent(float time,
-                                 const btTransform &trans,
-                                 const ReplayBase::PhysicInfo &pi,
-                                 const ReplayBase::KartReplayEvent &kre);
+    bool          loadReplay(const std::string &filename, unsigned int kart);
     // ------------------------------------------------------------------------
     /** Returns whether this kart is a ghost (replay) kart. */
     virtual bool  isGhostKart() const                         { return true; }
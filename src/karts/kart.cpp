@@ -31,6 +31,7 @@
 #include "graphics/central_settings.hpp"
 #include "graphics/explosion.hpp"
 #include "graphics/irr_driver.hpp"
+#include "graphics/material.hpp"
 #include "graphics/material_manager.hpp"
 #include "graphics/particle_emitter.hpp"
 #include "graphics/particle_kind.hpp"
@@ -49,7 +50,6 @@
 #include "items/projectile_manager.hpp"
 #include "karts/abstract_characteristic.hpp"
 #include "karts/abstract_kart_animation.hpp"
-#include "karts/cached_characteristic.hpp"
 #include "karts/controller/end_controller.hpp"
 #include "karts/controller/spare_tire_ai.hpp"
 #include "karts/explosion_animation.hpp"
@@ -1031,7 +1031,8 @@ void Kart::collectedItem(Item *item, int add_info)
 float Kart::getStartupBoost() const
 {
     float t = World::getWorld()->getTimeSinceStart();
-    std::vector<float> startup_times = m_kart_properties->getStartupTime();
+    const std::vector<float> &startup_times =
+                                       m_kart_properties->getStartupTime();
     for (unsigned int i = 0; i < startup_times.size(); i++)
     {
         if (t <= startup_times[i])
@@ -1175,11 +1176,12 @@ void Kart::eliminate()
 }   // eliminate
 
 //-----------------------------------------------------------------------------
-/** Updates the kart in each time step. It updates the physics setting,
- *  particle effects, camera position, etc.
+/** First part of the update of a kart, which is done for all karts before
+ *  any controller makes its decisions: it takes the new position and speed
+ *  from the physics, and updates timers that only affect this kart.
  *  \param dt Time step size.
  */
-void Kart::update(float dt)
+void Kart::preUpdate(float dt)
 {
     // Reset any instand speed increase in the bullet kart
     m_vehicle->resetInstantSpeed();
@@ -1223,7 +1225,61 @@ void Kart::update(float dt)
     // Update the locally maintained speed of the kart (m_speed), which 
     // is used furthermore for engine power, camera distance etc
     updateSpeed();
+}   // preUpdate
 
+//-----------------------------------------------------------------------------
+/** Returns the start point of the raycast that detects the terrain under
+ *  the kart.
+ */
+Vec3 Kart::getTerrainRayOrigin() const
+{
+    // After the physics step was done, the position of the wheels (as stored
+    // in wheelInfo) is actually outdated, since the chassis was moved
+    // according to the force acting from the wheels. So the center of the
+    // chassis is not at the center of the wheels anymore, it is somewhat
+    // moved forward (depending on speed and fps). In very extreme cases
+    // (see bug 2246) the center of the chassis can actually be ahead of the
+    // front wheels. So if we do a raycast to detect the terrain from the
+    // current chassis, that raycast might be ahead of the wheels - which
+    // results in incorrect rescues (the wheels are still on the ground,
+    // but the raycast happens ahead of the front wheels and are over
+    // a rescue texture).
+    // To avoid this problem, we do the raycast for terrain detection from
+    // the center of the 4 wheel positions (in world coordinates).
+
+    Vec3 from(0, 0, 0);
+    for (unsigned int i = 0; i < 4; i++)
+        from += m_vehicle->getWheelInfo(i).m_raycastInfo.m_hardPointWS;
+
+    // Add a certain epsilon (0.3) to the height of the kart. This avoids
+    // problems of the ray being cast from under the track (which happened
+    // e.g. on tux tollway when jumping down from the ramp, when the chassis
+    // partly tunnels through the track). While tunneling should not be
+    // happening (since Z velocity is clamped), the epsilon is left in place
+    // just to be on the safe side (it will not hit the chassis itself).
+    return from/4 + (getTrans().getBasis() * Vec3(0,0.3f,0));
+}   // getTerrainRayOrigin
+
+//-----------------------------------------------------------------------------
+/** Does the terrain raycast for the next update() in advance. This is
+ *  called for all karts in parallel after preUpdate(), and only reads the
+ *  state of the physics and the track. If the kart should be moved before
+ *  update() is called, update() will do the raycast again.
+ */
+void Kart::prepareTerrainInfo()
+{
+    m_terrain_info->prepareUpdate(getTrans().getBasis(),
+                                  getTerrainRayOrigin());
+}   // prepareTerrainInfo
+
+//-----------------------------------------------------------------------------
+/** Updates the kart in each time step. It updates the physics setting,
+ *  particle effects, camera position, etc. preUpdate() must have been called
+ *  for all karts before.
+ *  \param dt Time step size.
+ */
+void Kart::update(float dt)
+{
     if(!history->replayHistory() && !RewindManager::get()->isRewinding())
         m_controller->update(dt);
 
@@ -1378,33 +1434,7 @@ void Kart::update(float dt)
         m_body->getBroadphaseHandle()->m_collisionFilterGroup = 0;
     }
 
-    // After the physics step was done, the position of the wheels (as stored
-    // in wheelInfo) is actually outdated, since the chassis was moved
-    // according to the force acting from the wheels. So the center of the
-    // chassis is not at the center of the wheels anymore, it is somewhat
-    // moved forward (depending on speed and fps). In very extreme cases
-    // (see bug 2246) the center of the chassis can actually be ahead of the
-    // front wheels. So if we do a raycast to detect the terrain from the
-    // current chassis, that raycast might be ahead of the wheels - which
-    // results in incorrect rescues (the wheels are still on the ground,
-    // but the raycast happens ahead of the front wheels and are over
-    // a rescue texture).
-    // To avoid this problem, we do the raycast for terrain detection from
-    // the center of the 4 wheel positions (in world coordinates).
-
-    Vec3 from(0, 0, 0);
-    for (unsigned int i = 0; i < 4; i++)
-        from += m_vehicle->getWheelInfo(i).m_raycastInfo.m_hardPointWS;
-
-    // Add a certain epsilon (0.3) to the height of the kart. This avoids
-    // problems of the ray being cast from under the track (which happened
-    // e.g. on tux tollway when jumping down from the ramp, when the chassis
-    // partly tunnels through the track). While tunneling should not be
-    // happening (since Z velocity is clamped), the epsilon is left in place
-    // just to be on the safe side (it will not hit the chassis itself).
-    from = from/4 + (getTrans().getBasis() * Vec3(0,0.3f,0));
-
-    m_terrain_info->update(getTrans().getBasis(), from);
+    m_terrain_info->update(getTrans().getBasis(), getTerrainRayOrigin());
 
     if(m_body->getBroadphaseHandle())
     {
@@ -2882,6 +2912,7 @@ btQuaternion Kart::getVisualRotation() const
  */
 void Kart::setOnScreenText(const wchar_t *text)
 {
+#ifndef SERVER_ONLY
     BoldFace* bold_face = font_manager->getFont<BoldFace>();
     core::dimension2d<u32> textsize = bold_face->getDimension(text);
 
@@ -2914,6 +2945,7 @@ void Kart::setOnScreenText(const wchar_t *text)
     // No need to store the reference to the billboard scene node:
     // It has one reference to the parent, and will get deleted
     // when the parent is deleted.
+#endif   // !SERVER_ONLY
 }   // setOnScreenText
 
 // ------------------------------------------------------------------------
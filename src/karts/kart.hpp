@@ -234,6 +234,7 @@ protected:
     float         getActualWheelForce();
     void          playCrashSFX(const Material* m, AbstractKart *k);
     void          loadData(RaceManager::KartType type, bool animatedModel);
+    Vec3          getTerrainRayOrigin() const;
 
 public:
                    Kart(const std::string& ident, unsigned int world_kart_id,
@@ -279,6 +280,8 @@ public:
     virtual void   crashed          (AbstractKart *k, bool update_attachments);
     virtual void   crashed          (const Material *m, const Vec3 &normal);
     virtual float  getHoT           () const;
+    virtual void   preUpdate        (float dt);
+    virtual void   prepareTerrainInfo();
     virtual void   update           (float dt);
     virtual void   finishedRace     (float time, bool from_server=false);
     virtual void   setPosition      (int p);
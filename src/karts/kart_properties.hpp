@@ -33,6 +33,7 @@ using namespace irr;
 
 #include "audio/sfx_manager.hpp"
 #include "karts/kart_model.hpp"
+#include "karts/kart_stats.hpp"
 #include "io/xml_node.hpp"
 #include "race/race_manager.hpp"
 #include "utils/interpolation_array.hpp"
@@ -40,7 +41,6 @@ using namespace irr;
 
 class AbstractCharacteristic;
 class AIProperties;
-class CachedCharacteristic;
 class CombinedCharacteristic;
 class Material;
 class XMLNode;
@@ -126,8 +126,9 @@ private:
     std::shared_ptr<AbstractCharacteristic> m_characteristic;
     /** The base characteristics combined with the characteristics of this kart. */
     std::shared_ptr<CombinedCharacteristic> m_combined_characteristic;
-    /** The cached combined characteristics. */
-    std::shared_ptr<CachedCharacteristic> m_cached_characteristic;
+    /** The values of the combined characteristics, baked for fast access
+     *  by the getters below. */
+    KartStats m_stats;
 
     // Physic properties
     // -----------------
@@ -209,14 +210,18 @@ private:
 
 
     void  load              (const std::string &filename,
-                             const std::string &node);
+                             const std::string &node,
+                             const XMLNode *xml=NULL,
+                             const XMLNode *materials=NULL);
     void combineCharacteristics();
 
 public:
     /** Returns the string representation of a per-player difficulty. */
     static std::string      getPerPlayerDifficultyAsString(PerPlayerDifficulty d);
 
-          KartProperties    (const std::string &filename="");
+          KartProperties    (const std::string &filename="",
+                             const XMLNode *root=NULL,
+                             const XMLNode *materials=NULL);
          ~KartProperties    ();
     void  copyForPlayer     (const KartProperties *source);
     void  copyFrom          (const KartProperties *source);
@@ -419,130 +424,516 @@ public:
     // by the script and replace the contained content.
     // To update the code, use tools/update_characteristics.py
     /* <characteristics-start kpdefs> */
-
-    float getSuspensionStiffness() const;
-    float getSuspensionRest() const;
-    float getSuspensionTravel() const;
-    bool getSuspensionExpSpringResponse() const;
-    float getSuspensionMaxForce() const;
-
-    float getStabilityRollInfluence() const;
-    float getStabilityChassisLinearDamping() const;
-    float getStabilityChassisAngularDamping() const;
-    float getStabilityDownwardImpulseFactor() const;
-    float getStabilityTrackConnectionAccel() const;
-    float getStabilitySmoothFlyingImpulse() const;
-
-    InterpolationArray getTurnRadius() const;
-    float getTurnTimeResetSteer() const;
-    InterpolationArray getTurnTimeFullSteer() const;
-
-    float getEnginePower() const;
-    float getEngineMaxSpeed() const;
-    float getEngineBrakeFactor() const;
-    float getEngineBrakeTimeIncrease() const;
-    float getEngineMaxSpeedReverseRatio() const;
-
-    std::vector<float> getGearSwitchRatio() const;
-    std::vector<float> getGearPowerIncrease() const;
-
-    float getMass() const;
-
-    float getWheelsDampingRelaxation() const;
-    float getWheelsDampingCompression() const;
-
-    float getCameraDistance() const;
-    float getCameraForwardUpAngle() const;
-    float getCameraBackwardUpAngle() const;
-
-    float getJumpAnimationTime() const;
-
-    float getLeanMax() const;
-    float getLeanSpeed() const;
-
-    float getAnvilDuration() const;
-    float getAnvilWeight() const;
-    float getAnvilSpeedFactor() const;
-
-    float getParachuteFriction() const;
-    float getParachuteDuration() const;
-    float getParachuteDurationOther() const;
-    float getParachuteLboundFraction() const;
-    float getParachuteUboundFraction() const;
-    float getParachuteMaxSpeed() const;
-
-    float getBubblegumDuration() const;
-    float getBubblegumSpeedFraction() const;
-    float getBubblegumTorque() const;
-    float getBubblegumFadeInTime() const;
-    float getBubblegumShieldDuration() const;
-
-    float getZipperDuration() const;
-    float getZipperForce() const;
-    float getZipperSpeedGain() const;
-    float getZipperMaxSpeedIncrease() const;
-    float getZipperFadeOutTime() const;
-
-    float getSwatterDuration() const;
-    float getSwatterDistance() const;
-    float getSwatterSquashDuration() const;
-    float getSwatterSquashSlowdown() const;
-
-    float getPlungerBandMaxLength() const;
-    float getPlungerBandForce() const;
-    float getPlungerBandDuration() const;
-    float getPlungerBandSpeedIncrease() const;
-    float getPlungerBandFadeOutTime() const;
-    float getPlungerInFaceTime() const;
-
-    std::vector<float> getStartupTime() const;
-    std::vector<float> getStartupBoost() const;
-
-    float getRescueDuration() const;
-    float getRescueVertOffset() const;
-    float getRescueHeight() const;
-
-    float getExplosionDuration() const;
-    float getExplosionRadius() const;
-    float getExplosionInvulnerabilityTime() const;
-
-    float getNitroDuration() const;
-    float getNitroEngineForce() const;
-    float getNitroConsumption() const;
-    float getNitroSmallContainer() const;
-    float getNitroBigContainer() const;
-    float getNitroMaxSpeedIncrease() const;
-    float getNitroFadeOutTime() const;
-    float getNitroMax() const;
-
-    float getSlipstreamDuration() const;
-    float getSlipstreamLength() const;
-    float getSlipstreamWidth() const;
-    float getSlipstreamCollectTime() const;
-    float getSlipstreamUseTime() const;
-    float getSlipstreamAddPower() const;
-    float getSlipstreamMinSpeed() const;
-    float getSlipstreamMaxSpeedIncrease() const;
-    float getSlipstreamFadeOutTime() const;
-
-    float getSkidIncrease() const;
-    float getSkidDecrease() const;
-    float getSkidMax() const;
-    float getSkidTimeTillMax() const;
-    float getSkidVisual() const;
-    float getSkidVisualTime() const;
-    float getSkidRevertVisualTime() const;
-    float getSkidMinSpeed() const;
-    std::vector<float> getSkidTimeTillBonus() const;
-    std::vector<float> getSkidBonusSpeed() const;
-    std::vector<float> getSkidBonusTime() const;
-    std::vector<float> getSkidBonusForce() const;
-    float getSkidPhysicalJumpTime() const;
-    float getSkidGraphicalJumpTime() const;
-    float getSkidPostSkidRotateFactor() const;
-    float getSkidReduceTurnMin() const;
-    float getSkidReduceTurnMax() const;
-    bool getSkidEnabled() const;
+    // ------------------------------------------------------------------------
+    float getSuspensionStiffness() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::SUSPENSION_STIFFNESS);
+    }   // getSuspensionStiffness
+    // ------------------------------------------------------------------------
+    float getSuspensionRest() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::SUSPENSION_REST);
+    }   // getSuspensionRest
+    // ------------------------------------------------------------------------
+    float getSuspensionTravel() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::SUSPENSION_TRAVEL);
+    }   // getSuspensionTravel
+    // ------------------------------------------------------------------------
+    bool getSuspensionExpSpringResponse() const
+    {
+        return m_stats.getBool(AbstractCharacteristic::SUSPENSION_EXP_SPRING_RESPONSE);
+    }   // getSuspensionExpSpringResponse
+    // ------------------------------------------------------------------------
+    float getSuspensionMaxForce() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::SUSPENSION_MAX_FORCE);
+    }   // getSuspensionMaxForce
+    // ------------------------------------------------------------------------
+    float getStabilityRollInfluence() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::STABILITY_ROLL_INFLUENCE);
+    }   // getStabilityRollInfluence
+    // ------------------------------------------------------------------------
+    float getStabilityChassisLinearDamping() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::STABILITY_CHASSIS_LINEAR_DAMPING);
+    }   // getStabilityChassisLinearDamping
+    // ------------------------------------------------------------------------
+    float getStabilityChassisAngularDamping() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::STABILITY_CHASSIS_ANGULAR_DAMPING);
+    }   // getStabilityChassisAngularDamping
+    // ------------------------------------------------------------------------
+    float getStabilityDownwardImpulseFactor() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::STABILITY_DOWNWARD_IMPULSE_FACTOR);
+    }   // getStabilityDownwardImpulseFactor
+    // ------------------------------------------------------------------------
+    float getStabilityTrackConnectionAccel() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::STABILITY_TRACK_CONNECTION_ACCEL);
+    }   // getStabilityTrackConnectionAccel
+    // ------------------------------------------------------------------------
+    float getStabilitySmoothFlyingImpulse() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::STABILITY_SMOOTH_FLYING_IMPULSE);
+    }   // getStabilitySmoothFlyingImpulse
+    // ------------------------------------------------------------------------
+    const InterpolationArray& getTurnRadius() const
+    {
+        return m_stats.getInterpolationArray(AbstractCharacteristic::TURN_RADIUS);
+    }   // getTurnRadius
+    // ------------------------------------------------------------------------
+    float getTurnTimeResetSteer() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::TURN_TIME_RESET_STEER);
+    }   // getTurnTimeResetSteer
+    // ------------------------------------------------------------------------
+    const InterpolationArray& getTurnTimeFullSteer() const
+    {
+        return m_stats.getInterpolationArray(AbstractCharacteristic::TURN_TIME_FULL_STEER);
+    }   // getTurnTimeFullSteer
+    // ------------------------------------------------------------------------
+    float getEnginePower() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::ENGINE_POWER);
+    }   // getEnginePower
+    // ------------------------------------------------------------------------
+    float getEngineMaxSpeed() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::ENGINE_MAX_SPEED);
+    }   // getEngineMaxSpeed
+    // ------------------------------------------------------------------------
+    float getEngineBrakeFactor() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::ENGINE_BRAKE_FACTOR);
+    }   // getEngineBrakeFactor
+    // ------------------------------------------------------------------------
+    float getEngineBrakeTimeIncrease() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::ENGINE_BRAKE_TIME_INCREASE);
+    }   // getEngineBrakeTimeIncrease
+    // ------------------------------------------------------------------------
+    float getEngineMaxSpeedReverseRatio() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::ENGINE_MAX_SPEED_REVERSE_RATIO);
+    }   // getEngineMaxSpeedReverseRatio
+    // ------------------------------------------------------------------------
+    const std::vector<float>& getGearSwitchRatio() const
+    {
+        return m_stats.getFloatVector(AbstractCharacteristic::GEAR_SWITCH_RATIO);
+    }   // getGearSwitchRatio
+    // ------------------------------------------------------------------------
+    const std::vector<float>& getGearPowerIncrease() const
+    {
+        return m_stats.getFloatVector(AbstractCharacteristic::GEAR_POWER_INCREASE);
+    }   // getGearPowerIncrease
+    // ------------------------------------------------------------------------
+    float getMass() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::MASS);
+    }   // getMass
+    // ------------------------------------------------------------------------
+    float getWheelsDampingRelaxation() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::WHEELS_DAMPING_RELAXATION);
+    }   // getWheelsDampingRelaxation
+    // ------------------------------------------------------------------------
+    float getWheelsDampingCompression() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::WHEELS_DAMPING_COMPRESSION);
+    }   // getWheelsDampingCompression
+    // ------------------------------------------------------------------------
+    float getCameraDistance() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::CAMERA_DISTANCE);
+    }   // getCameraDistance
+    // ------------------------------------------------------------------------
+    float getCameraForwardUpAngle() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::CAMERA_FORWARD_UP_ANGLE);
+    }   // getCameraForwardUpAngle
+    // ------------------------------------------------------------------------
+    float getCameraBackwardUpAngle() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::CAMERA_BACKWARD_UP_ANGLE);
+    }   // getCameraBackwardUpAngle
+    // ------------------------------------------------------------------------
+    float getJumpAnimationTime() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::JUMP_ANIMATION_TIME);
+    }   // getJumpAnimationTime
+    // ------------------------------------------------------------------------
+    float getLeanMax() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::LEAN_MAX);
+    }   // getLeanMax
+    // ------------------------------------------------------------------------
+    float getLeanSpeed() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::LEAN_SPEED);
+    }   // getLeanSpeed
+    // ------------------------------------------------------------------------
+    float getAnvilDuration() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::ANVIL_DURATION);
+    }   // getAnvilDuration
+    // ------------------------------------------------------------------------
+    float getAnvilWeight() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::ANVIL_WEIGHT);
+    }   // getAnvilWeight
+    // ------------------------------------------------------------------------
+    float getAnvilSpeedFactor() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::ANVIL_SPEED_FACTOR);
+    }   // getAnvilSpeedFactor
+    // ------------------------------------------------------------------------
+    float getParachuteFriction() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::PARACHUTE_FRICTION);
+    }   // getParachuteFriction
+    // ------------------------------------------------------------------------
+    float getParachuteDuration() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::PARACHUTE_DURATION);
+    }   // getParachuteDuration
+    // ------------------------------------------------------------------------
+    float getParachuteDurationOther() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::PARACHUTE_DURATION_OTHER);
+    }   // getParachuteDurationOther
+    // ------------------------------------------------------------------------
+    float getParachuteLboundFraction() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::PARACHUTE_LBOUND_FRACTION);
+    }   // getParachuteLboundFraction
+    // ------------------------------------------------------------------------
+    float getParachuteUboundFraction() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::PARACHUTE_UBOUND_FRACTION);
+    }   // getParachuteUboundFraction
+    // ------------------------------------------------------------------------
+    float getParachuteMaxSpeed() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::PARACHUTE_MAX_SPEED);
+    }   // getParachuteMaxSpeed
+    // ------------------------------------------------------------------------
+    float getBubblegumDuration() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::BUBBLEGUM_DURATION);
+    }   // getBubblegumDuration
+    // ------------------------------------------------------------------------
+    float getBubblegumSpeedFraction() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::BUBBLEGUM_SPEED_FRACTION);
+    }   // getBubblegumSpeedFraction
+    // ------------------------------------------------------------------------
+    float getBubblegumTorque() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::BUBBLEGUM_TORQUE);
+    }   // getBubblegumTorque
+    // ------------------------------------------------------------------------
+    float getBubblegumFadeInTime() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::BUBBLEGUM_FADE_IN_TIME);
+    }   // getBubblegumFadeInTime
+    // ------------------------------------------------------------------------
+    float getBubblegumShieldDuration() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::BUBBLEGUM_SHIELD_DURATION);
+    }   // getBubblegumShieldDuration
+    // ------------------------------------------------------------------------
+    float getZipperDuration() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::ZIPPER_DURATION);
+    }   // getZipperDuration
+    // ------------------------------------------------------------------------
+    float getZipperForce() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::ZIPPER_FORCE);
+    }   // getZipperForce
+    // ------------------------------------------------------------------------
+    float getZipperSpeedGain() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::ZIPPER_SPEED_GAIN);
+    }   // getZipperSpeedGain
+    // ------------------------------------------------------------------------
+    float getZipperMaxSpeedIncrease() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::ZIPPER_MAX_SPEED_INCREASE);
+    }   // getZipperMaxSpeedIncrease
+    // ------------------------------------------------------------------------
+    float getZipperFadeOutTime() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::ZIPPER_FADE_OUT_TIME);
+    }   // getZipperFadeOutTime
+    // ------------------------------------------------------------------------
+    float getSwatterDuration() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::SWATTER_DURATION);
+    }   // getSwatterDuration
+    // ------------------------------------------------------------------------
+    float getSwatterDistance() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::SWATTER_DISTANCE);
+    }   // getSwatterDistance
+    // ------------------------------------------------------------------------
+    float getSwatterSquashDuration() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::SWATTER_SQUASH_DURATION);
+    }   // getSwatterSquashDuration
+    // ------------------------------------------------------------------------
+    float getSwatterSquashSlowdown() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::SWATTER_SQUASH_SLOWDOWN);
+    }   // getSwatterSquashSlowdown
+    // ------------------------------------------------------------------------
+    float getPlungerBandMaxLength() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::PLUNGER_BAND_MAX_LENGTH);
+    }   // getPlungerBandMaxLength
+    // ------------------------------------------------------------------------
+    float getPlungerBandForce() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::PLUNGER_BAND_FORCE);
+    }   // getPlungerBandForce
+    // ------------------------------------------------------------------------
+    float getPlungerBandDuration() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::PLUNGER_BAND_DURATION);
+    }   // getPlungerBandDuration
+    // ------------------------------------------------------------------------
+    float getPlungerBandSpeedIncrease() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::PLUNGER_BAND_SPEED_INCREASE);
+    }   // getPlungerBandSpeedIncrease
+    // ------------------------------------------------------------------------
+    float getPlungerBandFadeOutTime() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::PLUNGER_BAND_FADE_OUT_TIME);
+    }   // getPlungerBandFadeOutTime
+    // ------------------------------------------------------------------------
+    float getPlungerInFaceTime() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::PLUNGER_IN_FACE_TIME);
+    }   // getPlungerInFaceTime
+    // ------------------------------------------------------------------------
+    const std::vector<float>& getStartupTime() const
+    {
+        return m_stats.getFloatVector(AbstractCharacteristic::STARTUP_TIME);
+    }   // getStartupTime
+    // ------------------------------------------------------------------------
+    const std::vector<float>& getStartupBoost() const
+    {
+        return m_stats.getFloatVector(AbstractCharacteristic::STARTUP_BOOST);
+    }   // getStartupBoost
+    // ------------------------------------------------------------------------
+    float getRescueDuration() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::RESCUE_DURATION);
+    }   // getRescueDuration
+    // ------------------------------------------------------------------------
+    float getRescueVertOffset() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::RESCUE_VERT_OFFSET);
+    }   // getRescueVertOffset
+    // ------------------------------------------------------------------------
+    float getRescueHeight() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::RESCUE_HEIGHT);
+    }   // getRescueHeight
+    // ------------------------------------------------------------------------
+    float getExplosionDuration() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::EXPLOSION_DURATION);
+    }   // getExplosionDuration
+    // ------------------------------------------------------------------------
+    float getExplosionRadius() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::EXPLOSION_RADIUS);
+    }   // getExplosionRadius
+    // ------------------------------------------------------------------------
+    float getExplosionInvulnerabilityTime() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::EXPLOSION_INVULNERABILITY_TIME);
+    }   // getExplosionInvulnerabilityTime
+    // ------------------------------------------------------------------------
+    float getNitroDuration() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::NITRO_DURATION);
+    }   // getNitroDuration
+    // ------------------------------------------------------------------------
+    float getNitroEngineForce() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::NITRO_ENGINE_FORCE);
+    }   // getNitroEngineForce
+    // ------------------------------------------------------------------------
+    float getNitroConsumption() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::NITRO_CONSUMPTION);
+    }   // getNitroConsumption
+    // ------------------------------------------------------------------------
+    float getNitroSmallContainer() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::NITRO_SMALL_CONTAINER);
+    }   // getNitroSmallContainer
+    // ------------------------------------------------------------------------
+    float getNitroBigContainer() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::NITRO_BIG_CONTAINER);
+    }   // getNitroBigContainer
+    // ------------------------------------------------------------------------
+    float getNitroMaxSpeedIncrease() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::NITRO_MAX_SPEED_INCREASE);
+    }   // getNitroMaxSpeedIncrease
+    // ------------------------------------------------------------------------
+    float getNitroFadeOutTime() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::NITRO_FADE_OUT_TIME);
+    }   // getNitroFadeOutTime
+    // ------------------------------------------------------------------------
+    float getNitroMax() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::NITRO_MAX);
+    }   // getNitroMax
+    // ------------------------------------------------------------------------
+    float getSlipstreamDuration() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::SLIPSTREAM_DURATION);
+    }   // getSlipstreamDuration
+    // ------------------------------------------------------------------------
+    float getSlipstreamLength() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::SLIPSTREAM_LENGTH);
+    }   // getSlipstreamLength
+    // ------------------------------------------------------------------------
+    float getSlipstreamWidth() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::SLIPSTREAM_WIDTH);
+    }   // getSlipstreamWidth
+    // ------------------------------------------------------------------------
+    float getSlipstreamCollectTime() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::SLIPSTREAM_COLLECT_TIME);
+    }   // getSlipstreamCollectTime
+    // ------------------------------------------------------------------------
+    float getSlipstreamUseTime() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::SLIPSTREAM_USE_TIME);
+    }   // getSlipstreamUseTime
+    // ------------------------------------------------------------------------
+    float getSlipstreamAddPower() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::SLIPSTREAM_ADD_POWER);
+    }   // getSlipstreamAddPower
+    // ------------------------------------------------------------------------
+    float getSlipstreamMinSpeed() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::SLIPSTREAM_MIN_SPEED);
+    }   // getSlipstreamMinSpeed
+    // ------------------------------------------------------------------------
+    float getSlipstreamMaxSpeedIncrease() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::SLIPSTREAM_MAX_SPEED_INCREASE);
+    }   // getSlipstreamMaxSpeedIncrease
+    // ------------------------------------------------------------------------
+    float getSlipstreamFadeOutTime() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::SLIPSTREAM_FADE_OUT_TIME);
+    }   // getSlipstreamFadeOutTime
+    // ------------------------------------------------------------------------
+    float getSkidIncrease() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::SKID_INCREASE);
+    }   // getSkidIncrease
+    // ------------------------------------------------------------------------
+    float getSkidDecrease() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::SKID_DECREASE);
+    }   // getSkidDecrease
+    // ------------------------------------------------------------------------
+    float getSkidMax() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::SKID_MAX);
+    }   // getSkidMax
+    // ------------------------------------------------------------------------
+    float getSkidTimeTillMax() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::SKID_TIME_TILL_MAX);
+    }   // getSkidTimeTillMax
+    // ------------------------------------------------------------------------
+    float getSkidVisual() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::SKID_VISUAL);
+    }   // getSkidVisual
+    // ------------------------------------------------------------------------
+    float getSkidVisualTime() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::SKID_VISUAL_TIME);
+    }   // getSkidVisualTime
+    // ------------------------------------------------------------------------
+    float getSkidRevertVisualTime() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::SKID_REVERT_VISUAL_TIME);
+    }   // getSkidRevertVisualTime
+    // ------------------------------------------------------------------------
+    float getSkidMinSpeed() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::SKID_MIN_SPEED);
+    }   // getSkidMinSpeed
+    // ------------------------------------------------------------------------
+    const std::vector<float>& getSkidTimeTillBonus() const
+    {
+        return m_stats.getFloatVector(AbstractCharacteristic::SKID_TIME_TILL_BONUS);
+    }   // getSkidTimeTillBonus
+    // ------------------------------------------------------------------------
+    const std::vector<float>& getSkidBonusSpeed() const
+    {
+        return m_stats.getFloatVector(AbstractCharacteristic::SKID_BONUS_SPEED);
+    }   // getSkidBonusSpeed
+    // ------------------------------------------------------------------------
+    const std::vector<float>& getSkidBonusTime() const
+    {
+        return m_stats.getFloatVector(AbstractCharacteristic::SKID_BONUS_TIME);
+    }   // getSkidBonusTime
+    // ------------------------------------------------------------------------
+    const std::vector<float>& getSkidBonusForce() const
+    {
+        return m_stats.getFloatVector(AbstractCharacteristic::SKID_BONUS_FORCE);
+    }   // getSkidBonusForce
+    // ------------------------------------------------------------------------
+    float getSkidPhysicalJumpTime() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::SKID_PHYSICAL_JUMP_TIME);
+    }   // getSkidPhysicalJumpTime
+    // ------------------------------------------------------------------------
+    float getSkidGraphicalJumpTime() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::SKID_GRAPHICAL_JUMP_TIME);
+    }   // getSkidGraphicalJumpTime
+    // ------------------------------------------------------------------------
+    float getSkidPostSkidRotateFactor() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::SKID_POST_SKID_ROTATE_FACTOR);
+    }   // getSkidPostSkidRotateFactor
+    // ------------------------------------------------------------------------
+    float getSkidReduceTurnMin() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::SKID_REDUCE_TURN_MIN);
+    }   // getSkidReduceTurnMin
+    // ------------------------------------------------------------------------
+    float getSkidReduceTurnMax() const
+    {
+        return m_stats.getFloat(AbstractCharacteristic::SKID_REDUCE_TURN_MAX);
+    }   // getSkidReduceTurnMax
+    // ------------------------------------------------------------------------
+    bool getSkidEnabled() const
+    {
+        return m_stats.getBool(AbstractCharacteristic::SKID_ENABLED);
+    }   // getSkidEnabled
 
     /* <characteristics-end kpdefs> */
 };   // KartProperties
@@ -25,7 +25,9 @@
 #include "config/stk_config.hpp"
 #include "config/user_config.hpp"
 #include "graphics/irr_driver.hpp"
+#include "graphics/texture_streamer.hpp"
 #include "guiengine/engine.hpp"
+#include "io/asset_loader.hpp"
 #include "io/file_manager.hpp"
 #include "karts/kart_properties.hpp"
 #include "karts/xml_characteristic.hpp"
@@ -148,12 +150,24 @@ void KartPropertiesManager::removeKart(const std::string &ident)
 void KartPropertiesManager::loadAllKarts(bool loading_icon)
 {
     m_all_kart_dirs.clear();
+
+    // Collect all directories that might contain a kart. The xml files of
+    // all karts are then parsed in parallel, and the karts are created
+    // here in the order of the directories, so the result is the same as
+    // loading the karts one by one.
+    AssetLoader loader("kart-index.bin", "materials.xml");
+    std::vector<bool> show_icon;
     std::vector<std::string>::const_iterator dir;
     for(dir = m_kart_search_path.begin(); dir!=m_kart_search_path.end(); dir++)
     {
         // First check if there is a kart in the current directory
         // -------------------------------------------------------
-        if(loadKart(*dir)) continue;
+        if(file_manager->fileExists(*dir + "/kart.xml"))
+        {
+            loader.addDirectory(*dir, *dir + "/kart.xml");
+            show_icon.push_back(false);
+            continue;
+        }
 
         // If not, check each subdir of this directory.
         // --------------------------------------------
@@ -162,17 +176,39 @@ void KartPropertiesManager::loadAllKarts(bool loading_icon)
         for(std::set<std::string>::const_iterator subdir=result.begin();
             subdir!=result.end(); subdir++)
         {
-            const bool loaded = loadKart(*dir+*subdir);
-
-            if (loaded && loading_icon)
-            {
-                GUIEngine::addLoadingIcon(irr_driver->getTexture(
-                    m_karts_properties[m_karts_properties.size()-1]
-                            .getAbsoluteIconFile()              )
-                                          );
-            }
+            if(*subdir=="." || *subdir=="..") continue;
+            loader.addDirectory(*dir+*subdir, *dir+*subdir+"/kart.xml");
+            show_icon.push_back(loading_icon);
         }   // for all files in the currently handled directory
     }   // for i
+
+    loader.load();
+
+    // Decode the textures of all karts in the background while the karts
+    // are loaded one by one.
+    for(unsigned int i=0; i<loader.getNumEntries(); i++)
+    {
+        if(loader.getEntry(i).m_exists)
+            TextureStreamer::get()->requestDirectory(loader.getEntry(i).m_dir
+                                                     + "/");
+    }
+
+    for(unsigned int i=0; i<loader.getNumEntries(); i++)
+    {
+        const AssetLoader::Entry &entry = loader.getEntry(i);
+        if(!entry.m_exists) continue;
+        const bool loaded = loadKart(entry.m_dir, entry.m_config,
+                                     entry.m_materials);
+
+        if (loaded && show_icon[i])
+        {
+            GUIEngine::addLoadingIcon(irr_driver->getTexture(
+                m_karts_properties[m_karts_properties.size()-1]
+                        .getAbsoluteIconFile()              )
+                                      );
+        }
+    }   // for i < loader.getNumEntries()
+    TextureStreamer::get()->finishRequests();
 }   // loadAllKarts
 
 //-----------------------------------------------------------------------------
@@ -233,9 +269,13 @@ void KartPropertiesManager::loadCharacteristics(const XMLNode *root)
 
 //-----------------------------------------------------------------------------
 /** Loads a single kart and (if not disabled) the corresponding 3d model.
- *  \param filename Full path to the kart config file.
+ *  \param dir Directory of the kart.
+ *  \param xml If not NULL the already parsed kart.xml file.
+ *  \param materials If not NULL the already parsed materials.xml file.
  */
-bool KartPropertiesManager::loadKart(const std::string &dir)
+bool KartPropertiesManager::loadKart(const std::string &dir,
+                                     const XMLNode *xml,
+                                     const XMLNode *materials)
 {
     std::string config_filename = dir + "/kart.xml";
     if(!file_manager->fileExists(config_filename))
@@ -244,7 +284,7 @@ bool KartPropertiesManager::loadKart(const std::string &dir)
     KartProperties* kart_properties;
     try
     {
-        kart_properties = new KartProperties(config_filename);
+        kart_properties = new KartProperties(config_filename, xml, materials);
     }
     catch (std::runtime_error& err)
     {
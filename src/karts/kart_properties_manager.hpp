@@ -83,7 +83,9 @@ public:
                                            int i) const;
 
     void                     loadCharacteristics    (const XMLNode *root);
-    bool                     loadKart               (const std::string &dir);
+    bool                     loadKart               (const std::string &dir,
+                                                     const XMLNode *xml=NULL,
+                                                     const XMLNode *materials=NULL);
     void                     loadAllKarts           (bool loading_icon = true);
     void                     unloadAllKarts         ();
     void                     removeKart(const std::string &id);
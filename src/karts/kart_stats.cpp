@@ -0,0 +1,192 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2016 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#include "karts/kart_stats.hpp"
+
+#include "io/file_manager.hpp"
+#include "karts/combined_characteristic.hpp"
+#include "karts/kart_properties.hpp"
+#include "karts/kart_properties_manager.hpp"
+#include "karts/xml_characteristic.hpp"
+#include "utils/log.hpp"
+
+#include <assert.h>
+
+KartStats::KartStats()
+        : m_float_vector_values(AbstractCharacteristic::CHARACTERISTIC_COUNT),
+          m_interpolation_array_values(
+                                   AbstractCharacteristic::CHARACTERISTIC_COUNT)
+{
+    for (int i = 0; i < AbstractCharacteristic::CHARACTERISTIC_COUNT; i++)
+    {
+        m_is_set[i]       = false;
+        m_float_values[i] = 0.0f;
+        m_bool_values[i]  = false;
+    }
+}   // KartStats
+
+// ----------------------------------------------------------------------------
+/** Computes the values of all characteristics with the given (usually
+ *  combined) characteristic and stores them. This must be called again
+ *  whenever the characteristic changes.
+ *  \param characteristic The characteristic from which to take the values.
+ */
+void KartStats::bake(const AbstractCharacteristic *characteristic)
+{
+    for (int i = 0; i < AbstractCharacteristic::CHARACTERISTIC_COUNT; i++)
+    {
+        CharacteristicType type = static_cast<CharacteristicType>(i);
+        bool is_set = false;
+        switch (AbstractCharacteristic::getType(type))
+        {
+        case AbstractCharacteristic::TYPE_FLOAT:
+            characteristic->process(type, &m_float_values[i], &is_set);
+            break;
+        case AbstractCharacteristic::TYPE_BOOL:
+            characteristic->process(type, &m_bool_values[i], &is_set);
+            break;
+        case AbstractCharacteristic::TYPE_FLOAT_VECTOR:
+            m_float_vector_values[i].clear();
+            characteristic->process(type, &m_float_vector_values[i], &is_set);
+            break;
+        case AbstractCharacteristic::TYPE_INTERPOLATION_ARRAY:
+            m_interpolation_array_values[i].clear();
+            characteristic->process(type, &m_interpolation_array_values[i],
+                                    &is_set);
+            break;
+        }
+        m_is_set[i] = is_set;
+    }
+}   // bake
+
+// ----------------------------------------------------------------------------
+/** Called when a characteristic is read that has no value, which can only
+ *  happen because of broken data files. Kept out of the getters, so that
+ *  they remain small enough to be inlined.
+ */
+void KartStats::notSet(CharacteristicType type) const
+{
+    Log::fatal("KartStats", "Can't get characteristic %s",
+               AbstractCharacteristic::getName(type).c_str());
+}   // notSet
+
+// ============================================================================
+/** Tests that all baked values are identical to the values computed by
+ *  the process() function of the given characteristic.
+ */
+static void compareWithProcess(const KartStats &stats,
+                               const AbstractCharacteristic *characteristic)
+{
+    for (int i = 0; i < AbstractCharacteristic::CHARACTERISTIC_COUNT; i++)
+    {
+        AbstractCharacteristic::CharacteristicType type =
+            static_cast<AbstractCharacteristic::CharacteristicType>(i);
+        bool is_set = false;
+        switch (AbstractCharacteristic::getType(type))
+        {
+        case AbstractCharacteristic::TYPE_FLOAT:
+        {
+            float f = 0.0f;
+            characteristic->process(type, &f, &is_set);
+            assert(is_set == stats.isSet(type));
+            assert(!is_set || f == stats.getFloat(type));
+            break;
+        }
+        case AbstractCharacteristic::TYPE_BOOL:
+        {
+            bool b = false;
+            characteristic->process(type, &b, &is_set);
+            assert(is_set == stats.isSet(type));
+            assert(!is_set || b == stats.getBool(type));
+            break;
+        }
+        case AbstractCharacteristic::TYPE_FLOAT_VECTOR:
+        {
+            std::vector<float> fv;
+            characteristic->process(type, &fv, &is_set);
+            assert(is_set == stats.isSet(type));
+            assert(!is_set || fv == stats.getFloatVector(type));
+            break;
+        }
+        case AbstractCharacteristic::TYPE_INTERPOLATION_ARRAY:
+        {
+            InterpolationArray ia;
+            characteristic->process(type, &ia, &is_set);
+            assert(is_set == stats.isSet(type));
+            if (!is_set) break;
+            const InterpolationArray &baked =
+                stats.getInterpolationArray(type);
+            assert(ia.size() == baked.size());
+            for (unsigned int j = 0; j < ia.size(); j++)
+            {
+                assert(ia.getX(j) == baked.getX(j));
+                assert(ia.getY(j) == baked.getY(j));
+            }
+            break;
+        }
+        }   // switch
+    }   // for i < CHARACTERISTIC_COUNT
+}   // compareWithProcess
+
+// ----------------------------------------------------------------------------
+/** Checks that the baked values of a characteristic and of all loaded karts
+ *  are the same as the ones computed by AbstractCharacteristic::process().
+ */
+void KartStats::unitTesting()
+{
+    std::string s =
+        "<?xml version=\"1.0\"?>"
+        "  <characteristic name=\"base\">"
+        "    <suspension stiffness=\"4.5\" rest=\"-0.3\" travel=\"1+2\""
+        "        exp-spring-response=\"true\"/>"
+        "    <turn radius=\"0:2.0 10:7.5 25:15 45:30\"/>"
+        "    <gear switch-ratio=\"0.25 0.7 1.0\"/>"
+        "  </characteristic>"
+        "</characteristics>";
+
+    XMLNode *xml = file_manager->createXMLTreeFromString(s);
+    XmlCharacteristic *c = new XmlCharacteristic(xml);
+    delete xml;
+    CombinedCharacteristic *cc = new CombinedCharacteristic();
+    cc->addCharacteristic(c);
+
+    KartStats stats;
+    stats.bake(cc);
+    compareWithProcess(stats, cc);
+    assert(stats.getFloat(AbstractCharacteristic::SUSPENSION_TRAVEL) == 3.0f);
+    assert(!stats.isSet(AbstractCharacteristic::ENGINE_POWER));
+
+    // Baking again must replace all values, and not e.g. append to vectors
+    stats.bake(cc);
+    compareWithProcess(stats, cc);
+    delete cc;
+    delete c;
+
+    for (unsigned int i = 0; i < kart_properties_manager->getNumberOfKarts();
+         i++)
+    {
+        const KartProperties *kp = kart_properties_manager->getKartById(i);
+        const AbstractCharacteristic *combined =
+            kp->getCombinedCharacteristic();
+        KartStats kart_stats;
+        kart_stats.bake(combined);
+        compareWithProcess(kart_stats, combined);
+        assert(kp->getEnginePower() == combined->getEnginePower());
+        assert(kp->getGearSwitchRatio() == combined->getGearSwitchRatio());
+    }
+}   // unitTesting
@@ -0,0 +1,96 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2016 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#ifndef HEADER_KART_STATS_TABLE_HPP
+#define HEADER_KART_STATS_TABLE_HPP
+
+#include "karts/abstract_characteristic.hpp"
+#include "utils/interpolation_array.hpp"
+
+#include <vector>
+
+/** The resolved values of all characteristics of a kart. Computing a value
+ *  with AbstractCharacteristic::process() walks all combined
+ *  characteristics, so the values are instead baked once into flat arrays
+ *  (one for each value type, indexed by the characteristic type) whenever
+ *  the combined characteristic of a kart changes. Since the getters are
+ *  called with a constant characteristic type, each read is a simple load.
+ *  \ingroup karts
+ */
+class KartStats
+{
+private:
+    typedef AbstractCharacteristic::CharacteristicType CharacteristicType;
+
+    /** True for all characteristics that have a value. */
+    bool m_is_set[AbstractCharacteristic::CHARACTERISTIC_COUNT];
+
+    /** The values of all float characteristics. */
+    float m_float_values[AbstractCharacteristic::CHARACTERISTIC_COUNT];
+
+    /** The values of all bool characteristics. */
+    bool m_bool_values[AbstractCharacteristic::CHARACTERISTIC_COUNT];
+
+    /** The values of all float vector characteristics. */
+    std::vector<std::vector<float> > m_float_vector_values;
+
+    /** The values of all interpolation array characteristics. */
+    std::vector<InterpolationArray> m_interpolation_array_values;
+
+    void notSet(CharacteristicType type) const;
+
+public:
+         KartStats();
+    void bake(const AbstractCharacteristic *characteristic);
+    static void unitTesting();
+
+    // ------------------------------------------------------------------------
+    /** Returns the value of a float characteristic. */
+    float getFloat(CharacteristicType type) const
+    {
+        if (!m_is_set[type]) notSet(type);
+        return m_float_values[type];
+    }   // getFloat
+    // ------------------------------------------------------------------------
+    /** Returns the value of a bool characteristic. */
+    bool getBool(CharacteristicType type) const
+    {
+        if (!m_is_set[type]) notSet(type);
+        return m_bool_values[type];
+    }   // getBool
+    // ------------------------------------------------------------------------
+    /** Returns the value of a float vector characteristic. */
+    const std::vector<float>& getFloatVector(CharacteristicType type) const
+    {
+        if (!m_is_set[type]) notSet(type);
+        return m_float_vector_values[type];
+    }   // getFloatVector
+    // ------------------------------------------------------------------------
+    /** Returns the value of an interpolation array characteristic. */
+    const InterpolationArray& getInterpolationArray(CharacteristicType type)
+                                                                        const
+    {
+        if (!m_is_set[type]) notSet(type);
+        return m_interpolation_array_values[type];
+    }   // getInterpolationArray
+    // ------------------------------------------------------------------------
+    /** Returns if the given characteristic has a value. */
+    bool isSet(CharacteristicType type) const { return m_is_set[type]; }
+};   // KartStats
+
+#endif
@@ -156,11 +156,15 @@
 #include "graphics/camera.hpp"
 #include "graphics/camera_debug.hpp"
 #include "graphics/central_settings.hpp"
+#include "graphics/cpu_skinning.hpp"
 #include "graphics/graphics_restrictions.hpp"
+#include "graphics/image_kernels.hpp"
 #include "graphics/irr_driver.hpp"
 #include "graphics/material_manager.hpp"
 #include "graphics/particle_kind_manager.hpp"
 #include "graphics/referee.hpp"
+#include "graphics/texture_compressor.hpp"
+#include "graphics/texture_streamer.hpp"
 #include "guiengine/engine.hpp"
 #include "guiengine/event_handler.hpp"
 #include "guiengine/dialog_queue.hpp"
@@ -169,6 +173,7 @@
 #include "input/keyboard_device.hpp"
 #include "input/wiimote_manager.hpp"
 #include "io/file_manager.hpp"
+#include "io/xml_node.hpp"
 #include "items/attachment_manager.hpp"
 #include "items/item_manager.hpp"
 #include "items/projectile_manager.hpp"
@@ -176,9 +181,11 @@
 #include "karts/controller/ai_base_lap_controller.hpp"
 #include "karts/kart_properties.hpp"
 #include "karts/kart_properties_manager.hpp"
+#include "karts/kart_stats.hpp"
 #include "modes/cutscene_world.hpp"
 #include "modes/demo_world.hpp"
 #include "modes/profile_world.hpp"
+#include "network/kart_snapshot.hpp"
 #include "network/network_config.hpp"
 #include "network/network_string.hpp"
 #include "network/rewind_manager.hpp"
@@ -192,6 +199,7 @@
 #include "race/race_manager.hpp"
 #include "replay/replay_play.hpp"
 #include "replay/replay_recorder.hpp"
+#include "replay/replay_stream.hpp"
 #include "states_screens/main_menu_screen.hpp"
 #include "states_screens/register_screen.hpp"
 #include "states_screens/state_manager.hpp"
@@ -206,6 +214,7 @@
 #include "utils/leak_check.hpp"
 #include "utils/log.hpp"
 #include "utils/translation.hpp"
+#include "utils/worker_pool.hpp"
 
 static void cleanSuperTuxKart();
 static void cleanUserConfig();
@@ -535,6 +544,8 @@ void cmdLineHelp()
     "                          spaces are allowed in the track names.\n"
     "       --demo-laps=n      Number of laps in a demo.\n"
     "       --demo-karts=n     Number of karts to use in a demo.\n"
+    "       --convert-replay=file Convert a replay in the old text format\n"
+    "                          into the binary format.\n"
     // "       --history          Replay history file 'history.dat'.\n"
     // "       --history=n        Replay history file 'history.dat' using:\n"
     // "                            n=1: recorded positions\n"
@@ -555,6 +566,10 @@ void cmdLineHelp()
     "  -h,  --help             Show this help.\n"
     "       --log=N            Set the verbosity to a value between\n"
     "                          0 (Debug) and 5 (Only Fatal messages)\n"
+    "       --log-sync         Write log messages immediately instead of\n"
+    "                          using a separate thread.\n"
+    "       --log-rate=N       Maximum number of messages below warnings per\n"
+    "                          component and second (0 for no limit).\n"
     "       --root=DIR         Path to add to the list of STK root directories.\n"
     "                          You can specify more than one by separating them\n"
     "                          with colons (:).\n"
@@ -641,6 +656,9 @@ int handleCmdLineOutputModifier()
     if(CommandLine::has("--no-console"))
         UserConfigParams::m_log_errors_to_console=false;
 
+    if(CommandLine::has("--log-rate", &n))
+        Log::setRateLimit(n);
+
 
     return 0;
 }
@@ -690,6 +708,14 @@ int handleCmdLinePreliminary()
         UserConfigParams::m_log_errors_to_console=true;
     }
 
+#ifdef SERVER_ONLY
+    // The dedicated server never opens a window or plays any sound.
+    ProfileWorld::disableGraphics();
+    UserConfigParams::m_log_errors_to_console = true;
+    UserConfigParams::m_sfx   = false;
+    UserConfigParams::m_music = false;
+#endif
+
     if(CommandLine::has("--screensize", &s) || CommandLine::has("-s", &s))
     {
         //Check if fullscreen and new res is blacklisted
@@ -882,6 +908,8 @@ int handleCmdLine()
         AIBaseController::setTestAI(n);
     if (CommandLine::has("--fps-debug"))
         UserConfigParams::m_fps_debug = true;
+    if (CommandLine::has("--benchmark-graph"))
+        UserConfigParams::m_graph_benchmark = true;
     if (CommandLine::has("--rewind") )
         RewindManager::setEnable(true);
     if(CommandLine::has("--soccer-ai-stats"))
@@ -1177,6 +1205,19 @@ int handleCmdLine()
         race_manager->setNumLaps(999999); // profile end depends on time
     }   // --profile-time
 
+    if(CommandLine::has("--convert-replay", &s))
+    {
+        // Write the binary replay into the replay directory
+        std::string out = file_manager->getReplayDir()
+                        + StringUtils::getBasename(s);
+        if (out == s)
+            out = StringUtils::removeExtension(out) + "-binary.replay";
+        if (ReplayStreamReader::convertTextReplay(s, out))
+            Log::info("main", "Converted replay written to '%s'.",
+                      out.c_str());
+        return 0;
+    }   // --convert-replay
+
     if(CommandLine::has("--history",  &n))
     {
         history->doReplayHistory( (History::HistoryReplayMode)n);
@@ -1289,6 +1330,8 @@ void initUserConfig()
 void initRest()
 {
     stk_config->load(file_manager->getAsset("stk_config.xml"));
+    WorkerPool::create();
+    TextureStreamer::create();
 
     irr_driver = new IrrDriver();
     StkTime::init();   // grabs the timer object from the irrlicht device
@@ -1465,6 +1508,12 @@ int main(int argc, char *argv[] )
         // not have) other managers initialised:
         initUserConfig();
 
+        // Write log messages on a separate thread, so that e.g. the network
+        // threads do not wait for the console. This is done after the log
+        // file was opened in initUserConfig.
+        if(!CommandLine::has("--log-sync"))
+            Log::startWriterThread();
+
         handleCmdLinePreliminary();
 
         initRest();
@@ -1799,6 +1848,8 @@ static void cleanSuperTuxKart()
         Log::info("Thread", "Request Manager not aborting in time, aborting.");
     }
     Online::RequestManager::deallocate();
+    TextureStreamer::destroy();
+    WorkerPool::destroy();
 
     if (!SFXManager::get()->waitForReadyToDeleted(2.0f))
     {
@@ -1853,8 +1904,20 @@ void runUnitTests()
     Log::info("UnitTest", "=====================");
     Log::info("UnitTest", "GraphicsRestrictions");
     GraphicsRestrictions::unitTesting();
+    Log::info("UnitTest", "ImageKernels");
+    ImageKernels::unitTesting();
+    Log::info("UnitTest", "TextureCompressor");
+    TextureCompressor::unitTesting();
+    Log::info("UnitTest", "CPUSkinning");
+    CPUSkinning::unitTesting();
     Log::info("UnitTest", "NetworkString");
     NetworkString::unitTesting();
+    Log::info("UnitTest", "KartSnapshotEncoder");
+    KartSnapshotEncoder::unitTesting();
+    Log::info("UnitTest", "ReplayStream");
+    ReplayStreamReader::unitTesting();
+    Log::info("UnitTest", "XMLNode");
+    XMLNode::unitTesting();
 
     Log::info("UnitTest", "Easter detection");
     // Test easter mode: in 2015 Easter is 5th of April - check with 0 days
@@ -1890,6 +1953,7 @@ void runUnitTests()
 
     Log::info("UnitTest", "Kart characteristics");
     CombinedCharacteristic::unitTesting();
+    KartStats::unitTesting();
 
     Log::info("UnitTest", "Arena Graph");
     ArenaGraph::unitTesting();
@@ -39,6 +39,7 @@
 #include "race/race_manager.hpp"
 #include "states_screens/state_manager.hpp"
 #include "utils/profiler.hpp"
+#include "utils/time.hpp"
 
 MainLoop* main_loop = 0;
 
@@ -47,6 +48,7 @@ m_abort(false)
 {
     m_curr_time = 0;
     m_prev_time = 0;
+    m_next_tick_time = 0;
     m_throttle_fps = true;
 }  // MainLoop
 
@@ -78,6 +80,11 @@ float MainLoop::getLimitedDt()
         return 1.0f/60.0f;
     }
 
+    // A server without graphics (e.g. supertuxkart-server) simulates with
+    // a fixed tick in real time, independent of the maximum fps setting.
+    if (ProfileWorld::isNoGraphics() && NetworkConfig::get()->isServer())
+        return getFixedTickDt();
+
     IrrlichtDevice* device = irr_driver->getDevice();
     m_prev_time = m_curr_time;
 
@@ -129,6 +136,39 @@ float MainLoop::getLimitedDt()
     return dt;
 }   // getLimitedDt
 
+//-----------------------------------------------------------------------------
+/** Waits until the next fixed simulation tick is due and returns the tick
+ *  length. Used on a server without graphics, where no frames need to be
+ *  rendered: the process sleeps for most of the remaining time, and only
+ *  spins for the last millisecond, since sleep is not precise enough to
+ *  keep a steady tick rate. If the server falls behind by more than a few
+ *  ticks (e.g. while loading a track), the schedule is restarted instead of
+ *  trying to catch up with a burst of updates.
+ */
+float MainLoop::getFixedTickDt()
+{
+    int ticks_per_second = UserConfigParams::m_server_ticks_per_second;
+    if (ticks_per_second < 1) ticks_per_second = 1;
+    const double tick = 1.0 / ticks_per_second;
+
+    double now = StkTime::getRealTime();
+    if (m_next_tick_time == 0 || now - m_next_tick_time > 3 * tick)
+        m_next_tick_time = now;
+
+    PROFILER_PUSH_CPU_MARKER("Wait for tick", 0, 0, 0);
+    while (now < m_next_tick_time)
+    {
+        const double remaining = m_next_tick_time - now;
+        if (remaining > 0.002)
+            StkTime::sleep(int((remaining - 0.001) * 1000.0));
+        now = StkTime::getRealTime();
+    }
+    PROFILER_POP_CPU_MARKER();
+
+    m_next_tick_time += tick;
+    return (float)tick;
+}   // getFixedTickDt
+
 //-----------------------------------------------------------------------------
 /** Updates all race related objects.
  *  \param dt Time step size.
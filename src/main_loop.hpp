@@ -33,7 +33,13 @@ private:
 
     Uint32   m_curr_time;
     Uint32   m_prev_time;
+
+    /** Real time (in seconds) at which the next fixed tick of a server
+     *  without graphics is due, or 0 if no tick has been scheduled yet. */
+    double   m_next_tick_time;
+
     float    getLimitedDt();
+    float    getFixedTickDt();
     void     updateRace(float dt);
 public:
          MainLoop();
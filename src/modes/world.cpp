@@ -66,10 +66,12 @@
 #include "states_screens/state_manager.hpp"
 #include "tracks/track.hpp"
 #include "tracks/track_manager.hpp"
+#include "tracks/track_object_manager.hpp"
 #include "utils/constants.hpp"
 #include "utils/profiler.hpp"
 #include "utils/translation.hpp"
 #include "utils/string_utils.hpp"
+#include "utils/worker_pool.hpp"
 
 #include <algorithm>
 #include <assert.h>
@@ -974,9 +976,17 @@ void World::update(float dt)
 
     PROFILER_PUSH_CPU_MARKER("World::update (Kart::upate)", 0x40, 0x7F, 0x00);
 
-    // Update all the karts. This in turn will also update the controller,
-    // which causes all AI steering commands set. So in the following 
-    // physics update the new steering is taken into account.
+    // Update all the karts in three steps: first all karts take their new
+    // state from the physics. Then all controllers compute their decisions
+    // from this state. Each controller only modifies its own data in this
+    // step, so it is done in parallel, and the result does not depend on
+    // the number of threads or on the order of the karts (which keeps
+    // replays and rewind deterministic). Finally the karts are updated,
+    // which also updates the controller and applies its decisions, i.e.
+    // AI steering commands are set. So in the following physics update
+    // the new steering is taken into account.
+    std::vector<AbstractKart*> karts_to_update;
+    karts_to_update.reserve(m_karts.size());
     const int kart_amount = (int)m_karts.size();
     for (int i = 0 ; i < kart_amount; ++i)
     {
@@ -984,8 +994,35 @@ void World::update(float dt)
             dynamic_cast<SpareTireAI*>(m_karts[i]->getController());
         // Update all karts that are not eliminated
         if(!m_karts[i]->isEliminated() || (sta && sta->isMoving()))
-            m_karts[i]->update(dt);
+            karts_to_update.push_back(m_karts[i]);
     }
+    for (unsigned int i = 0; i < karts_to_update.size(); i++)
+        karts_to_update[i]->preUpdate(dt);
+
+    // The terrain raycasts of all karts only read the track and the new
+    // physics state, so they are done together in parallel.
+    PROFILER_PUSH_CPU_MARKER("World::update (terrain rays)", 0x40, 0x7F, 0x20);
+    WorkerPool::get()->parallelFor((int)karts_to_update.size(),
+        [&karts_to_update](int i)
+        {
+            karts_to_update[i]->prepareTerrainInfo();
+        });
+    PROFILER_POP_CPU_MARKER();
+
+    if (!history->replayHistory() && !RewindManager::get()->isRewinding())
+    {
+        PROFILER_PUSH_CPU_MARKER("World::update (AI decisions)",
+                                 0x40, 0x7F, 0x40);
+        WorkerPool::get()->parallelFor((int)karts_to_update.size(),
+            [&karts_to_update, dt](int i)
+            {
+                karts_to_update[i]->getController()->prepareUpdate(dt);
+            });
+        PROFILER_POP_CPU_MARKER();
+    }
+
+    for (unsigned int i = 0; i < karts_to_update.size(); i++)
+        karts_to_update[i]->update(dt);
     PROFILER_POP_CPU_MARKER();
 
     PROFILER_PUSH_CPU_MARKER("World::update (camera)", 0x60, 0x7F, 0x00);
@@ -1001,6 +1038,8 @@ void World::update(float dt)
     if (!history->dontDoPhysics())
     {
         m_physics->update(dt);
+        // The physics might have moved driveable objects.
+        m_track->getTrackObjectManager()->updateDriveableObjects();
     }
 
     PROFILER_PUSH_CPU_MARKER("World::update (weather)", 0x80, 0x7F, 0x00);
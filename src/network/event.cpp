@@ -18,12 +18,95 @@
 
 #include "network/event.hpp"
 
+#include "network/network_config.hpp"
 #include "network/stk_host.hpp"
 #include "network/stk_peer.hpp"
 #include "utils/log.hpp"
+#include "utils/mpsc_queue.hpp"
 
+#include <new>
 #include <string.h>
 
+namespace
+{
+    /** A pool of preallocated memory blocks for events, so that the
+     *  listening thread does not need to go through the heap allocator for
+     *  each received packet. Blocks are taken by the STKHost listening
+     *  thread (the only thread creating events), and can be returned from
+     *  any thread that deletes an event. */
+    class EventPool
+    {
+    private:
+        /** Number of events in the pool, must be a power of 2. */
+        static const size_t POOL_SIZE = 1024;
+
+        /** Memory for all pooled events. */
+        char *m_storage;
+
+        /** Size of one block in m_storage. */
+        size_t m_block_size;
+
+        /** Blocks that are currently not in use. */
+        MPSCQueue<void*> m_free_blocks;
+    public:
+        EventPool() : m_free_blocks(POOL_SIZE)
+        {
+            // Round the block size up so that each block is aligned
+            // like a pointer (Event contains pointers and doubles).
+            m_block_size = (sizeof(Event) + sizeof(double) - 1)
+                         & ~(sizeof(double) - 1);
+            m_storage = new char[m_block_size*POOL_SIZE];
+            for(size_t i=0; i<POOL_SIZE; i++)
+                m_free_blocks.push(m_storage + i*m_block_size);
+        }   // EventPool
+        // --------------------------------------------------------------------
+        ~EventPool() { delete [] m_storage; }
+        // --------------------------------------------------------------------
+        /** Returns a free block, or allocates one from the heap if the pool
+         *  is exhausted. */
+        void *allocate(size_t size)
+        {
+            void *p;
+            if(size<=m_block_size && m_free_blocks.pop(&p))
+                return p;
+            return ::operator new(size);
+        }   // allocate
+        // --------------------------------------------------------------------
+        /** Returns a block either to the pool or the heap. */
+        void release(void *p)
+        {
+            char *c = (char*)p;
+            if(c>=m_storage && c<m_storage+m_block_size*POOL_SIZE)
+                m_free_blocks.push(p);
+            else
+                ::operator delete(p);
+        }   // release
+    };   // EventPool
+
+    EventPool g_event_pool;
+}   // anonymous namespace
+
+// ----------------------------------------------------------------------------
+/** Allocates an event from the event pool. Must only be called from the
+ *  STKHost listening thread.
+ */
+void* Event::operator new(size_t size)
+{
+    return g_event_pool.allocate(size);
+}   // operator new
+
+// ----------------------------------------------------------------------------
+/** Returns the memory of an event to the pool. This can be called from
+ *  any thread.
+ */
+void Event::operator delete(void *p)
+{
+    if(p)
+        g_event_pool.release(p);
+}   // operator delete
+
+// ----------------------------------------------------------------------------
+
 /** \brief Constructor
  *  \param event : The event that needs to be translated.
  */
@@ -61,8 +144,12 @@ Event::Event(ENetEvent* event)
     }
 
     m_peer = STKHost::get()->getPeer(event->peer);
+    // A client accepts messages from the server that were broadcast to all
+    // clients, which do not contain the token of this client.
     if(m_type == EVENT_TYPE_MESSAGE && m_peer->isClientServerTokenSet() &&
-        m_data->getToken()!=m_peer->getClientServerToken() )
+        m_data->getToken()!=m_peer->getClientServerToken() &&
+        !(NetworkConfig::get()->isClient() &&
+          m_data->getToken()==NetworkString::BROADCAST_TOKEN)           )
     {
         Log::error("Event", "Received event with invalid token!");
         Log::error("Event", "HostID %d Token %d message token %d",
@@ -30,6 +30,8 @@
 
 #include "enet/enet.h"
 
+#include <stddef.h>
+
 class STKPeer;
 
 /*!
@@ -74,6 +76,9 @@ public:
          Event(ENetEvent* event);
         ~Event();
 
+    static void* operator new(size_t size);
+    static void  operator delete(void *p);
+
     // ------------------------------------------------------------------------
     /** Returns the type of this event. */
     EVENT_TYPE getType() const { return m_type; }
@@ -0,0 +1,464 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2016 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#include "network/kart_snapshot.hpp"
+
+#include "network/network_string.hpp"
+#include "utils/log.hpp"
+
+#include <assert.h>
+#include <math.h>
+
+namespace
+{
+    /** Flags used for each kart in a delta encoded snapshot. */
+    enum
+    {
+        KS_POSITION_CHANGED = 0x01,   //!< Position is included.
+        KS_POSITION_DELTA   = 0x02,   //!< Position is a 3 byte offset.
+        KS_ROTATION_CHANGED = 0x04    //!< Rotation is included.
+    };
+
+    /** Additional space around the track bounding box, so that karts
+     *  falling off the track or jumping high can still be represented. */
+    const float AABB_MARGIN = 20.0f;
+
+    /** Maximum value of one of the three smaller quaternion components. */
+    const float QUAT_COMPONENT_MAX = 0.70710678f;   // 1/sqrt(2)
+
+    /** Number of different values for one compressed component (10 bit). */
+    const float QUAT_COMPONENT_RANGE = 1023.0f;
+}   // anonymous namespace
+
+// ----------------------------------------------------------------------------
+/** Creates an encoder for a track with the given bounding box.
+ *  \param aabb_min Minimum corner of the track bounding box.
+ *  \param aabb_max Maximum corner of the track bounding box.
+ */
+KartSnapshotEncoder::KartSnapshotEncoder(const Vec3 &aabb_min,
+                                         const Vec3 &aabb_max)
+{
+    m_min = aabb_min - Vec3(AABB_MARGIN, AABB_MARGIN, AABB_MARGIN);
+    Vec3 extent = aabb_max - aabb_min
+                + Vec3(2*AABB_MARGIN, 2*AABB_MARGIN, 2*AABB_MARGIN);
+    for (unsigned int i = 0; i < 3; i++)
+        m_step[i] = extent[i] > 0 ? extent[i] / 65535.0f : 1.0f;
+    m_next_id = 0;
+    for (unsigned int i = 0; i < HISTORY_SIZE; i++)
+    {
+        m_history[i].m_id    = 0;
+        m_history[i].m_valid = false;
+    }
+}   // KartSnapshotEncoder
+
+// ----------------------------------------------------------------------------
+/** Compresses a quaternion into 32 bits: the index of the largest component
+ *  is stored in the top 2 bits, the other three components use 10 bits each.
+ *  The largest component is restored from the unit length.
+ *  \param q The quaternion to compress, which should be normalised.
+ */
+uint32_t KartSnapshotEncoder::compressQuaternion(const btQuaternion &q)
+{
+    float c[4] = { q.getX(), q.getY(), q.getZ(), q.getW() };
+    unsigned int largest = 0;
+    for (unsigned int i = 1; i < 4; i++)
+    {
+        if (fabsf(c[i]) > fabsf(c[largest]))
+            largest = i;
+    }
+    // q and -q are the same rotation, so make the largest one positive
+    // to avoid storing its sign.
+    float sign = c[largest] < 0 ? -1.0f : 1.0f;
+
+    uint32_t result = largest << 30;
+    int shift = 20;
+    for (unsigned int i = 0; i < 4; i++)
+    {
+        if (i == largest) continue;
+        float f = sign*c[i] / QUAT_COMPONENT_MAX;
+        if (f < -1.0f) f = -1.0f;
+        if (f >  1.0f) f =  1.0f;
+        uint32_t v = (uint32_t)((f + 1.0f) * 0.5f * QUAT_COMPONENT_RANGE
+                                + 0.5f);
+        result |= v << shift;
+        shift -= 10;
+    }
+    return result;
+}   // compressQuaternion
+
+// ----------------------------------------------------------------------------
+/** Restores a quaternion compressed with compressQuaternion.
+ *  \param c The compressed quaternion.
+ */
+btQuaternion KartSnapshotEncoder::decompressQuaternion(uint32_t c)
+{
+    unsigned int largest = c >> 30;
+    float q[4];
+    float sum = 0;
+    int shift = 20;
+    for (unsigned int i = 0; i < 4; i++)
+    {
+        if (i == largest) continue;
+        uint32_t v = (c >> shift) & 0x3ff;
+        q[i] = (v / QUAT_COMPONENT_RANGE * 2.0f - 1.0f) * QUAT_COMPONENT_MAX;
+        sum += q[i] * q[i];
+        shift -= 10;
+    }
+    q[largest] = sum < 1.0f ? sqrtf(1.0f - sum) : 0.0f;
+    btQuaternion result(q[0], q[1], q[2], q[3]);
+    result.normalize();
+    return result;
+}   // decompressQuaternion
+
+// ----------------------------------------------------------------------------
+/** Converts the position and rotation of a kart into the quantized form.
+ *  Positions outside of the (extended) track bounding box are clamped.
+ */
+void KartSnapshotEncoder::quantize(const Vec3 &xyz, const btQuaternion &q,
+                                   QuantizedKartState *state) const
+{
+    for (unsigned int i = 0; i < 3; i++)
+    {
+        float f = (xyz[i] - m_min[i]) / m_step[i] + 0.5f;
+        if (f < 0)        f = 0;
+        if (f > 65535.0f) f = 65535.0f;
+        state->m_position[i] = (uint16_t)f;
+    }
+    state->m_rotation = compressQuaternion(q);
+}   // quantize
+
+// ----------------------------------------------------------------------------
+/** Converts a quantized kart state back into position and rotation.
+ */
+void KartSnapshotEncoder::dequantize(const QuantizedKartState &state,
+                                     Vec3 *xyz, btQuaternion *q) const
+{
+    for (unsigned int i = 0; i < 3; i++)
+        (*xyz)[i] = m_min[i] + state.m_position[i] * m_step[i];
+    *q = decompressQuaternion(state.m_rotation);
+}   // dequantize
+
+// ----------------------------------------------------------------------------
+/** Stores a snapshot in the history, replacing the oldest entry.
+ */
+void KartSnapshotEncoder::storeSnapshot(uint16_t id,
+                                 const std::vector<QuantizedKartState> &karts)
+{
+    Snapshot &s = m_history[id % HISTORY_SIZE];
+    s.m_id    = id;
+    s.m_valid = true;
+    s.m_karts = karts;
+}   // storeSnapshot
+
+// ----------------------------------------------------------------------------
+/** Adds a new snapshot (on the sending side) and returns its id.
+ *  \param karts The quantized state of all karts.
+ */
+uint16_t KartSnapshotEncoder::addSnapshot(
+                                 const std::vector<QuantizedKartState> &karts)
+{
+    uint16_t id = m_next_id++;
+    storeSnapshot(id, karts);
+    return id;
+}   // addSnapshot
+
+// ----------------------------------------------------------------------------
+/** Returns the kart states of the snapshot with the given id, or NULL if
+ *  this snapshot is not (or not anymore) in the history.
+ */
+const std::vector<QuantizedKartState>*
+                             KartSnapshotEncoder::getSnapshot(uint16_t id) const
+{
+    const Snapshot &s = m_history[id % HISTORY_SIZE];
+    if (!s.m_valid || s.m_id != id)
+        return NULL;
+    return &s.m_karts;
+}   // getSnapshot
+
+// ----------------------------------------------------------------------------
+/** Writes a quantized kart state without any delta compression. */
+void KartSnapshotEncoder::encodeState(const QuantizedKartState &state,
+                                      BareNetworkString *message)
+{
+    message->addUInt16(state.m_position[0]).addUInt16(state.m_position[1])
+            .addUInt16(state.m_position[2]).addUInt32(state.m_rotation);
+}   // encodeState
+
+// ----------------------------------------------------------------------------
+/** Reads a quantized kart state written with encodeState. */
+void KartSnapshotEncoder::decodeState(const BareNetworkString &message,
+                                      QuantizedKartState *state)
+{
+    for (unsigned int i = 0; i < 3; i++)
+        state->m_position[i] = message.getUInt16();
+    state->m_rotation = message.getUInt32();
+}   // decodeState
+
+// ----------------------------------------------------------------------------
+/** Encodes a stored snapshot into a message.
+ *  \param id Id of the snapshot to send.
+ *  \param baseline_id If not NULL the id of the snapshot that the receiver
+ *         has acknowledged. If this snapshot is still in the history, only
+ *         the differences to it are encoded, otherwise the full snapshot.
+ *  \param message The message to append the snapshot to.
+ */
+void KartSnapshotEncoder::encode(uint16_t id, const uint16_t *baseline_id,
+                                 BareNetworkString *message) const
+{
+    const std::vector<QuantizedKartState> *karts = getSnapshot(id);
+    assert(karts);
+    const std::vector<QuantizedKartState> *base = NULL;
+    if (baseline_id && isNewer(id, *baseline_id))
+    {
+        base = getSnapshot(*baseline_id);
+        if (base && base->size() != karts->size())
+            base = NULL;
+    }
+
+    unsigned int num_karts = (unsigned int)karts->size();
+    message->addUInt16(id).addUInt8(num_karts).addUInt8(base ? 1 : 0);
+    if (!base)
+    {
+        for (unsigned int i = 0; i < num_karts; i++)
+            encodeState((*karts)[i], message);
+        return;
+    }
+
+    message->addUInt16(*baseline_id);
+    // One bit for each kart that has changed since the baseline
+    for (unsigned int i = 0; i < num_karts; i += 8)
+    {
+        uint8_t mask = 0;
+        for (unsigned int j = i; j < num_karts && j < i + 8; j++)
+        {
+            if (!((*karts)[j] == (*base)[j]))
+                mask |= 1 << (j - i);
+        }
+        message->addUInt8(mask);
+    }
+
+    for (unsigned int i = 0; i < num_karts; i++)
+    {
+        const QuantizedKartState &cur = (*karts)[i];
+        const QuantizedKartState &old = (*base)[i];
+        if (cur == old) continue;
+
+        uint8_t flags = 0;
+        int delta[3];
+        bool small_delta = true;
+        for (unsigned int j = 0; j < 3; j++)
+        {
+            delta[j] = (int)cur.m_position[j] - (int)old.m_position[j];
+            if (delta[j] != 0) flags |= KS_POSITION_CHANGED;
+            if (delta[j] < -127 || delta[j] > 127) small_delta = false;
+        }
+        if ((flags & KS_POSITION_CHANGED) && small_delta)
+            flags |= KS_POSITION_DELTA;
+        if (cur.m_rotation != old.m_rotation)
+            flags |= KS_ROTATION_CHANGED;
+
+        message->addUInt8(flags);
+        if (flags & KS_POSITION_DELTA)
+        {
+            for (unsigned int j = 0; j < 3; j++)
+                message->addUInt8((uint8_t)(int8_t)delta[j]);
+        }
+        else if (flags & KS_POSITION_CHANGED)
+        {
+            for (unsigned int j = 0; j < 3; j++)
+                message->addUInt16(cur.m_position[j]);
+        }
+        if (flags & KS_ROTATION_CHANGED)
+            message->addUInt32(cur.m_rotation);
+    }   // for i < num_karts
+}   // encode
+
+// ----------------------------------------------------------------------------
+/** Decodes a snapshot (on the receiving side) and stores it in the history,
+ *  so that it can be used as baseline for later snapshots.
+ *  \param message The message, positioned at the start of the snapshot.
+ *  \param id On return the id of the decoded snapshot.
+ *  \return False if the message is too short, or if the baseline of a delta
+ *          encoded snapshot is not available (in which case the snapshot
+ *          can not be used).
+ */
+bool KartSnapshotEncoder::decode(const BareNetworkString &message,
+                                 uint16_t *id)
+{
+    // The messages come from the network, so the size must be checked
+    // before anything is read.
+    if (message.size() < 4)
+    {
+        Log::warn("KartSnapshot", "Snapshot message too short.");
+        return false;
+    }
+    *id                    = message.getUInt16();
+    unsigned int num_karts = message.getUInt8();
+    bool has_baseline      = message.getUInt8() != 0;
+
+    std::vector<QuantizedKartState> karts(num_karts);
+    if (!has_baseline)
+    {
+        if (message.size() < num_karts * STATE_SIZE)
+        {
+            Log::warn("KartSnapshot", "Snapshot %d too short.", *id);
+            return false;
+        }
+        for (unsigned int i = 0; i < num_karts; i++)
+            decodeState(message, &karts[i]);
+        storeSnapshot(*id, karts);
+        return true;
+    }
+
+    if (message.size() < 2 + (num_karts + 7) / 8)
+    {
+        Log::warn("KartSnapshot", "Snapshot %d too short.", *id);
+        return false;
+    }
+    uint16_t baseline_id = message.getUInt16();
+    const std::vector<QuantizedKartState> *base = getSnapshot(baseline_id);
+    if (!base || base->size() != num_karts)
+    {
+        Log::warn("KartSnapshot", "Baseline %d for snapshot %d not found.",
+                  baseline_id, *id);
+        return false;
+    }
+
+    std::vector<uint8_t> mask((num_karts + 7) / 8);
+    for (unsigned int i = 0; i < mask.size(); i++)
+        mask[i] = message.getUInt8();
+
+    for (unsigned int i = 0; i < num_karts; i++)
+    {
+        karts[i] = (*base)[i];
+        if ((mask[i / 8] & (1 << (i % 8))) == 0) continue;
+
+        if (message.size() < 1)
+        {
+            Log::warn("KartSnapshot", "Snapshot %d too short.", *id);
+            return false;
+        }
+        uint8_t flags = message.getUInt8();
+        unsigned int needed = 0;
+        if (flags & KS_POSITION_DELTA)
+            needed += 3;
+        else if (flags & KS_POSITION_CHANGED)
+            needed += 6;
+        if (flags & KS_ROTATION_CHANGED)
+            needed += 4;
+        if (message.size() < needed)
+        {
+            Log::warn("KartSnapshot", "Snapshot %d too short.", *id);
+            return false;
+        }
+        if (flags & KS_POSITION_DELTA)
+        {
+            for (unsigned int j = 0; j < 3; j++)
+            {
+                int8_t delta = (int8_t)message.getUInt8();
+                karts[i].m_position[j] =
+                           (uint16_t)((int)karts[i].m_position[j] + delta);
+            }
+        }
+        else if (flags & KS_POSITION_CHANGED)
+        {
+            for (unsigned int j = 0; j < 3; j++)
+                karts[i].m_position[j] = message.getUInt16();
+        }
+        if (flags & KS_ROTATION_CHANGED)
+            karts[i].m_rotation = message.getUInt32();
+    }   // for i < num_karts
+
+    storeSnapshot(*id, karts);
+    return true;
+}   // decode
+
+// ----------------------------------------------------------------------------
+/** Unit testing function.
+ */
+void KartSnapshotEncoder::unitTesting()
+{
+    KartSnapshotEncoder server(Vec3(-100, -10, -200), Vec3(100, 50, 200));
+    KartSnapshotEncoder client(Vec3(-100, -10, -200), Vec3(100, 50, 200));
+
+    // Check quaternion compression for a set of rotations
+    for (int i = 0; i < 32; i++)
+    {
+        btQuaternion q(btVector3(0.3f*i, 1.0f, -0.2f*i).normalized(),
+                       0.4f*i - 6.0f);
+        btQuaternion r = decompressQuaternion(compressQuaternion(q));
+        // q and -q are the same rotation
+        assert(fabsf(fabsf(q.dot(r)) - 1.0f) < 0.001f);
+    }
+
+    // Check that position quantization is accurate to 1cm
+    QuantizedKartState state;
+    Vec3 xyz(12.345f, 3.21f, -123.456f), xyz_out;
+    btQuaternion q(btVector3(0, 1, 0), 1.0f), q_out;
+    server.quantize(xyz, q, &state);
+    server.dequantize(state, &xyz_out, &q_out);
+    assert((xyz - xyz_out).length() < 0.01f);
+    // Positions outside of the bounding box are clamped
+    server.quantize(Vec3(0, -1000.0f, 0), q, &state);
+    assert(state.m_position[1] == 0);
+
+    // Full snapshot, then a delta with one moved and one unchanged kart
+    std::vector<QuantizedKartState> karts(2);
+    server.quantize(Vec3(1, 2, 3), q, &karts[0]);
+    server.quantize(Vec3(4, 5, 6), q, &karts[1]);
+    uint16_t id0 = server.addSnapshot(karts);
+    BareNetworkString full;
+    server.encode(id0, NULL, &full);
+
+    uint16_t id;
+    assert(client.decode(full, &id));
+    assert(id == id0);
+    assert((*client.getSnapshot(id0))[1] == karts[1]);
+
+    server.quantize(Vec3(1.1f, 2, 3), q, &karts[0]);
+    uint16_t id1 = server.addSnapshot(karts);
+    BareNetworkString delta;
+    server.encode(id1, &id0, &delta);
+    assert(delta.getTotalSize() < full.getTotalSize());
+    assert(client.decode(delta, &id));
+    assert(id == id1);
+    assert((*client.getSnapshot(id1))[0] == karts[0]);
+    assert((*client.getSnapshot(id1))[1] == karts[1]);
+
+    // A delta against an unknown baseline must be rejected
+    KartSnapshotEncoder other(Vec3(-100, -10, -200), Vec3(100, 50, 200));
+    BareNetworkString delta2;
+    server.encode(id1, &id0, &delta2);
+    assert(!other.decode(delta2, &id));
+
+    // Truncated messages must be rejected without reading past their end
+    for (unsigned int n = 0; n < full.getTotalSize(); n++)
+    {
+        BareNetworkString truncated(full.getData(), n);
+        assert(!client.decode(truncated, &id));
+    }
+    for (unsigned int n = 0; n < delta.getTotalSize(); n++)
+    {
+        BareNetworkString truncated(delta.getData(), n);
+        assert(!client.decode(truncated, &id));
+    }
+
+    assert( isNewer(1, 0));
+    assert(!isNewer(0, 1));
+    assert( isNewer(2, 65534));
+}   // unitTesting
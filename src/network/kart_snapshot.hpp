@@ -0,0 +1,130 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2016 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+/*! \file kart_snapshot.hpp
+ *  \brief Compact encoding of the position and rotation of all karts.
+ */
+
+#ifndef HEADER_KART_SNAPSHOT_HPP
+#define HEADER_KART_SNAPSHOT_HPP
+
+#include "utils/no_copy.hpp"
+#include "utils/types.hpp"
+#include "utils/vec3.hpp"
+
+#include "LinearMath/btQuaternion.h"
+
+#include <vector>
+
+class BareNetworkString;
+
+/** The quantized state of one kart: each coordinate of the position is
+ *  stored as 16 bit fixed point relative to the track bounding box, and
+ *  the rotation as 'smallest three' compressed quaternion in 32 bit.
+ *  \ingroup network
+ */
+struct QuantizedKartState
+{
+    uint16_t m_position[3];
+    uint32_t m_rotation;
+
+    bool operator==(const QuantizedKartState &other) const
+    {
+        return m_position[0] == other.m_position[0] &&
+               m_position[1] == other.m_position[1] &&
+               m_position[2] == other.m_position[2] &&
+               m_rotation    == other.m_rotation;
+    }   // operator==
+};   // QuantizedKartState
+
+// ============================================================================
+/** \class KartSnapshotEncoder
+ *  \brief Encodes and decodes the state of all karts for the network.
+ *  The server stores each snapshot it sends, and encodes each new snapshot
+ *  as delta against the last snapshot a client has acknowledged: karts
+ *  that have not changed are skipped, and small position changes are sent
+ *  as 8 bit offsets. The client keeps the snapshots it has received, so
+ *  it can reconstruct the full state from the acknowledged baseline.
+ *  \ingroup network
+ */
+class KartSnapshotEncoder : public NoCopy
+{
+public:
+    /** Number of snapshots kept as possible baselines. */
+    static const unsigned int HISTORY_SIZE = 32;
+
+private:
+    /** One stored snapshot. */
+    struct Snapshot
+    {
+        /** Id of this snapshot. */
+        uint16_t m_id;
+        /** True if this entry contains a snapshot. */
+        bool m_valid;
+        /** The state of all karts. */
+        std::vector<QuantizedKartState> m_karts;
+    };   // Snapshot
+
+    /** Snapshots indexed by id modulo HISTORY_SIZE. */
+    Snapshot m_history[HISTORY_SIZE];
+
+    /** Minimum corner of the volume used for position quantization. */
+    Vec3 m_min;
+
+    /** Size of one quantization step for each axis. */
+    Vec3 m_step;
+
+    /** Id of the next snapshot created with addSnapshot. */
+    uint16_t m_next_id;
+
+    void storeSnapshot(uint16_t id,
+                       const std::vector<QuantizedKartState> &karts);
+
+public:
+    /** Size in bytes of a kart state written by encodeState(). */
+    static const unsigned int STATE_SIZE = 10;
+
+         KartSnapshotEncoder(const Vec3 &aabb_min, const Vec3 &aabb_max);
+
+    void quantize(const Vec3 &xyz, const btQuaternion &q,
+                  QuantizedKartState *state) const;
+    void dequantize(const QuantizedKartState &state, Vec3 *xyz,
+                    btQuaternion *q) const;
+    uint16_t addSnapshot(const std::vector<QuantizedKartState> &karts);
+    const std::vector<QuantizedKartState>* getSnapshot(uint16_t id) const;
+    void encode(uint16_t id, const uint16_t *baseline_id,
+                BareNetworkString *message) const;
+    bool decode(const BareNetworkString &message, uint16_t *id);
+    static uint32_t     compressQuaternion(const btQuaternion &q);
+    static btQuaternion decompressQuaternion(uint32_t c);
+    static void         encodeState(const QuantizedKartState &state,
+                                    BareNetworkString *message);
+    static void         decodeState(const BareNetworkString &message,
+                                    QuantizedKartState *state);
+    static void         unitTesting();
+
+    // ------------------------------------------------------------------------
+    /** Returns true if snapshot id a is newer than snapshot id b, taking
+     *  the wrap around of the 16 bit ids into account. */
+    static bool isNewer(uint16_t a, uint16_t b)
+    {
+        return (int16_t)(a - b) > 0;
+    }   // isNewer
+};   // KartSnapshotEncoder
+
+#endif
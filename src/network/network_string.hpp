@@ -331,6 +331,10 @@ public:
 class NetworkString : public BareNetworkString
 {
 public:
+    /** The token used in messages the server sends to all clients. It is
+     *  never used as the token of a peer. */
+    static const uint32_t BROADCAST_TOKEN = 0;
+
     static void unitTesting();
         
     /** Constructor for a message to be sent. It sets the 
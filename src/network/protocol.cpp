@@ -123,19 +123,16 @@ void Protocol::findAndTerminateProtocol(ProtocolType type)
 }   // findAndTerminateProtocol
 
 // ----------------------------------------------------------------------------
-/** Sends a message to all peers, inserting the peer's token into the message.
- *  The message is composed of a 1-byte message (usually the message type)
- *  followed by the token of this client and then actual message).
+/** Sends a message from the server to all peers. The message is composed of
+ *  a 1-byte message (usually the message type) followed by the broadcast
+ *  token and then actual message). One packet is shared by all peers, see
+ *  STKHost::sendPacketExcept().
  *  \param message The actual message content.
 */
 void Protocol::sendMessageToPeersChangingToken(NetworkString *message,
                                                bool reliable)
 {
-    const std::vector<STKPeer*> &peers = STKHost::get()->getPeers();
-    for (unsigned int i = 0; i < peers.size(); i++)
-    {
-        peers[i]->sendPacket(message, reliable);
-    }
+    STKHost::get()->sendPacketToAllPeers(message, reliable);
 }   // sendMessageToPeersChangingToken
 
 // ----------------------------------------------------------------------------
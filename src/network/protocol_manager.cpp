@@ -33,6 +33,8 @@
 
 
 ProtocolManager::ProtocolManager()
+               : m_synchronous_events(1024), m_asynchronous_events(1024),
+                 m_requests(256)
 {
     pthread_mutex_init(&m_asynchronous_protocols_mutex, NULL);
     m_exit.setAtomic(false);
@@ -70,42 +72,57 @@ ProtocolManager::~ProtocolManager()
 void ProtocolManager::abort()
 {
     m_exit.setAtomic(true);
+    // Wait for the thread to finish, after that this thread is the only
+    // consumer of all queues.
+    pthread_join(*m_asynchronous_update_thread, NULL);
     pthread_mutex_lock(&m_asynchronous_protocols_mutex);
 
     m_protocols.lock();
     for (unsigned int i = 0; i < m_protocols.getData().size() ; i++)
         delete m_protocols.getData()[i];
     m_protocols.getData().clear();
+    for (unsigned int i = 0; i < PROTOCOL_SYNCHRONOUS; i++)
+        m_protocols_by_type[i].clear();
     m_protocols.unlock();
 
-    m_events_to_process.lock();
-    for (unsigned int i = 0; i < m_events_to_process.getData().size() ; i++)
-        delete m_events_to_process.getData()[i];
-    m_events_to_process.getData().clear();
-    m_events_to_process.unlock();
-    
-    
-    m_requests.lock();
-    m_requests.getData().clear();
-    m_requests.unlock();
+    Event *event;
+    while (m_synchronous_events.pop(&event))
+        delete event;
+    while (m_asynchronous_events.pop(&event))
+        delete event;
+    for (unsigned int i = 0; i < m_pending_synchronous_events.size(); i++)
+        delete m_pending_synchronous_events[i];
+    m_pending_synchronous_events.clear();
+    for (unsigned int i = 0; i < m_pending_asynchronous_events.size(); i++)
+        delete m_pending_asynchronous_events[i];
+    m_pending_asynchronous_events.clear();
+
+    ProtocolRequest request;
+    while (m_requests.pop(&request)) {}
+    m_pending_terminations.lock();
+    m_pending_terminations.getData().clear();
+    m_pending_terminations.unlock();
 
     pthread_mutex_unlock(&m_asynchronous_protocols_mutex);
 
     pthread_mutex_destroy(&m_asynchronous_protocols_mutex);
-    pthread_join(*m_asynchronous_update_thread, NULL); // wait the thread to finish
 }   // abort
 
 // ----------------------------------------------------------------------------
 /** \brief Function that processes incoming events.
  *  This function is called by the network manager each time there is an
- *  incoming packet.
+ *  incoming packet. The event is queued for either the main thread or the
+ *  ProtocolManager thread, depending on whether it is synchronous.
  */
 void ProtocolManager::propagateEvent(Event* event)
 {
-    m_events_to_process.lock();
-    m_events_to_process.getData().push_back(event); 
-    m_events_to_process.unlock();
-    return;
+    MPSCQueue<Event*> &queue = event->isSynchronous() ? m_synchronous_events
+                                                      : m_asynchronous_events;
+    if (!queue.push(event))
+    {
+        Log::warn("ProtocolManager",
+                  "Event queue is full, events are processed too slowly.");
+    }
 }   // propagateEvent
 
 // ----------------------------------------------------------------------------
@@ -122,9 +139,7 @@ uint32_t ProtocolManager::requestStart(Protocol* protocol)
     // create the request
     ProtocolRequest req(PROTOCOL_REQUEST_START, protocol);
     // add it to the request stack
-    m_requests.lock();
-    m_requests.getData().push_back(req);
-    m_requests.unlock();
+    m_requests.push(req);
 
     return req.getProtocol()->getId();
 }   // requestStart
@@ -142,9 +157,7 @@ void ProtocolManager::requestPause(Protocol* protocol)
     // create the request
     ProtocolRequest req(PROTOCOL_REQUEST_PAUSE, protocol);
     // add it to the request stack
-    m_requests.lock();
-    m_requests.getData().push_back(req);
-    m_requests.unlock();
+    m_requests.push(req);
 }   // requestPause
 
 // ----------------------------------------------------------------------------
@@ -158,11 +171,9 @@ void ProtocolManager::requestUnpause(Protocol* protocol)
     if (!protocol)
         return;
     // create the request
-    ProtocolRequest req(PROTOCOL_REQUEST_UNPAUSE, protocol);;
+    ProtocolRequest req(PROTOCOL_REQUEST_UNPAUSE, protocol);
     // add it to the request stack
-    m_requests.lock();
-    m_requests.getData().push_back(req);
-    m_requests.unlock();
+    m_requests.push(req);
 }   // requestUnpause
 
 // ----------------------------------------------------------------------------
@@ -177,19 +188,16 @@ void ProtocolManager::requestTerminate(Protocol* protocol)
         return;
     // create the request
     ProtocolRequest req(PROTOCOL_REQUEST_TERMINATE, protocol);
-    // add it to the request stack
-    m_requests.lock();
     // check that the request does not already exist :
-    for (unsigned int i = 0; i < m_requests.getData().size(); i++)
+    m_pending_terminations.lock();
+    if (!m_pending_terminations.getData().insert(protocol).second)
     {
-        if (m_requests.getData()[i].m_protocol == protocol)
-        {
-            m_requests.unlock();
-            return;
-        }
+        m_pending_terminations.unlock();
+        return;
     }
-    m_requests.getData().push_back(req);
-    m_requests.unlock();
+    m_pending_terminations.unlock();
+    // add it to the request stack
+    m_requests.push(req);
 }   // requestTerminate
 
 // ----------------------------------------------------------------------------
@@ -207,6 +215,8 @@ void ProtocolManager::startProtocol(Protocol *protocol)
               typeid(*protocol).name(), protocol->getId(),
               m_protocols.getData().size()+1);
     m_protocols.getData().push_back(protocol);
+    if (protocol->getProtocolType() < PROTOCOL_SYNCHRONOUS)
+        m_protocols_by_type[protocol->getProtocolType()].push_back(protocol);
     // setup the protocol and notify it that it's started
     protocol->setup();
     protocol->setState(PROTOCOL_STATE_RUNNING);
@@ -260,6 +270,19 @@ void ProtocolManager::terminateProtocol(Protocol *protocol)
             offset++;
         }
     }
+    if (protocol->getProtocolType() < PROTOCOL_SYNCHRONOUS)
+    {
+        std::vector<Protocol*> &same_type =
+            m_protocols_by_type[protocol->getProtocolType()];
+        for (unsigned int i = 0; i < same_type.size(); i++)
+        {
+            if (same_type[i] == protocol)
+            {
+                same_type.erase(same_type.begin() + i);
+                break;
+            }
+        }
+    }
     Log::info("ProtocolManager",
               "A %s protocol has been terminated. There are %ld protocols running.",
               protocol_type.c_str(), m_protocols.getData().size());
@@ -275,30 +298,35 @@ bool ProtocolManager::sendEvent(Event* event)
 {
     m_protocols.lock();
     int count=0;
-    for(unsigned int i=0; i<m_protocols.getData().size(); i++)
+    if (event->getType() == EVENT_TYPE_MESSAGE)
     {
-        Protocol *p = m_protocols.getData()[i];
-        bool is_right_protocol = false;
-        switch(event->getType())
+        // Messages are only delivered to protocols of the same type,
+        // so use the dispatch table instead of testing all protocols.
+        const std::vector<Protocol*> &receivers =
+            m_protocols_by_type[event->data().getProtocolType()];
+        for (unsigned int i = 0; i < receivers.size(); i++)
         {
-        case EVENT_TYPE_MESSAGE:
-            is_right_protocol = event->data().getProtocolType()==p->getProtocolType();
-            break;
-        case EVENT_TYPE_DISCONNECTED:
-            is_right_protocol = p->handleDisconnects();
-            break;
-        case EVENT_TYPE_CONNECTED:
-            is_right_protocol = p->handleConnects(); 
-            break;
-        }   // switch event->getType()
-
-        if( is_right_protocol)  
-        {
-            count ++;
-            event->isSynchronous() ? p->notifyEvent(event)
-                                   : p->notifyEventAsynchronous(event);
+            count++;
+            event->isSynchronous() ? receivers[i]->notifyEvent(event)
+                                   : receivers[i]->notifyEventAsynchronous(event);
         }
-    }   // for i in protocols
+    }
+    else
+    {
+        for (unsigned int i = 0; i < m_protocols.getData().size(); i++)
+        {
+            Protocol *p = m_protocols.getData()[i];
+            bool is_right_protocol =
+                event->getType() == EVENT_TYPE_DISCONNECTED
+                                  ? p->handleDisconnects()
+                                  : p->handleConnects();
+            if (is_right_protocol)
+            {
+                count++;
+                p->notifyEventAsynchronous(event);
+            }
+        }   // for i in protocols
+    }
 
     m_protocols.unlock();
 
@@ -311,6 +339,25 @@ bool ProtocolManager::sendEvent(Event* event)
     return false;
 }   // sendEvent
 
+// ----------------------------------------------------------------------------
+/** Sends all events in the given list to the corresponding protocols. Events
+ *  that could not be delivered (and have not timed out) are kept in the list
+ *  so that they are tried again next time.
+ *  \param events The list of events, which must only be used by the
+ *         calling thread.
+ */
+void ProtocolManager::sendEvents(std::vector<Event*> *events)
+{
+    unsigned int kept = 0;
+    for (unsigned int i = 0; i < events->size(); i++)
+    {
+        Event *event = (*events)[i];
+        if (!sendEvent(event))
+            (*events)[kept++] = event;
+    }
+    events->resize(kept);
+}   // sendEvents
+
 // ----------------------------------------------------------------------------
 /** \brief Updates the manager.
  *
@@ -324,23 +371,11 @@ bool ProtocolManager::sendEvent(Event* event)
 void ProtocolManager::update(float dt)
 {
     // before updating, notify protocols that they have received events
-    m_events_to_process.lock();
-    int size = (int)m_events_to_process.getData().size();
-    int offset = 0;
-    for (int i = 0; i < size; i++)
-    {
-        // Don't handle asynchronous events here.
-        if(!m_events_to_process.getData()[i+offset]->isSynchronous()) continue;
-        bool result = sendEvent(m_events_to_process.getData()[i+offset]);
-        if (result)
-        {
-            m_events_to_process.getData()
-                               .erase(m_events_to_process.getData().begin()+(i+offset),
-                                      m_events_to_process.getData().begin()+(i+offset+1));
-            offset --;
-        }
-    }
-    m_events_to_process.unlock();
+    Event *event;
+    while (m_synchronous_events.pop(&event))
+        m_pending_synchronous_events.push_back(event);
+    sendEvents(&m_pending_synchronous_events);
+
     // now update all protocols
     m_protocols.lock();
     for (unsigned int i = 0; i < m_protocols.getData().size(); i++)
@@ -363,23 +398,10 @@ void ProtocolManager::update(float dt)
 void ProtocolManager::asynchronousUpdate()
 {
     // before updating, notice protocols that they have received information
-    m_events_to_process.lock();
-    int size = (int)m_events_to_process.getData().size();
-    int offset = 0;
-    for (int i = 0; i < size; i++)
-    {
-        // Don't handle synchronous events here.
-        if(m_events_to_process.getData()[i+offset]->isSynchronous()) continue;
-        bool result = sendEvent(m_events_to_process.getData()[i+offset]);
-        if (result)
-        {
-            m_events_to_process.getData()
-                               .erase(m_events_to_process.getData().begin()+(i+offset),
-                                      m_events_to_process.getData().begin()+(i+offset+1));
-            offset --;
-        }
-    }
-    m_events_to_process.unlock();
+    Event *event;
+    while (m_asynchronous_events.pop(&event))
+        m_pending_asynchronous_events.push_back(event);
+    sendEvents(&m_pending_asynchronous_events);
 
     // now update all protocols that need to be updated in asynchronous mode
     pthread_mutex_lock(&m_asynchronous_protocols_mutex);
@@ -392,16 +414,11 @@ void ProtocolManager::asynchronousUpdate()
     pthread_mutex_unlock(&m_asynchronous_protocols_mutex);
 
     // Process queued events for protocols
-    // these requests are asynchronous
-    m_requests.lock();
-    while(m_requests.getData().size()>0)
+    // these requests are asynchronous. New requests can be queued up while
+    // handling requests (e.g. terminating a protocol often unpauses another)
+    ProtocolRequest request;
+    while (m_requests.pop(&request))
     {
-        ProtocolRequest request = m_requests.getData()[0];
-        m_requests.getData().erase(m_requests.getData().begin());
-        m_requests.unlock();
-        // Make sure new requests can be queued up while handling requests.
-        // This is often used that terminating a protocol unpauses another,
-        // so the m_requests queue must not be locked while executing requests.
         switch (request.getType())
         {
             case PROTOCOL_REQUEST_START:
@@ -414,12 +431,13 @@ void ProtocolManager::asynchronousUpdate()
                 unpauseProtocol(request.getProtocol());
                 break;
             case PROTOCOL_REQUEST_TERMINATE:
+                m_pending_terminations.lock();
+                m_pending_terminations.getData().erase(request.getProtocol());
+                m_pending_terminations.unlock();
                 terminateProtocol(request.getProtocol());
                 break;
         }   // switch (type)
-        m_requests.lock();
-    }   // while m_requests.size()>0
-    m_requests.unlock();
+    }   // while m_requests.pop
 }   // asynchronousUpdate
 
 // ----------------------------------------------------------------------------
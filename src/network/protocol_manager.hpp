@@ -25,11 +25,13 @@
 
 #include "network/network_string.hpp"
 #include "network/protocol.hpp"
+#include "utils/mpsc_queue.hpp"
 #include "utils/no_copy.hpp"
 #include "utils/singleton.hpp"
 #include "utils/synchronised.hpp"
 #include "utils/types.hpp"
 
+#include <set>
 #include <vector>
 
 class Event;
@@ -65,6 +67,12 @@ public:
     Protocol *m_protocol;
 
 public:
+    ProtocolRequest()
+    {
+        m_type     = PROTOCOL_REQUEST_START;
+        m_protocol = NULL;
+    }   // ProtocolRequest
+    // ------------------------------------------------------------------------
     ProtocolRequest(ProtocolRequestType type, Protocol *protocol)
     {
         m_type     = type;
@@ -101,12 +109,35 @@ private:
      *  state and their unique id. */
     Synchronised<std::vector<Protocol*> >m_protocols;
 
-    /** Contains the network events to pass asynchronously to protocols
-     *  (i.e. from the separate ProtocolManager thread). */
-    Synchronised<std::vector<Event*> > m_events_to_process;
+    /** For each protocol type the running protocols of that type, so that
+     *  a message can be delivered without searching all protocols. Indexed
+     *  by the protocol type (without the synchronous flag), and protected
+     *  by the m_protocols lock. */
+    std::vector<Protocol*> m_protocols_by_type[PROTOCOL_SYNCHRONOUS];
+
+    /** Network events that are delivered synchronously, i.e. from the main
+     *  thread in update(). Filled by the STKHost listening thread. */
+    MPSCQueue<Event*> m_synchronous_events;
+
+    /** Network events to pass asynchronously to protocols (i.e. from the
+     *  separate ProtocolManager thread). */
+    MPSCQueue<Event*> m_asynchronous_events;
+
+    /** Synchronous events that have been taken from the queue, but not
+     *  been handled by any protocol yet. Only accessed by the main thread.*/
+    std::vector<Event*> m_pending_synchronous_events;
+
+    /** Asynchronous events that have been taken from the queue, but not
+     *  been handled by any protocol yet. Only accessed by the
+     *  ProtocolManager thread. */
+    std::vector<Event*> m_pending_asynchronous_events;
 
     /** Contains the requests to start/pause etc... protocols. */
-    Synchronised< std::vector<ProtocolRequest> > m_requests;
+    MPSCQueue<ProtocolRequest> m_requests;
+
+    /** Protocols for which a terminate request is queued, so that the same
+     *  protocol is not terminated twice. */
+    Synchronised<std::set<Protocol*> > m_pending_terminations;
 
     /*! \brief The next id to assign to a protocol.
      * This value is incremented by 1 each time a protocol is started.
@@ -130,6 +161,7 @@ private:
     static void* mainLoop(void *data);
     uint32_t     getNextProtocolId();
     bool         sendEvent(Event* event);
+    void         sendEvents(std::vector<Event*> *events);
 
     virtual void startProtocol(Protocol *protocol);
     virtual void terminateProtocol(Protocol *protocol);
@@ -1,20 +1,27 @@
 #include "network/protocols/kart_update_protocol.hpp"
 
+#include "config/user_config.hpp"
 #include "karts/abstract_kart.hpp"
 #include "karts/controller/controller.hpp"
 #include "modes/world.hpp"
 #include "network/event.hpp"
+#include "network/kart_snapshot.hpp"
 #include "network/network_config.hpp"
 #include "network/protocol_manager.hpp"
+#include "network/stk_host.hpp"
+#include "network/stk_peer.hpp"
+#include "tracks/track.hpp"
 #include "utils/time.hpp"
 
 KartUpdateProtocol::KartUpdateProtocol() : Protocol(PROTOCOL_KART_UPDATE)
 {
+    m_encoder = NULL;
 }   // KartUpdateProtocol
 
 // ----------------------------------------------------------------------------
 KartUpdateProtocol::~KartUpdateProtocol()
 {
+    delete m_encoder;
 }   // ~KartUpdateProtocol
 
 // ----------------------------------------------------------------------------
@@ -30,6 +37,15 @@ void KartUpdateProtocol::setup()
     m_was_updated = false;
 
     m_previous_time = 0;
+
+    // Positions are quantized relative to the track bounding box
+    const Vec3 *aabb_min, *aabb_max;
+    World::getWorld()->getTrack()->getAABB(&aabb_min, &aabb_max);
+    delete m_encoder;
+    m_encoder = new KartSnapshotEncoder(*aabb_min, *aabb_max);
+    m_acked_snapshots.clear();
+    m_has_received_snapshot  = false;
+    m_last_received_snapshot = 0;
 }   // setup
 
 // ----------------------------------------------------------------------------
@@ -43,29 +59,130 @@ bool KartUpdateProtocol::notifyEvent(Event* event)
     if (event->getType() != EVENT_TYPE_MESSAGE || !World::getWorld())
         return true;
     NetworkString &ns = event->data();
-    if (ns.size() < 33)
+    if (ns.size() < 5)
     {
         Log::info("KartUpdateProtocol", "Message too short.");
         return true;
     }
     float time = ns.getFloat();
-    while(ns.size() >= 29)
+
+    if (NetworkConfig::get()->isServer())
+    {
+        // A client update: the acknowledged snapshot followed by the
+        // full state of all local karts of that client.
+        int host_id = event->getPeer()->getHostId();
+        if (ns.getUInt8())
+        {
+            if (ns.size() < 2)
+            {
+                Log::info("KartUpdateProtocol", "Message too short.");
+                return true;
+            }
+            m_acked_snapshots[host_id] = ns.getUInt16();
+        }
+        else
+            m_acked_snapshots.erase(host_id);
+        while (ns.size() >= 1 + KartSnapshotEncoder::STATE_SIZE)
+        {
+            uint8_t kart_id = ns.getUInt8();
+            QuantizedKartState state;
+            KartSnapshotEncoder::decodeState(ns, &state);
+            if (kart_id >= m_next_positions.size()) continue;
+            m_encoder->dequantize(state, &m_next_positions[kart_id],
+                                  &m_next_quaternions[kart_id]);
+        }   // while ns.size()>=1+STATE_SIZE
+    }
+    else
     {
-        uint8_t kart_id             = ns.getUInt8();
-        Vec3 xyz                    = ns.getVec3();
-        btQuaternion quat           = ns.getQuat();
-        m_next_positions  [kart_id] = xyz;
-        m_next_quaternions[kart_id] = quat;
-    }   // while ns.size()>29
+        uint16_t id;
+        if (!m_encoder->decode(ns, &id))
+            return true;
+        // Ignore snapshots that arrive out of order.
+        if (m_has_received_snapshot &&
+            !KartSnapshotEncoder::isNewer(id, m_last_received_snapshot))
+            return true;
+        const std::vector<QuantizedKartState> &karts =
+                                                  *m_encoder->getSnapshot(id);
+        for (unsigned int i = 0;
+             i < karts.size() && i < m_next_positions.size(); i++)
+        {
+            m_encoder->dequantize(karts[i], &m_next_positions[i],
+                                  &m_next_quaternions[i]);
+        }
+        m_has_received_snapshot  = true;
+        m_last_received_snapshot = id;
+    }
 
     // Set the flag that a new update was received
     m_was_updated = true;
     return true;
 }   // notifyEvent
 
+// ----------------------------------------------------------------------------
+/** Sends the state of all karts to all clients. Each client receives the
+ *  snapshot delta-compressed against the last snapshot it acknowledged.
+ */
+void KartUpdateProtocol::sendServerUpdate()
+{
+    World *world = World::getWorld();
+    std::vector<QuantizedKartState> karts(world->getNumKarts());
+    for (unsigned int i = 0; i < world->getNumKarts(); i++)
+    {
+        AbstractKart* kart = world->getKart(i);
+        m_encoder->quantize(kart->getXYZ(), kart->getRotation(), &karts[i]);
+    }
+    uint16_t id = m_encoder->addSnapshot(karts);
+
+    const std::vector<STKPeer*> &peers = STKHost::get()->getPeers();
+    for (unsigned int i = 0; i < peers.size(); i++)
+    {
+        NetworkString *ns = getNetworkString(8+world->getNumKarts()*10);
+        ns->setSynchronous(true);
+        ns->addFloat( world->getTime() );
+        std::map<int, uint16_t>::const_iterator acked =
+                                m_acked_snapshots.find(peers[i]->getHostId());
+        m_encoder->encode(id, acked == m_acked_snapshots.end()
+                              ? NULL : &acked->second, ns);
+        peers[i]->sendPacket(ns, /*reliable*/false);
+        delete ns;
+    }
+    Log::verbose("KartUpdateProtocol", "Sent snapshot %d to %d peers",
+                 id, (int)peers.size());
+}   // sendServerUpdate
+
+// ----------------------------------------------------------------------------
+/** Sends the state of all local karts to the server, together with the
+ *  id of the last received snapshot.
+ */
+void KartUpdateProtocol::sendClientUpdate()
+{
+    NetworkString *ns =
+        getNetworkString(7+11*race_manager->getNumLocalPlayers());
+    ns->setSynchronous(true);
+    ns->addFloat(World::getWorld()->getTime());
+    ns->addUInt8(m_has_received_snapshot ? 1 : 0);
+    if (m_has_received_snapshot)
+        ns->addUInt16(m_last_received_snapshot);
+    for(unsigned int i=0; i<race_manager->getNumLocalPlayers(); i++)
+    {
+        AbstractKart *kart = World::getWorld()->getLocalPlayerKart(i);
+        const Vec3 &xyz = kart->getXYZ();
+        QuantizedKartState state;
+        m_encoder->quantize(xyz, kart->getRotation(), &state);
+        ns->addUInt8(kart->getWorldKartId());
+        KartSnapshotEncoder::encodeState(state, ns);
+        Log::verbose("KartUpdateProtocol",
+                     "Sending %d's positions %f %f %f",
+                      kart->getWorldKartId(), xyz[0], xyz[1], xyz[2]);
+    }
+    sendToServer(ns, /*reliable*/false);
+    delete ns;
+}   // sendClientUpdate
+
 // ----------------------------------------------------------------------------
 /** Sends regular update events from the server to all clients and from the
- *  clients to the server (FIXME - is that actually necessary??)
+ *  clients to the server (FIXME - is that actually necessary??). The number
+ *  of updates per second is set with the network_state_frequency option.
  *  Then it applies all update events that have been received in notifyEvent.
  *  This two-part implementation means that if the server should send two
  *  or more updates before this client handles them, only the last one will
@@ -76,49 +193,17 @@ void KartUpdateProtocol::update(float dt)
     if (!World::getWorld())
         return;
 
+    int frequency = UserConfigParams::m_network_state_frequency;
+    double interval = frequency > 0 ? 1.0 / frequency : 0.1;
     double current_time = StkTime::getRealTime();
-    if (current_time > m_previous_time + 0.1) // 10 updates per second
+    if (current_time > m_previous_time + interval)
     {
         m_previous_time = current_time;
         if (NetworkConfig::get()->isServer())
-        {
-            World *world = World::getWorld();
-            NetworkString *ns = getNetworkString(4+world->getNumKarts()*29);
-            ns->setSynchronous(true);
-            ns->addFloat( world->getTime() );
-            for (unsigned int i = 0; i < world->getNumKarts(); i++)
-            {
-                AbstractKart* kart = world->getKart(i);
-                Vec3 xyz = kart->getXYZ();
-                ns->addUInt8( kart->getWorldKartId());
-                ns->add(xyz).add(kart->getRotation());
-                Log::verbose("KartUpdateProtocol",
-                             "Sending %d's positions %f %f %f",
-                             kart->getWorldKartId(), xyz[0], xyz[1], xyz[2]);
-            }
-            sendMessageToPeersChangingToken(ns, /*reliable*/false);
-            delete ns;
-        }
+            sendServerUpdate();
         else
-        {
-            NetworkString *ns =
-                     getNetworkString(4+29*race_manager->getNumLocalPlayers());
-            ns->setSynchronous(true);
-            ns->addFloat(World::getWorld()->getTime());
-            for(unsigned int i=0; i<race_manager->getNumLocalPlayers(); i++)
-            {
-                AbstractKart *kart = World::getWorld()->getLocalPlayerKart(i);
-                const Vec3 &xyz = kart->getXYZ();
-                ns->addUInt8(kart->getWorldKartId());
-                ns->add(xyz).add(kart->getRotation());
-                Log::verbose("KartUpdateProtocol",
-                             "Sending %d's positions %f %f %f",
-                              kart->getWorldKartId(), xyz[0], xyz[1], xyz[2]);
-            }
-            sendToServer(ns, /*reliable*/false);
-            delete ns;
-        }   // if server
-    }   // if (current_time > time + 0.1)
+            sendClientUpdate();
+    }   // if (current_time > time + interval)
 
 
     // Now handle all update events that have been received.
@@ -7,10 +7,12 @@
 
 #include "LinearMath/btQuaternion.h"
 
+#include <map>
 #include <vector>
 #include "pthread.h"
 
 class AbstractKart;
+class KartSnapshotEncoder;
 
 class KartUpdateProtocol : public Protocol
 {
@@ -29,6 +31,24 @@ private:
      * a fixed frequency. */
     double m_previous_time;
 
+    /** Quantizes and delta-compresses the kart states. On the server it
+     *  stores the sent snapshots, on a client the received ones. */
+    KartSnapshotEncoder *m_encoder;
+
+    /** Server only: the last snapshot each client (indexed by host id)
+     *  has acknowledged, used as baseline for delta compression. */
+    std::map<int, uint16_t> m_acked_snapshots;
+
+    /** Client only: true if a snapshot was received. */
+    bool m_has_received_snapshot;
+
+    /** Client only: id of the newest received snapshot, which is sent
+     *  back to the server as acknowledgement. */
+    uint16_t m_last_received_snapshot;
+
+    void sendServerUpdate();
+    void sendClientUpdate();
+
 public:
              KartUpdateProtocol();
     virtual ~KartUpdateProtocol();
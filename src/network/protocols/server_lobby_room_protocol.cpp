@@ -475,6 +475,9 @@ void ServerLobbyRoomProtocol::connectionRequested(Event* event)
                                 (token_generator.get(RAND_MAX) & 0xff) << 16 |
                                 (token_generator.get(RAND_MAX) & 0xff) <<  8 |
                                 (token_generator.get(RAND_MAX) & 0xff));
+    // The broadcast token is reserved for messages sent to all clients.
+    if (token == NetworkString::BROADCAST_TOKEN)
+        token++;
 
     peer->setClientServerToken(token);
     peer->setAuthorised(is_authorised);
@@ -83,6 +83,7 @@ void RewindManager::reset()
     m_overall_state_size   = 0;
     m_state_frequency      = 0.1f;   // save 10 states a second
     m_last_saved_state     = -9999.9f;  // forces initial state save
+    m_max_rewind_time      = 2.0f;
 
     if(!m_enable_rewind_manager) return;
 
@@ -107,6 +108,36 @@ void RewindManager::reset()
     m_rewind_info.clear();
 }   // reset
 
+// ----------------------------------------------------------------------------
+/** Binary search in the (sorted) list of rewind infos.
+ *  \param time The time to search for.
+ *  \param include_same_time If true, returns the index of the first entry
+ *         with a time larger than 'time', i.e. after all entries with the
+ *         same time. Otherwise returns the index of the first entry with
+ *         a time larger or equal to 'time'.
+ *  \return The index found, which is m_rewind_info.size() if there is no
+ *          such entry.
+ */
+unsigned int RewindManager::findIndexAfter(float time,
+                                           bool include_same_time) const
+{
+    unsigned int low  = 0;
+    unsigned int high = (unsigned int)m_rewind_info.size();
+    while(low<high)
+    {
+#ifdef REWIND_SEARCH_STATS
+        m_count_of_comparisons++;
+#endif
+        unsigned int mid = (low+high)/2;
+        float t = m_rewind_info[mid]->getTime();
+        if(t < time || (include_same_time && t==time))
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return low;
+}   // findIndexAfter
+
 // ----------------------------------------------------------------------------
 void RewindManager::insertRewindInfo(RewindInfo *ri)
 {
@@ -115,40 +146,21 @@ void RewindManager::insertRewindInfo(RewindInfo *ri)
 #endif
     float t = ri->getTime();
 
-    if(ri->isEvent())
-    {
-        // If there are several infos for the same time t,
-        // events must be inserted at the end 
-        AllRewindInfo::reverse_iterator i = m_rewind_info.rbegin();
-        while(i!=m_rewind_info.rend() && 
-            (*i)->getTime() > t)
-        {
-#ifdef REWIND_SEARCH_STATS
-            m_count_of_comparisons++;
-#endif
-            i++;
-        }
-        AllRewindInfo::iterator insert_point = i.base();
-        m_rewind_info.insert(insert_point,ri);
-        return;
+    // If there are several infos for the same time t, events must be
+    // inserted at the end, and states first.
+    bool after_same_time = ri->isEvent();
 
-    }
-    else   // is a state
+    // Most infos are added at the current time, i.e. at the end of the list
+    if(m_rewind_info.empty() ||
+       m_rewind_info.back()->getTime() < t ||
+       (after_same_time && m_rewind_info.back()->getTime()==t))
     {
-        // If there are several infos for the same time t,
-        // a state must be inserted first
-        AllRewindInfo::reverse_iterator i = m_rewind_info.rbegin();
-        while(i!=m_rewind_info.rend() && (*i)->getTime() >= t)
-        {
-#ifdef REWIND_SEARCH_STATS
-            m_count_of_comparisons++;
-#endif
-            i++;
-        }
-        AllRewindInfo::iterator insert_point = i.base();
-        m_rewind_info.insert(insert_point,ri);
+        m_rewind_info.push_back(ri);
         return;
     }
+
+    unsigned int index = findIndexAfter(t, after_same_time);
+    m_rewind_info.insert(m_rewind_info.begin()+index, ri);
 }   // insertRewindInfo
 
 // ----------------------------------------------------------------------------
@@ -161,49 +173,83 @@ void RewindManager::insertRewindInfo(RewindInfo *ri)
  */
 unsigned int RewindManager::findFirstIndex(float target_time) const
 {
-    // For now do a linear search, even though m_rewind_info is sorted
-    // I would expect that most insertions will be towards the (very)
-    // end of the list, since rewinds should be for short periods of time. 
-    // Note that after finding an entry in a binary search, you still
-    // have to do a linear search to find the last entry with the same
-    // time in order to minimise the later necessary memory move.
-
-    // Gather some statistics about search for now:
 #ifdef REWIND_SEARCH_STATS
     m_count_of_searches++;
 #endif
-    int index = m_rewind_info.size()-1;
-    int index_last_state = -1;
+    // Find the first entry at or after target_time, then go back to the
+    // previous state. States are saved frequently, so this only needs to
+    // skip a few time and event entries.
+    int index = (int)findIndexAfter(target_time, /*include_same_time*/false)-1;
     while(index>=0)
     {
 #ifdef REWIND_SEARCH_STATS
         m_count_of_comparisons++;
 #endif
         if(m_rewind_info[index]->isState())
+            return index;
+        index--;
+    }
+
+    // Otherwise use the first state - not much we can do in this case.
+    int index_first_state = -1;
+    for(unsigned int i=0; i<m_rewind_info.size(); i++)
+    {
+        if(m_rewind_info[i]->isState())
         {
-            if(m_rewind_info[index]->getTime()<target_time)
-            {
-                return index;
-            }
-            index_last_state = index;
+            index_first_state = i;
+            break;
         }
-        index--;
     }
 
-    if(index_last_state<0)
+    if(index_first_state<0)
     {
         Log::fatal("RewindManager",
                    "Can't find any state when rewinding to %f - aborting.",
                    target_time);
     }
 
-    // Otherwise use the last found state - not much we can do in this case.
     Log::error("RewindManager",
                "Can't find state to rewind to for time %f, using %f.",
-               target_time, m_rewind_info[index_last_state]->getTime());
-    return index_last_state;  // avoid compiler warning
+               target_time, m_rewind_info[index_first_state]->getTime());
+    return index_first_state;
 }   // findFirstIndex
 
+// ----------------------------------------------------------------------------
+/** Removes all rewind information that is older than the rollback window.
+ *  The newest set of states before the window is kept, since it is the
+ *  starting point for a rewind to the beginning of the window.
+ */
+void RewindManager::discardOldRewindInfo()
+{
+    float threshold = getCurrentTime() - m_max_rewind_time;
+    if(m_rewind_info.empty() || m_rewind_info.front()->getTime() >= threshold)
+        return;
+
+    // Find the last state at or before the threshold
+    int index = (int)findIndexAfter(threshold, /*include_same_time*/true)-1;
+    while(index>=0 && !m_rewind_info[index]->isState())
+        index--;
+    if(index<=0) return;
+
+    // All states of one snapshot have the same time, and are stored
+    // before any other info with that time.
+    float state_time = m_rewind_info[index]->getTime();
+    while(index>0 && m_rewind_info[index-1]->getTime()==state_time)
+        index--;
+
+    for(int i=0; i<index; i++)
+    {
+        RewindInfo *ri = m_rewind_info.front();
+        if(ri->isState())
+        {
+            RewindInfoState *state = static_cast<RewindInfoState*>(ri);
+            m_overall_state_size -= state->getBuffer()->getTotalSize();
+        }
+        delete ri;
+        m_rewind_info.pop_front();
+    }
+}   // discardOldRewindInfo
+
 // ----------------------------------------------------------------------------
 /** Adds an event to the rewind data. The data to be stored must be allocated
  *  and not freed by the caller!
@@ -251,7 +297,7 @@ void RewindManager::saveStates()
         BareNetworkString *buffer = m_all_rewinder[i]->saveState();
         if(buffer && buffer->size()>=0)
         {
-            m_overall_state_size += buffer->size();
+            m_overall_state_size += buffer->getTotalSize();
             RewindInfo *ri = new RewindInfoState(getCurrentTime(),
                                                  m_all_rewinder[i], buffer,
                                                  /*is_confirmed*/true);
@@ -268,6 +314,8 @@ void RewindManager::saveStates()
                  float(m_count_of_comparisons)/ float(m_count_of_searches) );
 
     m_last_saved_state = time;
+
+    discardOldRewindInfo();
 }   // saveStates
 
 // ----------------------------------------------------------------------------
@@ -23,6 +23,7 @@
 #include "utils/ptr_vector.hpp"
 
 #include <assert.h>
+#include <deque>
 #include <vector>
 
 class RewindInfo;
@@ -43,7 +44,10 @@ class EventRewinder;
  *  declared (usually inside of the object it can rewind). This instance
  *  is automatically registered with the RewindManager.
  *  All states and events are stored in a RewindInfo object. All RewindInfo
- *  objects are stored in a list sorted by time.
+ *  objects are stored in a list sorted by time, which is searched with a
+ *  binary search. Rewind information older than the rollback window
+ *  (m_max_rewind_time) is discarded from the front of the list, so memory
+ *  and rewind cost stay bounded in long races.
  *  When a rewind to time T is requested, the following takes place:
  *  1. Go back in time:
  *     Determine the latest time t_min < T so that each rewindable objects
@@ -88,8 +92,10 @@ private:
     /** A list of all objects that can be rewound. */
     AllRewinder m_all_rewinder;
 
-    /** Pointer to all saved states. */
-    typedef std::vector<RewindInfo*> AllRewindInfo;
+    /** Pointer to all saved states. A deque is used so that old entries
+     *  can be removed from the front in constant time, while still
+     *  allowing random access for binary searches. */
+    typedef std::deque<RewindInfo*> AllRewindInfo;
 
     AllRewindInfo m_rewind_info;
 
@@ -105,6 +111,10 @@ private:
     /** Time at which the last state was saved. */
     float m_last_saved_state;
 
+    /** The maximum time the manager can rewind. Older rewind information
+     *  (except the state needed as starting point) is discarded. */
+    float m_max_rewind_time;
+
     /** The current time to be used in all states/events. This is used to
      *  give all states and events during one frame the same time, even
      *  if e.g. states are saved before world time is increased, other
@@ -126,7 +136,9 @@ private:
     RewindManager();
     ~RewindManager();
     unsigned int findFirstIndex(float time) const;
+    unsigned int findIndexAfter(float time, bool include_same_time) const;
     void insertRewindInfo(RewindInfo *ri);
+    void discardOldRewindInfo();
     float determineTimeStepSize(int state, float max_time);
 public:
     // First static functions to manage rewinding.
@@ -737,21 +737,36 @@ uint16_t STKHost::getPort() const
 }   // getPort
 
 //-----------------------------------------------------------------------------
-/** Sends data to all peers except the specified one.
- *  \param peer Peer which will not receive the message.
+/** Sends data to all peers except the specified one. Only one ENet packet
+ *  is created, which is shared by all peers (ENet reference counts it). This
+ *  means that the message can not contain the token of each peer, instead
+ *  NetworkString::BROADCAST_TOKEN is used, which clients accept from the
+ *  server (the ENet connection identifies the server already).
+ *  \param peer Peer which will not receive the message, can be NULL.
  *  \param data Data to sent.
  *  \param reliable If the data should be sent reliable or now.
  */
 void STKHost::sendPacketExcept(STKPeer* peer, NetworkString *data,
                                bool reliable)
 {
+    assert(NetworkConfig::get()->isServer());
+    data->setToken(NetworkString::BROADCAST_TOKEN);
+    Log::verbose("STKHost", "broadcasting packet of size %d to %d peers",
+                 data->size(), (int)m_peers.size());
+
+    ENetPacket* packet = enet_packet_create(data->getData(),
+                                            data->getTotalSize(),
+                                    (reliable ? ENET_PACKET_FLAG_RELIABLE
+                                              : ENET_PACKET_FLAG_UNSEQUENCED));
     for (unsigned int i = 0; i < m_peers.size(); i++)
     {
         STKPeer* p = m_peers[i];
-        if (!p->isSamePeer(peer))
-        {
-            p->sendPacket(data, reliable);
-        }
+        if (!peer || !p->isSamePeer(peer))
+            p->sendSharedPacket(packet);
     }
+    // If no peer took a reference, the packet must be freed here (this is
+    // the same that enet_host_broadcast does).
+    if (packet->referenceCount == 0)
+        enet_packet_destroy(packet);
 }   // sendPacketExcept
 
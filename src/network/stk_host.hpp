@@ -153,6 +153,13 @@ public:
     void sendPacketExcept(STKPeer* peer,
                           NetworkString *data,
                           bool reliable = true);
+    // ------------------------------------------------------------------------
+    /** Sends data from the server to all peers. */
+    void sendPacketToAllPeers(NetworkString *data, bool reliable = true)
+    {
+        sendPacketExcept(NULL, data, reliable);
+    }   // sendPacketToAllPeers
+    // ------------------------------------------------------------------------
     void        setupClient(int peer_count, int channel_limit,
                             uint32_t max_incoming_bandwidth,
                             uint32_t max_outgoing_bandwidth);
@@ -62,10 +62,14 @@ void STKPeer::disconnect()
 void STKPeer::sendPacket(NetworkString *data, bool reliable)
 {
     data->setToken(m_client_server_token);
-    TransportAddress a(m_enet_peer->address);
-    Log::verbose("STKPeer", "sending packet of size %d to %s",
-                 data->size(), a.toString().c_str());
-         
+    // Only format the address if the message is actually printed.
+    if (Log::getLogLevel() <= Log::LL_VERBOSE)
+    {
+        TransportAddress a(m_enet_peer->address);
+        Log::verbose("STKPeer", "sending packet of size %d to %s",
+                     data->size(), a.toString().c_str());
+    }
+
     ENetPacket* packet = enet_packet_create(data->getData(),
                                             data->getTotalSize(),
                                     (reliable ? ENET_PACKET_FLAG_RELIABLE
@@ -73,6 +77,19 @@ void STKPeer::sendPacket(NetworkString *data, bool reliable)
     enet_peer_send(m_enet_peer, 0, packet);
 }   // sendPacket
 
+//-----------------------------------------------------------------------------
+/** Queues a packet that is shared between several peers (see
+ *  STKHost::sendPacketExcept). ENet keeps a reference count in the packet,
+ *  so the data is neither copied nor freed here.
+ *  \param packet The packet to send.
+ *  \return True if the packet was queued, false otherwise (in which case
+ *          no reference to the packet is kept).
+ */
+bool STKPeer::sendSharedPacket(ENetPacket *packet)
+{
+    return enet_peer_send(m_enet_peer, 0, packet) == 0;
+}   // sendSharedPacket
+
 //-----------------------------------------------------------------------------
 /** Returns the IP address (in host format) of this client.
  */
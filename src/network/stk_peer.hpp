@@ -61,6 +61,7 @@ public:
 
     virtual void sendPacket(NetworkString *data,
                             bool reliable = true);
+    bool sendSharedPacket(ENetPacket *packet);
     void disconnect();
     bool isConnected() const;
     bool exists() const;
@@ -92,10 +92,24 @@ namespace Online
         m_string_buffer = "";
         m_filename      = "";
         m_parameters    = "";
+        m_curl_session  = NULL;
+        m_file          = NULL;
         m_curl_code     = CURLE_OK;
         m_progress.setAtomic(0);
     }   // init
 
+    // ------------------------------------------------------------------------
+    /** Frees the curl data structures, in case that afterOperation() was not
+     *  called (e.g. the request was aborted, or afterOperation was replaced).
+     */
+    HTTPRequest::~HTTPRequest()
+    {
+        if (m_file)
+            fclose(m_file);
+        if (m_curl_session)
+            curl_easy_cleanup(m_curl_session);
+    }   // ~HTTPRequest
+
     // ------------------------------------------------------------------------
     /** A handy shortcut that appends the given path to the URL of the
      *  mutiplayer server. It also supports the old (version 1) api,
@@ -158,6 +172,7 @@ namespace Online
         {
             Log::error("HTTPRequest::prepareOperation",
                        "LibCurl session not initialized.");
+            m_curl_code = CURLE_FAILED_INIT;
             return;
         }
 
@@ -196,26 +211,29 @@ namespace Online
     }   // prepareOperation
 
     // ------------------------------------------------------------------------
-    /** The actual curl download happens here.
+    /** Sets up the actual curl download, which is then done either by the
+     *  RequestManager (together with other downloads), or by execute().
+     *  \return The curl handle, or NULL if an error happened (in which case
+     *          the request is finished with an error).
      */
-    void HTTPRequest::operation()
+    CURL* HTTPRequest::prepareTransfer()
     {
         if (!m_curl_session)
-            return;
+            return NULL;
 
-        FILE *fout = NULL;
         if (m_filename.size() > 0)
         {
-            fout = fopen((m_filename+".part").c_str(), "wb");
+            m_file = fopen((m_filename+".part").c_str(), "wb");
 
-            if (!fout)
+            if (!m_file)
             {
                 Log::error("HTTPRequest",
                            "Can't open '%s' for writing, ignored.",
                            (m_filename+".part").c_str());
-                return;
+                m_curl_code = CURLE_WRITE_ERROR;
+                return NULL;
             }
-            curl_easy_setopt(m_curl_session,  CURLOPT_WRITEDATA,     fout  );
+            curl_easy_setopt(m_curl_session,  CURLOPT_WRITEDATA,     m_file);
             curl_easy_setopt(m_curl_session,  CURLOPT_WRITEFUNCTION, fwrite);
         }
         else
@@ -279,13 +297,22 @@ namespace Online
                     // Unknown system type
             #endif
         curl_easy_setopt(m_curl_session, CURLOPT_USERAGENT, uagent.c_str());
+        return m_curl_session;
+    }   // prepareTransfer
 
-        m_curl_code = curl_easy_perform(m_curl_session);
-        Request::operation();
+    // ------------------------------------------------------------------------
+    /** Called once the curl download is finished. If the data was saved in
+     *  a file, the downloaded file replaces the previous file.
+     *  \param code The curl result of the download.
+     */
+    void HTTPRequest::finishTransfer(CURLcode code)
+    {
+        m_curl_code = code;
 
-        if (fout)
+        if (m_file)
         {
-            fclose(fout);
+            fclose(m_file);
+            m_file = NULL;
             if (m_curl_code == CURLE_OK)
             {
                 if(UserConfigParams::logAddons())
@@ -311,8 +338,8 @@ namespace Online
                     m_curl_code = CURLE_WRITE_ERROR;
                 }
             }   // m_curl_code ==CURLE_OK
-        }   // if fout
-    }   // operation
+        }   // if m_file
+    }   // finishTransfer
 
     // ------------------------------------------------------------------------
     /** Cleanup once the download is finished. The value of progress is
@@ -327,7 +354,11 @@ namespace Online
             setProgress(-1.0f);
 
         Request::afterOperation();
-        curl_easy_cleanup(m_curl_session);
+        if (m_curl_session)
+        {
+            curl_easy_cleanup(m_curl_session);
+            m_curl_session = NULL;
+        }
     }   // afterOperation
 
     // ------------------------------------------------------------------------
@@ -65,6 +65,9 @@ namespace Online
         /** Pointer to the curl data structure for this request. */
         CURL *m_curl_session;
 
+        /** The file the data is written to while downloading to a file. */
+        FILE *m_file;
+
         /** curl return code. */
         CURLcode m_curl_code;
 
@@ -73,7 +76,6 @@ namespace Online
 
     protected:
         virtual void prepareOperation() OVERRIDE;
-        virtual void operation() OVERRIDE;
         virtual void afterOperation() OVERRIDE;
 
         static int progressDownload(void *clientp, double dltotal,
@@ -90,8 +92,10 @@ namespace Online
                     int priority = 1);
         HTTPRequest(const char * const filename, bool manage_memory = false,
                     int priority = 1);
-        virtual           ~HTTPRequest() {}
+        virtual           ~HTTPRequest();
         virtual bool       isAllowedToAdd() const OVERRIDE;
+        virtual CURL*      prepareTransfer() OVERRIDE;
+        virtual void       finishTransfer(CURLcode code) OVERRIDE;
         void               setApiURL(const std::string& url, const std::string &action);
         void               setAddonsURL(const std::string& path);
 
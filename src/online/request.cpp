@@ -54,22 +54,56 @@ namespace Online
     }   // queue
 
     // ------------------------------------------------------------------------
-    /** Executes the request. This calles prepareOperation, operation, and
-     *  afterOperation.
+    /** Executes the request. This calles prepareOperation, operation (or
+     *  performs the transfer set up by prepareTransfer), and afterOperation.
      */
     void Request::execute()
+    {
+        CURL *handle = startExecution();
+        if (handle)
+            finishExecution(curl_easy_perform(handle));
+    }   // execute
+
+    // ------------------------------------------------------------------------
+    /** Starts executing the request. This calls prepareOperation and
+     *  prepareTransfer. If the request is a transfer, its curl handle is
+     *  returned, and finishExecution must be called once the transfer is
+     *  done. Otherwise operation and afterOperation are called, i.e. the
+     *  request is completely executed.
+     *  \return The curl handle of the transfer, or NULL if the request was
+     *          executed (or aborted).
+     */
+    CURL* Request::startExecution()
     {
         assert(isBusy());
         // Abort as early as possible if abort is requested
-        if (RequestManager::get()->getAbort() && isAbortable()) return;
+        if (RequestManager::get()->getAbort() && isAbortable()) return NULL;
         prepareOperation();
-        if (RequestManager::get()->getAbort() && isAbortable()) return;
+        if (RequestManager::get()->getAbort() && isAbortable()) return NULL;
+        CURL *handle = prepareTransfer();
+        if (handle)
+            return handle;
         operation();
+        if (RequestManager::get()->getAbort() && isAbortable()) return NULL;
+        setExecuted();
+        if (RequestManager::get()->getAbort() && isAbortable()) return NULL;
+        afterOperation();
+        return NULL;
+    }   // startExecution
+
+    // ------------------------------------------------------------------------
+    /** Finishes a request whose transfer was started by startExecution. It
+     *  calls finishTransfer and afterOperation.
+     *  \param code The result of the curl transfer.
+     */
+    void Request::finishExecution(CURLcode code)
+    {
+        finishTransfer(code);
         if (RequestManager::get()->getAbort() && isAbortable()) return;
         setExecuted();
         if (RequestManager::get()->getAbort() && isAbortable()) return;
         afterOperation();
-    }   // execute
+    }   // finishExecution
 
     // ------------------------------------------------------------------------
     /** Executes the request now, i.e. in the main thread and without involving
@@ -138,6 +138,22 @@ namespace Online
         void     execute();
         void     executeNow();
         void     queue();
+        CURL*    startExecution();
+        void     finishExecution(CURLcode code);
+
+        // --------------------------------------------------------------------
+        /** Called after prepareOperation(). A request that is a curl transfer
+         *  sets it up and returns its curl handle, which allows the
+         *  RequestManager to run several transfers at the same time. Once
+         *  the transfer is finished finishTransfer() is called (instead of
+         *  operation()). The default returns NULL, in which case operation()
+         *  is called. */
+        virtual CURL* prepareTransfer() { return NULL; }
+
+        // --------------------------------------------------------------------
+        /** Called when the transfer set up in prepareTransfer() is finished.
+         *  \param code The result of the transfer. */
+        virtual void finishTransfer(CURLcode code) {}
 
         // --------------------------------------------------------------------
         /** Executed when a request has finished. */
@@ -72,7 +72,12 @@ namespace Online
         m_menu_polling_interval = 60;  // Default polling: every 60 seconds.
         m_game_polling_interval = 60;  // same for game polling
         m_time_since_poll       = m_menu_polling_interval;
+        m_num_transfers            = 0;
+        m_num_background_transfers = 0;
         curl_global_init(CURL_GLOBAL_DEFAULT);
+        // Created here (and not in the thread), since addRequest might
+        // use it to wake up the thread.
+        m_curl_multi = curl_multi_init();
         pthread_cond_init(&m_cond_request, NULL);
         m_abort.setAtomic(false);
     }   // RequestManager
@@ -85,6 +90,7 @@ namespace Online
         delete m_thread_id.getData();
         m_thread_id.unlock();
         pthread_cond_destroy(&m_cond_request);
+        curl_multi_cleanup(m_curl_multi);
         curl_global_cleanup();
     }   // ~RequestManager
 
@@ -176,12 +182,90 @@ namespace Online
         // Wake up the network http thread
         pthread_cond_signal(&m_cond_request);
         m_request_queue.unlock();
+#if LIBCURL_VERSION_NUM >= 0x074400
+        // In case that the thread is waiting for ongoing transfers
+        curl_multi_wakeup(m_curl_multi);
+#endif
     }   // addRequest
 
+    // ------------------------------------------------------------------------
+    /** Returns if the given request can be started now, or if it has to wait
+     *  for ongoing transfers to finish first.
+     *  \param request The request to check.
+     */
+    bool RequestManager::canStartRequest(const Request *request) const
+    {
+        int max_transfers = UserConfigParams::m_max_http_transfers;
+        if (max_transfers < 1)
+            max_transfers = 1;
+        if (m_num_transfers >= max_transfers)
+            return false;
+        // Keep one transfer free for more important requests.
+        if (request->getPriority() <= HTTP_BACKGROUND_PRIORITY &&
+            max_transfers > 1 &&
+            m_num_background_transfers >= max_transfers - 1)
+            return false;
+        return true;
+    }   // canStartRequest
+
+    // ------------------------------------------------------------------------
+    /** Starts to execute a request. A http transfer is added to the curl
+     *  multi handle, any other request is executed immediately.
+     *  \param request The request to execute.
+     */
+    void RequestManager::startRequest(Request *request)
+    {
+        CURL *handle = request->startExecution();
+        if (handle)
+        {
+            curl_easy_setopt(handle, CURLOPT_PRIVATE, request);
+            curl_multi_add_handle(m_curl_multi, handle);
+            m_num_transfers++;
+            if (request->getPriority() <= HTTP_BACKGROUND_PRIORITY)
+                m_num_background_transfers++;
+            return;
+        }
+        // This test is necessary in case that execute() was aborted
+        // (otherwise the assert in addResult will be triggered).
+        if (!getAbort()) addResult(request);
+    }   // startRequest
+
+    // ------------------------------------------------------------------------
+    /** Lets curl do the work for all ongoing transfers, and finishes all
+     *  requests whose transfers are done.
+     */
+    void RequestManager::handleFinishedTransfers()
+    {
+        int running = 0;
+        curl_multi_perform(m_curl_multi, &running);
+
+        CURLMsg *message;
+        int messages_left = 0;
+        while ((message = curl_multi_info_read(m_curl_multi, &messages_left)))
+        {
+            if (message->msg != CURLMSG_DONE)
+                continue;
+            // The message is invalid once the handle is removed.
+            CURL *handle  = message->easy_handle;
+            CURLcode code = message->data.result;
+            char *data    = NULL;
+            curl_easy_getinfo(handle, CURLINFO_PRIVATE, &data);
+            Request *request = (Request*)data;
+            curl_multi_remove_handle(m_curl_multi, handle);
+            m_num_transfers--;
+            if (request->getPriority() <= HTTP_BACKGROUND_PRIORITY)
+                m_num_background_transfers--;
+
+            request->finishExecution(code);
+            if (!getAbort()) addResult(request);
+        }
+    }   // handleFinishedTransfers
+
     // ------------------------------------------------------------------------
     /** The actual main loop, which is started as a separate thread from the
-     *  constructor. After testing for a new server, fetching news, the list
-     *  of packages to download, it will wait for commands to be issued.
+     *  constructor. It starts queued requests in order of their priority (as
+     *  long as there are free transfers), and drives all ongoing transfers.
+     *  If nothing is to be done, it waits for commands to be issued.
      *  \param obj: A pointer to this object, passed on by pthread_create
      */
     void *RequestManager::mainLoop(void *obj)
@@ -191,37 +275,62 @@ namespace Online
 
         pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL);
 
-        me->m_current_request = NULL;
+        bool quit = false;
         me->m_request_queue.lock();
-        while (me->m_request_queue.getData().empty() ||
-               me->m_request_queue.getData().top()->getType() != Request::RT_QUIT)
+        while (true)
         {
-            bool empty = me->m_request_queue.getData().empty();
-
-            // Wait in cond_wait for a request to arrive. The 'while' is necessary
-            // since "spurious wakeups from the pthread_cond_wait ... may occur"
-            // (pthread_cond_wait man page)!
-            while (empty)
+            // Start as many queued requests as possible
+            while (!quit && !me->m_request_queue.getData().empty())
             {
-                pthread_cond_wait(&me->m_cond_request, me->m_request_queue.getMutex());
-                empty = me->m_request_queue.getData().empty();
-            }
-            me->m_current_request = me->m_request_queue.getData().top();
-            me->m_request_queue.getData().pop();
-
-            if (me->m_current_request->getType() == Request::RT_QUIT)
+                Request *request = me->m_request_queue.getData().top();
+                if (request->getType() == Request::RT_QUIT)
+                {
+                    // Ongoing transfers are still finished (abortable ones
+                    // will be aborted quickly).
+                    me->m_request_queue.getData().pop();
+                    delete request;
+                    quit = true;
+                    break;
+                }
+                if (!me->canStartRequest(request))
+                    break;
+                me->m_request_queue.getData().pop();
+                me->m_request_queue.unlock();
+                me->startRequest(request);
+                me->m_request_queue.lock();
+            }   // while requests can be started
+
+            if (me->m_num_transfers == 0)
             {
-                delete me->m_current_request;
-                break;
+                if (quit)
+                    break;
+                // Wait in cond_wait for a request to arrive. The 'while' is
+                // necessary since "spurious wakeups from the
+                // pthread_cond_wait ... may occur" (pthread_cond_wait man
+                // page)!
+                while (me->m_request_queue.getData().empty())
+                {
+                    pthread_cond_wait(&me->m_cond_request,
+                                      me->m_request_queue.getMutex());
+                }
+                continue;
             }
 
             me->m_request_queue.unlock();
-            me->m_current_request->execute();
-            // This test is necessary in case that execute() was aborted
-            // (otherwise the assert in addResult will be triggered).
-            if (!me->getAbort()) me->addResult(me->m_current_request);
+            me->handleFinishedTransfers();
+            if (me->m_num_transfers > 0)
+            {
+                // Wait for network activity. If the curl version supports
+                // it addRequest will wake up this thread, otherwise new
+                // requests are started after the timeout.
+#if LIBCURL_VERSION_NUM >= 0x074400
+                curl_multi_poll(me->m_curl_multi, NULL, 0, 1000, NULL);
+#else
+                curl_multi_wait(me->m_curl_multi, NULL, 0, 50, NULL);
+#endif
+            }
             me->m_request_queue.lock();
-        } // while handle all requests
+        } // while true
 
         // Signal that the request manager can now be deleted.
         // We signal this even before cleaning up memory, since there's no
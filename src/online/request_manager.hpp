@@ -46,6 +46,13 @@ namespace Online
      *  receive an answer (e.g. to sign in; or to download an addon). The
      *  requests are sorted by priority (e.g. sign in and out have higher
      *  priority than downloading addon icons).
+     *  Http requests are run using curl's multi interface, so up to
+     *  UserConfigParams::m_max_http_transfers of them are executed at the
+     *  same time (and connections to the same server are reused). Requests
+     *  with background priority (e.g. addon icons) can only use all but one
+     *  of these transfers, so that e.g. a sign in is never delayed by a long
+     *  list of icon downloads. Other requests (e.g. LAN server discovery)
+     *  are executed one at a time in the thread.
      *  A request is created and initialised from the main thread. When it
      *  is moved into the request queue, it must not be handled by the main
      *  thread anymore, only the RequestManager thread can handle it.
@@ -94,8 +101,16 @@ namespace Online
             /** Time passed since the last poll request. */
             float                     m_time_since_poll;
 
-            /** The current requested being worked on. */
-            Online::Request *         m_current_request;
+            /** The curl multi handle which executes all http transfers. */
+            CURLM *                   m_curl_multi;
+
+            /** Number of transfers currently executed. Only used by the
+             *  manager thread. */
+            int                       m_num_transfers;
+
+            /** Number of transfers with background priority currently
+             *  executed. Only used by the manager thread. */
+            int                       m_num_background_transfers;
 
             /** A conditional variable to wake up the main loop. */
             pthread_cond_t            m_cond_request;
@@ -128,6 +143,9 @@ namespace Online
 
             void addResult(Online::Request *request);
             void handleResultQueue();
+            bool canStartRequest(const Online::Request *request) const;
+            void startRequest(Online::Request *request);
+            void handleFinishedTransfers();
 
             static void *mainLoop(void *obj);
 
@@ -139,6 +157,12 @@ namespace Online
         public:
             static const int HTTP_MAX_PRIORITY = 9999;
 
+            /** Requests with this or a lower priority (addon icons and
+             *  hardware reports) can not use all concurrent transfers. It is
+             *  below the default priority of http requests, so all other
+             *  requests are never delayed by them. */
+            static const int HTTP_BACKGROUND_PRIORITY = 0;
+
             // ----------------------------------------------------------------
             /** Singleton access function. Creates the RequestManager if
              * necessary. */
@@ -209,6 +209,12 @@ public:
     /** Returns the rigid body of this physical object. */
     btRigidBody *getBody        ()          { return m_body; }
     // ------------------------------------------------------------------------
+    /** Returns the rigid body of this physical object. */
+    const btRigidBody *getBody  ()    const { return m_body; }
+    // ------------------------------------------------------------------------
+    /** Returns the type of the collision shape of this object. */
+    BodyTypes getBodyType() const { return m_body_type; }
+    // ------------------------------------------------------------------------
     /** Returns true if this object should trigger a rescue in a kart that
      *  hits it. */
     bool isCrashReset() const { return m_crash_reset; }
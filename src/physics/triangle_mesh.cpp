@@ -20,12 +20,19 @@
 
 #include "btBulletDynamicsCommon.h"
 
+#include "io/file_manager.hpp"
 #include "modes/world.hpp"
 #include "physics/physics.hpp"
 #include "utils/constants.hpp"
+#include "utils/hash.hpp"
+#include "utils/log.hpp"
 #include "utils/time.hpp"
 
-#include <fstream>
+#include <stdio.h>
+#include <string.h>
+#ifndef WIN32
+#  include <sys/mman.h>
+#endif
 
 // -----------------------------------------------------------------------------
 /** Constructor: Initialises all data structures with zero.
@@ -42,6 +49,9 @@ TriangleMesh::TriangleMesh() : m_mesh()
     // (and m_mesh->m_weldingThreshold at m_normals
     m_collision_shape  = NULL;
     m_collision_object = NULL;
+    m_bvh_cache_data   = NULL;
+    m_bvh_cache_size   = 0;
+    m_bvh_cache_mapped = false;
     m_user_pointer.set(this);
 }   // TriangleMesh
 
@@ -84,13 +94,222 @@ void TriangleMesh::addTriangle(const btVector3 &t1, const btVector3 &t2,
     m_p1p2p3.push_back(edge1.cross(edge2).length2());
 }   // addTriangle
 
+// -----------------------------------------------------------------------------
+/** Computes a 64 bit hash (FNV-1a, applied to 32 bit words) of the vertices
+ *  and triangle indices of this mesh. The optimised BVH depends only on
+ *  this data, so the hash is used to detect if a cached BVH is up to date.
+ */
+uint64_t TriangleMesh::getContentHash() const
+{
+    uint64_t h = Hash::FNV_OFFSET;
+    const IndexedMeshArray &meshes = m_mesh.getIndexedMeshArray();
+    for (int i = 0; i < meshes.size(); i++)
+    {
+        const btIndexedMesh &m = meshes[i];
+        const unsigned char *v = m.m_vertexBase;
+        for (int j = 0; j < m.m_numVertices; j++)
+        {
+            // Only hash x, y and z, the padding of btVector3 is not
+            // necessarily initialised.
+            const uint32_t *xyz = (const uint32_t*)(v + j*m.m_vertexStride);
+            for (unsigned int k = 0; k < 3; k++)
+                h = Hash::mix(h, xyz[k]);
+        }
+        const unsigned char *t = m.m_triangleIndexBase;
+        for (int j = 0; j < m.m_numTriangles; j++)
+        {
+            const uint32_t *index = (const uint32_t*)(t+j*m.m_triangleIndexStride);
+            for (unsigned int k = 0; k < 3; k++)
+                h = Hash::mix(h, index[k]);
+        }
+        h = Hash::mix(h, m.m_numTriangles);
+    }
+    return h;
+}   // getContentHash
+
+// -----------------------------------------------------------------------------
+/** Returns the name of the file in which the BVH of this mesh is cached.
+ *  \param cache_name Name to identify the mesh (e.g. the track ident).
+ *  \param hash Content hash of the mesh.
+ */
+std::string TriangleMesh::getBvhCacheFileName(const std::string &cache_name,
+                                              uint64_t hash) const
+{
+    char hex[17];
+    sprintf(hex, "%08x%08x", (unsigned int)(hash >> 32),
+            (unsigned int)(hash & 0xffffffff));
+    return file_manager->getCachedDataDir() + "bvh-" + cache_name + "-" +
+           hex + ".bin";
+}   // getBvhCacheFileName
+
+// -----------------------------------------------------------------------------
+/** Header of a cached BVH file. It is padded to a multiple of 16 bytes, since
+ *  the serialised BVH which follows it must be 16 byte aligned.
+ */
+struct BvhCacheHeader
+{
+    char     m_magic[8];
+    uint32_t m_version;
+    /** sizeof(btScalar), the data can't be used with a different bullet
+     *  precision. */
+    uint32_t m_scalar_size;
+    uint64_t m_hash;
+    /** Size of the serialised BVH following this header. */
+    uint32_t m_bvh_size;
+    uint32_t m_padding;
+};   // BvhCacheHeader
+
+static const char     BVH_CACHE_MAGIC[8] = "STKBVH";
+static const uint32_t BVH_CACHE_VERSION  = 1;
+
+// -----------------------------------------------------------------------------
+/** Loads the BVH of this mesh from the cache. If possible the file is memory
+ *  mapped (privately, since the BVH is fixed up in place), otherwise it is
+ *  read into aligned memory. The memory is kept in m_bvh_cache_data till
+ *  freeBvhCache() is called.
+ *  \param name Name of the cache file.
+ *  \param hash Content hash of this mesh.
+ *  \return The BVH, or NULL if no up to date cache file exists.
+ */
+btOptimizedBvh* TriangleMesh::loadBvhCache(const std::string &name,
+                                           uint64_t hash)
+{
+    FILE *file = fopen(name.c_str(), "rb");
+    if (!file)
+        return NULL;
+
+    BvhCacheHeader header;
+    bool ok = fread(&header, sizeof(header), 1, file) == 1          &&
+              memcmp(header.m_magic, BVH_CACHE_MAGIC, 8) == 0       &&
+              header.m_version == BVH_CACHE_VERSION                 &&
+              header.m_scalar_size == sizeof(btScalar)              &&
+              header.m_hash == hash;
+    size_t size = ok ? sizeof(header) + header.m_bvh_size : 0;
+    if (ok)
+    {
+        fseek(file, 0, SEEK_END);
+        ok = ftell(file) == (long)size;
+    }
+
+#ifndef WIN32
+    if (ok)
+    {
+        void *data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+                          fileno(file), 0);
+        if (data != MAP_FAILED)
+        {
+            m_bvh_cache_data   = data;
+            m_bvh_cache_mapped = true;
+        }
+    }
+#endif
+    if (ok && !m_bvh_cache_data)
+    {
+        m_bvh_cache_data   = btAlignedAlloc(size, 16);
+        m_bvh_cache_mapped = false;
+        fseek(file, 0, SEEK_SET);
+        ok = fread(m_bvh_cache_data, size, 1, file) == 1;
+    }
+    fclose(file);
+
+    btOptimizedBvh *bvh = NULL;
+    if (ok)
+    {
+        m_bvh_cache_size = size;
+        bvh = btOptimizedBvh::deSerializeInPlace(
+                             (char*)m_bvh_cache_data + sizeof(BvhCacheHeader),
+                             header.m_bvh_size, !IS_LITTLE_ENDIAN);
+    }
+    if (!bvh)
+    {
+        Log::warn("TriangleMesh", "Ignoring invalid BVH cache '%s'.",
+                  name.c_str());
+        freeBvhCache();
+        return NULL;
+    }
+    Log::debug("TriangleMesh", "Loaded BVH from '%s'.", name.c_str());
+    return bvh;
+}   // loadBvhCache
+
+// -----------------------------------------------------------------------------
+/** Saves the BVH of this mesh in the cache.
+ *  \param name Name of the cache file.
+ *  \param hash Content hash of this mesh.
+ *  \param bvh The BVH to save.
+ */
+void TriangleMesh::saveBvhCache(const std::string &name, uint64_t hash,
+                                const btOptimizedBvh *bvh) const
+{
+    BvhCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.m_magic, BVH_CACHE_MAGIC, 8);
+    header.m_version     = BVH_CACHE_VERSION;
+    header.m_scalar_size = sizeof(btScalar);
+    header.m_hash        = hash;
+    header.m_bvh_size    = bvh->calculateSerializeBufferSize();
+
+    char *buffer = (char*)btAlignedAlloc(header.m_bvh_size, 16);
+    if (!bvh->serialize(buffer, header.m_bvh_size, !IS_LITTLE_ENDIAN))
+    {
+        btAlignedFree(buffer);
+        return;
+    }
+
+    // Write to a temporary file first, so that an interrupted write can
+    // not leave an incomplete cache file behind.
+    std::string tmp_name = name + ".tmp";
+    FILE *file = fopen(tmp_name.c_str(), "wb");
+    if (!file)
+    {
+        Log::warn("TriangleMesh", "Can not write BVH cache '%s'.",
+                  tmp_name.c_str());
+        btAlignedFree(buffer);
+        return;
+    }
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+              fwrite(buffer, header.m_bvh_size, 1, file) == 1;
+    ok = fclose(file) == 0 && ok;
+    btAlignedFree(buffer);
+
+    file_manager->removeFile(name);
+    if (!ok || rename(tmp_name.c_str(), name.c_str()) != 0)
+    {
+        Log::warn("TriangleMesh", "Can not write BVH cache '%s'.",
+                  name.c_str());
+        file_manager->removeFile(tmp_name);
+    }
+}   // saveBvhCache
+
+// -----------------------------------------------------------------------------
+/** Frees the memory of a BVH loaded from the cache. The collision shape
+ *  using this BVH must have been deleted before.
+ */
+void TriangleMesh::freeBvhCache()
+{
+    if (!m_bvh_cache_data)
+        return;
+#ifndef WIN32
+    if (m_bvh_cache_mapped)
+        munmap(m_bvh_cache_data, m_bvh_cache_size);
+    else
+#endif
+        btAlignedFree(m_bvh_cache_data);
+    m_bvh_cache_data   = NULL;
+    m_bvh_cache_size   = 0;
+    m_bvh_cache_mapped = false;
+}   // freeBvhCache
+
 // -----------------------------------------------------------------------------
 /** Creates a collision body only, which can be used for raycasting, but
  *  has no physical properties.
- *  @param serialized_bhv if non-null, load the serialized bhv from file instead
- *                        of builing it on the fly
+ *  \param create_collision_object If true, a collision object is created
+ *         for the shape.
+ *  \param bvh_cache_name If not empty, the optimised BVH is loaded from the
+ *         cached data directory, or saved there if no up to date cache file
+ *         exists. The name is used as part of the cache file name.
  */
-void TriangleMesh::createCollisionShape(bool create_collision_object, const char* serialized_bhv)
+void TriangleMesh::createCollisionShape(bool create_collision_object,
+                                        const std::string &bvh_cache_name)
 {
     if(m_triangleIndex2Material.size()==0)
     {
@@ -103,53 +322,26 @@ void TriangleMesh::createCollisionShape(bool create_collision_object, const char
     // Now convert the triangle mesh into a static rigid body
     btBvhTriangleMeshShape* bhv_triangle_mesh;
 
-    if (serialized_bhv != NULL)
+    if (bvh_cache_name.empty())
+    {
+        bhv_triangle_mesh = new btBvhTriangleMeshShape(&m_mesh, false /* useQuantizedAabbCompression */);
+    }
+    else
     {
-        FILE *f = fopen(serialized_bhv, "rb");
-        fseek(f, 0, SEEK_END);
-        long pos = ftell(f);
-        assert(pos != -1L);
-        fseek(f, 0, SEEK_SET);
-
-        void* bytes = btAlignedAlloc(pos, 16);
-        fread(bytes, pos, 1, f);
-        fclose(f);
-
-        btOptimizedBvh* bhv = btOptimizedBvh::deSerializeInPlace(bytes, pos, !IS_LITTLE_ENDIAN);
-        if (bhv == NULL)
+        uint64_t hash = getContentHash();
+        std::string name = getBvhCacheFileName(bvh_cache_name, hash);
+        btOptimizedBvh *bvh = loadBvhCache(name, hash);
+        if (bvh)
         {
-            Log::warn("TriangleMesh", "Failed to load serialized BHV");
-            bhv_triangle_mesh = new btBvhTriangleMeshShape(&m_mesh, false /* useQuantizedAabbCompression */);
+            bhv_triangle_mesh = new btBvhTriangleMeshShape(&m_mesh, false /* useQuantizedAabbCompression */,
+                                                           false /* buildBvh */);
+            bhv_triangle_mesh->setOptimizedBvh(bvh);
         }
         else
         {
-            bhv_triangle_mesh = new btBvhTriangleMeshShape(&m_mesh, false /* useQuantizedAabbCompression */,
-                                                           false /* buildBvh */);
-            bhv_triangle_mesh->setOptimizedBvh( bhv );
+            bhv_triangle_mesh = new btBvhTriangleMeshShape(&m_mesh, false /* useQuantizedAabbCompression */);
+            saveBvhCache(name, hash, bhv_triangle_mesh->getOptimizedBvh());
         }
-        // Do *NOT* free the bytes, 'deSerializeInPlace' makes the btOptimizedBvh object
-        // directly at this memory location
-        //free(bytes);
-
-    }
-    else
-    {
-        bhv_triangle_mesh = new btBvhTriangleMeshShape(&m_mesh, false /* useQuantizedAabbCompression */);
-
-        /*
-         // code to serialize triangle mesh
-        btOptimizedBvh* bvh = bhv_triangle_mesh->getOptimizedBvh();
-        unsigned int ssize = bvh->calculateSerializeBufferSize();
-        char* buffer = (char*)btAlignedAlloc(ssize, 16);
-        bool success = bvh->serialize(buffer, ssize, !IS_LITTLE_ENDIAN);
-        printf("serialization success = %i\n", success);
-
-        std::ofstream fileout("/tmp/btOptimizedBvh");
-        fileout.write(buffer, ssize);
-        fileout.close();
-
-        btAlignedFree(buffer);
-         */
     }
 
     m_collision_shape = bhv_triangle_mesh;
@@ -174,15 +366,16 @@ void TriangleMesh::createCollisionShape(bool create_collision_object, const char
  *  removed and all objects together with the track is converted again into
  *  a single rigid body. This avoids using irrlicht (or the graphics engine)
  *  for height of terrain detection).
- *  @param serializedBhv if non-NULL, the bhv is deserialized instead of
- *                       being calculated on the fly
+ *  \param flags Additional collision flags for the body.
+ *  \param bvh_cache_name If not empty, the optimised BVH is cached under
+ *         this name, see createCollisionShape().
  */
 void TriangleMesh::createPhysicalBody(btCollisionObject::CollisionFlags flags,
-                                      const char* serializedBhv)
+                                      const std::string &bvh_cache_name)
 {
     // We need the collision shape, but not the collision object (since
     // this will be created when the dynamics body is anyway).
-    createCollisionShape(/*create_collision_object*/false, serializedBhv);
+    createCollisionShape(/*create_collision_object*/false, bvh_cache_name);
     btTransform startTransform;
     startTransform.setIdentity();
     m_motion_state = new btDefaultMotionState(startTransform);
@@ -223,6 +416,8 @@ void TriangleMesh::removeAll()
     }
     delete m_collision_shape;
     m_collision_shape = NULL;
+    // The shape does not own a BVH loaded from the cache.
+    freeBvhCache();
 }   // removeAll
 
 // -----------------------------------------------------------------------------
@@ -19,11 +19,13 @@
 #ifndef HEADER_TRIANGLE_MESH_HPP
 #define HEADER_TRIANGLE_MESH_HPP
 
+#include <string>
 #include <vector>
 #include "btBulletDynamicsCommon.h"
 
 #include "physics/user_pointer.hpp"
 #include "utils/aligned_array.hpp"
+#include "utils/types.hpp"
 
 class Material;
 
@@ -49,6 +51,22 @@ private:
     AlignedArray<btVector3>      m_normals;
     /** Pre-compute value used in smoothing. */
     AlignedArray<float>          m_p1p2p3;
+    /** If the BVH was loaded from the cache, the memory that contains it
+     *  (the BVH is created in place in this memory). NULL otherwise. */
+    void                        *m_bvh_cache_data;
+    /** Size of m_bvh_cache_data. */
+    size_t                       m_bvh_cache_size;
+    /** True if m_bvh_cache_data is a memory mapped file, false if it was
+     *  allocated with btAlignedAlloc. */
+    bool                         m_bvh_cache_mapped;
+
+    uint64_t        getContentHash() const;
+    std::string     getBvhCacheFileName(const std::string &cache_name,
+                                        uint64_t hash) const;
+    btOptimizedBvh* loadBvhCache(const std::string &name, uint64_t hash);
+    void            saveBvhCache(const std::string &name, uint64_t hash,
+                                 const btOptimizedBvh *bvh) const;
+    void            freeBvhCache();
 public:
          TriangleMesh();
         ~TriangleMesh();
@@ -56,10 +74,11 @@ public:
                      const btVector3 &t3, const btVector3 &n1,
                      const btVector3 &n2, const btVector3 &n3,
                      const Material* m);
-    void createCollisionShape(bool create_collision_object=true, const char* serialized_bhv=NULL);
+    void createCollisionShape(bool create_collision_object=true,
+                              const std::string &bvh_cache_name="");
     void createPhysicalBody(btCollisionObject::CollisionFlags flags=
                                (btCollisionObject::CollisionFlags)0,
-                            const char* serializedBhv = NULL);
+                            const std::string &bvh_cache_name="");
     void removeAll();
     void removeCollisionObject();
     btVector3 getInterpolatedNormal(unsigned int index,
@@ -17,27 +17,7 @@
 
 #include "replay/replay_base.hpp"
 
-#include "io/file_manager.hpp"
-
 // -----------------------------------------------------------------------------
 ReplayBase::ReplayBase()
 {
 }   // ReplayBaese
-// -----------------------------------------------------------------------------
-/** Opens a replay file which is determined by sub classes.
- *  \param writeable True if the file should be opened for writing.
- *  \param full_path True if the file is full path.
- *  \return A FILE *, or NULL if the file could not be opened.
- */
-FILE* ReplayBase::openReplayFile(bool writeable, bool full_path)
-{
-    FILE *fd = fopen(full_path ? getReplayFilename().c_str() :
-        (file_manager->getReplayDir() + getReplayFilename()).c_str(),
-        writeable ? "w" : "r");
-    if (!fd)
-    {
-        return NULL;
-    }
-    return fd;
-
-}   // openReplayFile
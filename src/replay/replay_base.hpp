@@ -33,6 +33,9 @@ class ReplayBase : public NoCopy
 {
     // Needs access to KartReplayEvent
     friend class GhostKart;
+    // Need access to all event types to read and write replay files
+    friend class ReplayStreamReader;
+    friend class ReplayStreamWriter;
 
 protected:
     /** Stores a transform event, i.e. a position and rotation of a kart
@@ -72,16 +75,9 @@ protected:
         bool        m_jumping;
     };   // KartReplayEvent
 
-    // ------------------------------------------------------------------------
-    FILE *openReplayFile(bool writeable, bool full_path = false);
     // ------------------------------------------------------------------------
     /** Returns the filename that was opened. */
     virtual const std::string& getReplayFilename() const = 0;
-    // ------------------------------------------------------------------------
-    /** Returns the version number of the replay file. This is used to check
-     *  that a loaded replay file can still be understood by this
-     *  executable. */
-    unsigned int getReplayVersion() const { return 3; }
 
 public:
              ReplayBase();
@@ -24,6 +24,7 @@
 #include "karts/controller/ghost_controller.hpp"
 #include "modes/world.hpp"
 #include "race/race_manager.hpp"
+#include "replay/replay_stream.hpp"
 #include "tracks/track.hpp"
 #include "tracks/track_manager.hpp"
 
@@ -99,10 +100,10 @@ void ReplayPlay::loadAllReplayFile()
 bool ReplayPlay::addReplayFile(const std::string& fn, bool custom_replay)
 {
 
-    char s[1024], s1[1024];
     if (StringUtils::getExtension(fn) != "replay") return false;
-    FILE *fd = fopen(custom_replay ? fn.c_str() :
-        (file_manager->getReplayDir() + fn).c_str(), "r");
+    const std::string full_path = custom_replay ? fn
+                                : file_manager->getReplayDir() + fn;
+    FILE *fd = fopen(full_path.c_str(), "rb");
     if (fd == NULL) return false;
     ReplayData rd;
 
@@ -110,91 +111,36 @@ bool ReplayPlay::addReplayFile(const std::string& fn, bool custom_replay)
     rd.m_custom_replay_file = custom_replay;
     rd.m_filename = fn;
 
-    fgets(s, 1023, fd);
-    unsigned int version;
-    if (sscanf(s,"version: %u", &version) != 1)
+    // Replays can be in the binary or in the old text format (which will
+    // be converted when the replay is loaded).
+    ReplayStreamHeader header;
+    bool ok = ReplayStreamReader::readHeader(fd, &header);
+    if (!ok)
     {
-        Log::warn("Replay", "No Version information "
-                  "found in replay file (bogus replay file).");
-        fclose(fd);
-        return false;
+        ::rewind(fd);
+        ok = ReplayStreamReader::readTextHeader(fd, &header);
     }
-    if (version != getReplayVersion())
+    fclose(fd);
+    if (!ok)
     {
-        Log::warn("Replay", "Replay is version '%d'", version);
-        Log::warn("Replay", "STK version is '%d'", getReplayVersion());
         Log::warn("Replay", "Skipped '%s'", fn.c_str());
-        fclose(fd);
-        return false;
-    }
-
-    while(true)
-    {
-        fgets(s, 1023, fd);
-        core::stringc is_end(s);
-        is_end.trim();
-        if (is_end == "kart_list_end") break;
-        char s1[1024];
-
-        if (sscanf(s,"kart: %s", s1) != 1)
-        {
-            Log::warn("Replay", "Could not read ghost karts info!");
-            break;
-        }
-        rd.m_kart_list.push_back(std::string(s1));
-    }
-
-    int reverse = 0;
-    fgets(s, 1023, fd);
-    if(sscanf(s, "reverse: %d", &reverse) != 1)
-    {
-        Log::warn("Replay", "Reverse info found in replay file.");
-        fclose(fd);
-        return false;
-    }
-    rd.m_reverse = reverse != 0;
-
-    fgets(s, 1023, fd);
-    if (sscanf(s, "difficulty: %u", &rd.m_difficulty) != 1)
-    {
-        Log::warn("Replay", " No difficulty found in replay file.");
-        fclose(fd);
         return false;
     }
 
-    fgets(s, 1023, fd);
-    if (sscanf(s, "track: %s", s1) != 1)
-    {
-        Log::warn("Replay", "Track info not found in replay file.");
-        fclose(fd);
-        return false;
-    }
-    rd.m_track_name = std::string(s1);
+    rd.m_kart_list  = header.m_kart_list;
+    rd.m_reverse    = header.m_reverse;
+    rd.m_difficulty = header.m_difficulty;
+    rd.m_track_name = header.m_track_name;
+    rd.m_laps       = header.m_laps;
+    rd.m_min_time   = header.m_min_time;
     Track* t = track_manager->getTrack(rd.m_track_name);
     if (t == NULL)
     {
         Log::warn("Replay", "Track '%s' used in replay not found in STK!",
         rd.m_track_name.c_str());
-        fclose(fd);
         return false;
     }
 
-    fgets(s, 1023, fd);
-    if (sscanf(s, "laps: %u", &rd.m_laps) != 1)
-    {
-        Log::warn("Replay", "No number of laps found in replay file.");
-        fclose(fd);
-        return false;
-    }
-
-    fgets(s, 1023, fd);
-    if (sscanf(s, "min_time: %f", &rd.m_min_time) != 1)
-    {
-        Log::warn("Replay", "Finish time not found in replay file.");
-        fclose(fd);
-        return false;
-    }
-    fclose(fd);
     m_replay_file_list.push_back(rd);
 
     assert(m_replay_file_list.size() > 0);
@@ -207,102 +153,66 @@ bool ReplayPlay::addReplayFile(const std::string& fn, bool custom_replay)
 }   // addReplayFile
 
 //-----------------------------------------------------------------------------
+/** Creates the ghost karts and reads their replay data. If the replay file
+ *  can not be read, the file is skipped: the ghost karts are still created
+ *  (the world expects them), but they have no data and stay invisible.
+ */
 void ReplayPlay::load()
 {
     m_ghost_karts.clearAndDeleteAll();
-    char s[1024];
 
-    FILE *fd = openReplayFile(/*writeable*/false,
-        m_replay_file_list.at(m_current_replay_file).m_custom_replay_file);
-    if(!fd)
-    {
-        Log::error("Replay", "Can't read '%s', ghost replay disabled.",
-               getReplayFilename().c_str());
-        destroy();
-        return;
-    }
+    std::string filename = getReplayFilename();
+    if (!m_replay_file_list.at(m_current_replay_file).m_custom_replay_file)
+        filename = file_manager->getReplayDir() + filename;
 
-    Log::info("Replay", "Reading replay file '%s'.", getReplayFilename().c_str());
-
-    const unsigned int line_skipped = getNumGhostKart() + 7;
-    for (unsigned int i = 0; i < line_skipped; i++)
-        fgets(s, 1023, fd);
-
-    // eof actually doesn't trigger here, since it requires first to try
-    // reading behind eof, but still it's clearer this way.
-    while(!feof(fd))
+    bool readable = true;
+    // Replays in the old text format are converted once, and the binary
+    // version is kept in the cache.
+    if (!ReplayStreamReader::isBinaryReplay(filename))
     {
-        if(fgets(s, 1023, fd)==NULL)  // eof reached
-            break;
-        readKartData(fd, s);
-    }
-
-    fprintf(fd, "Replay file end.\n");
-    fclose(fd);
-}   // load
-
-//-----------------------------------------------------------------------------
-/** Reads all data from a replay file for a specific kart.
- *  \param fd The file descriptor from which to read.
- */
-void ReplayPlay::readKartData(FILE *fd, char *next_line)
-{
-    char s[1024];
-    const unsigned int kart_num = m_ghost_karts.size();
-    m_ghost_karts.push_back(new GhostKart(m_replay_file_list
-        [m_current_replay_file].m_kart_list.at(kart_num),
-        kart_num, kart_num + 1));
-    m_ghost_karts[kart_num].init(RaceManager::KT_GHOST);
-    Controller* controller = new GhostController(getGhostKart(kart_num));
-    getGhostKart(kart_num)->setController(controller);
-
-    unsigned int size;
-    if(sscanf(next_line,"size: %u",&size)!=1)
-        Log::fatal("Replay", "Number of records not found in replay file "
-            "for kart %d.", kart_num);
-
-    for(unsigned int i=0; i<size; i++)
-    {
-        fgets(s, 1023, fd);
-        float x, y, z, rx, ry, rz, rw, time, speed, steer, w1, w2, w3, w4;
-        int nitro, zipper, skidding, red_skidding, jumping;
-
-        // Check for EV_TRANSFORM event:
-        // -----------------------------
-        if(sscanf(s, "%f  %f %f %f  %f %f %f %f  %f  %f  %f %f %f %f  %d %d %d %d %d\n",
-            &time,
-            &x, &y, &z,
-            &rx, &ry, &rz, &rw,
-            &speed, &steer, &w1, &w2, &w3, &w4,
-            &nitro, &zipper, &skidding, &red_skidding, &jumping
-            )==19)
+        uint64_t hash;
+        if (!file_manager->getFileHash(filename, &hash))
         {
-            btQuaternion q(rx, ry, rz, rw);
-            btVector3 xyz(x, y, z);
-            PhysicInfo pi = {0};
-            KartReplayEvent kre = {0};
-            pi.m_speed = speed;
-            pi.m_steer = steer;
-            pi.m_suspension_length[0] = w1;
-            pi.m_suspension_length[1] = w2;
-            pi.m_suspension_length[2] = w3;
-            pi.m_suspension_length[3] = w4;
-            kre.m_nitro_usage = nitro;
-            kre.m_zipper_usage = zipper!=0;
-            kre.m_skidding_state = skidding;
-            kre.m_red_skidding = red_skidding!=0;
-            kre.m_jumping = jumping != 0;
-            m_ghost_karts[kart_num].addReplayEvent(time,
-                btTransform(q, xyz), pi, kre);
+            Log::warn("Replay", "Can't read '%s', skipping it.",
+                      filename.c_str());
+            readable = false;
         }
         else
         {
-            // Invalid record found
-            // ---------------------
-            Log::warn("Replay", "Can't read replay data line %d:", i);
-            Log::warn("Replay", "%s", s);
-            Log::warn("Replay", "Ignored.");
+            char hex[17];
+            sprintf(hex, "%08x%08x", (unsigned int)(hash >> 32),
+                    (unsigned int)(hash & 0xffffffff));
+            std::string binary = file_manager->getCachedDataDir() +
+                StringUtils::removeExtension(StringUtils::getBasename(filename))
+                + "-" + hex + ".replay";
+            if (!file_manager->fileExists(binary) &&
+                !ReplayStreamReader::convertTextReplay(filename, binary))
+            {
+                Log::warn("Replay", "Can't convert '%s', skipping it.",
+                          filename.c_str());
+                readable = false;
+            }
+            filename = binary;
         }
-    }   // for i
+    }
 
-}   // readKartData
+    if (readable)
+        Log::info("Replay", "Reading replay file '%s'.", filename.c_str());
+
+    for (unsigned int kart_num = 0; kart_num < getNumGhostKart(); kart_num++)
+    {
+        m_ghost_karts.push_back(new GhostKart(m_replay_file_list
+            [m_current_replay_file].m_kart_list.at(kart_num),
+            kart_num, kart_num + 1));
+        m_ghost_karts[kart_num].init(RaceManager::KT_GHOST);
+        Controller* controller = new GhostController(getGhostKart(kart_num));
+        getGhostKart(kart_num)->setController(controller);
+        if (readable && !getGhostKart(kart_num)->loadReplay(filename, kart_num))
+        {
+            Log::warn("Replay", "Can't read replay data in '%s' for "
+                      "kart %d, skipping the file.", filename.c_str(),
+                      kart_num);
+            readable = false;
+        }
+    }
+}   // load
@@ -101,7 +101,6 @@ private:
 
           ReplayPlay();
          ~ReplayPlay();
-    void  readKartData(FILE *fd, char *next_line);
 public:
     void  reset();
     void  load();
@@ -26,6 +26,7 @@
 #include "modes/world.hpp"
 #include "physics/btKart.hpp"
 #include "race/race_manager.hpp"
+#include "replay/replay_stream.hpp"
 #include "tracks/track.hpp"
 
 #include <algorithm>
@@ -207,69 +208,48 @@ void ReplayRecorder::save()
         << "_" << num_karts << "_" << time << ".replay";
     m_filename = oss.str();
 
-    FILE *fd = openReplayFile(/*writeable*/true);
-    if (!fd)
+    ReplayStreamHeader header;
+    for (unsigned int real_karts = 0; real_karts < num_karts; real_karts++)
+    {
+        if (world->getKart(real_karts)->isGhostKart()) continue;
+        header.m_kart_list.push_back(world->getKart(real_karts)->getIdent());
+    }
+    header.m_reverse    = race_manager->getReverseTrack();
+    header.m_difficulty = race_manager->getDifficulty();
+    header.m_track_name = world->getTrack()->getIdent();
+    header.m_laps       = race_manager->getNumLaps();
+    header.m_min_time   = min_time;
+
+    const std::string full_path = file_manager->getReplayDir()
+                                + getReplayFilename();
+    ReplayStreamWriter writer;
+    if (!writer.open(full_path, /*compress*/true, header))
     {
         Log::error("ReplayRecorder", "Can't open '%s' for writing - "
             "can't save replay data.", getReplayFilename().c_str());
         return;
     }
 
-    core::stringw msg = _("Replay saved in \"%s\".",
-        (file_manager->getReplayDir() + getReplayFilename()).c_str());
-    MessageQueue::add(MessageQueue::MT_GENERIC, msg);
-
-    fprintf(fd, "version: %d\n",    getReplayVersion());
-    for (unsigned int real_karts = 0; real_karts < num_karts; real_karts++)
-    {
-        if (world->getKart(real_karts)->isGhostKart()) continue;
-        fprintf(fd, "kart: %s\n",
-            world->getKart(real_karts)->getIdent().c_str());
-    }
-
-    fprintf(fd, "kart_list_end\n");
-    fprintf(fd, "reverse: %d\n",    (int)race_manager->getReverseTrack());
-    fprintf(fd, "difficulty: %d\n", race_manager->getDifficulty());
-    fprintf(fd, "track: %s\n",      world->getTrack()->getIdent().c_str());
-    fprintf(fd, "laps: %d\n",       race_manager->getNumLaps());
-    fprintf(fd, "min_time: %f\n",   min_time);
-
     unsigned int max_frames = (unsigned int)(  stk_config->m_replay_max_time 
                                              / stk_config->m_replay_dt      );
-    for (unsigned int k = 0; k < num_karts; k++)
+    bool ok = true;
+    for (unsigned int k = 0; k < num_karts && ok; k++)
     {
         if (world->getKart(k)->isGhostKart()) continue;
-        fprintf(fd, "size:     %d\n", m_count_transforms[k]);
-
         unsigned int num_transforms = std::min(max_frames,
                                                m_count_transforms[k]);
-        for (unsigned int i = 0; i < num_transforms; i++)
-        {
-            const TransformEvent *p  = &(m_transform_events[k][i]);
-            const PhysicInfo *q      = &(m_physic_info[k][i]);
-            const KartReplayEvent *r = &(m_kart_replay_event[k][i]);
-            fprintf(fd, "%f  %f %f %f  %f %f %f %f  %f  %f  %f %f %f %f  %d %d %d %d %d\n",
-                    p->m_time,
-                    p->m_transform.getOrigin().getX(),
-                    p->m_transform.getOrigin().getY(),
-                    p->m_transform.getOrigin().getZ(),
-                    p->m_transform.getRotation().getX(),
-                    p->m_transform.getRotation().getY(),
-                    p->m_transform.getRotation().getZ(),
-                    p->m_transform.getRotation().getW(),
-                    q->m_speed,
-                    q->m_steer,
-                    q->m_suspension_length[0],
-                    q->m_suspension_length[1],
-                    q->m_suspension_length[2],
-                    q->m_suspension_length[3],
-                    r->m_nitro_usage,
-                    (int)r->m_zipper_usage,
-                    r->m_skidding_state,
-                    (int)r->m_red_skidding,
-                    (int)r->m_jumping
-                );
-        }   // for i
+        ok = writer.addKart(m_transform_events[k].data(),
+                            m_physic_info[k].data(),
+                            m_kart_replay_event[k].data(), num_transforms);
     }
-    fclose(fd);
+    if (!writer.close() || !ok)
+    {
+        Log::error("ReplayRecorder", "Error writing replay file '%s'.",
+                   full_path.c_str());
+        file_manager->removeFile(full_path);
+        return;
+    }
+
+    core::stringw msg = _("Replay saved in \"%s\".", full_path.c_str());
+    MessageQueue::add(MessageQueue::MT_GENERIC, msg);
 }   // save
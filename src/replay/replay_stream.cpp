@@ -0,0 +1,919 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2016 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#include "replay/replay_stream.hpp"
+
+#include "io/file_manager.hpp"
+#include "utils/log.hpp"
+
+#include <algorithm>
+#include <assert.h>
+#include <math.h>
+#include <string.h>
+
+/** Identifies a binary replay file (text replays start with 'version:'). */
+static const char     REPLAY_MAGIC[8]       = "STKRPLB";
+/** Version of the binary format. */
+static const uint32_t REPLAY_BINARY_VERSION = 1;
+/** The only supported version of the old text format. */
+static const unsigned int REPLAY_TEXT_VERSION = 3;
+/** Flag set in the header if the event data is compressed. */
+static const uint8_t  REPLAY_FLAG_COMPRESSED = 1;
+
+/** Scaling factors used to quantize the replay data. */
+static const float TIME_SCALE       = 1000.0f;
+static const float POSITION_SCALE   = 1000.0f;
+static const float ROTATION_SCALE   = 32767.0f;
+static const float SPEED_SCALE      = 100.0f;
+static const float STEER_SCALE      = 1000.0f;
+static const float SUSPENSION_SCALE = 10000.0f;
+
+/** Upper limit for the size of one encoded event. */
+static const unsigned int MAX_EVENT_SIZE  = 128;
+/** Size of the buffers used when reading event data. */
+static const unsigned int READ_BUFFER_SIZE = 16384;
+
+/** Bits of QuantizedReplayEvent::m_flags. */
+enum { RF_ZIPPER = 1, RF_RED_SKIDDING = 2, RF_JUMPING = 4 };
+
+// ----------------------------------------------------------------------------
+/** Helper functions to write little-endian values and varints to a buffer,
+ *  and to read them back. */
+static void addUInt(std::vector<uint8_t> *buffer, uint32_t value,
+                    unsigned int bytes)
+{
+    for (unsigned int i = 0; i < bytes; i++)
+        buffer->push_back((uint8_t)(value >> (8 * i)));
+}   // addUInt
+
+// ----------------------------------------------------------------------------
+static void addVarInt(std::vector<uint8_t> *buffer, uint32_t value)
+{
+    while (value >= 0x80)
+    {
+        buffer->push_back((uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    buffer->push_back((uint8_t)value);
+}   // addVarInt
+
+// ----------------------------------------------------------------------------
+/** Stores a signed value as varint, using zig-zag encoding so that small
+ *  negative values only need a few bytes. */
+static void addSignedVarInt(std::vector<uint8_t> *buffer, int32_t value)
+{
+    addVarInt(buffer, ((uint32_t)value << 1) ^ (uint32_t)(value >> 31));
+}   // addSignedVarInt
+
+// ----------------------------------------------------------------------------
+static void addString(std::vector<uint8_t> *buffer, const std::string &s)
+{
+    addUInt(buffer, (uint32_t)s.size(), 2);
+    buffer->insert(buffer->end(), s.begin(), s.end());
+}   // addString
+
+// ----------------------------------------------------------------------------
+static bool getVarInt(const uint8_t *data, unsigned int *pos,
+                      unsigned int end, uint32_t *value)
+{
+    uint32_t result = 0;
+    for (unsigned int shift = 0; shift < 35; shift += 7)
+    {
+        if (*pos >= end)
+            return false;
+        const uint8_t b = data[(*pos)++];
+        result |= (uint32_t)(b & 0x7f) << shift;
+        if ((b & 0x80) == 0)
+        {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}   // getVarInt
+
+// ----------------------------------------------------------------------------
+/** Reads a zig-zag encoded varint and adds it to value. */
+static bool addSignedDelta(const uint8_t *data, unsigned int *pos,
+                           unsigned int end, int32_t *value)
+{
+    uint32_t v;
+    if (!getVarInt(data, pos, end, &v))
+        return false;
+    *value += (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+    return true;
+}   // addSignedDelta
+
+// ----------------------------------------------------------------------------
+static bool readUInt(FILE *file, uint32_t *value, unsigned int bytes)
+{
+    uint8_t data[4];
+    if (fread(data, 1, bytes, file) != bytes)
+        return false;
+    *value = 0;
+    for (unsigned int i = 0; i < bytes; i++)
+        *value |= (uint32_t)data[i] << (8 * i);
+    return true;
+}   // readUInt
+
+// ----------------------------------------------------------------------------
+static bool readString(FILE *file, std::string *s)
+{
+    uint32_t len;
+    if (!readUInt(file, &len, 2))
+        return false;
+    s->resize(len);
+    return len == 0 || fread(&(*s)[0], 1, len, file) == len;
+}   // readString
+
+// ----------------------------------------------------------------------------
+static int32_t quantize(float f, float scale)
+{
+    return (int32_t)floorf(f * scale + 0.5f);
+}   // quantize
+
+// ============================================================================
+ReplayStreamWriter::ReplayStreamWriter()
+{
+    m_file     = NULL;
+    m_compress = false;
+}   // ReplayStreamWriter
+
+// ----------------------------------------------------------------------------
+ReplayStreamWriter::~ReplayStreamWriter()
+{
+    if (m_file)
+        fclose(m_file);
+}   // ~ReplayStreamWriter
+
+// ----------------------------------------------------------------------------
+/** Creates the replay file and writes the header.
+ *  \param filename Full path of the file to write.
+ *  \param compress True if the event data should be compressed.
+ *  \param header The information about the replay.
+ *  \return False if the file could not be written.
+ */
+bool ReplayStreamWriter::open(const std::string &filename, bool compress,
+                              const ReplayStreamHeader &header)
+{
+    assert(!m_file);
+    m_file = fopen(filename.c_str(), "wb");
+    if (!m_file)
+        return false;
+    m_compress = compress;
+
+    std::vector<uint8_t> buffer(REPLAY_MAGIC, REPLAY_MAGIC + 8);
+    addUInt(&buffer, REPLAY_BINARY_VERSION, 4);
+    addUInt(&buffer, compress ? REPLAY_FLAG_COMPRESSED : 0, 1);
+    addUInt(&buffer, (uint32_t)header.m_kart_list.size(), 1);
+    for (unsigned int i = 0; i < header.m_kart_list.size(); i++)
+        addString(&buffer, header.m_kart_list[i]);
+    addUInt(&buffer, header.m_reverse ? 1 : 0, 1);
+    addUInt(&buffer, header.m_difficulty, 1);
+    addString(&buffer, header.m_track_name);
+    addUInt(&buffer, header.m_laps, 2);
+    uint32_t min_time;
+    memcpy(&min_time, &header.m_min_time, 4);
+    addUInt(&buffer, min_time, 4);
+    return fwrite(buffer.data(), 1, buffer.size(), m_file) == buffer.size();
+}   // open
+
+// ----------------------------------------------------------------------------
+/** Writes the events of one kart. This must be called once for each kart
+ *  in the kart list of the header, in the same order.
+ *  Events with the same (quantized) time as the previous event are skipped,
+ *  since the GhostController can not interpolate between them.
+ *  \return False if the data could not be written.
+ */
+bool ReplayStreamWriter::addKart(const ReplayBase::TransformEvent *transform,
+                          const ReplayBase::PhysicInfo *physic_info,
+                          const ReplayBase::KartReplayEvent *kart_replay_event,
+                          unsigned int num_events)
+{
+    assert(m_file);
+    std::vector<uint8_t> times, data;
+    QuantizedReplayEvent previous;
+    memset(&previous, 0, sizeof(previous));
+    int32_t previous_time = 0;
+    unsigned int count = 0;
+    for (unsigned int i = 0; i < num_events; i++)
+    {
+        const int32_t time = quantize(transform[i].m_time, TIME_SCALE);
+        if (count > 0 && time == previous_time)
+            continue;
+        addSignedVarInt(&times, time - previous_time);
+        previous_time = time;
+        count++;
+
+        QuantizedReplayEvent e;
+        const btVector3 &xyz = transform[i].m_transform.getOrigin();
+        btQuaternion q = transform[i].m_transform.getRotation();
+        q.normalize();
+        for (unsigned int j = 0; j < 3; j++)
+            e.m_xyz[j] = quantize(xyz[j], POSITION_SCALE);
+        for (unsigned int j = 0; j < 4; j++)
+            e.m_rotation[j] = quantize(q[j], ROTATION_SCALE);
+        e.m_speed = quantize(physic_info[i].m_speed, SPEED_SCALE);
+        e.m_steer = quantize(physic_info[i].m_steer, STEER_SCALE);
+        for (unsigned int j = 0; j < 4; j++)
+        {
+            e.m_suspension_length[j] =
+                quantize(physic_info[i].m_suspension_length[j],
+                         SUSPENSION_SCALE);
+        }
+        const ReplayBase::KartReplayEvent &kre = kart_replay_event[i];
+        e.m_nitro_usage    = kre.m_nitro_usage;
+        e.m_skidding_state = kre.m_skidding_state;
+        e.m_flags = (kre.m_zipper_usage ? RF_ZIPPER       : 0) |
+                    (kre.m_red_skidding ? RF_RED_SKIDDING : 0) |
+                    (kre.m_jumping      ? RF_JUMPING      : 0);
+
+        for (unsigned int j = 0; j < 3; j++)
+            addSignedVarInt(&data, e.m_xyz[j] - previous.m_xyz[j]);
+        for (unsigned int j = 0; j < 4; j++)
+            addSignedVarInt(&data, e.m_rotation[j] - previous.m_rotation[j]);
+        addSignedVarInt(&data, e.m_speed - previous.m_speed);
+        addSignedVarInt(&data, e.m_steer - previous.m_steer);
+        for (unsigned int j = 0; j < 4; j++)
+        {
+            addSignedVarInt(&data, e.m_suspension_length[j]
+                                 - previous.m_suspension_length[j]);
+        }
+        addUInt(&data, e.m_flags, 1);
+        addSignedVarInt(&data, e.m_nitro_usage - previous.m_nitro_usage);
+        addSignedVarInt(&data, e.m_skidding_state -previous.m_skidding_state);
+        previous = e;
+    }   // for i < num_events
+
+    if (m_compress && !data.empty())
+    {
+        uLongf size = compressBound((uLong)data.size());
+        std::vector<uint8_t> compressed(size);
+        if (compress2(compressed.data(), &size, data.data(),
+                      (uLong)data.size(), Z_BEST_COMPRESSION) != Z_OK)
+        {
+            Log::error("ReplayStream", "Can not compress replay data.");
+            return false;
+        }
+        compressed.resize(size);
+        data.swap(compressed);
+    }
+
+    std::vector<uint8_t> buffer;
+    addUInt(&buffer, count, 4);
+    addUInt(&buffer, (uint32_t)times.size(), 4);
+    buffer.insert(buffer.end(), times.begin(), times.end());
+    addUInt(&buffer, (uint32_t)data.size(), 4);
+    buffer.insert(buffer.end(), data.begin(), data.end());
+    return fwrite(buffer.data(), 1, buffer.size(), m_file) == buffer.size();
+}   // addKart
+
+// ----------------------------------------------------------------------------
+/** Closes the file.
+ *  \return False if an error happened when writing the remaining data.
+ */
+bool ReplayStreamWriter::close()
+{
+    if (!m_file)
+        return false;
+    const bool ok = fclose(m_file) == 0;
+    m_file = NULL;
+    return ok;
+}   // close
+
+// ============================================================================
+ReplayStreamReader::ReplayStreamReader()
+{
+    m_file                = NULL;
+    m_data_offset         = 0;
+    m_data_size           = 0;
+    m_data_read           = 0;
+    m_compressed          = false;
+    m_zstream_initialised = false;
+    m_buffer_pos          = 0;
+    m_buffer_end          = 0;
+    m_events_read         = 0;
+    memset(&m_previous, 0, sizeof(m_previous));
+}   // ReplayStreamReader
+
+// ----------------------------------------------------------------------------
+ReplayStreamReader::~ReplayStreamReader()
+{
+    closeStream();
+    if (m_file)
+        fclose(m_file);
+}   // ~ReplayStreamReader
+
+// ----------------------------------------------------------------------------
+/** Tests if a file is a replay in the binary format.
+ *  \param filename Full path of the file.
+ */
+bool ReplayStreamReader::isBinaryReplay(const std::string &filename)
+{
+    FILE *file = fopen(filename.c_str(), "rb");
+    if (!file)
+        return false;
+    char magic[8];
+    const bool result = fread(magic, 1, 8, file) == 8 &&
+                        memcmp(magic, REPLAY_MAGIC, 8) == 0;
+    fclose(file);
+    return result;
+}   // isBinaryReplay
+
+// ----------------------------------------------------------------------------
+/** Reads the header of a binary replay file.
+ *  \param file The file, positioned at the beginning.
+ *  \param header On return contains the information about the replay.
+ *  \param compressed If not NULL, on return indicates whether the event
+ *         data is compressed.
+ *  \return False if this is not a (supported) binary replay file.
+ */
+bool ReplayStreamReader::readHeader(FILE *file, ReplayStreamHeader *header,
+                                    bool *compressed)
+{
+    char magic[8];
+    if (fread(magic, 1, 8, file) != 8 || memcmp(magic, REPLAY_MAGIC, 8) != 0)
+        return false;
+
+    uint32_t version, flags, num_karts;
+    if (!readUInt(file, &version, 4))
+        return false;
+    if (version != REPLAY_BINARY_VERSION)
+    {
+        Log::warn("Replay", "Binary replay is version '%d'", version);
+        Log::warn("Replay", "STK version is '%d'", REPLAY_BINARY_VERSION);
+        return false;
+    }
+    if (!readUInt(file, &flags, 1) || !readUInt(file, &num_karts, 1))
+        return false;
+    if (compressed)
+        *compressed = (flags & REPLAY_FLAG_COMPRESSED) != 0;
+
+    header->m_kart_list.resize(num_karts);
+    for (unsigned int i = 0; i < num_karts; i++)
+    {
+        if (!readString(file, &header->m_kart_list[i]))
+            return false;
+    }
+    uint32_t reverse, difficulty, laps, min_time;
+    if (!readUInt(file, &reverse, 1) || !readUInt(file, &difficulty, 1) ||
+        !readString(file, &header->m_track_name) ||
+        !readUInt(file, &laps, 2) || !readUInt(file, &min_time, 4))
+        return false;
+    header->m_reverse    = reverse != 0;
+    header->m_difficulty = difficulty;
+    header->m_laps       = laps;
+    memcpy(&header->m_min_time, &min_time, 4);
+    return true;
+}   // readHeader
+
+// ----------------------------------------------------------------------------
+/** Reads the header of a replay in the old text format.
+ *  \param file The file, positioned at the beginning.
+ *  \param header On return contains the information about the replay.
+ *  \return False if the header could not be read.
+ */
+bool ReplayStreamReader::readTextHeader(FILE *file,
+                                        ReplayStreamHeader *header)
+{
+    char s[1024], s1[1024];
+    if (fgets(s, 1023, file) == NULL)
+        return false;
+    unsigned int version;
+    if (sscanf(s,"version: %u", &version) != 1)
+    {
+        Log::warn("Replay", "No Version information "
+                  "found in replay file (bogus replay file).");
+        return false;
+    }
+    if (version != REPLAY_TEXT_VERSION)
+    {
+        Log::warn("Replay", "Replay is version '%d'", version);
+        Log::warn("Replay", "STK version is '%d'", REPLAY_TEXT_VERSION);
+        return false;
+    }
+
+    while(true)
+    {
+        if (fgets(s, 1023, file) == NULL)
+            return false;
+        if (sscanf(s, "%1023s", s1) == 1 && strcmp(s1, "kart_list_end") == 0)
+            break;
+
+        if (sscanf(s,"kart: %s", s1) != 1)
+        {
+            Log::warn("Replay", "Could not read ghost karts info!");
+            break;
+        }
+        header->m_kart_list.push_back(std::string(s1));
+    }
+
+    int reverse = 0;
+    if (fgets(s, 1023, file) == NULL || sscanf(s, "reverse: %d", &reverse) != 1)
+    {
+        Log::warn("Replay", "Reverse info found in replay file.");
+        return false;
+    }
+    header->m_reverse = reverse != 0;
+
+    if (fgets(s, 1023, file) == NULL ||
+        sscanf(s, "difficulty: %u", &header->m_difficulty) != 1)
+    {
+        Log::warn("Replay", " No difficulty found in replay file.");
+        return false;
+    }
+
+    if (fgets(s, 1023, file) == NULL || sscanf(s, "track: %s", s1) != 1)
+    {
+        Log::warn("Replay", "Track info not found in replay file.");
+        return false;
+    }
+    header->m_track_name = std::string(s1);
+
+    if (fgets(s, 1023, file) == NULL ||
+        sscanf(s, "laps: %u", &header->m_laps) != 1)
+    {
+        Log::warn("Replay", "No number of laps found in replay file.");
+        return false;
+    }
+
+    if (fgets(s, 1023, file) == NULL ||
+        sscanf(s, "min_time: %f", &header->m_min_time) != 1)
+    {
+        Log::warn("Replay", "Finish time not found in replay file.");
+        return false;
+    }
+    return true;
+}   // readTextHeader
+
+// ----------------------------------------------------------------------------
+/** Converts a replay in the old text format into the binary format.
+ *  \param text_file Full path of the text replay.
+ *  \param binary_file Full path of the binary replay to write.
+ *  \return False if the text replay could not be read or the binary
+ *          replay could not be written.
+ */
+bool ReplayStreamReader::convertTextReplay(const std::string &text_file,
+                                           const std::string &binary_file)
+{
+    FILE *fd = fopen(text_file.c_str(), "r");
+    if (!fd)
+    {
+        Log::error("Replay", "Can't read '%s'.", text_file.c_str());
+        return false;
+    }
+
+    ReplayStreamHeader header;
+    if (!readTextHeader(fd, &header))
+    {
+        Log::error("Replay", "Invalid replay file '%s'.", text_file.c_str());
+        fclose(fd);
+        return false;
+    }
+
+    ReplayStreamWriter writer;
+    if (!writer.open(binary_file, /*compress*/true, header))
+    {
+        Log::error("Replay", "Can't open '%s' for writing.",
+                   binary_file.c_str());
+        fclose(fd);
+        return false;
+    }
+
+    bool ok = true;
+    char s[1024];
+    std::vector<ReplayBase::TransformEvent>  transform;
+    std::vector<ReplayBase::PhysicInfo>      physic_info;
+    std::vector<ReplayBase::KartReplayEvent> kart_replay_event;
+    for (unsigned int k = 0; k < header.m_kart_list.size() && ok; k++)
+    {
+        unsigned int size;
+        if (fgets(s, 1023, fd) == NULL || sscanf(s,"size: %u",&size) != 1)
+        {
+            Log::error("Replay", "Number of records not found in replay file "
+                       "for kart %d.", k);
+            ok = false;
+            break;
+        }
+        transform.clear();
+        physic_info.clear();
+        kart_replay_event.clear();
+        for (unsigned int i = 0; i < size; i++)
+        {
+            if (fgets(s, 1023, fd) == NULL)
+                break;
+            float x, y, z, rx, ry, rz, rw, time, speed, steer, w1, w2, w3, w4;
+            int nitro, zipper, skidding, red_skidding, jumping;
+            if (sscanf(s, "%f  %f %f %f  %f %f %f %f  %f  %f  %f %f %f %f  %d %d %d %d %d\n",
+                &time,
+                &x, &y, &z,
+                &rx, &ry, &rz, &rw,
+                &speed, &steer, &w1, &w2, &w3, &w4,
+                &nitro, &zipper, &skidding, &red_skidding, &jumping
+                ) != 19)
+            {
+                // Invalid record found
+                Log::warn("Replay", "Can't read replay data line %d:", i);
+                Log::warn("Replay", "%s", s);
+                Log::warn("Replay", "Ignored.");
+                continue;
+            }
+            ReplayBase::TransformEvent te;
+            te.m_time = time;
+            te.m_transform = btTransform(btQuaternion(rx, ry, rz, rw),
+                                         btVector3(x, y, z));
+            ReplayBase::PhysicInfo pi = {0};
+            pi.m_speed = speed;
+            pi.m_steer = steer;
+            pi.m_suspension_length[0] = w1;
+            pi.m_suspension_length[1] = w2;
+            pi.m_suspension_length[2] = w3;
+            pi.m_suspension_length[3] = w4;
+            ReplayBase::KartReplayEvent kre = {0};
+            kre.m_nitro_usage = nitro;
+            kre.m_zipper_usage = zipper!=0;
+            kre.m_skidding_state = skidding;
+            kre.m_red_skidding = red_skidding!=0;
+            kre.m_jumping = jumping != 0;
+            transform.push_back(te);
+            physic_info.push_back(pi);
+            kart_replay_event.push_back(kre);
+        }   // for i < size
+        ok = writer.addKart(transform.data(), physic_info.data(),
+                            kart_replay_event.data(),
+                            (unsigned int)transform.size());
+    }   // for k
+    fclose(fd);
+
+    ok = writer.close() && ok;
+    if (!ok)
+    {
+        Log::error("Replay", "Could not convert '%s'.", text_file.c_str());
+        file_manager->removeFile(binary_file);
+    }
+    return ok;
+}   // convertTextReplay
+
+// ----------------------------------------------------------------------------
+/** Opens a binary replay file and prepares reading the events of one kart.
+ *  \param filename Full path of the replay file.
+ *  \param kart Index of the kart in the kart list of the replay.
+ *  \return False if the file could not be read.
+ */
+bool ReplayStreamReader::open(const std::string &filename, unsigned int kart)
+{
+    assert(!m_file);
+    m_file = fopen(filename.c_str(), "rb");
+    if (!m_file)
+        return false;
+
+    ReplayStreamHeader header;
+    if (!readHeader(m_file, &header, &m_compressed) ||
+        kart >= header.m_kart_list.size())
+        return false;
+
+    uint32_t num_events, size;
+    for (unsigned int k = 0; k < kart; k++)
+    {
+        // Skip the times and the event data
+        if (!readUInt(m_file, &num_events, 4) || !readUInt(m_file, &size, 4) ||
+            fseek(m_file, size, SEEK_CUR) != 0 ||
+            !readUInt(m_file, &size, 4) || fseek(m_file, size, SEEK_CUR) != 0)
+            return false;
+    }
+
+    if (!readUInt(m_file, &num_events, 4) || !readUInt(m_file, &size, 4))
+        return false;
+    // Don't trust the sizes from the file before allocating memory: the
+    // times can't be larger than the rest of the file, and each time
+    // delta takes at least one byte.
+    long pos_times = ftell(m_file);
+    if (pos_times < 0 || fseek(m_file, 0, SEEK_END) != 0)
+        return false;
+    long file_end = ftell(m_file);
+    if (file_end < pos_times || fseek(m_file, pos_times, SEEK_SET) != 0 ||
+        size > (unsigned long)(file_end - pos_times) || num_events > size)
+        return false;
+    std::vector<uint8_t> times(size);
+    if (size > 0 && fread(times.data(), 1, size, m_file) != size)
+        return false;
+    m_times.resize(num_events);
+    unsigned int pos = 0;
+    int32_t time = 0;
+    for (unsigned int i = 0; i < num_events; i++)
+    {
+        if (!addSignedDelta(times.data(), &pos, size, &time))
+            return false;
+        m_times[i] = time / TIME_SCALE;
+    }
+
+    if (!readUInt(m_file, &m_data_size, 4))
+        return false;
+    m_data_offset = ftell(m_file);
+    m_buffer.resize(READ_BUFFER_SIZE);
+    if (m_compressed)
+        m_input.resize(READ_BUFFER_SIZE);
+    return startStream();
+}   // open
+
+// ----------------------------------------------------------------------------
+/** Starts reading the event data from the beginning. */
+bool ReplayStreamReader::startStream()
+{
+    closeStream();
+    if (fseek(m_file, m_data_offset, SEEK_SET) != 0)
+        return false;
+    m_data_read   = 0;
+    m_buffer_pos  = 0;
+    m_buffer_end  = 0;
+    m_events_read = 0;
+    memset(&m_previous, 0, sizeof(m_previous));
+    if (m_compressed)
+    {
+        memset(&m_zstream, 0, sizeof(m_zstream));
+        if (inflateInit(&m_zstream) != Z_OK)
+            return false;
+        m_zstream_initialised = true;
+    }
+    return true;
+}   // startStream
+
+// ----------------------------------------------------------------------------
+/** Frees the zlib stream (if any). */
+void ReplayStreamReader::closeStream()
+{
+    if (m_zstream_initialised)
+        inflateEnd(&m_zstream);
+    m_zstream_initialised = false;
+}   // closeStream
+
+// ----------------------------------------------------------------------------
+/** Restarts reading the events from the first event.
+ *  \return False if the file could not be read.
+ */
+bool ReplayStreamReader::rewind()
+{
+    if (!m_file)
+        return false;
+    return startStream();
+}   // rewind
+
+// ----------------------------------------------------------------------------
+/** Moves the not yet decoded data to the beginning of the buffer, and fills
+ *  the rest of the buffer with new data from the file.
+ *  \return False if an error occurred.
+ */
+bool ReplayStreamReader::fillBuffer()
+{
+    memmove(m_buffer.data(), m_buffer.data() + m_buffer_pos,
+            m_buffer_end - m_buffer_pos);
+    m_buffer_end -= m_buffer_pos;
+    m_buffer_pos  = 0;
+
+    if (!m_compressed)
+    {
+        const unsigned int n = std::min(READ_BUFFER_SIZE - m_buffer_end,
+                                        m_data_size - m_data_read);
+        if (n > 0 && fread(m_buffer.data() + m_buffer_end, 1, n, m_file) != n)
+            return false;
+        m_buffer_end += n;
+        m_data_read  += n;
+        return true;
+    }
+
+    m_zstream.next_out  = m_buffer.data() + m_buffer_end;
+    m_zstream.avail_out = READ_BUFFER_SIZE - m_buffer_end;
+    while (m_zstream.avail_out > 0)
+    {
+        if (m_zstream.avail_in == 0)
+        {
+            const unsigned int n = std::min(READ_BUFFER_SIZE,
+                                            m_data_size - m_data_read);
+            if (n == 0)
+                break;
+            if (fread(m_input.data(), 1, n, m_file) != n)
+                return false;
+            m_data_read += n;
+            m_zstream.next_in  = m_input.data();
+            m_zstream.avail_in = n;
+        }
+        const int ret = inflate(&m_zstream, Z_NO_FLUSH);
+        if (ret == Z_STREAM_END)
+            break;
+        if (ret != Z_OK)
+        {
+            Log::error("ReplayStream", "Error %d decompressing replay.", ret);
+            return false;
+        }
+    }   // while avail_out > 0
+    m_buffer_end = READ_BUFFER_SIZE - m_zstream.avail_out;
+    return true;
+}   // fillBuffer
+
+// ----------------------------------------------------------------------------
+/** Reads the next event of the kart.
+ *  \return False if all events were read or the data is invalid.
+ */
+bool ReplayStreamReader::readEvent(ReplayBase::TransformEvent *transform,
+                          ReplayBase::PhysicInfo *physic_info,
+                          ReplayBase::KartReplayEvent *kart_replay_event)
+{
+    if (!m_file || m_events_read >= m_times.size())
+        return false;
+    if (m_buffer_end - m_buffer_pos < MAX_EVENT_SIZE && !fillBuffer())
+        return false;
+
+    const uint8_t *data = m_buffer.data();
+    unsigned int   pos  = m_buffer_pos;
+    QuantizedReplayEvent &e = m_previous;
+    bool ok = true;
+    for (unsigned int j = 0; j < 3; j++)
+        ok = ok && addSignedDelta(data, &pos, m_buffer_end, &e.m_xyz[j]);
+    for (unsigned int j = 0; j < 4; j++)
+        ok = ok && addSignedDelta(data, &pos, m_buffer_end, &e.m_rotation[j]);
+    ok = ok && addSignedDelta(data, &pos, m_buffer_end, &e.m_speed);
+    ok = ok && addSignedDelta(data, &pos, m_buffer_end, &e.m_steer);
+    for (unsigned int j = 0; j < 4; j++)
+    {
+        ok = ok && addSignedDelta(data, &pos, m_buffer_end,
+                                  &e.m_suspension_length[j]);
+    }
+    ok = ok && pos < m_buffer_end;
+    if (ok)
+        e.m_flags = data[pos++];
+    ok = ok && addSignedDelta(data, &pos, m_buffer_end, &e.m_nitro_usage);
+    ok = ok && addSignedDelta(data, &pos, m_buffer_end, &e.m_skidding_state);
+    if (!ok)
+    {
+        Log::error("ReplayStream", "Invalid replay data.");
+        m_events_read = (unsigned int)m_times.size();
+        return false;
+    }
+    m_buffer_pos = pos;
+
+    transform->m_time = m_times[m_events_read++];
+    btQuaternion q(e.m_rotation[0] / ROTATION_SCALE,
+                   e.m_rotation[1] / ROTATION_SCALE,
+                   e.m_rotation[2] / ROTATION_SCALE,
+                   e.m_rotation[3] / ROTATION_SCALE);
+    if (q.length2() > 0)
+        q.normalize();
+    else
+        q = btQuaternion(0, 0, 0, 1);
+    transform->m_transform.setRotation(q);
+    transform->m_transform.setOrigin(btVector3(e.m_xyz[0] / POSITION_SCALE,
+                                               e.m_xyz[1] / POSITION_SCALE,
+                                               e.m_xyz[2] / POSITION_SCALE));
+    physic_info->m_speed = e.m_speed / SPEED_SCALE;
+    physic_info->m_steer = e.m_steer / STEER_SCALE;
+    for (unsigned int j = 0; j < 4; j++)
+    {
+        physic_info->m_suspension_length[j] =
+            e.m_suspension_length[j] / SUSPENSION_SCALE;
+    }
+    kart_replay_event->m_nitro_usage    = e.m_nitro_usage;
+    kart_replay_event->m_skidding_state = e.m_skidding_state;
+    kart_replay_event->m_zipper_usage   = (e.m_flags & RF_ZIPPER) != 0;
+    kart_replay_event->m_red_skidding   = (e.m_flags & RF_RED_SKIDDING) != 0;
+    kart_replay_event->m_jumping        = (e.m_flags & RF_JUMPING) != 0;
+    return true;
+}   // readEvent
+
+// ----------------------------------------------------------------------------
+/** Writes a replay with two karts, and checks that reading it back gives
+ *  the same data (within the quantization accuracy), with and without
+ *  compression.
+ */
+void ReplayStreamReader::unitTesting()
+{
+    const unsigned int num_events = 5000;
+    std::vector<ReplayBase::TransformEvent>  transform(num_events);
+    std::vector<ReplayBase::PhysicInfo>      physic_info(num_events);
+    std::vector<ReplayBase::KartReplayEvent> kart_replay_event(num_events);
+    for (unsigned int i = 0; i < num_events; i++)
+    {
+        // Two events with the same time, the second one must be skipped
+        transform[i].m_time = (i == 1 ? 0 : i) * 0.05f;
+        transform[i].m_transform.setOrigin(btVector3(100.0f*sinf(i*0.01f),
+                                                     -3.0f + i*0.001f,
+                                                     100.0f*cosf(i*0.01f)));
+        transform[i].m_transform.setRotation(btQuaternion(btVector3(0, 1, 0),
+                                                          i*0.01f));
+        physic_info[i].m_speed = 20.0f + 10.0f*sinf(i*0.1f);
+        physic_info[i].m_steer = sinf(i*0.3f);
+        for (unsigned int j = 0; j < 4; j++)
+            physic_info[i].m_suspension_length[j] = 0.28f + 0.01f*j;
+        kart_replay_event[i].m_nitro_usage    = (i / 100) % 3;
+        kart_replay_event[i].m_zipper_usage   = (i % 200) == 0;
+        kart_replay_event[i].m_skidding_state = (i / 50) % 4;
+        kart_replay_event[i].m_red_skidding   = (i % 7) == 0;
+        kart_replay_event[i].m_jumping        = (i % 11) == 0;
+    }
+
+    ReplayStreamHeader header;
+    header.m_kart_list.push_back("tux");
+    header.m_kart_list.push_back("nolok");
+    header.m_reverse    = true;
+    header.m_difficulty = 2;
+    header.m_track_name = "farm";
+    header.m_laps       = 3;
+    header.m_min_time   = 123.5f;
+
+    const std::string filename = file_manager->getCachedDataDir() +
+                                 "unit_test.replay";
+    for (int compress = 0; compress < 2; compress++)
+    {
+        ReplayStreamWriter writer;
+        bool ok = writer.open(filename, compress != 0, header);
+        for (unsigned int k = 0; k < 2; k++)
+        {
+            ok = ok && writer.addKart(transform.data(), physic_info.data(),
+                                      kart_replay_event.data(), num_events);
+        }
+        ok = writer.close() && ok;
+        assert(ok);
+
+        FILE *file = fopen(filename.c_str(), "rb");
+        ReplayStreamHeader h;
+        bool compressed = false;
+        ok = readHeader(file, &h, &compressed);
+        fclose(file);
+        assert(ok);
+        assert(compressed == (compress != 0));
+        assert(h.m_kart_list == header.m_kart_list);
+        assert(h.m_reverse && h.m_difficulty == 2 && h.m_laps == 3);
+        assert(h.m_track_name == "farm" && h.m_min_time == 123.5f);
+
+        ReplayStreamReader reader;
+        ok = reader.open(filename, 1);
+        assert(ok);
+        assert(reader.getNumEvents() == num_events - 1);
+        // Read everything twice to test rewind
+        for (int pass = 0; pass < 2; pass++)
+        {
+            for (unsigned int i = 0; i < num_events; i++)
+            {
+                if (i == 1) continue;
+                ReplayBase::TransformEvent te;
+                ReplayBase::PhysicInfo pi;
+                ReplayBase::KartReplayEvent kre;
+                ok = reader.readEvent(&te, &pi, &kre);
+                assert(ok);
+                assert(fabsf(te.m_time - transform[i].m_time) < 0.001f);
+                assert((te.m_transform.getOrigin() -
+                        transform[i].m_transform.getOrigin()).length()<0.001f);
+                assert(fabsf(te.m_transform.getRotation()
+                            .dot(transform[i].m_transform.getRotation())) >
+                       0.9999f);
+                assert(fabsf(pi.m_speed - physic_info[i].m_speed) < 0.01f);
+                assert(fabsf(pi.m_steer - physic_info[i].m_steer) < 0.001f);
+                assert(fabsf(pi.m_suspension_length[3] -
+                             physic_info[i].m_suspension_length[3]) < 0.0001f);
+                assert(kre.m_nitro_usage ==
+                       kart_replay_event[i].m_nitro_usage);
+                assert(kre.m_zipper_usage ==
+                       kart_replay_event[i].m_zipper_usage);
+                assert(kre.m_skidding_state ==
+                       kart_replay_event[i].m_skidding_state);
+                assert(kre.m_red_skidding ==
+                       kart_replay_event[i].m_red_skidding);
+                assert(kre.m_jumping == kart_replay_event[i].m_jumping);
+            }
+            ReplayBase::TransformEvent te;
+            ReplayBase::PhysicInfo pi;
+            ReplayBase::KartReplayEvent kre;
+            ok = reader.readEvent(&te, &pi, &kre);
+            assert(!ok);
+            reader.rewind();
+        }   // for pass
+
+        // A corrupted number of events must not be trusted
+        file = fopen(filename.c_str(), "r+b");
+        ok = readHeader(file, &h);
+        assert(ok);
+        const uint8_t bad_num_events[4] = { 0xff, 0xff, 0xff, 0x7f };
+        ok = fseek(file, ftell(file), SEEK_SET) == 0 &&
+             fwrite(bad_num_events, 1, 4, file) == 4;
+        fclose(file);
+        assert(ok);
+        ReplayStreamReader bad_reader;
+        ok = bad_reader.open(filename, 0);
+        assert(!ok);
+    }   // for compress
+    file_manager->removeFile(filename);
+}   // unitTesting
@@ -0,0 +1,172 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2016 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#ifndef HEADER_REPLAY_STREAM_HPP
+#define HEADER_REPLAY_STREAM_HPP
+
+#include "replay/replay_base.hpp"
+#include "utils/no_copy.hpp"
+#include "utils/types.hpp"
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <zlib.h>
+
+/** The information stored at the beginning of a replay file, which is
+ *  all that is needed to list a replay in the ghost replay selection.
+ *  \ingroup replay
+ */
+struct ReplayStreamHeader
+{
+    std::vector<std::string> m_kart_list;
+    bool                     m_reverse;
+    unsigned int             m_difficulty;
+    std::string              m_track_name;
+    unsigned int             m_laps;
+    float                    m_min_time;
+};   // ReplayStreamHeader
+
+// ============================================================================
+/** The quantized state of one replay event (without the time, which is
+ *  stored separately). Consecutive events are stored as difference to the
+ *  previous event.
+ *  \ingroup replay
+ */
+struct QuantizedReplayEvent
+{
+    int32_t m_xyz[3];
+    int32_t m_rotation[4];
+    int32_t m_speed;
+    int32_t m_steer;
+    int32_t m_suspension_length[4];
+    int32_t m_nitro_usage;
+    int32_t m_skidding_state;
+    uint8_t m_flags;
+};   // QuantizedReplayEvent
+
+// ============================================================================
+/** Writes a replay in the binary format. The file starts with a header
+ *  (see ReplayStreamHeader), followed by one section for each kart. Each
+ *  section contains the time of all events (which the GhostController
+ *  needs in advance), followed by the delta- and varint-encoded events,
+ *  which can optionally be compressed with zlib.
+ *  \ingroup replay
+ */
+class ReplayStreamWriter : public NoCopy
+{
+private:
+    /** The file to write to. */
+    FILE *m_file;
+
+    /** True if the event data is compressed. */
+    bool m_compress;
+
+public:
+         ReplayStreamWriter();
+        ~ReplayStreamWriter();
+    bool open(const std::string &filename, bool compress,
+              const ReplayStreamHeader &header);
+    bool addKart(const ReplayBase::TransformEvent *transform,
+                 const ReplayBase::PhysicInfo *physic_info,
+                 const ReplayBase::KartReplayEvent *kart_replay_event,
+                 unsigned int num_events);
+    bool close();
+};   // ReplayStreamWriter
+
+// ============================================================================
+/** Reads the events of one kart from a binary replay file. The events are
+ *  decoded (and decompressed) on demand, so only a small buffer is kept in
+ *  memory independent of the length of the replay.
+ *  \ingroup replay
+ */
+class ReplayStreamReader : public NoCopy
+{
+private:
+    /** The replay file. */
+    FILE *m_file;
+
+    /** Offset of the (compressed) event data in the file. */
+    long m_data_offset;
+
+    /** Size of the (compressed) event data in the file. */
+    unsigned int m_data_size;
+
+    /** Number of bytes of the event data read from the file. */
+    unsigned int m_data_read;
+
+    /** True if the event data is compressed. */
+    bool m_compressed;
+
+    /** True if m_zstream was initialised. */
+    bool m_zstream_initialised;
+
+    /** The zlib stream state. */
+    z_stream m_zstream;
+
+    /** Buffer for data read from the file (only used for compressed data). */
+    std::vector<uint8_t> m_input;
+
+    /** Buffer with uncompressed event data. */
+    std::vector<uint8_t> m_buffer;
+
+    /** Index of the next byte to decode in m_buffer. */
+    unsigned int m_buffer_pos;
+
+    /** Number of valid bytes in m_buffer. */
+    unsigned int m_buffer_end;
+
+    /** The time of all events. */
+    std::vector<float> m_times;
+
+    /** Number of events already read. */
+    unsigned int m_events_read;
+
+    /** The previous event, used to decode the next delta. */
+    QuantizedReplayEvent m_previous;
+
+    bool fillBuffer();
+    void closeStream();
+    bool startStream();
+
+public:
+         ReplayStreamReader();
+        ~ReplayStreamReader();
+    bool open(const std::string &filename, unsigned int kart);
+    bool readEvent(ReplayBase::TransformEvent *transform,
+                   ReplayBase::PhysicInfo *physic_info,
+                   ReplayBase::KartReplayEvent *kart_replay_event);
+    bool rewind();
+
+    static bool isBinaryReplay(const std::string &filename);
+    static bool readHeader(FILE *file, ReplayStreamHeader *header,
+                           bool *compressed = NULL);
+    static bool readTextHeader(FILE *file, ReplayStreamHeader *header);
+    static bool convertTextReplay(const std::string &text_file,
+                                  const std::string &binary_file);
+    static void unitTesting();
+
+    // ------------------------------------------------------------------------
+    /** Returns the time of all events of this kart. */
+    const std::vector<float>& getTimes() const { return m_times; }
+    // ------------------------------------------------------------------------
+    /** Returns the number of events of this kart. */
+    unsigned int getNumEvents() const { return (unsigned int)m_times.size(); }
+};   // ReplayStreamReader
+
+#endif
@@ -22,6 +22,7 @@
 #include "font/digit_face.hpp"
 #include "font/font_manager.hpp"
 #include "graphics/central_settings.hpp"
+#include "graphics/irr_driver.hpp"
 #include "graphics/stk_text_billboard.hpp"
 #include "guiengine/scalable_font.hpp"
 #include "input/device_manager.hpp"
@@ -95,6 +96,7 @@ namespace Scripting
 
             core::vector3df xyz(location->getX(), location->getY(), location->getZ());
 
+#ifndef SERVER_ONLY
             if (CVS->isGLSL())
             {
                 STKTextBillboard* tb = new STKTextBillboard(wtext.c_str(), digit_face,
@@ -107,6 +109,7 @@ namespace Scripting
                 World::getWorld()->getTrack()->addNode(tb);
             }
             else
+#endif   // !SERVER_ONLY
             {
                 assert(GUIEngine::getHighresDigitFont() != NULL);
                 scene::ISceneManager* sm = irr_driver->getSceneManager();
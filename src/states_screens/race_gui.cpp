@@ -349,7 +349,9 @@ void RaceGUI::drawGlobalMiniMap()
         return;
 
     const video::ITexture *old_rtt_mini_map = world->getTrack()->getOldRttMiniMap();
+#ifndef SERVER_ONLY
     const FrameBuffer* new_rtt_mini_map = world->getTrack()->getNewRttMiniMap();
+#endif
 
     int upper_y = irr_driver->getActualScreenSize().Height - m_map_bottom - m_map_height;
     int lower_y = irr_driver->getActualScreenSize().Height - m_map_bottom;
@@ -364,6 +366,7 @@ void RaceGUI::drawGlobalMiniMap()
         draw2DImage(old_rtt_mini_map, dest, source,
                     NULL, NULL, true);
     }
+#ifndef SERVER_ONLY
     else if (new_rtt_mini_map != NULL)
     {
         core::rect<s32> source(0, 0, (int)new_rtt_mini_map->getWidth(),
@@ -372,6 +375,7 @@ void RaceGUI::drawGlobalMiniMap()
             new_rtt_mini_map->getWidth(), new_rtt_mini_map->getHeight(),
             dest, source, NULL, video::SColor(127, 255, 255, 255), true);
     }
+#endif
 
     for(unsigned int i=0; i<world->getNumKarts(); i++)
     {
@@ -321,7 +321,9 @@ void RaceGUIOverworld::drawGlobalMiniMap()
 
 
     const video::ITexture *old_rtt_mini_map = world->getTrack()->getOldRttMiniMap();
+#ifndef SERVER_ONLY
     const FrameBuffer* new_rtt_mini_map = world->getTrack()->getNewRttMiniMap();
+#endif
 
     int upper_y = m_map_bottom - m_map_height;
     int lower_y = m_map_bottom;
@@ -334,6 +336,7 @@ void RaceGUIOverworld::drawGlobalMiniMap()
         core::rect<s32> source(core::position2di(0, 0), old_rtt_mini_map->getSize());
         draw2DImage(old_rtt_mini_map, dest, source, 0, 0, true);
     }
+#ifndef SERVER_ONLY
     else if (new_rtt_mini_map != NULL)
     {
         core::rect<s32> source(0, 0, (int)new_rtt_mini_map->getWidth(),
@@ -342,6 +345,7 @@ void RaceGUIOverworld::drawGlobalMiniMap()
             new_rtt_mini_map->getWidth(), new_rtt_mini_map->getHeight(),
             dest, source, NULL, video::SColor(127, 255, 255, 255), true);
     }
+#endif
 
     Vec3 kart_xyz;
 
@@ -26,24 +26,35 @@
 #include "tracks/track.hpp"
 #include "tracks/track_manager.hpp"
 #include "utils/log.hpp"
+#include "utils/string_utils.hpp"
+#include "utils/time.hpp"
 
 #include <algorithm>
 #include <queue>
+#include <stdio.h>
+#include <string.h>
 
 // -----------------------------------------------------------------------------
 ArenaGraph::ArenaGraph(const std::string &navmesh, const XMLNode *node)
           : Graph()
 {
     loadNavmesh(navmesh);
-    buildGraph();
-    // Compute shortest distance from all nodes
-    for (unsigned int i = 0; i < getNumNodes(); i++)
-        computeDijkstra(i);
+    // The shortest paths only depend on the navmesh, so they are computed
+    // once and then loaded from the cache.
+    if (!loadPathCache(navmesh))
+    {
+        buildGraph();
+        // Compute shortest distance from all nodes
+        for (unsigned int i = 0; i < getNumNodes(); i++)
+            computeDijkstra(i);
+        savePathCache(navmesh);
+    }
 
     setNearbyNodesOfAllNodes();
     if (node && race_manager->getMinorMode() == RaceManager::MINOR_MODE_SOCCER)
         loadGoalNodes(node);
 
+    buildNodeGrid();
     loadBoundingBoxNodes();
 
 }   // ArenaGraph
@@ -167,8 +178,8 @@ void ArenaGraph::buildGraph()
 {
     const unsigned int n_nodes = getNumNodes();
 
-    m_distance_matrix = std::vector<std::vector<float>>
-        (n_nodes, std::vector<float>(n_nodes, 9999.9f));
+    m_distance_matrix.clear();
+    m_distance_matrix.resize(n_nodes * n_nodes, 9999.9f);
     for (unsigned int i = 0; i < n_nodes; i++)
     {
         ArenaNode* cur_node = getNode(i);
@@ -176,22 +187,22 @@ void ArenaGraph::buildGraph()
         {
             Vec3 diff = getNode(adjacent)->getCenter() - cur_node->getCenter();
             float distance = diff.length();
-            m_distance_matrix[i][adjacent] = distance;
+            m_distance_matrix[getIndex(i, adjacent)] = distance;
         }
-        m_distance_matrix[i][i] = 0.0f;
+        m_distance_matrix[getIndex(i, i)] = 0.0f;
     }
 
     // Allocate and initialise the previous node data structure:
-    m_parent_node = std::vector<std::vector<int16_t>>
-        (n_nodes, std::vector<int16_t>(n_nodes, Graph::UNKNOWN_SECTOR));
+    m_parent_node.clear();
+    m_parent_node.resize(n_nodes * n_nodes, Graph::UNKNOWN_SECTOR);
     for (unsigned int i = 0; i < n_nodes; i++)
     {
         for (unsigned int j = 0; j < n_nodes; j++)
         {
-            if (i == j || m_distance_matrix[i][j] >= 9899.9f)
-                m_parent_node[i][j] = -1;
+            if (i == j || m_distance_matrix[getIndex(i, j)] >= 9899.9f)
+                m_parent_node[getIndex(i, j)] = -1;
             else
-                m_parent_node[i][j] = i;
+                m_parent_node[getIndex(i, j)] = i;
         }   // for j
     }   // for i
 
@@ -225,6 +236,8 @@ void ArenaGraph::computeDijkstra(int source)
     const unsigned int n = getNumNodes();
     std::vector<bool> visited;
     visited.resize(n, false);
+    float   *source_distance = &m_distance_matrix[getIndex(source, 0)];
+    int16_t *source_parent   = &m_parent_node[getIndex(source, 0)];
     while (!queue.empty())
     {
         // Get element with shortest path
@@ -239,12 +252,12 @@ void ArenaGraph::computeDijkstra(int source)
             // Distance already computed, can be ignored
             if (visited[adjacent]) continue;
 
-            float new_dist =
-                current.second + m_distance_matrix[cur_index][adjacent];
-            if (new_dist < m_distance_matrix[source][adjacent])
+            float new_dist = current.second +
+                m_distance_matrix[getIndex(cur_index, adjacent)];
+            if (new_dist < source_distance[adjacent])
             {
-                m_distance_matrix[source][adjacent] = new_dist;
-                m_parent_node[source][adjacent] = cur_index;
+                source_distance[adjacent] = new_dist;
+                source_parent[adjacent] = cur_index;
             }
             IndDistPair pair(adjacent, new_dist);
             queue.push(pair);
@@ -272,12 +285,13 @@ void ArenaGraph::computeFloydWarshall()
         {
             for (unsigned int j = 0; j < n; j++)
             {
-                if ((m_distance_matrix[i][k] + m_distance_matrix[k][j]) <
-                    m_distance_matrix[i][j])
+                const float d = m_distance_matrix[getIndex(i, k)] +
+                                m_distance_matrix[getIndex(k, j)];
+                if (d < m_distance_matrix[getIndex(i, j)])
                 {
-                    m_distance_matrix[i][j] =
-                        m_distance_matrix[i][k] + m_distance_matrix[k][j];
-                    m_parent_node[i][j] = m_parent_node[k][j];
+                    m_distance_matrix[getIndex(i, j)] = d;
+                    m_parent_node[getIndex(i, j)] =
+                        m_parent_node[getIndex(k, j)];
                 }
             }
         }
@@ -285,6 +299,134 @@ void ArenaGraph::computeFloydWarshall()
 
 }   // computeFloydWarshall
 
+// ----------------------------------------------------------------------------
+/** Returns the name of the file in which the shortest paths for a navmesh
+ *  are cached. The name contains a hash of the navmesh file, so a modified
+ *  navmesh will not use outdated data.
+ *  \param navmesh Full path of the navmesh file.
+ *  \param hash On return the hash of the navmesh file.
+ *  \return The file name, or "" if the navmesh could not be read.
+ */
+std::string ArenaGraph::getCacheFileName(const std::string &navmesh,
+                                         uint64_t *hash) const
+{
+    if (!file_manager->getFileHash(navmesh, hash))
+        return "";
+    // Use the name of the track directory to make the files easier to
+    // identify.
+    std::string track = StringUtils::getPath(navmesh);
+    if (StringUtils::hasSuffix(track, "/"))
+        track = track.substr(0, track.size() - 1);
+    track = StringUtils::getBasename(track);
+    char hex[17];
+    sprintf(hex, "%08x%08x", (unsigned int)(*hash >> 32),
+            (unsigned int)(*hash & 0xffffffff));
+    return file_manager->getCachedDataDir() + "navmesh-" + track + "-" +
+           hex + ".bin";
+}   // getCacheFileName
+
+// ----------------------------------------------------------------------------
+/** Header of the file in which the shortest paths are cached. It is followed
+ *  by the distance matrix and the parent node matrix.
+ */
+struct ArenaPathCacheHeader
+{
+    char     m_magic[8];
+    uint32_t m_version;
+    uint32_t m_num_nodes;
+    uint64_t m_hash;
+};   // ArenaPathCacheHeader
+
+static const char     ARENA_PATH_CACHE_MAGIC[8] = "STKPATH";
+static const uint32_t ARENA_PATH_CACHE_VERSION  = 1;
+
+// ----------------------------------------------------------------------------
+/** Loads the shortest paths of this navmesh from the cache.
+ *  \param navmesh Full path of the navmesh file.
+ *  \return True if up to date data was found and loaded.
+ */
+bool ArenaGraph::loadPathCache(const std::string &navmesh)
+{
+    uint64_t hash;
+    std::string name = getCacheFileName(navmesh, &hash);
+    if (name.empty())
+        return false;
+
+    FILE *file = fopen(name.c_str(), "rb");
+    if (!file)
+        return false;
+
+    const unsigned int n = getNumNodes();
+    ArenaPathCacheHeader header;
+    bool ok = fread(&header, sizeof(header), 1, file) == 1           &&
+              memcmp(header.m_magic, ARENA_PATH_CACHE_MAGIC, 8) == 0 &&
+              header.m_version == ARENA_PATH_CACHE_VERSION           &&
+              header.m_num_nodes == n && header.m_hash == hash;
+    if (ok)
+    {
+        m_distance_matrix.resize(n * n);
+        m_parent_node.resize(n * n);
+        ok = fread(m_distance_matrix.data(), sizeof(float), n * n, file)
+                == n * n &&
+             fread(m_parent_node.data(), sizeof(int16_t), n * n, file)
+                == n * n;
+    }
+    fclose(file);
+
+    if (!ok)
+    {
+        Log::warn("ArenaGraph", "Ignoring invalid path cache '%s'.",
+                  name.c_str());
+        m_distance_matrix.clear();
+        m_parent_node.clear();
+        return false;
+    }
+    Log::debug("ArenaGraph", "Loaded shortest paths from '%s'.",
+               name.c_str());
+    return true;
+}   // loadPathCache
+
+// ----------------------------------------------------------------------------
+/** Saves the shortest paths of this navmesh in the cache.
+ *  \param navmesh Full path of the navmesh file.
+ */
+void ArenaGraph::savePathCache(const std::string &navmesh) const
+{
+    ArenaPathCacheHeader header;
+    std::string name = getCacheFileName(navmesh, &header.m_hash);
+    if (name.empty())
+        return;
+
+    // Write to a temporary file first, so that an interrupted write can
+    // not leave an incomplete cache file behind.
+    std::string tmp_name = name + ".tmp";
+    FILE *file = fopen(tmp_name.c_str(), "wb");
+    if (!file)
+    {
+        Log::warn("ArenaGraph", "Can not write path cache '%s'.",
+                  tmp_name.c_str());
+        return;
+    }
+    const unsigned int n = getNumNodes();
+    memcpy(header.m_magic, ARENA_PATH_CACHE_MAGIC, 8);
+    header.m_version   = ARENA_PATH_CACHE_VERSION;
+    header.m_num_nodes = n;
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+              fwrite(m_distance_matrix.data(), sizeof(float), n * n, file)
+                 == n * n &&
+              fwrite(m_parent_node.data(), sizeof(int16_t), n * n, file)
+                 == n * n;
+    ok = fclose(file) == 0 && ok;
+
+    file_manager->removeFile(name);
+    if (!ok || rename(tmp_name.c_str(), name.c_str()) != 0)
+    {
+        Log::warn("ArenaGraph", "Can not write path cache '%s'.",
+                  name.c_str());
+        file_manager->removeFile(tmp_name);
+    }
+}   // savePathCache
+
 // -----------------------------------------------------------------------------
 void ArenaGraph::loadGoalNodes(const XMLNode *node)
 {
@@ -329,7 +471,8 @@ void ArenaGraph::setNearbyNodesOfAllNodes()
         // Get the distance to all nodes at i
         ArenaNode* cur_node = getNode(i);
         std::vector<int> nearby_nodes;
-        std::vector<float> dist = m_distance_matrix[i];
+        std::vector<float> dist(m_distance_matrix.begin() + getIndex(i, 0),
+            m_distance_matrix.begin() + getIndex(i + 1, 0));
 
         // Skip the same node
         dist[i] = 999999.0f;
@@ -351,13 +494,13 @@ void ArenaGraph::setNearbyNodesOfAllNodes()
  *  std::vector (in reverse order). Used only for unit testing.
  */
 std::vector<int16_t> ArenaGraph::getPathFromTo(int from, int to,
-                      const std::vector< std::vector< int16_t > >& parent_node)
+                              const std::vector<int16_t>& parent_node) const
 {
     std::vector<int16_t> path;
     path.push_back(to);
     while(from!=to)
     {
-        to = parent_node[from][to];
+        to = parent_node[getIndex(from, to)];
         path.push_back(to);
     }
     return path;
@@ -380,9 +523,19 @@ void ArenaGraph::unitTesting()
     double e = StkTime::getRealTime();
     Log::error("Time", "Dijkstra       %lf", e-s);
 
-    // Save the Dijkstra results
-    std::vector< std::vector< float > > distance_matrix = ag->m_distance_matrix;
-    std::vector< std::vector< int16_t > > parent_node = ag->m_parent_node;
+    // Save the Dijkstra results (which might come from the path cache)
+    std::vector<float> distance_matrix = ag->m_distance_matrix;
+    std::vector<int16_t> parent_node = ag->m_parent_node;
+
+    // Make sure that the cached data is identical to newly computed data
+    ag->buildGraph();
+    for (unsigned int i = 0; i < ag->getNumNodes(); i++)
+        ag->computeDijkstra(i);
+    if (ag->m_distance_matrix != distance_matrix ||
+        ag->m_parent_node != parent_node)
+    {
+        Log::error("ArenaGraph", "Cached paths differ from computed paths.");
+    }
     ag->buildGraph();
 
     // Now compute results with Floyd-Warshall
@@ -392,15 +545,17 @@ void ArenaGraph::unitTesting()
     Log::error("Time", "Floyd-Warshall %lf", e-s);
 
     int error_count = 0;
-    for(unsigned int i=0; i<ag->m_distance_matrix.size(); i++)
+    const unsigned int n = ag->getNumNodes();
+    for(unsigned int i=0; i<n; i++)
     {
-        for(unsigned int j=0; j<ag->m_distance_matrix[i].size(); j++)
+        for(unsigned int j=0; j<n; j++)
         {
-            if(ag->m_distance_matrix[i][j] - distance_matrix[i][j] > 0.001f)
+            const unsigned int ij = ag->getIndex(i, j);
+            if(ag->m_distance_matrix[ij] - distance_matrix[ij] > 0.001f)
             {
                 Log::error("ArenaGraph",
                            "Incorrect distance %d, %d: Dijkstra: %f F.W.: %f",
-                           i, j, distance_matrix[i][j], ag->m_distance_matrix[i][j]);
+                           i, j, distance_matrix[ij], ag->m_distance_matrix[ij]);
                 error_count++;
             }    // if distance is too different
 
@@ -412,16 +567,16 @@ void ArenaGraph::unitTesting()
             // debugging in the feature
 #undef TEST_PARENT_POLY_EVEN_THOUGH_MANY_FALSE_POSITIVES
 #ifdef TEST_PARENT_POLY_EVEN_THOUGH_MANY_FALSE_POSITIVES
-            if(ag->m_parent_node[i][j] != parent_node[i][j])
+            if(ag->m_parent_node[ij] != parent_node[ij])
             {
                 error_count++;
-                std::vector<int16_t> dijkstra_path = getPathFromTo(i, j, parent_node);
-                std::vector<int16_t> floyd_path = getPathFromTo(i, j, ag->m_parent_node);
+                std::vector<int16_t> dijkstra_path = ag->getPathFromTo(i, j, parent_node);
+                std::vector<int16_t> floyd_path = ag->getPathFromTo(i, j, ag->m_parent_node);
                 if(dijkstra_path.size()!=floyd_path.size())
                 {
                     Log::error("ArenaGraph",
                                "Incorrect path length %d, %d: Dijkstra: %d F.W.: %d",
-                               i, j, parent_node[i][j], ag->m_parent_node[i][j]);
+                               i, j, parent_node[ij], ag->m_parent_node[ij]);
                     continue;
                 }
                 Log::error("ArenaGraph", "Path problems from %d to %d:",
@@ -21,6 +21,7 @@
 
 #include "tracks/graph.hpp"
 #include "utils/cpp2011.hpp"
+#include "utils/types.hpp"
 
 #include <set>
 
@@ -34,11 +35,13 @@ class XMLNode;
 class ArenaGraph : public Graph
 {
 private:
-    /** The actual graph data structure, it is an adjacency matrix. */
-    std::vector<std::vector<float>> m_distance_matrix;
+    /** The actual graph data structure, it is an adjacency matrix. It is
+     *  stored row by row in one array, use getIndex() to access it. */
+    std::vector<float> m_distance_matrix;
 
-    /** The matrix that is used to store computed shortest paths. */
-    std::vector<std::vector<int16_t>> m_parent_node;
+    /** The matrix that is used to store computed shortest paths, stored
+     *  the same way as m_distance_matrix. */
+    std::vector<int16_t> m_parent_node;
 
     /** Used in soccer mode to colorize the goal lines in minimap. */
     std::set<int> m_red_node;
@@ -58,8 +61,22 @@ private:
     // ------------------------------------------------------------------------
     void computeFloydWarshall();
     // ------------------------------------------------------------------------
-    static std::vector<int16_t> getPathFromTo(int from, int to,
-                     const std::vector< std::vector< int16_t > >& parent_node);
+    std::string getCacheFileName(const std::string &navmesh,
+                                 uint64_t *hash) const;
+    // ------------------------------------------------------------------------
+    bool loadPathCache(const std::string &navmesh);
+    // ------------------------------------------------------------------------
+    void savePathCache(const std::string &navmesh) const;
+    // ------------------------------------------------------------------------
+    std::vector<int16_t> getPathFromTo(int from, int to,
+                            const std::vector<int16_t>& parent_node) const;
+    // ------------------------------------------------------------------------
+    /** Returns the index of the entry for the path from i to j in
+     *  m_distance_matrix and m_parent_node. */
+    unsigned int getIndex(int i, int j) const
+    {
+        return (unsigned int)i * getNumNodes() + j;
+    }   // getIndex
     // ------------------------------------------------------------------------
     virtual bool hasLapLine() const OVERRIDE                  { return false; }
     // ------------------------------------------------------------------------
@@ -84,7 +101,7 @@ public:
     {
         if (i == Graph::UNKNOWN_SECTOR || j == Graph::UNKNOWN_SECTOR)
             return Graph::UNKNOWN_SECTOR;
-        return (int)(m_parent_node[j][i]);
+        return (int)(m_parent_node[getIndex(j, i)]);
     }
     // ------------------------------------------------------------------------
     /** Returns the distance between any two nodes */
@@ -92,7 +109,7 @@ public:
     {
         if (from == Graph::UNKNOWN_SECTOR || to == Graph::UNKNOWN_SECTOR)
             return 99999.0f;
-        return m_distance_matrix[from][to];
+        return m_distance_matrix[getIndex(from, to)];
     }
 
 };   // ArenaGraph
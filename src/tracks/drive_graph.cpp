@@ -240,6 +240,7 @@ void DriveGraph::load(const std::string &quad_file_name,
             m_lap_length = l;
     }
 
+    buildNodeGrid();
     loadBoundingBoxNodes();
 
 }   // load
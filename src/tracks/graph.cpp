@@ -33,6 +33,9 @@
 #include "tracks/drive_node_2d.hpp"
 #include "tracks/drive_node_3d.hpp"
 #include "utils/log.hpp"
+#include "utils/time.hpp"
+
+#include <algorithm>
 
 const int Graph::UNKNOWN_SECTOR = -1;
 Graph *Graph::m_graph = NULL;
@@ -47,16 +50,23 @@ Graph::Graph()
     m_bb_min      = Vec3( 99999,  99999,  99999);
     m_bb_max      = Vec3(-99999, -99999, -99999);
     memset(m_bb_nodes, 0, 4 * sizeof(int));
+    m_grid_min_x     = 0;
+    m_grid_min_z     = 0;
+    m_grid_cell_size = 1.0f;
+    m_grid_width     = 0;
+    m_grid_height    = 0;
 }  // Graph
 
 // -----------------------------------------------------------------------------
 Graph::~Graph()
 {
+#ifndef SERVER_ONLY
     if (m_new_rtt != NULL)
     {
         delete m_new_rtt;
         m_new_rtt = NULL;
     }
+#endif
 
     if (UserConfigParams::m_track_debug)
         cleanupDebugMesh();
@@ -260,14 +270,18 @@ void Graph::makeMiniMap(const core::dimension2du &dimension,
     *oldRttMinimap = NULL;
     *newRttMinimap = NULL;
 
+#ifndef SERVER_ONLY
     RTT* newRttProvider = NULL;
+#endif
     IrrDriver::RTTProvider* oldRttProvider = NULL;
+#ifndef SERVER_ONLY
     if (CVS->isGLSL())
     {
         m_new_rtt = newRttProvider =
             new RTT(dimension.Width, dimension.Height);
     }
     else
+#endif   // !SERVER_ONLY
     {
         oldRttProvider = new IrrDriver::RTTProvider(dimension, name, true);
     }
@@ -350,12 +364,14 @@ void Graph::makeMiniMap(const core::dimension2du &dimension,
     video::ITexture* texture = NULL;
     FrameBuffer* frame_buffer = NULL;
 
+#ifndef SERVER_ONLY
     if (CVS->isGLSL())
     {
         frame_buffer = newRttProvider->render(camera,
             GUIEngine::getLatestDt());
     }
     else
+#endif   // !SERVER_ONLY
     {
         texture = oldRttProvider->renderToTexture();
         delete oldRttProvider;
@@ -376,7 +392,9 @@ void Graph::makeMiniMap(const core::dimension2du &dimension,
     World::getWorld()->forceFogDisabled(false);
 
     irr_driver->getSceneManager()->clear();
+#ifndef SERVER_ONLY
     VAOManager::kill();
+#endif
     irr_driver->clearGlowingNodes();
     irr_driver->clearLights();
     irr_driver->clearForcedBloom();
@@ -476,6 +494,15 @@ void Graph::findRoadSector(const Vec3& xyz, int *sector,
         return;
     }   // if still on same quad
 
+    // Unless only a limited list of sectors is to be tested, use the grid
+    // to only test the nodes close to xyz.
+    if (!m_node_grid.empty() &&
+        (*sector == UNKNOWN_SECTOR || all_sectors == NULL))
+    {
+        *sector = findRoadSectorInGrid(xyz, *sector + 1, ignore_vertical);
+        return;
+    }
+
     // Now we search through all quads, starting with
     // the current one
     int indx       = *sector;
@@ -558,6 +585,8 @@ int Graph::findOutOfRoadSector(const Vec3& xyz, const int curr_sector,
         // bottleneck, we need to set up a graph of 'next' quads for each
         // quad (similar to what the AI does), and only test the quads
         // in this graph.
+        // This is now done using m_node_grid (if available), which keeps
+        // the result of testing all quads in this order.
         const int LIMIT = getNumNodes();
         count           = LIMIT;
         // Start 10 quads before the current quad, so the quads closest
@@ -566,6 +595,22 @@ int Graph::findOutOfRoadSector(const Vec3& xyz, const int curr_sector,
         if(current_sector<0) current_sector += getNumNodes();
     }
 
+    if (!all_sectors && !m_node_grid.empty())
+    {
+        int start = current_sector + 1 == (int)getNumNodes()
+                  ? 0 : current_sector + 1;
+        int sector = findClosestNodeInGrid(xyz, start, /*height_test*/true,
+                                           ignore_vertical);
+        if (sector == UNKNOWN_SECTOR)
+        {
+            sector = findClosestNodeInGrid(xyz, start, /*height_test*/false,
+                                           ignore_vertical);
+        }
+        if (sector == UNKNOWN_SECTOR)
+            Log::info("Graph", "unknown sector found.");
+        return sector;
+    }
+
     int   min_sector = UNKNOWN_SECTOR;
     float min_dist_2 = 999999.0f*999999.0f;
 
@@ -593,20 +638,11 @@ int Graph::findOutOfRoadSector(const Vec3& xyz, const int curr_sector,
                 // quad.
                 float dist_2 =
                     m_all_nodes[next_sector]->getDistance2FromPoint(xyz);
-                if (dist_2 < min_dist_2)
+                if (dist_2 < min_dist_2 &&
+                    isCloseEnough(q, xyz, phase == 0, ignore_vertical))
                 {
-                    float dist = xyz.getY() - q->getMinHeight();
-                    // While negative distances are unlikely, we allow some small
-                    // negative numbers in case that the kart is partly in the
-                    // track. Only do the height test in phase==0, in phase==1
-                    // accept any point, independent of height, or this node is 3d
-                    // which already takes height into account
-                    if (phase == 1 || (dist < 5.0f && dist>-1.0f) ||
-                        q->is3DQuad() || ignore_vertical)
-                    {
-                        min_dist_2 = dist_2;
-                        min_sector = next_sector;
-                    }
+                    min_dist_2 = dist_2;
+                    min_sector = next_sector;
                 }
             }
             current_sector = next_sector;
@@ -623,6 +659,292 @@ int Graph::findOutOfRoadSector(const Vec3& xyz, const int curr_sector,
     return min_sector;
 }   // findOutOfRoadSector
 
+//-----------------------------------------------------------------------------
+/** Tests if a node can be accepted by findOutOfRoadSector.
+ *  \param q The node to test.
+ *  \param xyz The point for which the sector is searched.
+ *  \param height_test If the vertical distance should be tested.
+ *  \param ignore_vertical Ignore the height test in any case.
+ */
+bool Graph::isCloseEnough(const Quad *q, const Vec3 &xyz, bool height_test,
+                          bool ignore_vertical) const
+{
+    // While negative distances are unlikely, we allow some small
+    // negative numbers in case that the kart is partly in the
+    // track. Only do the height test if height_test is set, otherwise
+    // accept any point, independent of height, or if this node is 3d
+    // which already takes height into account
+    const float dist = xyz.getY() - q->getMinHeight();
+    return !height_test || (dist < 5.0f && dist > -1.0f) ||
+           q->is3DQuad() || ignore_vertical;
+}   // isCloseEnough
+
+//-----------------------------------------------------------------------------
+/** Builds the grid used to speed up findRoadSector and findOutOfRoadSector.
+ *  This must be called once all nodes are created. The size of the cells is
+ *  chosen so that there are about as many cells as nodes.
+ */
+void Graph::buildNodeGrid()
+{
+    m_node_grid.clear();
+    const unsigned int n = getNumNodes();
+    if (n == 0) return;
+
+    // Bounding box of each node, enlarged by the height tolerance used in
+    // pointInside of 3d nodes (5 units along the normal).
+    std::vector<Vec3> node_min(n), node_max(n);
+    Vec3 grid_min( 999999.0f,  999999.0f,  999999.0f);
+    Vec3 grid_max(-999999.0f, -999999.0f, -999999.0f);
+    for (unsigned int i = 0; i < n; i++)
+    {
+        const Quad *q = m_all_nodes[i];
+        const Vec3 extend = q->getNormal() * 5.0f;
+        node_min[i] = node_max[i] = (*q)[0];
+        for (unsigned int j = 0; j < 4; j++)
+        {
+            node_min[i].min((*q)[j] + extend);
+            node_min[i].min((*q)[j] - extend);
+            node_max[i].max((*q)[j] + extend);
+            node_max[i].max((*q)[j] - extend);
+        }
+        grid_min.min(node_min[i]);
+        grid_max.max(node_max[i]);
+    }
+
+    const float size_x = grid_max.getX() - grid_min.getX();
+    const float size_z = grid_max.getZ() - grid_min.getZ();
+    m_grid_cell_size = sqrtf(size_x*size_z / n);
+    if (m_grid_cell_size < 2.0f)  m_grid_cell_size = 2.0f;
+    if (m_grid_cell_size > 50.0f) m_grid_cell_size = 50.0f;
+    m_grid_min_x  = grid_min.getX();
+    m_grid_min_z  = grid_min.getZ();
+    m_grid_width  = (int)(size_x / m_grid_cell_size) + 1;
+    m_grid_height = (int)(size_z / m_grid_cell_size) + 1;
+    // Avoid huge grids for degenerated tracks
+    while ((float)m_grid_width * m_grid_height > 16.0f * n + 64.0f)
+    {
+        m_grid_cell_size *= 2.0f;
+        m_grid_width  = (int)(size_x / m_grid_cell_size) + 1;
+        m_grid_height = (int)(size_z / m_grid_cell_size) + 1;
+    }
+
+    m_node_grid.resize(m_grid_width * m_grid_height);
+    for (unsigned int i = 0; i < n; i++)
+    {
+        const int x0 = (int)((node_min[i].getX()-m_grid_min_x)/m_grid_cell_size);
+        const int x1 = (int)((node_max[i].getX()-m_grid_min_x)/m_grid_cell_size);
+        const int z0 = (int)((node_min[i].getZ()-m_grid_min_z)/m_grid_cell_size);
+        const int z1 = (int)((node_max[i].getZ()-m_grid_min_z)/m_grid_cell_size);
+        for (int z = z0; z <= z1 && z < m_grid_height; z++)
+        {
+            for (int x = x0; x <= x1 && x < m_grid_width; x++)
+                m_node_grid[z*m_grid_width + x].push_back(i);
+        }
+    }
+    Log::verbose("Graph", "Node grid with %dx%d cells of size %f.",
+                 m_grid_width, m_grid_height, m_grid_cell_size);
+
+    if (UserConfigParams::m_graph_benchmark)
+        benchmarkSectorLookup();
+}   // buildNodeGrid
+
+//-----------------------------------------------------------------------------
+/** Finds the node that contains xyz using the grid. If several nodes
+ *  contain the point, the one that comes first when testing all nodes
+ *  in order starting at 'start' (wrapping around) is returned, so the
+ *  result is the same as the one of the linear search in findRoadSector.
+ *  \param xyz The point to test.
+ *  \param start Index of the first node in the search order.
+ *  \param ignore_vertical If the height test of pointInside is ignored.
+ */
+int Graph::findRoadSectorInGrid(const Vec3 &xyz, int start,
+                                bool ignore_vertical) const
+{
+    const int n = (int)getNumNodes();
+    const float fx = (xyz.getX() - m_grid_min_x) / m_grid_cell_size;
+    const float fz = (xyz.getZ() - m_grid_min_z) / m_grid_cell_size;
+    if (fx < 0 || fz < 0 || fx >= m_grid_width || fz >= m_grid_height)
+        return UNKNOWN_SECTOR;
+
+    const std::vector<int> &cell =
+        m_node_grid[(int)fz * m_grid_width + (int)fx];
+    int best       = UNKNOWN_SECTOR;
+    int best_order = n;
+    for (unsigned int i = 0; i < cell.size(); i++)
+    {
+        const int order = (cell[i] - start + n) % n;
+        if (order < best_order &&
+            getQuad(cell[i])->pointInside(xyz, ignore_vertical))
+        {
+            best       = cell[i];
+            best_order = order;
+        }
+    }
+    return best;
+}   // findRoadSectorInGrid
+
+//-----------------------------------------------------------------------------
+/** Finds the node closest to xyz (as defined by getDistance2FromPoint) using
+ *  the grid: the cells are searched in rings of increasing size around the
+ *  point, till no node outside of the searched area can be closer than the
+ *  best node found. Ties are resolved as in the linear search of
+ *  findOutOfRoadSector starting at 'start'.
+ *  \param xyz The point to test.
+ *  \param start Index of the first node in the search order.
+ *  \param height_test If nodes too far below or above xyz are ignored.
+ *  \param ignore_vertical Ignore the height test in any case.
+ */
+int Graph::findClosestNodeInGrid(const Vec3 &xyz, int start, bool height_test,
+                                 bool ignore_vertical) const
+{
+    const int n = (int)getNumNodes();
+    // Clamp the cell coordinates so that far away points (e.g. a kart
+    // falling off the track) can not overflow the integer coordinates.
+    const float fx =
+        irr::core::clamp((xyz.getX() - m_grid_min_x) / m_grid_cell_size,
+                         -100000.0f, 100000.0f);
+    const float fz =
+        irr::core::clamp((xyz.getZ() - m_grid_min_z) / m_grid_cell_size,
+                         -100000.0f, 100000.0f);
+    const int cx = (int)floorf(fx);
+    const int cz = (int)floorf(fz);
+
+    int   best       = UNKNOWN_SECTOR;
+    int   best_order = n;
+    float best_dist_2 = 999999.0f*999999.0f;
+
+    // Start with the first ring that overlaps the grid.
+    int r = std::max(std::max(-cx, cx - (m_grid_width - 1)),
+                     std::max(-cz, cz - (m_grid_height - 1)));
+    if (r < 0) r = 0;
+    while (true)
+    {
+        const int x0 = std::max(cx - r, 0);
+        const int x1 = std::min(cx + r, m_grid_width - 1);
+        const int z0 = std::max(cz - r, 0);
+        const int z1 = std::min(cz + r, m_grid_height - 1);
+        for (int z = z0; z <= z1; z++)
+        {
+            // Only the border of the ring needs to be tested, the inside
+            // was tested in the previous iterations.
+            const bool full_row = z == cz - r || z == cz + r;
+            for (int x = x0; x <= x1; x++)
+            {
+                if (!full_row && x != cx - r && x != cx + r)
+                {
+                    if (cx + r > x1) break;
+                    x = cx + r;
+                }
+                const std::vector<int> &cell = m_node_grid[z*m_grid_width+x];
+                for (unsigned int i = 0; i < cell.size(); i++)
+                {
+                    const Quad *q = getQuad(cell[i]);
+                    if (q->isIgnored()) continue;
+                    const float dist_2 = q->getDistance2FromPoint(xyz);
+                    if (dist_2 > best_dist_2) continue;
+                    const int order = (cell[i] - start + n) % n;
+                    if (dist_2 == best_dist_2 && order >= best_order)
+                        continue;
+                    if (!isCloseEnough(q, xyz, height_test, ignore_vertical))
+                        continue;
+                    best        = cell[i];
+                    best_order  = order;
+                    best_dist_2 = dist_2;
+                }
+            }   // for x
+        }   // for z
+
+        // Stop if all cells were tested
+        if (cx - r <= 0 && cx + r >= m_grid_width  - 1 &&
+            cz - r <= 0 && cz + r >= m_grid_height - 1)
+            break;
+
+        // Any node not found so far is outside of the tested area, so its
+        // (horizontal) distance is at least the distance of xyz to the
+        // border of this area.
+        float border = std::min(fx - (cx - r), (cx + r + 1) - fx);
+        border = std::min(border, std::min(fz - (cz - r), (cz + r + 1) - fz));
+        border *= m_grid_cell_size;
+        if (best != UNKNOWN_SECTOR && best_dist_2 < border*border)
+            break;
+        r++;
+    }   // while true
+
+    return best;
+}   // findClosestNodeInGrid
+
+//-----------------------------------------------------------------------------
+/** Compares the time used by findRoadSector and findOutOfRoadSector with
+ *  and without the node grid, and checks that both give the same result.
+ *  The points tested are the centers of all nodes, and random points in
+ *  and around the bounding box of the graph (which are mostly off-road).
+ *  This is called after loading a track if --benchmark-graph is used.
+ */
+void Graph::benchmarkSectorLookup()
+{
+    const int num_points = 5000;
+    std::vector<Vec3> points;
+    for (unsigned int i = 0; i < getNumNodes(); i++)
+        points.push_back(getQuad(i)->getCenter());
+    // Use a fixed sequence of pseudo random numbers, so that the results
+    // of different runs can be compared.
+    unsigned int random = 1234;
+    const Vec3 size = m_bb_max - m_bb_min;
+    for (int i = 0; i < num_points; i++)
+    {
+        float f[3];
+        for (unsigned int j = 0; j < 3; j++)
+        {
+            random = random * 1103515245 + 12345;
+            f[j] = ((random >> 16) % 1200) / 1000.0f - 0.1f;
+        }
+        points.push_back(m_bb_min + Vec3(size.getX()*f[0], size.getY()*f[1],
+                                         size.getZ()*f[2]));
+    }
+
+    std::vector<int> road[2], out_of_road[2];
+    double road_time[2], out_of_road_time[2];
+    std::vector<std::vector<int> > grid;
+    // Pass 0 uses the linear search (by temporarily removing the grid),
+    // pass 1 the grid.
+    for (int pass = 0; pass < 2; pass++)
+    {
+        grid.swap(m_node_grid);
+        double start = StkTime::getRealTime();
+        for (unsigned int i = 0; i < points.size(); i++)
+        {
+            int sector = UNKNOWN_SECTOR;
+            findRoadSector(points[i], &sector);
+            road[pass].push_back(sector);
+        }
+        road_time[pass] = StkTime::getRealTime() - start;
+
+        start = StkTime::getRealTime();
+        for (unsigned int i = 0; i < points.size(); i++)
+        {
+            int prev = road[pass][i] == UNKNOWN_SECTOR ? 0 : road[pass][i];
+            out_of_road[pass].push_back(findOutOfRoadSector(points[i], prev));
+        }
+        out_of_road_time[pass] = StkTime::getRealTime() - start;
+    }   // for pass
+
+    int differences = 0;
+    for (unsigned int i = 0; i < points.size(); i++)
+    {
+        if (road[0][i] != road[1][i] || out_of_road[0][i] != out_of_road[1][i])
+            differences++;
+    }
+    Log::info("Graph", "Sector lookup for %d nodes, %d points:",
+              getNumNodes(), (int)points.size());
+    Log::info("Graph", "  findRoadSector      linear %f ms grid %f ms",
+              road_time[0]*1000, road_time[1]*1000);
+    Log::info("Graph", "  findOutOfRoadSector linear %f ms grid %f ms",
+              out_of_road_time[0]*1000, out_of_road_time[1]*1000);
+    if (differences > 0)
+        Log::error("Graph", "  %d points with different results.",
+                   differences);
+}   // benchmarkSectorLookup
+
 //-----------------------------------------------------------------------------
 void Graph::loadBoundingBoxNodes()
 {
@@ -65,6 +65,8 @@ protected:
     // ------------------------------------------------------------------------
     /** Map 4 bounding box points to 4 closest graph nodes. */
     void loadBoundingBoxNodes();
+    // ------------------------------------------------------------------------
+    void buildNodeGrid();
 
 private:
     /** The 2d bounding box, used for hashing. */
@@ -88,6 +90,33 @@ private:
     /** Scaling for mini map. */
     float m_scaling;
 
+    /** A uniform grid over the XZ plane used to speed up findRoadSector
+     *  and findOutOfRoadSector: each cell contains the indices of all
+     *  nodes whose bounding box (enlarged by the height tolerance of
+     *  pointInside) overlaps the cell, i.e. the list of nodes that can
+     *  contain or be close to a point in that cell. It is empty till
+     *  buildNodeGrid is called, in which case all nodes are tested. */
+    std::vector<std::vector<int> > m_node_grid;
+
+    /** Minimum X and Z coordinate of the grid. */
+    float m_grid_min_x, m_grid_min_z;
+
+    /** Size of one grid cell. */
+    float m_grid_cell_size;
+
+    /** Number of grid cells in X and Z direction. */
+    int m_grid_width, m_grid_height;
+
+    // ------------------------------------------------------------------------
+    int  findRoadSectorInGrid(const Vec3 &xyz, int start,
+                              bool ignore_vertical) const;
+    // ------------------------------------------------------------------------
+    int  findClosestNodeInGrid(const Vec3 &xyz, int start, bool height_test,
+                               bool ignore_vertical) const;
+    // ------------------------------------------------------------------------
+    bool isCloseEnough(const Quad *q, const Vec3 &xyz, bool height_test,
+                       bool ignore_vertical) const;
+
     // ------------------------------------------------------------------------
     void createMesh(bool show_invisible=true,
                     bool enable_transparency=false,
@@ -161,6 +190,8 @@ public:
     const Vec3& getBBMax() const                           { return m_bb_max; }
     // ------------------------------------------------------------------------
     const int* getBBNodes() const                        { return m_bb_nodes; }
+    // ------------------------------------------------------------------------
+    void benchmarkSectorLookup();
 
 };   // Graph
 
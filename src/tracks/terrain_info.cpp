@@ -32,8 +32,10 @@
  */
 TerrainInfo::TerrainInfo()
 {
-    m_last_material = NULL;
-    m_material      = NULL;
+    m_last_material     = NULL;
+    m_material          = NULL;
+    m_has_prepared      = false;
+    m_prepared_material = NULL;
 }   // TerrainInfo
 
 //-----------------------------------------------------------------------------
@@ -45,6 +47,8 @@ TerrainInfo::TerrainInfo(const Vec3 &pos)
     // initialise HoT
     m_last_material = NULL;
     m_material = NULL;
+    m_has_prepared = false;
+    m_prepared_material = NULL;
     update(pos);
 }   // TerrainInfo
 
@@ -54,18 +58,61 @@ TerrainInfo::TerrainInfo(const Vec3 &pos)
  */
 void TerrainInfo::update(const Vec3 &from)
 {
+    m_has_prepared  = false;
     m_last_material = m_material;
-    btVector3 to(from);
+    Vec3 to(from);
     to.setY(-10000.0f);
 
+    castTerrainRay(from, to, /*interpolate*/false, &m_hit_point, &m_material,
+                   &m_normal);
+}   // update
+
+//-----------------------------------------------------------------------------
+/** Casts a ray against the track mesh and all driveable track objects, and
+ *  returns the data of the closest hit. This only reads the track data, so
+ *  it can be called from several threads at the same time.
+ *  \param from, to Start and end point of the ray.
+ *  \param interpolate_normal If the normal should be interpolated.
+ *  \param hit_point Returns the hit point (unchanged if nothing was hit).
+ *  \param material Returns the material hit, or NULL.
+ *  \param normal Returns the normal at the hit point.
+ */
+void TerrainInfo::castTerrainRay(const Vec3 &from, const Vec3 &to,
+                                 bool interpolate_normal, Vec3 *hit_point,
+                                 const Material **material, Vec3 *normal)
+{
     const TriangleMesh &tm = World::getWorld()->getTrack()->getTriangleMesh();
-    tm.castRay(from, to, &m_hit_point, &m_material, &m_normal,
-               /*interpolate*/false);
-    // Now also raycast against all track objects (that are driveable).
+    tm.castRay(from, to, hit_point, material, normal, interpolate_normal);
+    // Now also raycast against all track objects (that are driveable). If
+    // there should be a closer result (than the one against the main track 
+    // mesh), its data will be returned.
     World::getWorld()->getTrack()->getTrackObjectManager()
-                     ->castRay(from, to, &m_hit_point, &m_material,
-                               &m_normal, /*interpolate*/false);
-}   // update
+                     ->castRay(from, to, hit_point, material, normal,
+                               interpolate_normal);
+}   // castTerrainRay
+
+//-----------------------------------------------------------------------------
+/** Does the raycast for the next call of update(rotation, from) in advance.
+ *  This allows the terrain raycasts of all karts to be done together (and
+ *  in parallel) before the karts are updated. If update() is then called
+ *  with the same parameters, the result of this raycast is used, otherwise
+ *  update() does the raycast again. This function only modifies the
+ *  prepared data of this object, so it is thread-safe.
+ *  \param rotation The rotation of the kart.
+ *  \param from World coordinates from which to start the raycast.
+ */
+void TerrainInfo::prepareUpdate(const btMatrix3x3 &rotation, const Vec3 &from)
+{
+    m_prepared_from = from;
+    m_prepared_to   = from + rotation*btVector3(0, -10000.0f, 0);
+    // The hit point is not changed if nothing is hit, so start with the
+    // current value, as update() would do.
+    m_prepared_hit_point = m_hit_point;
+    castTerrainRay(m_prepared_from, m_prepared_to, /*interpolate*/true,
+                   &m_prepared_hit_point, &m_prepared_material,
+                   &m_prepared_normal);
+    m_has_prepared = true;
+}   // prepareUpdate
 
 //-----------------------------------------------------------------------------
 /** Update the terrain information based on the latest position.
@@ -83,15 +130,18 @@ void TerrainInfo::update(const btMatrix3x3 &rotation, const Vec3 &from)
     btVector3 to(0, -10000.0f, 0);
     to = from + rotation*to;
 
-    const TriangleMesh &tm = World::getWorld()->getTrack()->getTriangleMesh();
-    tm.castRay(from, to, &m_hit_point, &m_material, &m_normal,
-               /*interpolate*/true);
-    // Now also raycast against all track objects (that are driveable). If
-    // there should be a closer result (than the one against the main track 
-    // mesh), its data will be returned.
-    World::getWorld()->getTrack()->getTrackObjectManager()
-                     ->castRay(from, to, &m_hit_point, &m_material,
-                               &m_normal, /*interpolate*/true);
+    if (m_has_prepared && m_prepared_from == from && m_prepared_to == to)
+    {
+        m_hit_point = m_prepared_hit_point;
+        m_material  = m_prepared_material;
+        m_normal    = m_prepared_normal;
+    }
+    else
+    {
+        castTerrainRay(from, to, /*interpolate*/true, &m_hit_point,
+                       &m_material, &m_normal);
+    }
+    m_has_prepared = false;
 }   // update
 //-----------------------------------------------------------------------------
 /** Update the terrain information based on the latest position.
@@ -99,6 +149,7 @@ void TerrainInfo::update(const btMatrix3x3 &rotation, const Vec3 &from)
 */
 void TerrainInfo::update(const Vec3 &from, const Vec3 &towards)
 {
+    m_has_prepared  = false;
     m_last_material = m_material;
     Vec3 direction = towards.normalized();
     btVector3 to = from + 10000.0f*direction;
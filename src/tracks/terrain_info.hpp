@@ -43,6 +43,19 @@ private:
     /** DEBUG only: origin of raycast. */
     Vec3 m_origin_ray;
 
+    /** True if prepareUpdate() was called since the last update. */
+    bool              m_has_prepared;
+    /** Start and end point of the ray cast in prepareUpdate(). */
+    Vec3              m_prepared_from, m_prepared_to;
+    /** The results of the ray cast in prepareUpdate(). */
+    Vec3              m_prepared_hit_point;
+    Vec3              m_prepared_normal;
+    const Material   *m_prepared_material;
+
+    static void castTerrainRay(const Vec3 &from, const Vec3 &to,
+                               bool interpolate_normal, Vec3 *hit_point,
+                               const Material **material, Vec3 *normal);
+
 public:
              TerrainInfo();
              TerrainInfo(const Vec3 &pos);
@@ -51,6 +64,7 @@ public:
     bool     getSurfaceInfo(const Vec3 &from, Vec3 *position,
                             const Material **m);
     virtual void update(const btMatrix3x3 &rotation, const Vec3 &from);
+    void     prepareUpdate(const btMatrix3x3 &rotation, const Vec3 &from);
     virtual void update(const Vec3 &from);
     virtual void update(const Vec3 &from, const Vec3 &towards);
 
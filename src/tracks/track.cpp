@@ -39,6 +39,7 @@
 #include "graphics/particle_emitter.hpp"
 #include "graphics/particle_kind.hpp"
 #include "graphics/particle_kind_manager.hpp"
+#include "graphics/texture_streamer.hpp"
 #include "io/file_manager.hpp"
 #include "io/xml_node.hpp"
 #include "items/item.hpp"
@@ -86,7 +87,7 @@ const float Track::NOHIT               = -99999.9f;
 bool        Track::m_dont_load_navmesh = false;
 
 // ----------------------------------------------------------------------------
-Track::Track(const std::string &filename)
+Track::Track(const std::string &filename, const XMLNode *xml)
 {
 #ifdef DEBUG
     m_magic_number          = 0x17AC3802;
@@ -149,7 +150,7 @@ Track::Track(const std::string &filename)
     m_all_nodes.clear();
     m_static_physics_only_nodes.clear();
     m_all_cached_meshes.clear();
-    loadTrackInfo();
+    loadTrackInfo(xml);
 }   // Track
 
 //-----------------------------------------------------------------------------
@@ -279,7 +280,9 @@ void Track::cleanup()
 {
     Graph::destroy();
     ItemManager::destroy();
+#ifndef SERVER_ONLY
     VAOManager::kill();
+#endif
 
     ParticleKindManager::get()->cleanUpTrackSpecificGfx();
     // Clear reminder of transformed textures
@@ -327,8 +330,10 @@ void Track::cleanup()
     delete m_gfx_effect_mesh;
     m_gfx_effect_mesh = NULL;
 
+#ifndef SERVER_ONLY
     if (CVS->isGLSL())
         irr_driver->cleanSunInterposer();
+#endif
 
 
     // The m_all_cached_mesh contains each mesh loaded from a file, which
@@ -466,7 +471,12 @@ void Track::cleanup()
 }   // cleanup
 
 //-----------------------------------------------------------------------------
-void Track::loadTrackInfo()
+/** Reads the information about this track that is needed before the track
+ *  is actually loaded (name, groups, modes, ...) from track.xml.
+ *  \param xml If not NULL the already parsed track.xml file, otherwise the
+ *         file is read here.
+ */
+void Track::loadTrackInfo(const XMLNode *xml)
 {
     // Default values
     m_use_fog               = false;
@@ -489,11 +499,12 @@ void Track::loadTrackInfo()
     irr_driver->setSSAORadius(1.);
     irr_driver->setSSAOK(1.5);
     irr_driver->setSSAOSigma(1.);
-    XMLNode *root           = file_manager->createXMLTree(m_filename);
+    const XMLNode *root     = xml ? xml
+                                  : file_manager->createXMLTree(m_filename);
 
     if(!root || root->getName()!="track")
     {
-        delete root;
+        if(!xml) delete root;
         std::ostringstream o;
         o<<"Can't load track '"<<m_filename<<"', no track element.";
         throw std::runtime_error(o.str());
@@ -567,7 +578,7 @@ void Track::loadTrackInfo()
 
     // Set the correct paths
     m_screenshot = m_root+m_screenshot;
-    delete root;
+    if(!xml) delete root;
 
     std::string dir = StringUtils::getPath(m_filename);
     std::string easter_name = dir + "/easter_eggs.xml";
@@ -824,7 +835,10 @@ void Track::createPhysicsModel(unsigned int main_track_count)
     {
         convertTrackToBullet(m_all_nodes[i]);
     }
-    m_track_mesh->createPhysicalBody();
+    // Building the BVH of the complete track is expensive, so it is cached
+    // (the cache file name contains a hash of the track mesh).
+    m_track_mesh->createPhysicalBody((btCollisionObject::CollisionFlags)0,
+                                     m_ident);
     m_gfx_effect_mesh->createCollisionShape();
 }   // createPhysicsModel
 
@@ -1059,11 +1073,13 @@ void Track::loadMinimap()
         m_minimap_x_scale = float(m_mini_map_size.Width) / float(m_old_rtt_mini_map->getSize().Width);
         m_minimap_y_scale = float(m_mini_map_size.Height) / float(m_old_rtt_mini_map->getSize().Height);
     }
+#ifndef SERVER_ONLY
     else if (m_new_rtt_mini_map)
     {
         m_minimap_x_scale = float(m_mini_map_size.Width) / float(m_new_rtt_mini_map->getWidth());
         m_minimap_y_scale = float(m_mini_map_size.Height) / float(m_new_rtt_mini_map->getHeight());
     }
+#endif
     else
     {
         m_minimap_x_scale = 0;
@@ -1667,6 +1683,10 @@ void Track::loadTrackModel(bool reverse_track, unsigned int mode_id)
         throw std::runtime_error(msg.str());
     }
 
+    // Decode the textures of the track in the background while the
+    // meshes are loaded.
+    TextureStreamer::get()->requestDirectory(m_root);
+
     // Load the graph only now: this function is called from world, after
     // the race gui was created. The race gui is needed since it stores
     // the information about the size of the texture to render the mini
@@ -1863,11 +1883,13 @@ void Track::loadTrackModel(bool reverse_track, unsigned int mode_id)
 
         sun->getLightData().SpecularColor = m_sun_specular_color;
     }
+#ifndef SERVER_ONLY
     else
     {
         irr_driver->createSunInterposer();
         m_sun->grab();
     }
+#endif
 
     createPhysicsModel(main_track_count);
 
@@ -1905,6 +1927,8 @@ void Track::loadTrackModel(bool reverse_track, unsigned int mode_id)
                   "positions might be incorrect.");
     }
 
+    TextureStreamer::get()->finishRequests();
+
     if (UserConfigParams::logMemory())
     {
         Log::debug("track", "[memory] After loading  '%s': mesh cache %d "
@@ -372,7 +372,7 @@ private:
     /** The number of laps that is predefined in a track info dialog. */
     int m_actual_number_of_laps;
 
-    void loadTrackInfo();
+    void loadTrackInfo(const XMLNode *xml);
     void loadDriveGraph(unsigned int mode_id, const bool reverse);
     void loadArenaGraph(const XMLNode &node);
     btQuaternion getArenaStartRotation(const Vec3& xyz, float heading);
@@ -405,7 +405,8 @@ public:
         return btQuaternion(axis, normal.angle(Vec3(0, 1, 0)));
     }   // createRotationFromNormal
 
-                       Track             (const std::string &filename);
+                       Track             (const std::string &filename,
+                                          const XMLNode *xml=NULL);
                       ~Track             ();
     void               cleanup           ();
     void               removeCachedData  ();
@@ -20,6 +20,7 @@
 
 #include "config/stk_config.hpp"
 #include "graphics/irr_driver.hpp"
+#include "io/asset_loader.hpp"
 #include "io/file_manager.hpp"
 #include "tracks/track.hpp"
 
@@ -146,13 +147,20 @@ void TrackManager::loadTrackList()
     m_track_avail.clear();
     m_tracks.clear();
 
+    // The track.xml files are parsed in parallel, then the tracks are
+    // created in the order of the directories (see AssetLoader).
+    AssetLoader loader("track-index.bin", "");
     for(unsigned int i=0; i<m_track_search_path.size(); i++)
     {
         const std::string &dir = m_track_search_path[i];
 
         // First test if the directory itself contains a track:
         // ----------------------------------------------------
-        if(loadTrack(dir)) continue;  // track found, no more tests
+        if(file_manager->fileExists(dir+"track.xml"))
+        {
+            loader.addDirectory(dir, dir+"track.xml");
+            continue;  // track found, no more tests
+        }
 
         // Then see if a subdir of this dir contains tracks
         // ------------------------------------------------
@@ -162,17 +170,26 @@ void TrackManager::loadTrackList()
             subdir != dirs.end(); subdir++)
         {
             if(*subdir=="." || *subdir=="..") continue;
-            loadTrack(dir+*subdir+"/");
+            loader.addDirectory(dir+*subdir+"/", dir+*subdir+"/track.xml");
         }   // for dir in dirs
     }   // for i <m_track_search_path.size()
+
+    loader.load();
+    for(unsigned int i=0; i<loader.getNumEntries(); i++)
+    {
+        const AssetLoader::Entry &entry = loader.getEntry(i);
+        if(entry.m_exists)
+            loadTrack(entry.m_dir, entry.m_config);
+    }
 }  // loadTrackList
 
 // ----------------------------------------------------------------------------
 /** Tries to load a track from a single directory. Returns true if a track was
  *  successfully loaded.
  *  \param dirname Name of the directory to load the track from.
+ *  \param xml If not NULL the already parsed track.xml file.
  */
-bool TrackManager::loadTrack(const std::string& dirname)
+bool TrackManager::loadTrack(const std::string& dirname, const XMLNode *xml)
 {
     std::string config_file = dirname+"track.xml";
     if(!file_manager->fileExists(config_file))
@@ -182,7 +199,7 @@ bool TrackManager::loadTrack(const std::string& dirname)
 
     try
     {
-        track = new Track(config_file);
+        track = new Track(config_file, xml);
     }
     catch (std::exception& e)
     {
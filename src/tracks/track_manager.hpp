@@ -24,6 +24,7 @@
 #include <map>
 
 class Track;
+class XMLNode;
 
 /**
   * \brief Simple class to load and manage track data, track names and such
@@ -80,7 +81,7 @@ public:
     /** Load all .track files from all directories */
     void  loadTrackList();
     void  removeTrack(const std::string &ident);
-    bool  loadTrack(const std::string& dirname);
+    bool  loadTrack(const std::string& dirname, const XMLNode *xml=NULL);
     void  removeAllCachedData();
     int   getNumberOfRaceTracks() const;
     Track* getTrack(const std::string& ident) const;
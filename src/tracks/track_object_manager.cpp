@@ -70,6 +70,7 @@ void TrackObjectManager::init()
     {
         curr->onWorldReady();
     }
+    updateDriveableObjects();
 }   // reset
 // ----------------------------------------------------------------------------
 /** Initialises all track objects.
@@ -81,6 +82,7 @@ void TrackObjectManager::reset()
         curr->reset();
         curr->resetEnabled();
     }
+    updateDriveableObjects();
 }   // reset
 // ----------------------------------------------------------------------------
 /** returns a reference to the track object
@@ -148,14 +150,50 @@ void TrackObjectManager::update(float dt)
     {
         curr->update(dt);
     }
+    updateDriveableObjects();
 }   // update
 
+// ----------------------------------------------------------------------------
+/** Updates the bounding boxes of the driveable objects in the AABB tree
+ *  used for raycasts. Only objects that have moved since the last call are
+ *  updated. This must be called whenever driveable objects might have been
+ *  moved, i.e. after updating the track objects and the physics.
+ */
+void TrackObjectManager::updateDriveableObjects()
+{
+    m_driveable_leaves.resize(m_driveable_objects.size(), NULL);
+    m_driveable_transforms.resize(m_driveable_objects.size());
+    for (unsigned int i = 0; i < m_driveable_objects.size(); i++)
+    {
+        TrackObject *object = m_driveable_objects.get(i);
+        const PhysicalObject *po = object->getPhysicalObject();
+        // Only objects with an exact collision shape can be hit by a ray.
+        if (!po || po->getBodyType() != PhysicalObject::MP_EXACT ||
+            !po->getBody())
+            continue;
+
+        const btTransform &t = po->getBody()->getWorldTransform();
+        if (m_driveable_leaves[i] && t == m_driveable_transforms[i])
+            continue;
+
+        btVector3 min, max;
+        po->getBody()->getCollisionShape()->getAabb(t, min, max);
+        btDbvtVolume volume = btDbvtVolume::FromMM(min, max);
+        if (m_driveable_leaves[i])
+            m_driveable_tree.update(m_driveable_leaves[i], volume);
+        else
+            m_driveable_leaves[i] = m_driveable_tree.insert(volume, object);
+        m_driveable_transforms[i] = t;
+    }
+}   // updateDriveableObjects
+
 // ----------------------------------------------------------------------------
 /** Does a raycast against all driveable objects. This way part of the track
  *  can be a physical object, and can e.g. be animated. A separate list of all
  *  driveable objects is maintained (in one case there were over 2000 bodies,
- *  but only one is driveable). The result of the raycast against the track
- *  mesh are the input parameter. It is then tested if the raycast against 
+ *  but only one is driveable), and an AABB tree of these objects is used so
+ *  that only objects near the ray are tested. The result of the raycast
+ *  against the track mesh are the input parameter. It is then tested if the raycast against 
  *  a track object gives a 'closer' result. If so, the parameters hit_point,
  *  normal, and material will be updated.
  *  \param from/to The from and to position for the raycast.
@@ -176,32 +214,75 @@ void TrackObjectManager::castRay(const btVector3 &from,
                                  btVector3 *normal,
                                  bool interpolate_normal) const
 {
+    /** Tests the ray against each object whose bounding box is hit. */
+    class DriveableRayCallback : public btDbvt::ICollide
+    {
+    public:
+        const btVector3 &m_from, &m_to;
+        btVector3       *m_hit_point;
+        const Material **m_material;
+        btVector3       *m_normal;
+        bool             m_interpolate_normal;
+        float            m_distance;
+        // --------------------------------------------------------------------
+        DriveableRayCallback(const btVector3 &from, const btVector3 &to,
+                             btVector3 *hit_point, const Material **material,
+                             btVector3 *normal, bool interpolate_normal,
+                             float distance)
+            : m_from(from), m_to(to)
+        {
+            m_hit_point          = hit_point;
+            m_material           = material;
+            m_normal             = normal;
+            m_interpolate_normal = interpolate_normal;
+            m_distance           = distance;
+        }   // DriveableRayCallback
+        // --------------------------------------------------------------------
+        virtual void Process(const btDbvtNode *leaf)
+        {
+            const TrackObject *curr = (const TrackObject*)leaf->data;
+            btVector3 new_hit_point;
+            const Material *new_material;
+            btVector3 new_normal;
+            if(curr->castRay(m_from, m_to, &new_hit_point, &new_material,
+                             &new_normal, m_interpolate_normal))
+            {
+                float new_distance = new_hit_point.distance(m_from);
+                // If the new hit is closer than the current hit, save
+                // the data.
+                if (new_distance < m_distance)
+                {
+                    *m_material  = new_material;
+                    *m_hit_point = new_hit_point;
+                    if(m_normal)
+                        *m_normal = new_normal;
+                    m_distance   = new_distance;
+                }   // if new_distance < distance
+            }   // if hit
+        }   // Process
+    };   // DriveableRayCallback
+    // ------------------------------------------------------------------------
+
+    if(!m_driveable_tree.m_root)
+        return;
+
     float distance = 9999.9f;
     // If there was a hit already, compute the current distance
     if(*material)
     {
         distance = hit_point->distance(from);
     }
-    for (const TrackObject* curr : m_driveable_objects)
-    {
-        btVector3 new_hit_point;
-        const Material *new_material;
-        btVector3 new_normal;
-        if(curr->castRay(from, to, &new_hit_point, &new_material, &new_normal,
-                      interpolate_normal))
-        {
-            float new_distance = new_hit_point.distance(from);
-            // If the new hit is closer than the current hit, save
-            // the data.
-            if (new_distance < distance)
-            {
-                *material  = new_material;
-                *hit_point = new_hit_point;
-                *normal    = new_normal;
-                distance   = new_distance;
-            }   // if new_distance < distance
-        }   // if hit
-    }   // for all track objects.
+
+    // Only a hit closer than the current one is of interest, so the ray
+    // can end there. This also reduces the number of bounding boxes hit.
+    btVector3 ray_to = to;
+    float length = (to - from).length();
+    if(distance < length)
+        ray_to = from + (to - from)*(distance/length);
+
+    DriveableRayCallback callback(from, ray_to, hit_point, material, normal,
+                                  interpolate_normal, distance);
+    btDbvt::rayTest(m_driveable_tree.m_root, from, ray_to, callback);
 }   // castRay
 
 // ----------------------------------------------------------------------------
@@ -284,6 +365,20 @@ void TrackObjectManager::insertObject(TrackObject* object)
  */
 void TrackObjectManager::removeObject(TrackObject* obj)
 {
+    for (unsigned int i = 0; i < m_driveable_objects.size(); i++)
+    {
+        if (m_driveable_objects.get(i) != obj)
+            continue;
+        if (i < m_driveable_leaves.size())
+        {
+            if (m_driveable_leaves[i])
+                m_driveable_tree.remove(m_driveable_leaves[i]);
+            m_driveable_leaves.erase(m_driveable_leaves.begin() + i);
+            m_driveable_transforms.erase(m_driveable_transforms.begin() + i);
+        }
+        m_driveable_objects.remove(obj);
+        break;
+    }
     m_all_objects.remove(obj);
     delete obj;
 }   // removeObject
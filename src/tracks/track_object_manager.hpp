@@ -23,6 +23,8 @@
 #include "tracks/track_object.hpp"
 #include "utils/ptr_vector.hpp"
 
+#include "BulletCollision/BroadphaseCollision/btDbvt.h"
+
 class Track;
 class Vec3;
 class XMLNode;
@@ -51,6 +53,18 @@ protected:
     /** A second list which holds all objects that karts can drive on. */
     PtrVector<TrackObject, REF> m_driveable_objects;
 
+    /** An AABB tree of all driveable objects, so that a raycast is only
+     *  tested against the objects whose bounding box is hit by the ray. */
+    btDbvt m_driveable_tree;
+
+    /** For each driveable object its leaf in m_driveable_tree, or NULL if
+     *  the object can not be hit by a raycast. */
+    std::vector<btDbvtNode*> m_driveable_leaves;
+
+    /** For each driveable object the transform for which its bounding box
+     *  in m_driveable_tree was computed. */
+    std::vector<btTransform> m_driveable_transforms;
+
 public:
          TrackObjectManager();
         ~TrackObjectManager();
@@ -66,6 +80,7 @@ public:
                  const btVector3 &to, btVector3 *hit_point,
                  const Material **material, btVector3 *normal = NULL,
                  bool interpolate_normal = false) const;
+    void updateDriveableObjects();
 
     /** Enable or disable fog on objects */
     void enableFog(bool enable);
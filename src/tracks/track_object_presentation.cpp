@@ -26,6 +26,7 @@
 #include "graphics/central_settings.hpp"
 #include "graphics/irr_driver.hpp"
 #include "graphics/light.hpp"
+#include "graphics/material.hpp"
 #include "graphics/material_manager.hpp"
 #include "graphics/mesh_tools.hpp"
 #include "graphics/particle_emitter.hpp"
@@ -534,9 +535,11 @@ void TrackObjectPresentationMesh::init(const XMLNode* xml_node,
 
         m_node = irr_driver->addMesh(m_mesh, m_model_file, parent, m_render_info);
 
+#ifndef SERVER_ONLY
         STKMeshSceneNode* stkmesh = dynamic_cast<STKMeshSceneNode*>(m_node);
         if (displacing && stkmesh != NULL)
             stkmesh->setIsDisplacement(displacing);
+#endif
 
         m_frame_start = 0;
         m_frame_end = 0;
@@ -0,0 +1,78 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2016 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#ifndef HEADER_HASH_HPP
+#define HEADER_HASH_HPP
+
+#include "utils/types.hpp"
+
+#include <stddef.h>
+#include <string.h>
+
+/** 64 bit FNV-1a hashing. These hashes are only used to detect changed data
+ *  (e.g. for caches) and for hash tables, they are not cryptographically
+ *  secure. A hash is started with FNV_OFFSET, and any number of values can
+ *  be mixed into it.
+ */
+namespace Hash
+{
+    const uint64_t FNV_OFFSET = 0xcbf29ce484222325ULL;
+    const uint64_t FNV_PRIME  = 0x100000001b3ULL;
+
+    // ------------------------------------------------------------------------
+    /** Mixes one value (e.g. a byte, a character or an integer) into a hash.
+     */
+    inline uint64_t mix(uint64_t hash, uint64_t value)
+    {
+        return (hash ^ value) * FNV_PRIME;
+    }   // mix
+
+    // ------------------------------------------------------------------------
+    /** Mixes a block of memory into a hash one byte at a time, which gives
+     *  the standard FNV-1a hash of the data. */
+    inline uint64_t mixBytes(uint64_t hash, const void *data, size_t size)
+    {
+        const uint8_t *bytes = (const uint8_t*)data;
+        for (size_t i = 0; i < size; i++)
+            hash = mix(hash, bytes[i]);
+        return hash;
+    }   // mixBytes
+
+    // ------------------------------------------------------------------------
+    /** Mixes a block of memory into a hash 64 bit words at a time, and the
+     *  remaining bytes one at a time. This is much faster than mixBytes for
+     *  large blocks (e.g. images), but the hash depends on the byte order
+     *  of the machine, so it must not be shared between machines. */
+    inline uint64_t mixWords(uint64_t hash, const void *data, size_t size)
+    {
+        const uint8_t *bytes = (const uint8_t*)data;
+        size_t i = 0;
+        for (; i + 8 <= size; i += 8)
+        {
+            uint64_t word;
+            memcpy(&word, bytes + i, 8);
+            hash = mix(hash, word);
+        }
+        for (; i < size; i++)
+            hash = mix(hash, bytes[i]);
+        return hash;
+    }   // mixWords
+
+}   // namespace Hash
+
+#endif
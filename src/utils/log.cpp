@@ -19,9 +19,17 @@
 #include "utils/log.hpp"
 
 #include "config/user_config.hpp"
+#include "utils/hash.hpp"
+#include "utils/mpsc_queue.hpp"
+#include "utils/time.hpp"
+#include "utils/vs.hpp"
 
+#include <atomic>
 #include <cstdio>
+#include <pthread.h>
 #include <stdio.h>
+#include <string.h>
+#include <time.h>
 
 #ifdef ANDROID
 #  include <android/log.h>
@@ -123,19 +131,16 @@ void Log::resetTerminalColor()
 }   // resetTerminalColor
 
 // ----------------------------------------------------------------------------
-/** This actually prints the log message. If log messages are not redirected
- *  to a file, it tries to select a terminal colour.
+/** Writes one (already formatted) log message to the console and/or log
+ *  file. If log messages are not redirected to a file, it tries to select
+ *  a terminal colour. This is called from the writer thread, or directly
+ *  from printMessage() if no writer thread is running.
  *  \param level Log level of the message to print.
- *  \param format A printf-like format string.
- *  \param va_list The values to be printed for the format.
+ *  \param component Name of the component that logged the message.
+ *  \param message The formatted message.
  */
-void Log::printMessage(int level, const char *component, const char *format,
-                       VALIST args)
+void Log::writeMessage(int level, const char *component, const char *message)
 {
-    assert(level>=0 && level <=LL_FATAL);
-
-    if(level<m_min_log_level) return;
-
 #ifdef ANDROID
     android_LogPriority alp;
     switch (level)
@@ -153,82 +158,334 @@ void Log::printMessage(int level, const char *component, const char *format,
     case LL_FATAL:   alp = ANDROID_LOG_FATAL;   break;
     default:         alp = ANDROID_LOG_FATAL;
     }
-    __android_log_vprint(alp, "SuperTuxKart", format, args);
+    __android_log_print(alp, "SuperTuxKart", "%s", message);
 #else
     static const char *names[] = {"debug", "verbose  ", "info   ",
                                   "warn   ", "error  ", "fatal  "};
 
-    // Using a va_list twice produces undefined results, ie crash.
-    // So make a copy if we're going to use it twice.
-    VALIST copy;
-    if (m_file_stdout)
-    {
-        va_copy(copy, args);
-    }
-#if defined(_MSC_FULL_VER) && defined(_DEBUG)
-    VALIST copy2;
-    va_copy(copy2, args);
-#endif
-
     // If we don't have a console file, write to stdout and hope for the best
     if(!m_file_stdout || level >= LL_WARN ||
         UserConfigParams::m_log_errors_to_console) // log to console & file
     {
-        VALIST out;
-        va_copy(out, args);
-
         setTerminalColor((LogLevel)level);
-        printf("[%s] %s: ", names[level], component);
-        vprintf(format, out);
+        printf("[%s] %s: %s", names[level], component, message);
         resetTerminalColor();  // this prints a \n
-
-        va_end(out);
     }
 
 #if defined(_MSC_FULL_VER) && defined(_DEBUG)
-    static char szBuff[2048];
-    vsnprintf(szBuff, sizeof(szBuff), format, copy2);
-
     OutputDebugString("[");
     OutputDebugString(names[level]);
     OutputDebugString("] ");
     OutputDebugString(component);
     OutputDebugString(": ");
-    OutputDebugString(szBuff);
+    OutputDebugString(message);
     OutputDebugString("\r\n");
 #endif
 
-
     if(m_file_stdout)
-    {
-        fprintf (m_file_stdout, "[%s] %s: ", names[level], component);
-        vfprintf(m_file_stdout, format, copy);
-        fprintf (m_file_stdout, "\n");
-        va_end(copy);
-    }
+        fprintf(m_file_stdout, "[%s] %s: %s\n", names[level], component,
+                message);
 
 #ifdef WIN32
     if (level >= LL_FATAL)
     {
-        std::string message;
+        std::string text = std::string("[") + names[level] + "] " +
+                           component + ": " + message;
+        MessageBoxA(NULL, text.c_str(), "SuperTuxKart - Fatal error", MB_OK);
+    }
+#endif
+
+#endif
+}   // writeMessage
+
+// ============================================================================
+/** Size of the buffer in a log record. Longer messages are allocated on the
+ *  heap. */
+#define LOG_RECORD_INLINE_SIZE 240
+
+/** A formatted log message waiting to be written by the writer thread. */
+struct LogRecord
+{
+    /** The log level of the message. */
+    int   m_level;
+    /** If the message did not fit into m_inline, a buffer allocated with
+     *  malloc, which the writer thread frees. NULL otherwise. */
+    char *m_heap;
+    /** The name of the component and the message, separated by a 0 byte. */
+    char  m_inline[LOG_RECORD_INLINE_SIZE];
+};   // LogRecord
+
+/** The queue of messages for the writer thread. */
+static MPSCQueue<LogRecord> *g_log_queue = NULL;
+static pthread_t             g_log_writer_thread;
+/** True while messages should be queued for the writer thread. */
+static std::atomic<bool>     g_log_async(false);
+/** Tells the writer thread to exit once the queue is empty. */
+static std::atomic<bool>     g_log_writer_quit(false);
+/** Number of threads which are currently queueing a message. It is used
+ *  to make sure that no message is queued after the writer thread exited. */
+static std::atomic<int>      g_log_producers(0);
+/** Number of messages queued so far. The writer thread compares it with
+ *  the number of messages it has written to decide if it can sleep. */
+static std::atomic<uint64_t> g_log_num_queued(0);
+/** Number of messages written by the writer thread. It is only used by the
+ *  writer thread, and kept when the thread is restarted, since all queued
+ *  messages are written before it exits. */
+static uint64_t              g_log_num_written = 0;
+/** True while the writer thread is waiting (or about to wait) for new
+ *  messages, so that producers only signal it (which needs the mutex)
+ *  if necessary. */
+static std::atomic<bool>     g_log_writer_sleeping(false);
+/** Protects waiting for and signalling g_log_writer_cond. */
+static pthread_mutex_t       g_log_writer_mutex = PTHREAD_MUTEX_INITIALIZER;
+/** Signalled when a message is queued or the writer thread should exit. */
+static pthread_cond_t        g_log_writer_cond  = PTHREAD_COND_INITIALIZER;
+
+/** Counts the messages of the components in the current second for rate
+ *  limiting. Components are hashed into a small table, so two components
+ *  can share one limit, which is an acceptable inaccuracy. */
+struct LogRateSlot
+{
+    std::atomic<uint32_t> m_second;
+    std::atomic<uint32_t> m_count;
+    std::atomic<uint32_t> m_dropped;
+};   // LogRateSlot
+static LogRateSlot g_log_rate_slots[64];
+/** Maximum number of messages below LL_WARN per component and second.
+ *  0 disables rate limiting. */
+static std::atomic<int> g_log_rate_limit(200);
+
+// ----------------------------------------------------------------------------
+/** Sets the maximum number of messages per second that a component can log
+ *  at a level below LL_WARN while the writer thread is running. Warnings
+ *  and errors are never dropped.
+ *  \param n Maximum number of messages per second, 0 disables the limit.
+ */
+void Log::setRateLimit(int n)
+{
+    g_log_rate_limit.store(n < 0 ? 0 : n);
+}   // setRateLimit
 
-        char tmp[2048];
-        sprintf(tmp, "[%s] %s: ", names[level], component);
-        message += tmp;
+// ----------------------------------------------------------------------------
+/** Returns true if a message of the given level and component should be
+ *  dropped because the component is logging too much. At the start of each
+ *  second the number of messages dropped in the previous second is reported.
+ */
+bool Log::isRateLimited(int level, const char *component)
+{
+    const int limit = g_log_rate_limit.load(std::memory_order_relaxed);
+    if (limit == 0 || level >= LL_WARN)
+        return false;
+
+    const uint64_t hash = Hash::mixBytes(Hash::FNV_OFFSET, component,
+                                         strlen(component));
+    LogRateSlot &slot = g_log_rate_slots[hash % 64];
+
+    uint32_t now    = (uint32_t)time(NULL);
+    uint32_t second = slot.m_second.load(std::memory_order_relaxed);
+    if (second != now &&
+        slot.m_second.compare_exchange_strong(second, now))
+    {
+        slot.m_count.store(0, std::memory_order_relaxed);
+        uint32_t dropped = slot.m_dropped.exchange(0);
+        if (dropped > 0)
+            warn("Log", "%u messages of '%s' (or components sharing its "
+                        "limit) were dropped.", dropped, component);
+    }
+    if (slot.m_count.fetch_add(1, std::memory_order_relaxed) <
+        (uint32_t)limit)
+        return false;
+    slot.m_dropped.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}   // isRateLimited
 
-        VALIST out;
+// ----------------------------------------------------------------------------
+/** Formats a message into a log record, and queues it for the writer
+ *  thread.
+ */
+void Log::queueMessage(int level, const char *component, const char *format,
+                       VALIST args)
+{
+    LogRecord record;
+    record.m_level = level;
+    record.m_heap  = NULL;
+    size_t component_size = strlen(component) + 1;
+    if (component_size > LOG_RECORD_INLINE_SIZE / 2)
+        component_size = LOG_RECORD_INLINE_SIZE / 2;
+    memcpy(record.m_inline, component, component_size - 1);
+    record.m_inline[component_size - 1] = 0;
+
+    VALIST out;
+    va_copy(out, args);
+    int n = vsnprintf(record.m_inline + component_size,
+                      LOG_RECORD_INLINE_SIZE - component_size, format, out);
+    va_end(out);
+    // Older Windows versions of vsnprintf return -1 if the output was
+    // truncated, in which case the message remains truncated.
+    if (n >= (int)(LOG_RECORD_INLINE_SIZE - component_size))
+    {
+        record.m_heap = (char*)malloc(component_size + n + 1);
+        memcpy(record.m_heap, record.m_inline, component_size);
         va_copy(out, args);
-        vsprintf(tmp, format, out);
-        message += tmp;
+        vsnprintf(record.m_heap + component_size, n + 1, format, out);
         va_end(out);
+    }
+    g_log_queue->push(record);
+    // The counter must be increased before testing if the writer thread
+    // sleeps (the writer does it the other way round), so that either the
+    // writer sees the new message or it is woken up.
+    g_log_num_queued.fetch_add(1);
+    if (g_log_writer_sleeping.load())
+    {
+        pthread_mutex_lock(&g_log_writer_mutex);
+        pthread_cond_signal(&g_log_writer_cond);
+        pthread_mutex_unlock(&g_log_writer_mutex);
+    }
+}   // queueMessage
 
-        MessageBoxA(NULL, message.c_str(), "SuperTuxKart - Fatal error", MB_OK);
+// ----------------------------------------------------------------------------
+/** The writer thread, which writes all queued messages, and waits for
+ *  new messages when the queue is empty.
+ */
+void* Log::writerLoop(void *data)
+{
+    VS::setThreadName("LogWriter");
+    while (true)
+    {
+        // Read the flag before draining the queue, so that all messages
+        // queued before stopWriterThread() was called are written.
+        bool quit = g_log_writer_quit.load(std::memory_order_acquire);
+        bool any  = false;
+        LogRecord record;
+        while (g_log_queue->pop(&record))
+        {
+            const char *text = record.m_heap ? record.m_heap
+                                             : record.m_inline;
+            writeMessage(record.m_level, text, text + strlen(text) + 1);
+            free(record.m_heap);
+            g_log_num_written++;
+            any = true;
+        }
+        if (any)
+            fflush(stdout);
+        if (quit)
+            break;
+
+        pthread_mutex_lock(&g_log_writer_mutex);
+        g_log_writer_sleeping.store(true);
+        while (g_log_num_queued.load() <= g_log_num_written &&
+               !g_log_writer_quit.load())
+        {
+            pthread_cond_wait(&g_log_writer_cond, &g_log_writer_mutex);
+        }
+        g_log_writer_sleeping.store(false);
+        pthread_mutex_unlock(&g_log_writer_mutex);
     }
-#endif
+    return NULL;
+}   // writerLoop
 
+// ----------------------------------------------------------------------------
+/** Starts the thread that writes log messages. Afterwards log messages
+ *  (except fatal ones) are only formatted on the calling thread, and the
+ *  writer thread does the (much slower) output to the console and log
+ *  file. The thread is stopped at exit, or when stopWriterThread() is
+ *  called.
+ */
+void Log::startWriterThread()
+{
+#ifndef ANDROID
+    if (g_log_async.load())
+        return;
+    if (!g_log_queue)
+        g_log_queue = new MPSCQueue<LogRecord>(1024);
+    g_log_writer_quit.store(false);
+    if (pthread_create(&g_log_writer_thread, NULL, &Log::writerLoop, NULL))
+    {
+        warn("Log", "Could not create log writer thread.");
+        return;
+    }
+    g_log_async.store(true, std::memory_order_release);
+    static bool registered = false;
+    if (!registered)
+    {
+        registered = true;
+        atexit(stopWriterThread);
+    }
 #endif
-}   // printMessage
+}   // startWriterThread
 
+// ----------------------------------------------------------------------------
+/** Writes all queued messages, and stops the writer thread. Afterwards
+ *  messages are written synchronously again. If called on the writer
+ *  thread itself (e.g. from a crash handler), queued messages are lost.
+ */
+void Log::stopWriterThread()
+{
+    if (!g_log_async.exchange(false))
+        return;
+    if (pthread_equal(pthread_self(), g_log_writer_thread))
+        return;
+    // Wait till all threads that are queueing a message are done.
+    while (g_log_producers.load() > 0)
+        StkTime::sleep(1);
+    pthread_mutex_lock(&g_log_writer_mutex);
+    g_log_writer_quit.store(true, std::memory_order_release);
+    pthread_cond_signal(&g_log_writer_cond);
+    pthread_mutex_unlock(&g_log_writer_mutex);
+    pthread_join(g_log_writer_thread, NULL);
+}   // stopWriterThread
+
+// ----------------------------------------------------------------------------
+/** This is called for every log message with a high enough level. If the
+ *  writer thread is running, the message is queued for it (unless the
+ *  component is rate limited), otherwise it is written immediately. Fatal
+ *  messages are always written immediately (after all queued messages),
+ *  since the program is aborted afterwards.
+ *  \param level Log level of the message to print.
+ *  \param format A printf-like format string.
+ *  \param va_list The values to be printed for the format.
+ */
+void Log::printMessage(int level, const char *component, const char *format,
+                       VALIST args)
+{
+    assert(level>=0 && level <=LL_FATAL);
+
+    if(level<m_min_log_level) return;
+
+    if (level < LL_FATAL && g_log_async.load(std::memory_order_acquire))
+    {
+        if (isRateLimited(level, component))
+            return;
+        g_log_producers.fetch_add(1);
+        // Check again, the writer thread might have been stopped.
+        if (g_log_async.load(std::memory_order_acquire))
+        {
+            queueMessage(level, component, format, args);
+            g_log_producers.fetch_sub(1);
+            return;
+        }
+        g_log_producers.fetch_sub(1);
+    }
+
+    if (level == LL_FATAL)
+        stopWriterThread();
+
+    char buffer[1024];
+    VALIST out;
+    va_copy(out, args);
+    int n = vsnprintf(buffer, sizeof(buffer), format, out);
+    va_end(out);
+    if (n < (int)sizeof(buffer))
+    {
+        writeMessage(level, component, buffer);
+        return;
+    }
+    std::string message(n + 1, 0);
+    va_copy(out, args);
+    vsnprintf(&message[0], n + 1, format, out);
+    va_end(out);
+    writeMessage(level, component, message.c_str());
+}   // printMessage
 
 // ----------------------------------------------------------------------------
 /** This function opens the files that will contain the output.
@@ -254,6 +511,7 @@ void Log::openOutputFiles(const std::string &logout)
 /** Function to close output files */
 void Log::closeOutputFiles()
 {
+    stopWriterThread();
     fclose(m_file_stdout);
 } // closeOutputFiles
 
@@ -61,6 +61,12 @@ private:
 
     static void setTerminalColor(LogLevel level);
     static void resetTerminalColor();
+    static void writeMessage(int level, const char *component,
+                             const char *message);
+    static bool isRateLimited(int level, const char *component);
+    static void queueMessage(int level, const char *component,
+                             const char *format, VALIST args);
+    static void* writerLoop(void *data);
 
 public:
 
@@ -96,6 +102,12 @@ public:
 
     static void closeOutputFiles();
 
+    static void startWriterThread();
+
+    static void stopWriterThread();
+
+    static void setRateLimit(int n);
+
     // ------------------------------------------------------------------------
     /** Defines the minimum log level to be displayed. */
     static void setLogLevel(int n)
@@ -0,0 +1,194 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2016 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#ifndef HEADER_MPSC_QUEUE_HPP
+#define HEADER_MPSC_QUEUE_HPP
+
+#include "utils/no_copy.hpp"
+#include "utils/synchronised.hpp"
+
+#include <assert.h>
+#include <atomic>
+#include <deque>
+#include <stddef.h>
+
+/** A bounded, lock-free multi-producer single-consumer queue. Any number of
+ *  threads can push, but only one thread may pop. The ring buffer uses a
+ *  sequence number per cell (based on Dmitry Vyukov's bounded queue), so
+ *  producers only contend on one compare-and-swap and the consumer never
+ *  takes a lock in the common case.
+ *  If the ring is full, elements are appended to a mutex-protected overflow
+ *  list instead of being dropped. While the overflow list is not empty all
+ *  producers use it, so the order of elements pushed by one thread is kept.
+ *  \ingroup utils
+ */
+template<typename T>
+class MPSCQueue : public NoCopy
+{
+private:
+    /** One entry in the ring buffer. */
+    struct Cell
+    {
+        std::atomic<size_t> m_sequence;
+        T                   m_data;
+    };   // Cell
+
+    /** The ring buffer. */
+    Cell *m_cells;
+
+    /** Size of the ring buffer minus 1, used to wrap indices. */
+    size_t m_mask;
+
+    /** Position at which the next element will be written, shared by
+     *  all producers. */
+    std::atomic<size_t> m_enqueue_pos;
+
+    /** Position from which the next element is read. Only accessed by
+     *  the consumer thread. */
+    size_t m_dequeue_pos;
+
+    /** Number of elements in the overflow list. Checked without a lock
+     *  so that the overflow mutex is only used if the ring was full. */
+    std::atomic<size_t> m_overflow_size;
+
+    /** Elements that did not fit into the ring buffer. */
+    Synchronised<std::deque<T> > m_overflow;
+
+    // ------------------------------------------------------------------------
+    /** Tries to add an element to the ring buffer. Returns false if the
+     *  ring is full. */
+    bool pushRing(const T &value)
+    {
+        size_t pos = m_enqueue_pos.load(std::memory_order_relaxed);
+        Cell *cell;
+        while(true)
+        {
+            cell = &m_cells[pos & m_mask];
+            size_t seq = cell->m_sequence.load(std::memory_order_acquire);
+            ptrdiff_t dif = (ptrdiff_t)seq - (ptrdiff_t)pos;
+            if(dif==0)
+            {
+                if(m_enqueue_pos.compare_exchange_weak(pos, pos+1,
+                                                 std::memory_order_relaxed))
+                    break;
+            }
+            else if(dif<0)
+                return false;
+            else
+                pos = m_enqueue_pos.load(std::memory_order_relaxed);
+        }   // while true
+        cell->m_data = value;
+        cell->m_sequence.store(pos+1, std::memory_order_release);
+        return true;
+    }   // pushRing
+
+    // ------------------------------------------------------------------------
+    /** Tries to remove the oldest element from the ring buffer. Returns
+     *  false if the ring is empty. */
+    bool popRing(T *value)
+    {
+        Cell *cell = &m_cells[m_dequeue_pos & m_mask];
+        size_t seq = cell->m_sequence.load(std::memory_order_acquire);
+        if((ptrdiff_t)seq - (ptrdiff_t)(m_dequeue_pos+1) < 0)
+            return false;
+        *value = cell->m_data;
+        cell->m_sequence.store(m_dequeue_pos + m_mask + 1,
+                               std::memory_order_release);
+        m_dequeue_pos++;
+        return true;
+    }   // popRing
+
+public:
+    /** Creates the queue.
+     *  \param size Number of elements in the ring buffer, which must be a
+     *         power of 2. */
+    MPSCQueue(size_t size)
+    {
+        assert(size>=2 && (size & (size-1))==0);
+        m_cells = new Cell[size];
+        m_mask  = size - 1;
+        for(size_t i=0; i<size; i++)
+            m_cells[i].m_sequence.store(i, std::memory_order_relaxed);
+        m_enqueue_pos.store(0, std::memory_order_relaxed);
+        m_dequeue_pos = 0;
+        m_overflow_size.store(0, std::memory_order_relaxed);
+    }   // MPSCQueue
+
+    // ------------------------------------------------------------------------
+    ~MPSCQueue()
+    {
+        delete [] m_cells;
+    }   // ~MPSCQueue
+
+    // ------------------------------------------------------------------------
+    /** Adds an element to the queue. This can be called from any thread.
+     *  \return False if the ring buffer was full and the (slower)
+     *          overflow list had to be used. */
+    bool push(const T &value)
+    {
+        if(m_overflow_size.load(std::memory_order_acquire)==0 &&
+            pushRing(value))
+            return true;
+
+        m_overflow.lock();
+        m_overflow.getData().push_back(value);
+        m_overflow_size.fetch_add(1, std::memory_order_release);
+        m_overflow.unlock();
+        return false;
+    }   // push
+
+    // ------------------------------------------------------------------------
+    /** Removes the oldest element from the queue. Must only be called from
+     *  the one consumer thread.
+     *  \param value Where to store the element.
+     *  \return True if an element was removed, false if the queue is empty.*/
+    bool pop(T *value)
+    {
+        if(popRing(value))
+            return true;
+        if(m_overflow_size.load(std::memory_order_acquire)==0)
+            return false;
+
+        m_overflow.lock();
+        if(m_overflow.getData().empty())
+        {
+            m_overflow.unlock();
+            return false;
+        }
+        *value = m_overflow.getData().front();
+        m_overflow.getData().pop_front();
+        m_overflow_size.fetch_sub(1, std::memory_order_release);
+        m_overflow.unlock();
+        return true;
+    }   // pop
+
+    // ------------------------------------------------------------------------
+    /** Returns true if the queue is empty. Like pop() this must only be
+     *  called from the consumer thread. An element which is still being
+     *  written by a producer is not counted. */
+    bool isEmpty() const
+    {
+        const Cell *cell = &m_cells[m_dequeue_pos & m_mask];
+        size_t seq = cell->m_sequence.load(std::memory_order_acquire);
+        return (ptrdiff_t)seq - (ptrdiff_t)(m_dequeue_pos+1) < 0 &&
+               m_overflow_size.load(std::memory_order_acquire)==0;
+    }   // isEmpty
+
+};   // MPSCQueue
+
+#endif
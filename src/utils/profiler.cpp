@@ -371,7 +371,11 @@ void Profiler::draw()
     unsigned int gpu_timers[Q_LAST];
     for (unsigned i = 0; i < Q_LAST; i++)
     {
+#ifndef SERVER_ONLY
         gpu_timers[i] = irr_driver->getGPUTimer(i).elapsedTimeus();
+#else
+        gpu_timers[i] = 0;
+#endif
         total += gpu_timers[i];
     }
     
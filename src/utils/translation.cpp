@@ -43,6 +43,7 @@
 #include "config/user_config.hpp"
 #include "io/file_manager.hpp"
 #include "utils/constants.hpp"
+#include "utils/hash.hpp"
 #include "utils/log.hpp"
 
 
@@ -56,6 +57,21 @@ using namespace tinygettext;
 Translations* translations = NULL;
 const bool REMOVE_BOM = false;
 
+namespace
+{
+    /** Mixes a 0 terminated string into a FNV-1a hash. The terminating 0 is
+     *  included, so that e.g. message and context can not be confused. */
+    template<typename T>
+    uint64_t hashString(uint64_t hash, const T *s)
+    {
+        do
+        {
+            hash = Hash::mix(hash, (uint64_t)*s);
+        } while (*s++);
+        return hash;
+    }   // hashString
+}   // namespace
+
 #ifdef LINUX // m_debug
 #define PACKAGE "supertuxkart"
 #endif
@@ -174,6 +190,7 @@ wchar_t* fromFribidiChar(const FriBidiChar* str)
 // ----------------------------------------------------------------------------
 Translations::Translations() //: m_dictionary_manager("UTF-16")
 {
+    pthread_mutex_init(&m_cache_mutex, NULL);
     m_dictionary_manager.add_directory(
                         file_manager->getAsset(FileManager::TRANSLATION,""));
 
@@ -397,56 +414,76 @@ Translations::Translations() //: m_dictionary_manager("UTF-16")
 
 Translations::~Translations()
 {
+    pthread_mutex_destroy(&m_cache_mutex);
 }   // ~Translations
 
 // ----------------------------------------------------------------------------
 
 const wchar_t* Translations::fribidize(const wchar_t* in_ptr)
 {
-    if (isRTLText(in_ptr))
+    if (!isRTLText(in_ptr))
+        return in_ptr;
+
+    // Test if this string was already fribidized
+    const uint64_t hash = hashString(Hash::FNV_OFFSET, in_ptr);
+    typedef std::unordered_multimap<uint64_t, FribidizedString>::iterator
+            Iterator;
+    pthread_mutex_lock(&m_cache_mutex);
+    std::pair<Iterator, Iterator> range = m_fribidized_strings.equal_range(hash);
+    for (Iterator i = range.first; i != range.second; i++)
     {
-        // Test if this string was already fribidized
-        std::map<const irr::core::stringw, const irr::core::stringw>::const_iterator
-            found = m_fribidized_strings.find(in_ptr);
-        if (found != m_fribidized_strings.cend())
-            return found->second.c_str();
-
-        // Use fribidi to fribidize the string
-        // Split text into lines
-        std::vector<core::stringw> input_lines = StringUtils::split(in_ptr, '\n');
-        // Reverse lines for RTL strings, irrlicht will reverse them back
-        // This is needed because irrlicht inserts line breaks itself if a text
-        // is too long for one line and then reverses the lines again.
-        std::reverse(input_lines.begin(), input_lines.end());
-
-        // Fribidize and concat lines
-        core::stringw converted_string;
-        for (std::vector<core::stringw>::iterator it = input_lines.begin();
-             it != input_lines.end(); it++)
+        if (wcscmp(i->second.first.c_str(), in_ptr) == 0)
         {
-            if (it == input_lines.begin())
-                converted_string = fribidizeLine(*it);
-            else
-            {
-                converted_string += "\n";
-                converted_string += fribidizeLine(*it);
-            }
+            pthread_mutex_unlock(&m_cache_mutex);
+            return i->second.second.c_str();
+        }
+    }
+    pthread_mutex_unlock(&m_cache_mutex);
+
+    // Use fribidi to fribidize the string
+    // Split text into lines
+    std::vector<core::stringw> input_lines = StringUtils::split(in_ptr, '\n');
+    // Reverse lines for RTL strings, irrlicht will reverse them back
+    // This is needed because irrlicht inserts line breaks itself if a text
+    // is too long for one line and then reverses the lines again.
+    std::reverse(input_lines.begin(), input_lines.end());
+
+    // Fribidize and concat lines
+    core::stringw converted_string;
+    for (std::vector<core::stringw>::iterator it = input_lines.begin();
+         it != input_lines.end(); it++)
+    {
+        if (it == input_lines.begin())
+            converted_string = fribidizeLine(*it);
+        else
+        {
+            converted_string += "\n";
+            converted_string += fribidizeLine(*it);
         }
-
-        // Save it in the map
-        m_fribidized_strings.insert(std::pair<const irr::core::stringw, const irr::core::stringw>(
-            in_ptr, converted_string));
-        found = m_fribidized_strings.find(in_ptr);
-
-        return found->second.c_str();
     }
-    else
-        return in_ptr;
-}
+
+    // Save it in the cache. If another thread added the same string in the
+    // meantime, the duplicate is harmless.
+    pthread_mutex_lock(&m_cache_mutex);
+    Iterator i = m_fribidized_strings.insert(
+        std::make_pair(hash, FribidizedString(in_ptr, converted_string)));
+    const wchar_t *out_ptr = i->second.second.c_str();
+    pthread_mutex_unlock(&m_cache_mutex);
+    return out_ptr;
+}   // fribidize
 
 bool Translations::isRTLText(const wchar_t *in_ptr)
 {
 #if ENABLE_BIDI
+    // All characters with right-to-left direction (including the explicit
+    // direction marks) are at or above the Hebrew block, so most strings
+    // can be tested without calling fribidi.
+    const wchar_t *c = in_ptr;
+    while (*c && (unsigned int)*c < 0x0590)
+        c++;
+    if (*c == 0)
+        return false;
+
     std::size_t length = wcslen(in_ptr);
     FriBidiChar *fribidiInput = toFribidiChar(in_ptr);
 
@@ -494,29 +531,7 @@ const wchar_t* Translations::w_gettext(const char* original, const char* context
     Log::info("Translations", "Translating %s", original);
 #endif
 
-    const std::string& original_t = (context == NULL ?
-                                     m_dictionary.translate(original) :
-                                     m_dictionary.translate_ctxt(context, original));
-
-    if (original_t == original)
-    {
-        static irr::core::stringw converted_string;
-        converted_string = StringUtils::utf8ToWide(original);
-
-#if TRANSLATE_VERBOSE
-        std::wcout << L"  translation : " << converted_string << std::endl;
-#endif
-        return converted_string.c_str();
-    }
-
-    // print
-    //for (int n=0;; n+=4)
-
-    static core::stringw original_tw;
-    original_tw = StringUtils::utf8ToWide(original_t);
-
-    const wchar_t* out_ptr = original_tw.c_str();
-    if (REMOVE_BOM) out_ptr++;
+    const wchar_t* out_ptr = getCachedTranslation(original, NULL, 0, context);
 
 #if TRANSLATE_VERBOSE
     std::wcout << L"  translation : " << out_ptr << std::endl;
@@ -548,14 +563,8 @@ const wchar_t* Translations::w_ngettext(const wchar_t* singular, const wchar_t*
  */
 const wchar_t* Translations::w_ngettext(const char* singular, const char* plural, int num, const char* context)
 {
-    const std::string& res = (context == NULL ?
-                              m_dictionary.translate_plural(singular, plural, num) :
-                              m_dictionary.translate_ctxt_plural(context, singular, plural, num));
-
-    static core::stringw str_buffer;
-    str_buffer = StringUtils::utf8ToWide(res);
-    const wchar_t* out_ptr = str_buffer.c_str();
-    if (REMOVE_BOM) out_ptr++;
+    const wchar_t* out_ptr = getCachedTranslation(singular, plural, num,
+                                                  context);
 
 #if TRANSLATE_VERBOSE
     std::wcout << L"  translation : " << out_ptr << std::endl;
@@ -565,6 +574,98 @@ const wchar_t* Translations::w_ngettext(const char* singular, const char* plural
 }
 
 
+// ----------------------------------------------------------------------------
+/** Returns the translation of a message from the translation cache, and
+ *  adds it to the cache if it was not translated before. The returned
+ *  string stays valid as long as this object exists.
+ * \param original Message to translate, or singular form for plurals.
+ * \param plural   Plural form of the message, or NULL if the message has
+ *                 no plural form.
+ * \param num      Count used to obtain the correct plural form.
+ * \param context  Optional context of the message, or NULL.
+ */
+const wchar_t* Translations::getCachedTranslation(const char *original,
+                                                  const char *plural, int num,
+                                                  const char *context)
+{
+    // The translation of a plural message only depends on the plural form
+    // selected by the number, and on whether the number is 1 (the english
+    // rule used for untranslated messages).
+    int plural_key = -1;
+    if (plural)
+    {
+        plural_key = 2 * m_dictionary.get_plural_forms().get_plural(num)
+                   + (num == 1 ? 1 : 0);
+    }
+
+    uint64_t hash = hashString(Hash::FNV_OFFSET, original);
+    if (plural)
+        hash = hashString(hash, plural);
+    if (context)
+        hash = hashString(hash, context);
+    hash = Hash::mix(hash, (uint64_t)(plural_key + 1));
+    hash = Hash::mix(hash, context ? 1 : 0);
+
+    const size_t original_length = strlen(original);
+    const size_t full_length     = plural ? original_length + 1 + strlen(plural)
+                                          : original_length;
+
+    typedef std::unordered_multimap<uint64_t, CachedTranslation>::iterator
+            Iterator;
+    pthread_mutex_lock(&m_cache_mutex);
+    std::pair<Iterator, Iterator> range = m_translation_cache.equal_range(hash);
+    for (Iterator i = range.first; i != range.second; i++)
+    {
+        const CachedTranslation &cached = i->second;
+        if (cached.m_plural_key != plural_key                     ||
+            cached.m_has_context != (context != NULL)             ||
+            (context && cached.m_context != context)              ||
+            cached.m_original.size() != full_length               ||
+            memcmp(cached.m_original.data(), original,
+                   original_length) != 0                          ||
+            (plural && strcmp(cached.m_original.c_str() + original_length + 1,
+                              plural) != 0)                          )
+            continue;
+        const wchar_t *out_ptr = cached.m_translated.c_str();
+        pthread_mutex_unlock(&m_cache_mutex);
+        return REMOVE_BOM ? out_ptr + 1 : out_ptr;
+    }
+
+    std::string translated;
+    if (plural)
+    {
+        translated = context == NULL
+                   ? m_dictionary.translate_plural(original, plural, num)
+                   : m_dictionary.translate_ctxt_plural(context, original,
+                                                        plural, num);
+    }
+    else
+    {
+        translated = context == NULL
+                   ? m_dictionary.translate(original)
+                   : m_dictionary.translate_ctxt(context, original);
+    }
+
+    CachedTranslation cached;
+    cached.m_original = original;
+    if (plural)
+    {
+        cached.m_original.push_back('\0');
+        cached.m_original.append(plural);
+    }
+    cached.m_has_context = context != NULL;
+    if (context)
+        cached.m_context = context;
+    cached.m_plural_key  = plural_key;
+    cached.m_translated  = StringUtils::utf8ToWide(translated);
+
+    Iterator i = m_translation_cache.insert(std::make_pair(hash, cached));
+    const wchar_t *out_ptr = i->second.m_translated.c_str();
+    pthread_mutex_unlock(&m_cache_mutex);
+    return REMOVE_BOM ? out_ptr + 1 : out_ptr;
+}   // getCachedTranslation
+
+// ----------------------------------------------------------------------------
 bool Translations::isRTLLanguage() const
 {
     return m_rtl;
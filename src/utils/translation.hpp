@@ -21,11 +21,14 @@
 
 #include <irrString.h>
 #include <map>
+#include <pthread.h>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include "utils/string_utils.hpp"
+#include "utils/types.hpp"
 
 #include "tinygettext/tinygettext.hpp"
 
@@ -49,8 +52,38 @@ private:
     tinygettext::DictionaryManager m_dictionary_manager;
     tinygettext::Dictionary        m_dictionary;
 
-    /** A map that saves all fribidized strings: Original string, fribidized string */
-    std::map<const irr::core::stringw, const irr::core::stringw> m_fribidized_strings;
+    /** A translated string in the translation cache. */
+    struct CachedTranslation
+    {
+        /** The original message, for plural forms singular and plural
+         *  separated by a 0 byte. */
+        std::string        m_original;
+        /** The context, only valid if m_has_context is set. */
+        std::string        m_context;
+        bool               m_has_context;
+        /** Selects the plural form, -1 for messages without plural. */
+        int                m_plural_key;
+        irr::core::stringw m_translated;
+    };   // CachedTranslation
+
+    /** All strings translated so far, indexed by a hash of the original
+     *  message, context and plural form. Since the entries are never
+     *  removed or modified, the returned wide strings stay valid for the
+     *  lifetime of this object, and a repeated lookup does not need to
+     *  allocate any memory. A language switch creates a new Translations
+     *  object, which starts with an empty cache. */
+    std::unordered_multimap<uint64_t, CachedTranslation> m_translation_cache;
+
+    /** A fribidized string: original string, fribidized string. */
+    typedef std::pair<irr::core::stringw, irr::core::stringw> FribidizedString;
+
+    /** All strings fribidized so far, indexed by a hash of the original. */
+    std::unordered_multimap<uint64_t, FribidizedString> m_fribidized_strings;
+
+    /** Protects both caches, so that strings can be translated from
+     *  different threads. */
+    pthread_mutex_t m_cache_mutex;
+
     bool m_rtl;
 
     std::map<std::string, std::string> m_localized_name;
@@ -87,6 +120,9 @@ public:
 
 private:
     irr::core::stringw fribidizeLine(const irr::core::stringw &str);
+    const wchar_t*     getCachedTranslation(const char *original,
+                                            const char *plural, int num,
+                                            const char *context);
 };   // Translations
 
 
@@ -0,0 +1,173 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2016 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#include "utils/worker_pool.hpp"
+
+#include "config/hardware_stats.hpp"
+#include "config/user_config.hpp"
+#include "utils/log.hpp"
+#include "utils/vs.hpp"
+
+WorkerPool *WorkerPool::m_worker_pool = NULL;
+
+/** Upper limit for the number of worker threads. The work done in parallel
+ *  per frame is small, so more threads only add synchronisation overhead. */
+static const int MAX_WORKER_THREADS = 8;
+
+// ----------------------------------------------------------------------------
+/** Creates the worker pool. The number of threads is taken from the user
+ *  config, -1 selecting one thread less than the number of processors.
+ */
+void WorkerPool::create()
+{
+    assert(!m_worker_pool);
+    int n = UserConfigParams::m_worker_threads;
+    if (n < 0)
+        n = HardwareStats::getNumProcessors() - 1;
+    if (n < 0) n = 0;
+    if (n > MAX_WORKER_THREADS) n = MAX_WORKER_THREADS;
+    m_worker_pool = new WorkerPool(n);
+}   // create
+
+// ----------------------------------------------------------------------------
+/** Stops all worker threads and deletes the pool.
+ */
+void WorkerPool::destroy()
+{
+    delete m_worker_pool;
+    m_worker_pool = NULL;
+}   // destroy
+
+// ----------------------------------------------------------------------------
+WorkerPool::WorkerPool(unsigned int num_threads)
+{
+    pthread_mutex_init(&m_mutex, NULL);
+    pthread_cond_init(&m_cond_work, NULL);
+    pthread_cond_init(&m_cond_done, NULL);
+    m_job            = NULL;
+    m_job_count      = 0;
+    m_next_index.store(0);
+    m_busy_workers   = 0;
+    m_job_generation = 0;
+    m_abort          = false;
+
+    for (unsigned int i = 0; i < num_threads; i++)
+    {
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, &WorkerPool::mainLoop, this))
+        {
+            Log::warn("WorkerPool", "Could not create worker thread %d.", i);
+            break;
+        }
+        m_threads.push_back(thread);
+    }
+    Log::info("WorkerPool", "Using %d worker threads.",
+              (int)m_threads.size());
+}   // WorkerPool
+
+// ----------------------------------------------------------------------------
+WorkerPool::~WorkerPool()
+{
+    pthread_mutex_lock(&m_mutex);
+    m_abort = true;
+    pthread_cond_broadcast(&m_cond_work);
+    pthread_mutex_unlock(&m_mutex);
+
+    for (unsigned int i = 0; i < m_threads.size(); i++)
+        pthread_join(m_threads[i], NULL);
+
+    pthread_cond_destroy(&m_cond_done);
+    pthread_cond_destroy(&m_cond_work);
+    pthread_mutex_destroy(&m_mutex);
+}   // ~WorkerPool
+
+// ----------------------------------------------------------------------------
+/** The main loop of each worker thread: waits for a new job, then processes
+ *  indices of this job till none are left.
+ *  \param obj Pointer to the worker pool.
+ */
+void *WorkerPool::mainLoop(void *obj)
+{
+    VS::setThreadName("WorkerPool");
+    WorkerPool *me = (WorkerPool*)obj;
+    unsigned int last_generation = 0;
+
+    pthread_mutex_lock(&me->m_mutex);
+    while (true)
+    {
+        while (!me->m_abort && me->m_job_generation == last_generation)
+            pthread_cond_wait(&me->m_cond_work, &me->m_mutex);
+        if (me->m_abort)
+            break;
+
+        last_generation = me->m_job_generation;
+        const std::function<void(int)> *job = me->m_job;
+        const int count = me->m_job_count;
+        pthread_mutex_unlock(&me->m_mutex);
+
+        int i;
+        while ((i = me->m_next_index.fetch_add(1)) < count)
+            (*job)(i);
+
+        pthread_mutex_lock(&me->m_mutex);
+        me->m_busy_workers--;
+        if (me->m_busy_workers == 0)
+            pthread_cond_signal(&me->m_cond_done);
+    }   // while true
+    pthread_mutex_unlock(&me->m_mutex);
+    return NULL;
+}   // mainLoop
+
+// ----------------------------------------------------------------------------
+/** Calls f(i) for each i in 0 to count-1, distributed over the worker
+ *  threads and the calling thread, and returns when all calls are done.
+ *  The order in which the calls happen is undefined, so f must only
+ *  write data that belongs to index i.
+ *  \param count Number of indices.
+ *  \param f The function to call.
+ */
+void WorkerPool::parallelFor(int count, const std::function<void(int)> &f)
+{
+    if (count <= 0) return;
+    if (count == 1 || m_threads.empty())
+    {
+        for (int i = 0; i < count; i++)
+            f(i);
+        return;
+    }
+
+    pthread_mutex_lock(&m_mutex);
+    assert(m_busy_workers == 0);
+    m_job          = &f;
+    m_job_count    = count;
+    m_next_index.store(0);
+    m_busy_workers = (int)m_threads.size();
+    m_job_generation++;
+    pthread_cond_broadcast(&m_cond_work);
+    pthread_mutex_unlock(&m_mutex);
+
+    int i;
+    while ((i = m_next_index.fetch_add(1)) < count)
+        f(i);
+
+    pthread_mutex_lock(&m_mutex);
+    while (m_busy_workers > 0)
+        pthread_cond_wait(&m_cond_done, &m_mutex);
+    m_job = NULL;
+    pthread_mutex_unlock(&m_mutex);
+}   // parallelFor
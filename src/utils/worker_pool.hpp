@@ -0,0 +1,98 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2016 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#ifndef HEADER_WORKER_POOL_HPP
+#define HEADER_WORKER_POOL_HPP
+
+#include "utils/no_copy.hpp"
+
+#include <assert.h>
+#include <atomic>
+#include <functional>
+#include <pthread.h>
+#include <vector>
+
+/** A small pool of worker threads used to run independent pieces of work
+ *  of one frame in parallel (e.g. the decision making of all AI karts).
+ *  The only operation is parallelFor(), which calls a function for each
+ *  index in a range and returns once all calls are done. The calling
+ *  thread takes part in the work, so with 0 worker threads everything is
+ *  simply executed in order on the calling thread.
+ *  parallelFor() must only be called from the main thread, and the function
+ *  must not call parallelFor() again.
+ *  \ingroup utils
+ */
+class WorkerPool : public NoCopy
+{
+private:
+    /** The singleton instance. */
+    static WorkerPool *m_worker_pool;
+
+    /** The ids of all worker threads. */
+    std::vector<pthread_t> m_threads;
+
+    /** Protects the job data and the counters below. */
+    pthread_mutex_t m_mutex;
+
+    /** Signalled when a new job is available (or the pool is shut down). */
+    pthread_cond_t m_cond_work;
+
+    /** Signalled when the last worker has finished the current job. */
+    pthread_cond_t m_cond_done;
+
+    /** The function to execute for the current job. */
+    const std::function<void(int)> *m_job;
+
+    /** Number of indices of the current job. */
+    int m_job_count;
+
+    /** The next index to be processed. Each thread takes indices from
+     *  here till all are used, which balances the load automatically. */
+    std::atomic<int> m_next_index;
+
+    /** Number of worker threads still working on the current job. */
+    int m_busy_workers;
+
+    /** Incremented for each job, so workers can detect a new job. */
+    unsigned int m_job_generation;
+
+    /** Set to tell all worker threads to exit. */
+    bool m_abort;
+
+    WorkerPool(unsigned int num_threads);
+    ~WorkerPool();
+    static void *mainLoop(void *obj);
+
+public:
+    static void create();
+    static void destroy();
+    void parallelFor(int count, const std::function<void(int)> &f);
+
+    // ------------------------------------------------------------------------
+    /** Returns the worker pool. */
+    static WorkerPool *get()
+    {
+        assert(m_worker_pool);
+        return m_worker_pool;
+    }   // get
+    // ------------------------------------------------------------------------
+    /** Returns the number of worker threads (not counting the main thread).*/
+    unsigned int getNumThreads() const { return (unsigned int)m_threads.size(); }
+};   // WorkerPool
+
+#endif
@@ -182,30 +182,28 @@ def createAcGetter(groups):
 """.format(m.typeC, nameTitle, nameUnderscore.upper(), typeC, result))
 
 def createKpDefs(groups):
+    # The getter of KartStats to use for each type
+    statsGetters = {
+        "float":              "getFloat",
+        "bool":               "getBool",
+        "std::vector<float>": "getFloatVector",
+        "InterpolationArray": "getInterpolationArray",
+    }
     for g in groups:
-        print()
         for m in g.members:
             nameTitle = joinSubName(g, m, True)
             nameUnderscore = joinSubName(g, m, False)
             typeC = m.typeC
+            # Return larger types by reference to avoid copies
+            if typeC not in ["float", "bool"]:
+                typeC = "const {0}&".format(typeC)
 
-            print("    {0} get{1}() const;".
-                format(typeC, nameTitle, nameUnderscore))
-
-def createKpGetter(groups):
-    for g in groups:
-        for m in g.members:
-            nameTitle = joinSubName(g, m, True)
-            nameUnderscore = joinSubName(g, m, False)
-            typeC = m.typeC
-            result = "result"
-
-            print("""// ----------------------------------------------------------------------------
-{1} KartProperties::get{0}() const
-{{
-    return m_cached_characteristic->get{0}();
-}}  // get{0}
-""".format(nameTitle, typeC))
+            print("""    // ------------------------------------------------------------------------
+    {0} get{1}() const
+    {{
+        return m_stats.{2}(AbstractCharacteristic::{3});
+    }}   // get{1}""".format(typeC, nameTitle, statsGetters[m.typeC],
+                             nameUnderscore.upper()))
 
 def createGetType(groups):
     for g in groups:
@@ -243,8 +241,7 @@ functions = {
     "acgetter": (createAcGetter, "Implement the getters",                                  "karts/abstract_characteristic.cpp"),
     "getType":  (createGetType,  "Implement the getType function",                         "karts/abstract_characteristic.cpp"),
     "getName":  (createGetName,  "Implement the getName function",                         "karts/abstract_characteristic.cpp"),
-    "kpdefs":   (createKpDefs,   "Create the header function definitions for the getters", "karts/kart_properties.hpp"),
-    "kpgetter": (createKpGetter, "Implement the getters",                                  "karts/kart_properties.cpp"),
+    "kpdefs":   (createKpDefs,   "Implement the inline getters of the kart properties",    "karts/kart_properties.hpp"),
     "loadXml":  (createLoadXml,  "Code to load the characteristics from an xml file",      "karts/xml_characteristic.hpp"),
 }
 